@@ -7,14 +7,19 @@ document.addEventListener('DOMContentLoaded', () => {
   let currentMode = null;
   let modeStartTime = null;
   let tempChart;
+  let historyWindow = 'live';
+  let rangeData = [];
 
   // ---------------- WebSocket ----------------
 
   function initWebSocket() {
     ws = new WebSocket(`ws://${location.host}/ws`);
+    ws.binaryType = 'arraybuffer';
 
     ws.onopen = () => {
       console.log('WebSocket connected');
+      ws.send(JSON.stringify({ action: 'telemetryFormat', data: { format: 'binary' } }));
+      if (document.hidden) subscribeForVisibility();
       ws.send(JSON.stringify({ action: 'getHistory' }));
       ws.send(JSON.stringify({ action: 'notepadList' }));
     };
@@ -24,6 +29,18 @@ document.addEventListener('DOMContentLoaded', () => {
     ws.onerror = (error) => console.error('WebSocket error:', error);
   }
 
+  // A background tab only needs an occasional update; what changed
+  // meanwhile arrives with the next frame once the tab is shown again
+  const HIDDEN_UPDATE_RATE = 0.2;  // updates per second
+
+  function subscribeForVisibility() {
+    if (ws && ws.readyState === WebSocket.OPEN) {
+      ws.send(JSON.stringify({ action: 'subscribe', data: { maxRate: document.hidden ? HIDDEN_UPDATE_RATE : 0 } }));
+    }
+  }
+
+  document.addEventListener('visibilitychange', subscribeForVisibility);
+
   function sendMessage(payload) {
     if (ws && ws.readyState === WebSocket.OPEN) {
       ws.send(JSON.stringify(payload));
@@ -39,7 +56,7 @@ document.addEventListener('DOMContentLoaded', () => {
       const name = document.getElementById('notepadName').value.trim();
       const notes = document.getElementById('notepadArea').value;
       if (!name) return alert('Please enter a note name.');
-      sendMessage({ action: 'notepadSave', experiment: name, notes: notes });
+      saveNote(name, notes);
     };
 
     document.getElementById('notepadClear').onclick = () => {
@@ -51,10 +68,58 @@ document.addEventListener('DOMContentLoaded', () => {
     document.getElementById('notepadList').onchange = () => {
       const name = document.getElementById('notepadList').value;
       if (!name) return;
-      sendMessage({ action: 'notepadLoad', experiment: name });
+      loadingNote = '';
+      sendMessage({ action: 'notepadLoad', experiment: name, offset: 0 });
     };
   }
 
+  // Notes travel in chunks that fit one WebSocket frame; the device appends
+  // a chunk whose byte offset equals the stored size and replaces the note at 0.
+  const NOTE_MESSAGE_BYTES = 1024;
+  const utf8 = new TextEncoder();
+  let savedNote = { name: null, text: '' };  // content the device is known to hold
+  let loadingNote = '';
+
+  function saveNote(name, notes) {
+    let offset = 0;
+    let text = notes;
+    if (savedNote.name === name && savedNote.text && notes.startsWith(savedNote.text)) {
+      // Incremental save: only what was typed after the saved content
+      offset = utf8.encode(savedNote.text).length;
+      text = notes.slice(savedNote.text.length);
+      if (!text) return showStatusMessage('No changes to save', 'info');
+    }
+
+    const chunks = [];
+    while (text.length) {
+      let take = Math.min(text.length, NOTE_MESSAGE_BYTES / 2);
+      // Keep surrogate pairs together and shrink until the escaped message fits
+      while (take > 1 && utf8.encode(JSON.stringify(text.slice(0, take))).length > NOTE_MESSAGE_BYTES) take >>= 1;
+      if (take < text.length && /[\ud800-\udbff]/.test(text[take - 1])) take--;
+      chunks.push(text.slice(0, take));
+      text = text.slice(take);
+    }
+    if (!chunks.length) chunks.push('');
+
+    chunks.forEach((chunk, i) => {
+      sendMessage({ action: 'notepadSave', experiment: name, notes: chunk, offset: offset, last: i === chunks.length - 1 });
+      offset += utf8.encode(chunk).length;
+    });
+    savedNote = { name: name, text: notes };
+  }
+
+  function handleNoteChunk(msg) {
+    if (msg.offset === 0) loadingNote = '';
+    loadingNote += msg.notes || '';
+    if (msg.next < msg.total) {
+      sendMessage({ action: 'notepadLoad', experiment: msg.experiment, offset: msg.next });
+      return;
+    }
+    document.getElementById('notepadName').value = msg.experiment;
+    document.getElementById('notepadArea').value = loadingNote;
+    savedNote = { name: msg.experiment, text: loadingNote };
+  }
+
   function refreshNotepadList() {
     sendMessage({ action: 'notepadList' });
   }
@@ -139,6 +204,8 @@ document.addEventListener('DOMContentLoaded', () => {
   }
 
   function updateChart(data) {
+    // Long-term views are static snapshots of the telemetry log
+    if (historyWindow !== 'live') return;
     // Use backend timestamp if available
     if (data.time) {
       if (!chartStartTime) {
@@ -227,41 +294,109 @@ document.addEventListener('DOMContentLoaded', () => {
     });
   }
 
+  // ---------------- Binary Telemetry ----------------
+
+  // Must match Telemetry::Frame in include/utilities/TelemetryFrame.h
+  const TELEMETRY_MAGIC = 0xA5;
+  const TELEMETRY_VERSION = 2;
+  const TELEMETRY_FRAME_SIZE = 50;
+  const MODE_NAMES = ['Off', 'Ramp', 'Hold', 'Timer', 'Profile'];
+
+  function decodeTelemetryFrame(buffer) {
+    if (buffer.byteLength < TELEMETRY_FRAME_SIZE) return null;
+    const v = new DataView(buffer);
+    if (v.getUint8(0) !== TELEMETRY_MAGIC || v.getUint8(1) !== TELEMETRY_VERSION) return null;
+    return {
+      dirtyMask: v.getUint16(2, true),
+      sequence: v.getUint32(4, true),
+      temperature: v.getFloat32(8, true),
+      rpm: v.getInt32(12, true),
+      temp_setpoint: v.getFloat32(16, true),
+      rpm_setpoint: v.getInt32(20, true),
+      duration: v.getInt32(24, true),
+      alertTempThreshold: v.getFloat32(28, true),
+      alertRpmThreshold: v.getFloat32(32, true),
+      alertTimerThreshold: v.getInt32(36, true),
+      running_time: v.getUint32(40, true),
+      mode: MODE_NAMES[v.getUint8(44)] ?? 'Unknown',
+      profile_segment: v.getUint8(45) === 0xFF ? -1 : v.getUint8(45),
+      profile_elapsed: v.getUint32(46, true)
+    };
+  }
+
+  // ---------------- Long-term History ----------------
+
+  function requestHistoryWindow(value) {
+    historyWindow = value;
+    if (value === 'live') {
+      sendMessage({ action: 'getHistory' });
+    } else {
+      sendMessage({ action: 'getHistory', data: { window: parseInt(value, 10) } });
+    }
+  }
+
+  function renderHistoryRange(points, now) {
+    // x axis in seconds relative to "now" on the device log clock
+    fullData.labels = points.map(p => p.t - now);
+    fullData.temps = points.map(p => p.avg);
+    tempChart.data.datasets[1].data = [];
+    updateChartAggregated();
+  }
+
   // ---------------- Message Handling ----------------
 
+  function handleDataUpdate(data) {
+    updateInfoBoxes(data);
+    updateChart(data);
+    if (!window.formSyncedOnce) syncForm(data);
+
+    if (!modeStartTime && data.mode) {
+      currentMode = data.mode;
+      modeStartTime = Date.now();
+    }
+  }
+
   function handleWebSocketMessage(event) {
+    if (event.data instanceof ArrayBuffer) {
+      const frame = decodeTelemetryFrame(event.data);
+      if (frame) handleDataUpdate(frame);
+      else console.warn('Ignoring unknown binary frame');
+      return;
+    }
+
     try {
       const msg = JSON.parse(event.data);
 
       switch (msg.type) {
         case 'history':
-          console.log('Received history:', msg.data);
+          // History arrives in chunks; chunk 0 starts a fresh dataset
           if (Array.isArray(msg.data)) {
-            chartStartTime = new Date(msg.data[0]?.time).getTime();
-            fullData.labels = [];
-            fullData.temps = [];
-            tempChart.data.datasets[1].data = [];
+            if (!msg.chunk) {
+              chartStartTime = msg.data.length ? new Date(msg.data[0].time).getTime() : null;
+              fullData.labels = [];
+              fullData.temps = [];
+              tempChart.data.datasets[1].data = [];
+            }
 
             msg.data.forEach(point => {
               const t = new Date(point.time).getTime();
+              if (chartStartTime === null) chartStartTime = t;
               const elapsedSec = Math.floor((t - chartStartTime) / 1000);
               fullData.labels.push(elapsedSec);
               fullData.temps.push(point.temperature);
             });
 
-            updateChartAggregated();
+            if (msg.last !== false) updateChartAggregated();
           }
-        
+          break;
+        case 'historyRange':
+          // Persistent log query result, possibly split into chunks
+          if (!msg.chunk) rangeData = [];
+          rangeData.push(...msg.data);
+          if (msg.last !== false) renderHistoryRange(rangeData, msg.now);
           break;
         case 'dataUpdate':
-          updateInfoBoxes(msg.data);
-          updateChart(msg.data);
-          if (!window.formSyncedOnce) syncForm(msg.data);
-
-          if (!modeStartTime && msg.data.mode) {
-            currentMode = msg.data.mode;
-            modeStartTime = Date.now();
-          }
+          handleDataUpdate(msg.data);
           break;
         case 'events':
           renderEvents(msg.data);
@@ -271,14 +406,15 @@ document.addEventListener('DOMContentLoaded', () => {
           populateNotepadList(msg.experiments);
           break;
         case 'notepadData':
-          document.getElementById('notepadName').value = msg.experiment;
-          document.getElementById('notepadArea').value = msg.notes || '';
+          handleNoteChunk(msg);
           break;
         case 'notepadSaved':
           alert(`Notepad "${msg.experiment}" saved successfully.`);
           refreshNotepadList();
           break;
         case 'error':
+          // A failed save leaves the device copy unknown; the next save rewrites the note
+          savedNote = { name: null, text: '' };
           alert('Error: ' + msg.message);
           break;
         default:
@@ -311,7 +447,8 @@ document.addEventListener('DOMContentLoaded', () => {
   function updateInfoBoxes(data) {
     $('#temp').text(`${data.temperature.toFixed(1)} °C`);
     $('#rpm').text(data.rpm);
-    $('#mode').text(data.mode);
+    const step = data.profile_segment >= 0 ? ` (step ${data.profile_segment + 1}, ${data.profile_elapsed}s)` : '';
+    $('#mode').text(data.mode + step);
     $('#runningTime').text(formatRunningTime(data.running_time));
   }
 
@@ -384,6 +521,7 @@ document.addEventListener('DOMContentLoaded', () => {
 
   function setupControlHandlers() {
     $('#modeSelect').on('change', updateModeFields);
+    $('#historyWindow').on('change', e => requestHistoryWindow(e.target.value));
 
     $('#controlForm').on('submit', (e) => {
       e.preventDefault();
@@ -7,6 +7,7 @@
 #define CONFIG_H
 
 #include <cstdint> // For fixed-width integer types
+#include <cstddef> // For size_t
 
 // WiFi credentials
 constexpr char WIFI_SSID[] = "NETGEAR67";           ///< WiFi network SSID
@@ -15,6 +16,12 @@ constexpr char WIFI_PASSWORD[] = "IHaveATinyPenis"; ///< WiFi network password
 // Server settings
 constexpr uint16_t SERVER_PORT = 80;        ///< HTTP server port
 constexpr char WEBSOCKET_PATH[] = "/ws";    ///< WebSocket endpoint path
+constexpr size_t WS_MESSAGE_JSON_CAPACITY = 2560;   ///< ArduinoJson capacity of one incoming WebSocket message (a full profileSave; strings are parsed in place)
+constexpr int MAX_WS_CLIENTS = 8;           ///< Maximum tracked WebSocket clients (AsyncWebSocket default)
+constexpr uint32_t WS_MAX_UPDATE_INTERVAL_MS = 60000;   ///< Slowest update rate a client can subscribe to
+constexpr size_t WS_SLOW_CLIENT_TCP_SPACE = 1024;       ///< Client counts as slow below this much free TCP send buffer
+constexpr uint32_t WS_BACKOFF_MIN_MS = 200;             ///< First extra interval for a slow client (doubles while it stays slow)
+constexpr uint32_t WS_BACKOFF_MAX_MS = 5000;            ///< Longest extra interval for a slow client
 
 // Alert thresholds
 constexpr float ALERT_TEMP_THRESHOLD = 85.0f;   ///< Temperature alert threshold in degrees Celsius
@@ -22,8 +29,10 @@ constexpr int ALERT_RPM_THRESHOLD = 1500;        ///< RPM alert threshold
 constexpr int ALERT_TIMER_THRESHOLD = 3600;      ///< Timer alert threshold in seconds
 
 // History and event buffer sizes
-constexpr int HISTORY_SIZE = 100;   ///< Maximum number of history entries
-constexpr int MAX_EVENTS = 50;      ///< Maximum number of event log entries
+constexpr int HISTORY_SIZE = 2048;  ///< Maximum number of history entries (power of two)
+constexpr int HISTORY_CHUNK_ENTRIES = 64;   ///< History entries per streamed getHistory message
+constexpr int MAX_EVENTS = 50;      ///< Events kept by EventLog (16-byte records)
+constexpr size_t EVENT_TEXT_MAX = 96;   ///< Serialized size limit of one getEvents entry
 
 /**
  * @brief Namespace containing mode name strings
@@ -32,27 +41,210 @@ namespace Modes {
     constexpr char HOLD[] = "Hold";                         ///< Hold temperature mode
     constexpr char RAMP[] = "Ramp";                         ///< Temperature ramp mode
     constexpr char TIMER[] = "Timer";                       ///< Timer mode
-    constexpr char RECRYSTALLIZATION[] = "Recrystallization"; ///< Recrystallization mode
+    constexpr char PROFILE[] = "Profile";                   ///< Multi-segment profile mode
+    constexpr char RECRYSTALLIZATION[] = "Recrystallization"; ///< Built-in profile (alias of PROFILE as a mode name)
     constexpr char OFF[] = "Off";                           ///< Off mode
 }
 
+// Long-term telemetry log (LittleFS)
+#ifdef LITTLEFS_BLOCK_SIZE
+constexpr uint32_t TLOG_BLOCK_BYTES = LITTLEFS_BLOCK_SIZE;  ///< Flash write batch size (one LittleFS block)
+#else
+constexpr uint32_t TLOG_BLOCK_BYTES = 4096;                 ///< Flash write batch size (one LittleFS block)
+#endif
+constexpr char TLOG_DIR[] = "/tlog";                 ///< Directory holding telemetry log segments
+constexpr int TLOG_SEGMENT_BLOCKS = 4;               ///< Blocks per segment file (16 KB)
+constexpr int TLOG_MAX_SEGMENTS = 12;                ///< Upper bound on segments kept by any tier
+constexpr uint8_t TLOG_SEGMENTS_PER_TIER[] = {6, 6, 12};    ///< Retention per tier (1 s: ~1.7 h, 10 s: ~17 h, 1 min: ~8.5 days)
+constexpr int TLOG_MAX_QUERY_RECORDS = 4096;         ///< Finest tier is used while a window spans at most this many records
+constexpr int TLOG_MAX_QUERY_POINTS = 360;           ///< Maximum points returned by a range query
+
+// Persistent settings (NVS)
+constexpr char PERSIST_NAMESPACE[] = "smartplate";           ///< NVS namespace of the settings record
+constexpr char PERSIST_KEY[] = "settings";                   ///< NVS key of the settings record
+constexpr uint32_t PERSIST_DEBOUNCE_MS = 2000;               ///< Settings are written once unchanged this long
+constexpr uint32_t PERSIST_MAX_LATENCY_MS = 10000;           ///< ...or at the latest this long after the first unsaved change
+constexpr uint32_t PERSIST_FLUSH_WAIT_MS = 1000;             ///< flush() waits this long for a write in progress
+constexpr bool PERSIST_RESUME_HOLD = true;                   ///< Resume a HOLD after a reset (timed modes always come back OFF)
+
+// Static assets (built by scripts/build_assets.py)
+constexpr char ASSET_MANIFEST_PATH[] = "/assets.json";      ///< Path -> ETag/encoding manifest
+constexpr int MAX_STATIC_ASSETS = 32;                       ///< Manifest entries kept in RAM
+constexpr int ASSET_PATH_MAX = 48;                          ///< Longest served asset path (including terminator)
+constexpr size_t ASSET_MANIFEST_JSON_CAPACITY = 4096;       ///< ArduinoJson capacity for parsing the manifest
+constexpr char ASSET_CACHE_IMMUTABLE[] = "public, max-age=31536000, immutable";  ///< Cache-Control for ?v=<etag> URLs
+
+// File explorer streaming
+constexpr size_t FS_STREAM_BUFFER_BYTES = TLOG_BLOCK_BYTES;  ///< Download read size and alignment (one LittleFS block)
+constexpr int FS_MAX_DOWNLOADS = 2;                          ///< Concurrent /fs/download streams
+constexpr int FS_MAX_LISTINGS = 2;                           ///< Concurrent /fs/list streams
+constexpr int FS_PATH_MAX = 64;                              ///< Longest listed directory path (including terminator)
+constexpr size_t FS_LIST_LINE_BYTES = 192;                   ///< Serialized size limit of one listing entry
+constexpr int FS_MAX_UPLOADS = 2;                            ///< Concurrent /fs/upload requests (2 blocks of RAM each)
+constexpr int UPLOAD_QUEUE_LENGTH = 3 * FS_MAX_UPLOADS;      ///< Writer jobs in flight (two blocks and a commit per upload)
+
+// Notepad
+constexpr char NOTES_DIR[] = "/notes";                       ///< Directory holding one <name>.txt per note
+constexpr int NOTES_MAX = 32;                                ///< Notes kept in the in-RAM index
+constexpr size_t NOTE_NAME_MAX = 32;                         ///< Longest note name (including terminator)
+constexpr size_t NOTE_CHUNK_BYTES = 1024;                    ///< Note bytes per notepadData message
+
+// Profiles
+constexpr char PROFILES_DIR[] = "/profiles";                 ///< Directory holding one <name>.bin per profile
+constexpr int PROFILE_MAX_SEGMENTS = 32;                     ///< Segments per profile
+constexpr size_t PROFILE_NAME_MAX = 24;                      ///< Longest profile name (including terminator)
+constexpr float RECRYST_DISSOLVE_TEMP = 65.0f;               ///< Built-in recrystallization: dissolve temperature (C)
+constexpr float RECRYST_HEAT_RATE = 5.0f;                    ///< Built-in recrystallization: heating rate (C/min)
+constexpr uint32_t RECRYST_DISSOLVE_S = 600;                 ///< Built-in recrystallization: soak at the dissolve temperature (s)
+constexpr float RECRYST_COOL_RATE = 0.5f;                    ///< Built-in recrystallization: controlled cooling rate (C/min)
+constexpr float RECRYST_END_TEMP = 25.0f;                    ///< Built-in recrystallization: end of controlled cooling (C)
+
 // Other constants
 constexpr float DEFAULT_RAMP_RATE = 1.0f;   ///< Default temperature ramp rate in degrees/second
 
 // Hardware Configuration
 constexpr int CS_PIN = 5;                   ///< GPIO pin for MAX31865 chip select (SPI)
+constexpr int DRDY_PIN = 4;                 ///< GPIO pin for MAX31865 DRDY (-1 if not wired)
+constexpr bool SENSOR_FILTER_50HZ = true;   ///< MAX31865 mains filter: true = 50 Hz, false = 60 Hz
+constexpr int PROBE_CS_PIN = -1;            ///< Chip select of a second MAX31865 (liquid probe) on the same bus, -1 if not fitted
+constexpr int PROBE_DRDY_PIN = -1;          ///< DRDY of the second MAX31865 (-1 if not wired)
+constexpr size_t SENSOR_BATCH_MAX = 16;     ///< Samples taken from the sensor per control step (more stay queued)
+constexpr uint32_t SENSOR_STALE_MS = 500;   ///< Control channel without samples this long counts as failed (~25 conversions)
 constexpr int RELAY_PIN = 5;                ///< GPIO pin for relay control
 constexpr float MAX_TEMP_LIMIT = 70.0f;     ///< Maximum safe temperature in degrees Celsius
-constexpr int TEMP_FILTER_SIZE = 5;         ///< Size of temperature filter buffer
+
+// Stirrer (LEDC PWM drive, PCNT hall tachometer, closed-loop speed)
+constexpr int STIRRER_PWM_PIN = 25;                         ///< GPIO driving the motor driver input
+constexpr int STIRRER_TACH_PIN = 27;                        ///< GPIO of the hall sensor (open drain; PCNT enables the pull-up)
+constexpr int STIRRER_PULSES_PER_REV = 2;                   ///< Tachometer pulses per revolution
+constexpr int STIRRER_PWM_CHANNEL = 0;                      ///< LEDC channel of the motor
+constexpr uint32_t STIRRER_PWM_FREQ_HZ = 20000;             ///< Motor PWM frequency (above hearing)
+constexpr uint8_t STIRRER_PWM_BITS = 10;                    ///< Motor PWM resolution
+constexpr int STIRRER_PCNT_UNIT = 0;                        ///< PCNT unit counting tachometer pulses
+constexpr int16_t STIRRER_PCNT_LIMIT = 30000;               ///< Counter restarts at 0 here (far above the pulses of one step)
+constexpr uint16_t STIRRER_PCNT_FILTER = 1023;              ///< Glitch filter in APB cycles (12.8 us, the maximum)
+constexpr int STIRRER_RPM_WINDOW = 5;                       ///< Control steps the speed is measured over
+constexpr int STIRRER_MIN_RPM = 100;                        ///< Lowest running setpoint
+constexpr int STIRRER_MAX_RPM = 3000;                       ///< Highest setpoint, and the speed at full duty (feed-forward)
+constexpr float STIRRER_KP = 0.0002f;                       ///< Speed loop proportional gain (duty per RPM)
+constexpr float STIRRER_KI = 0.0004f;                       ///< Speed loop integral gain (duty per RPM*s)
+constexpr float STIRRER_KD = 0.0f;                          ///< Speed loop derivative gain (duty per RPM/s)
+constexpr float STIRRER_STALL_RPM = 30.0f;                  ///< A running motor below this speed is not turning
+constexpr uint32_t STIRRER_STALL_MS = 2000;                 ///< Stall fault after this long below STIRRER_STALL_RPM (includes spin-up)
+
+// Simulated plant (ThermalSimulator: env:bench, SMARTPLATE_SIMULATED_PLANT)
+constexpr float SIM_AMBIENT_C = 22.0f;                      ///< Ambient temperature
+constexpr float SIM_GAIN_C = 180.0f;                        ///< Plate rise above ambient at full power
+constexpr float SIM_PLATE_TAU_S = 300.0f;                   ///< Plate time constant
+constexpr float SIM_ELEMENT_TAU_S = 20.0f;                  ///< Heating element time constant
+constexpr float SIM_NOISE_C = 0.05f;                        ///< Peak reading noise
+
+// Temperature Filtering (HeatingElement control signal: median -> low-pass -> Kalman)
+enum class TempLowPass { NONE, EMA, BIQUAD };               ///< Low-pass stage selection
+constexpr int TEMP_MEDIAN_SIZE = 3;                         ///< Median-of-N spike rejection window (<= 1 disables)
+constexpr TempLowPass TEMP_LOWPASS = TempLowPass::BIQUAD;   ///< Low-pass stage
+constexpr float TEMP_EMA_ALPHA = 0.3f;                      ///< EMA weight of a new sample
+constexpr float TEMP_BIQUAD_CUTOFF_HZ = 0.25f;              ///< Biquad cutoff (sample rate is 1000 / HEATER_PERIOD_MS)
+constexpr float TEMP_BIQUAD_Q = 0.7071f;                    ///< Biquad quality factor (Butterworth)
+constexpr bool TEMP_KALMAN_ENABLED = false;                 ///< Enable the Kalman stage
+constexpr float TEMP_KALMAN_PROCESS_NOISE = 0.01f;          ///< Kalman process variance per sample (C^2)
+constexpr float TEMP_KALMAN_MEASUREMENT_NOISE = 0.25f;      ///< Kalman measurement variance (C^2)
+
+// Heater Control
+enum class HeaterControl { BANG_BANG, PID };                ///< Control algorithm selection
+constexpr HeaterControl HEATER_CONTROL_MODE = HeaterControl::PID;   ///< Heater control algorithm
+constexpr uint32_t PID_WINDOW_MS = 2000;                    ///< Time-proportioning window length
+constexpr uint32_t PID_MIN_SWITCH_MS = 200;                 ///< Minimum relay on/off time within a window
+constexpr float PID_KP = 0.1f;                              ///< Default proportional gain (duty per C)
+constexpr float PID_KI = 0.00033f;                          ///< Default integral gain (duty per C*s)
+constexpr float PID_KD = 1.0f;                              ///< Default derivative gain (duty per C/s)
+constexpr char PID_GAINS_PATH[] = "/pid.json";              ///< LittleFS file holding tuned gains
+constexpr float AUTOTUNE_HYSTERESIS = 0.3f;                 ///< Relay autotune switching band (+/- C)
+constexpr int AUTOTUNE_CYCLES = 4;                          ///< Oscillations averaged by the autotune
+constexpr uint32_t AUTOTUNE_TIMEOUT_MS = 2UL * 60 * 60 * 1000;  ///< Autotune gives up after this long
+
+// Plant model and ramp feed-forward
+constexpr uint32_t PLANT_SAMPLE_MS = 5000;                  ///< Identification interval (temperature slope and mean duty)
+constexpr float PLANT_FORGETTING = 0.995f;                  ///< RLS forgetting factor (memory of ~200 samples)
+constexpr float PLANT_RLS_P0 = 1000.0f;                     ///< Initial RLS covariance (and its bound when unexcited)
+constexpr uint32_t PLANT_MIN_SAMPLES = 24;                  ///< Samples before the model is trusted for feed-forward
+constexpr float PLANT_DEFAULT_GAIN = 150.0f;                ///< Initial guess: rise above ambient at full power (C)
+constexpr float PLANT_DEFAULT_TAU_S = 180.0f;               ///< Initial guess: time constant (s)
+constexpr float PLANT_DEFAULT_AMBIENT = 22.0f;              ///< Initial guess: ambient temperature (C)
+constexpr uint32_t PLANT_LEAD_MS = PID_WINDOW_MS / 2;       ///< Ramp feed-forward looks this far ahead (middle of the PID window)
 
 // Network Configuration
 constexpr char OTA_HOSTNAME[] = "ESP32-SmartPlate";  ///< OTA hostname
 
+/**
+ * @brief Fleet role of this plate: 0 = off, 1 = publisher, 2 = collector
+ *
+ * Select per plate with a build flag, e.g. -D FLEET_ROLE=2 on the plate that
+ * serves the combined dashboard. With the fleet enabled the mDNS hostname
+ * becomes OTA_HOSTNAME plus the last three MAC bytes, so plates do not clash.
+ */
+#ifndef FLEET_ROLE
+#define FLEET_ROLE 0
+#endif
+
+constexpr uint8_t FLEET_MULTICAST_GROUP[4] = {239, 255, 42, 1};    ///< IPv4 multicast group of the fleet datagrams
+constexpr uint16_t FLEET_PORT = 4210;                   ///< UDP port of the fleet datagrams (also announced over mDNS)
+constexpr uint32_t FLEET_PUBLISH_MS = 500;             ///< Publisher sends changed telemetry at most this often
+constexpr uint32_t FLEET_HEARTBEAT_MS = 5000;           ///< Publisher sends at least this often, changed or not
+constexpr uint32_t FLEET_PEER_TIMEOUT_MS = 3 * FLEET_HEARTBEAT_MS;  ///< Peer shown offline after this long without a datagram
+constexpr uint32_t FLEET_DISCOVERY_MS = 60000;          ///< Collector browses mDNS for plates this often
+constexpr int FLEET_MAX_PEERS = 8;                      ///< Plates tracked by the collector, itself included
+constexpr int FLEET_NAME_LEN = 24;                      ///< Plate name bytes in a datagram (NUL padded)
+constexpr uint32_t FLEET_HISTORY_PERIOD_MS = 5000;      ///< Collector keeps one temperature per plate this often
+constexpr int FLEET_HISTORY_POINTS = 120;               ///< Temperatures kept per plate (10 minutes)
+
 // System Configuration
 constexpr unsigned long UPDATE_INTERVAL_MS = 500;   ///< System state update interval in milliseconds
-constexpr int RPM_MIN = 100;                        ///< Minimum RPM value
-constexpr int RPM_MAX = 200;                        ///< Maximum RPM value
-constexpr int RPM_INCREMENT = 10;                   ///< RPM increment step
 constexpr uint16_t SERIAL_TCP_PORT = 23;            ///< TCP port for remote serial (telnet)
 
+// Task Scheduling
+constexpr int CONTROL_CORE = 1;                     ///< Core for the control, sensor and state tasks
+constexpr int NETWORK_CORE = 0;                     ///< Core for WiFi, AsyncTCP, web, telemetry and logging tasks
+constexpr int CONTROL_TASK_PRIORITY = 5;            ///< Control core: sensor, safety, heater, modes (highest on CONTROL_CORE)
+constexpr int SENSOR_TASK_PRIORITY = 4;             ///< RTD acquisition (short SPI reads on DRDY)
+constexpr int STATE_TASK_PRIORITY = 2;              ///< State/mode manager update
+constexpr int BROADCAST_TASK_PRIORITY = 2;          ///< WebSocket state broadcast
+constexpr int WEB_TASK_PRIORITY = 1;                ///< Web housekeeping and OTA
+constexpr int TELEMETRY_TASK_PRIORITY = 1;          ///< Persistent telemetry log
+constexpr int UPLOAD_TASK_PRIORITY = 1;             ///< Upload writer (flash writes off the AsyncTCP task)
+constexpr int FLEET_TASK_PRIORITY = 1;              ///< Fleet mDNS discovery (collector only)
+constexpr int PERSIST_TASK_PRIORITY = 1;            ///< Settings writer (NVS writes off the web task)
+
+// Task stacks (bytes, static). Each is the deepest path of the task plus about
+// 1 KB of headroom; /metrics reports stackSize and the measured stackFree per task.
+constexpr uint32_t CONTROL_TASK_STACK = 4096;       ///< Filters, PID, profile engine, mode callbacks and logging
+constexpr uint32_t SENSOR_TASK_STACK = 2048;        ///< SPI register reads and a queue send
+constexpr uint32_t STATE_TASK_STACK = 3072;         ///< Command batch, one formatted log line (LOG_LINE_MAX)
+constexpr uint32_t LOG_TASK_STACK = 3072;           ///< Serial and TCP writes of one log line
+constexpr uint32_t BROADCAST_TASK_STACK = 4096;     ///< dataUpdate document on the stack, lwIP UDP send
+constexpr uint32_t WEB_TASK_STACK = 4096;           ///< OTA update writes and LittleFS gains file
+constexpr uint32_t TELEMETRY_TASK_STACK = 4096;     ///< LittleFS block writes and segment rotation
+constexpr uint32_t UPLOAD_TASK_STACK = 4096;        ///< LittleFS block writes
+constexpr uint32_t PERSIST_TASK_STACK = 3072;       ///< One NVS blob write
+constexpr uint32_t FLEET_TASK_STACK = 4096;         ///< Blocking mDNS query
+constexpr uint32_t SENSOR_TIMEOUT_MS = 25;          ///< Acquisition also runs this often without DRDY (covers 50 Hz conversions)
+constexpr uint32_t HEATER_PERIOD_MS = 100;          ///< Control timer period (5% of PID_WINDOW_MS)
+constexpr uint32_t CONTROL_TIMEOUT_MS = 2 * HEATER_PERIOD_MS;   ///< Control also steps this long without a timer tick
+constexpr int CONTROL_COMMAND_SLOTS = 8;            ///< Mode commands queued for the next control step
+constexpr uint32_t STATE_TIMEOUT_MS = 100;          ///< State task runs at least this often without a control notification
+constexpr uint32_t WEB_PERIOD_MS = 50;              ///< Web housekeeping period
+constexpr uint32_t TELEMETRY_PERIOD_MS = 1000;      ///< Telemetry log sample period
+constexpr uint32_t PERSIST_PERIOD_MS = 500;         ///< Settings writer checks the debounce this often
+constexpr uint32_t HISTORY_INTERVAL_MS = 500;       ///< Minimum spacing of chart history entries
+
+// Instrumentation
+constexpr int METRICS_MAX_SECTIONS = 12;            ///< Maximum named METRICS_SCOPE sections
+constexpr size_t METRICS_JSON_CAPACITY = 4096;      ///< ArduinoJson capacity of a metrics report
+constexpr size_t RESPONSE_JSON_CAPACITY = METRICS_JSON_CAPACITY;    ///< Static arena for HTTP/WebSocket response documents (largest: metrics)
+
+// Logging Configuration
+constexpr int LOG_QUEUE_SLOTS = 32;                 ///< Messages buffered for the log drain task (power of two)
+constexpr int LOG_LINE_MAX = 128;                   ///< Maximum length of one log message, longer ones are truncated
+constexpr uint32_t LOG_DRAIN_INTERVAL_MS = 50;      ///< Log drain task polling interval in milliseconds
+
 #endif // CONFIG_H
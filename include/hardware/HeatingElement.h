@@ -3,34 +3,65 @@
 #define HEATINGELEMENT_H
 
 #include <Arduino.h>
-#include <Adafruit_MAX31865.h>
 #include "hardware/ITemperatureSensor.h"
+#include "hardware/ITemperatureFilter.h"
+#include "utilities/Pid.h"
+#include "utilities/PlantModel.h"
+#include "config/Config.h"
+#include <atomic>
 
 /**
  * @brief Controls a heating element with temperature monitoring and safety features
  * 
  * This class manages a heating element connected to a relay, monitors temperature
- * via a sensor interface, implements bang-bang control, and provides fault detection
- * and callback mechanisms.
+ * via a sensor interface, regulates it with bang-bang or PID control (selected by
+ * HEATER_CONTROL_MODE), and provides fault detection and callback mechanisms.
+ * Control acts on the filtered temperature; the over-temperature check uses the
+ * raw reading so filtering never delays a trip.
+ *
+ * In PID mode the controller output is a duty cycle that a time-proportioning
+ * window (PID_WINDOW_MS) turns into relay on/off, so the relay switches at most
+ * twice per window. A relay autotune experiment can derive the gains, which are
+ * stored in PID_GAINS_PATH on LittleFS.
+ *
+ * A PlantModel is identified online from the control samples. Once it is
+ * valid its inverse supplies feed-forward duty for the setpoint and its
+ * slope (setSetpointRate()), evaluated PLANT_LEAD_MS ahead, so ramps are
+ * not followed with the lag of a pure feedback loop. Bang-bang control
+ * switches against the same look-ahead setpoint.
+ *
+ * start()/stop() enable and disable control; the relay itself is switched by
+ * the control step in update(). Autotune and gain changes requested from other
+ * tasks are queued and applied by update().
  */
 class HeatingElement
 {
 public:
     using Callback = void (*)();
 
+    /**
+     * @brief Ramp tracking statistics and plant estimate
+     */
+    struct RampTracking
+    {
+        float error = 0.0f;         ///< Latest setpoint - temperature during a ramp (C)
+        float rmsError = 0.0f;      ///< RMS error over the current (or last) ramp (C)
+        float maxError = 0.0f;      ///< Largest absolute error over the current (or last) ramp (C)
+        uint32_t samples = 0;       ///< Control steps in the current (or last) ramp
+        bool modelValid = false;    ///< Feed-forward in use
+        float gain = 0.0f;          ///< Plant rise above ambient at full power (C)
+        float timeConstant = 0.0f;  ///< Plant time constant (s)
+        float ambient = 0.0f;       ///< Plant ambient temperature (C)
+    };
+
     /**
      * @brief Construct a new Heating Element object
      * @param relayPin GPIO pin number for the relay control
      * @param maxTempLimit Maximum temperature limit for safety
-     * @param filterSize Size of the temperature filter buffer
      * @param sensor Pointer to temperature sensor interface
+     * @param filter Pointer to temperature filter (nullptr to control on raw readings)
      */
-    HeatingElement(uint8_t relayPin, float maxTempLimit, int filterSize, ITemperatureSensor* sensor);
-    
-    /**
-     * @brief Destroy the Heating Element object and clean up resources
-     */
-    ~HeatingElement();
+    HeatingElement(uint8_t relayPin, float maxTempLimit, ITemperatureSensor* sensor, ITemperatureFilter* filter = nullptr);
 
     /**
      * @brief Initialize the temperature sensor (call in setup)
@@ -40,23 +71,28 @@ public:
     /**
      * @brief Update the heater state - call frequently (e.g. in loop)
      * 
-     * Reads temperature, checks for faults, and controls heater based on current mode
+     * Polls the sensor (the mean of the samples acquired since the previous
+     * update is the new reading, the previous one is kept if none arrived),
+     * reads the second probe if fitted, and controls heater based on current
+     * mode. A sensor fault, a missing channel or a control channel silent for
+     * SENSOR_STALE_MS turns the reading into NAN and latches a fault that
+     * stops the heater until the channel delivers samples again.
      */
     void update();
 
     /**
-     * @brief Manually start the heater
+     * @brief Enable temperature control (the relay follows the control mode)
      */
     void start();
     
     /**
-     * @brief Manually stop the heater
+     * @brief Disable temperature control, switch the relay off and cancel any autotune
      */
     void stop();
 
 
     /**
-     * @brief Add a new temperature reading to the filter buffer
+     * @brief Add a new temperature reading (runs the filter and the control logic)
      * @param temp Temperature value to add
      */
     void addTemperatureReading(float temp);
@@ -69,17 +105,102 @@ public:
     void setTargetTemperature(float target, float tolerance);
 
     /**
-     * @brief Get the current temperature reading
+     * @brief Remove the setpoint (an enabled heater then runs at full power)
+     */
+    void clearTargetTemperature();
+
+    /**
+     * @brief Set the slope of the setpoint (0 when it is constant)
+     * @param ratePerS Degrees Celsius per second, negative when cooling
+     */
+    void setSetpointRate(float ratePerS);
+
+    /**
+     * @brief Get ramp tracking statistics and the plant estimate
+     * @return RampTracking Snapshot published by the heater task
+     */
+    RampTracking getRampTracking() const;
+
+    /**
+     * @brief Load PID gains from PID_GAINS_PATH (call in setup after LittleFS is mounted)
+     */
+    void loadPidGains();
+
+    /**
+     * @brief Request new PID gains (applied by the next update(), saved by savePendingGains())
+     * @param gains New controller gains
+     */
+    void requestPidGains(const PidGains &gains);
+
+    /**
+     * @brief Write gains changed by update() (a request or a finished autotune) to PID_GAINS_PATH
+     *
+     * The control task does no file I/O; call this from a task that may
+     * wait on the file system.
+     */
+    void savePendingGains();
+
+    /**
+     * @brief Request a relay autotune around a setpoint (started by the next update())
+     * @param setpoint Temperature to oscillate around in degrees Celsius
+     *
+     * The experiment only drives the relay while the heater is enabled;
+     * stop() cancels it.
+     */
+    void requestAutotune(float setpoint);
+
+    /**
+     * @brief Request cancellation of a running autotune
+     */
+    void cancelAutotune();
+
+    /**
+     * @brief Get the PID gains in use
+     * @return PidGains Current gains
+     */
+    PidGains getPidGains() const;
+
+    /**
+     * @brief Get the autotune progress
+     * @return PidAutotuner::State State of the last requested experiment
+     */
+    PidAutotuner::State getAutotuneState() const;
+
+    /**
+     * @brief Get the current (filtered) temperature
      * @return float Current temperature in degrees Celsius
      */
     float getCurrentTemperature() const;
+
+    /**
+     * @brief Get the most recent unfiltered sensor reading
+     * @return float Raw temperature in degrees Celsius
+     */
+    float getRawTemperature() const;
+
+    /**
+     * @brief Get the latest reading of the second sensor channel (e.g. the liquid probe)
+     * @return float Temperature in degrees Celsius, NAN if not fitted or no sample yet
+     */
+    float getProbeTemperature() const { return probe.temperature; }
+
+    /**
+     * @brief Samples the sensor lost on the control channel since it started
+     */
+    uint32_t getDroppedSamples() const { return sensor.dropped; }
     
     /**
-     * @brief Check if heater is currently running
+     * @brief Check if heater control is enabled
      * @return true if heater is running
      * @return false if heater is stopped
      */
     bool isRunningState() const;
+
+    /**
+     * @brief Check if the relay is currently energized
+     * @return true if the relay is on
+     */
+    bool isRelayOn() const;
     
     /**
      * @brief Check if a fault condition has occurred
@@ -126,18 +247,10 @@ public:
 
 private:
     /**
-     * @brief Set the relay state (on/off)
+     * @brief Set the relay state (on/off), firing the heater on/off callbacks on transitions
      * @param on true to turn relay on, false to turn off
      */
     void setRelay(bool on);
-    
-    /**
-     * @brief Set relay state and trigger callback
-     * @param on true to turn relay on, false to turn off
-     * @param cb Callback function to trigger
-     * @param msg Optional message for logging
-     */
-    void setRelayWithCallback(bool on, Callback cb, const char* msg = nullptr);
 
     /**
      * @brief Trigger callback if value has changed
@@ -148,14 +261,41 @@ private:
     void triggerIfChanged(void (*cb)(float), float prev, float curr);
     
     /**
-     * @brief Check if temperature exceeds maximum limit and handle fault
+     * @brief Check the temperature limit and the sensor, and handle a fault
      */
     void checkOverTemperature();
     
+    /**
+     * @brief Run one control step and drive the relay
+     */
+    void control();
+
     /**
      * @brief Implement bang-bang control algorithm
      */
     void bangBangControl();
+
+    /**
+     * @brief Implement PID control through the time-proportioning window
+     */
+    void pidControl();
+
+    /**
+     * @brief Feed the running autotune experiment and apply its result when done
+     */
+    void autotuneControl();
+
+    /**
+     * @brief Apply autotune and gain requests queued by other tasks
+     */
+    void applyRequests();
+
+    /**
+     * @brief Use new gains and publish them for getPidGains()
+     * @param gains New controller gains
+     * @param save Mark them for savePendingGains()
+     */
+    void setPidGains(const PidGains &gains, bool save = false);
     
     /**
      * @brief Check if target temperature has been reached
@@ -163,16 +303,16 @@ private:
     void checkTargetReached();
 
     /**
-     * @brief Update the running state based on relay state
-     * @param relayOn Current relay state
+     * @brief Update the ramp tracking statistics and publish them with the plant estimate
      */
-    void updateRunningState(bool relayOn);
+    void trackRamp();
 
     void (*onTemperatureChanged)(float) = nullptr;
 
     // Relay pin and heater state
     uint8_t relayPin;
-    bool isRunning = false;
+    std::atomic<bool> enabled;
+    bool relayOn = false;
 
     // Temperature control variables
     float maxTemp;
@@ -180,18 +320,39 @@ private:
     float targetTolerance = 0.0f;
     bool targetTempSet = false;
     bool targetReachedTriggered = false;
+    float setpointRate = 0.0f;          ///< Setpoint slope in C/s (written by the mode manager)
 
     // Fault state
     bool fault = false;
 
-    // Temperature filtering buffer
-    int tempFilterSize;
-    float *tempBuffer = nullptr;
-    int tempIndex = 0;
+    // PID control (heater task only)
+    PidController pid;
+    TimeProportionalOutput window;
+    PidAutotuner autotuner;
+    uint32_t lastControlMs = 0;
+    bool pidArmed = false;              ///< Cleared to reset PID history on the next step
+    PlantModel plant;
+    bool ramping = false;
+    float rampErrorSq = 0.0f;           ///< Sum of squared tracking errors of the current ramp
+    RampTracking tracking;
 
-    // Current and filtered temperature
+    // Requests from other tasks and published values, guarded by requestMux
+    mutable portMUX_TYPE requestMux = portMUX_INITIALIZER_UNLOCKED;
+    bool gainsRequested = false;
+    PidGains requestedGains;
+    float requestedAutotune = NAN;      ///< NAN = no autotune request
+    bool cancelRequested = false;
+    PidGains publishedGains;
+    bool gainsUnsaved = false;          ///< publishedGains still need savePendingGains()
+    PidAutotuner::State publishedAutotune = PidAutotuner::IDLE;
+    RampTracking publishedTracking;
+
+    // Temperature filtering
+    ITemperatureFilter* tempFilter;
+
+    // Filtered (control) and raw temperature
     float currentTemp = 0.0f;
-    // float filteredTemp = 0.0f; // Filtering disabled in implementation
+    float rawTemp = 0.0f;
 
     // Callbacks
     Callback onFault = nullptr;
@@ -199,10 +360,31 @@ private:
     Callback onHeaterOff = nullptr;
     Callback onTargetReached = nullptr;
 
-   
-
     // Temperature sensor interface
     ITemperatureSensor* tempSensor;
+
+    /**
+     * @brief Reading state of one sensor channel
+     */
+    struct SensorChannel
+    {
+        float temperature = NAN;        ///< Mean of the last batch, NAN while failed
+        uint32_t lastSampleMs = 0;      ///< millis() of the last batch with samples
+        uint32_t dropped = 0;           ///< Samples the sensor lost on the channel
+        bool failed = false;            ///< Fault, unavailable or silent for SENSOR_STALE_MS
+    };
+    SensorChannel sensor;               ///< Control channel (0)
+    SensorChannel probe;                ///< Second channel (1)
+
+    /**
+     * @brief Poll one sensor channel and update its reading
+     * @param channel Channel index
+     * @param state Reading state of the channel
+     *
+     * A fault is logged and cleared on the sensor so the channel rearms, but
+     * the reading stays NAN (state.failed) until samples arrive again.
+     */
+    void pollSensor(uint8_t channel, SensorChannel &state);
 };
 
 #endif // HEATINGELEMENT_H
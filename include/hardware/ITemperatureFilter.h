@@ -0,0 +1,27 @@
+#pragma once
+
+/**
+ * @brief Interface for temperature sample filters
+ * 
+ * A filter turns the raw sensor readings into the control signal used by
+ * the heating element. Implementations must not allocate.
+ */
+class ITemperatureFilter {
+public:
+    /**
+     * @brief Virtual destructor
+     */
+    virtual ~ITemperatureFilter() = default;
+
+    /**
+     * @brief Feed one sample and get the filtered value
+     * @param sample Raw temperature in degrees Celsius (never NAN)
+     * @return float Filtered temperature in degrees Celsius
+     */
+    virtual float apply(float sample) = 0;
+
+    /**
+     * @brief Forget all history; the next sample restarts the filter
+     */
+    virtual void reset() = 0;
+};
@@ -1,21 +1,82 @@
 #pragma once
+#include <stddef.h>
+#include <stdint.h>
 
 /**
  * @brief Interface for temperature sensor implementations
- * 
+ *
  * This abstract class defines the interface that temperature sensors
  * must implement to be used with the heating element controller.
+ *
+ * A sensor has one or more channels (probes). poll() hands over the
+ * samples converted on a channel since the previous poll, each with its
+ * acquisition time, together with a status, so the caller never waits on
+ * a conversion and needs no knowledge of the concrete sensor.
  */
 class ITemperatureSensor {
 public:
+    /**
+     * @brief Outcome of a poll()
+     */
+    enum Status : uint8_t {
+        OK = 0,         ///< Samples returned
+        NO_DATA,        ///< No conversion finished since the previous poll
+        FAULT,          ///< The channel reported a fault (faultCode); clearFault() rearms it
+        UNAVAILABLE     ///< No such channel, or it was not started
+    };
+
+    /**
+     * @brief One conversion
+     */
+    struct Sample {
+        uint32_t timestampUs;   ///< esp_timer time of the acquisition
+        float temperature;      ///< Degrees Celsius
+    };
+
+    /**
+     * @brief Summary of one poll()
+     */
+    struct Batch {
+        Status status = UNAVAILABLE;
+        uint8_t faultCode = 0;      ///< Sensor specific fault bits (FAULT)
+        size_t count = 0;           ///< Samples written (oldest first)
+        uint32_t dropped = 0;       ///< Samples lost on the channel since it started
+    };
+
     /**
      * @brief Virtual destructor
      */
     virtual ~ITemperatureSensor() = default;
-    
+
+    /**
+     * @brief Initialize the sensor hardware
+     * @return true if at least the first channel is usable
+     */
+    virtual bool begin() = 0;
+
+    /**
+     * @brief Number of channels (probes)
+     */
+    virtual uint8_t channelCount() const { return 1; }
+
+    /**
+     * @brief Collect the samples of one channel acquired since the previous call
+     * @param channel Channel index (0 is the control probe)
+     * @param samples Receives up to maxSamples samples; the rest stay queued
+     * @param maxSamples Capacity of samples
+     * @return Batch Status, fault code and sample count
+     */
+    virtual Batch poll(uint8_t channel, Sample *samples, size_t maxSamples) = 0;
+
+    /**
+     * @brief Clear a fault reported by poll()
+     * @param channel Channel index
+     */
+    virtual void clearFault(uint8_t channel) = 0;
+
     /**
-     * @brief Read the current temperature from the sensor
+     * @brief Read the current temperature of the first channel
      * @return float Temperature reading in degrees Celsius
      */
     virtual float readTemperature() = 0;
-};
\ No newline at end of file
+};
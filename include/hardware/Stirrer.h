@@ -0,0 +1,106 @@
+#pragma once
+#ifndef STIRRER_H
+#define STIRRER_H
+
+#include <Arduino.h>
+#include <driver/pcnt.h>
+#include "utilities/Pid.h"
+#include "config/Config.h"
+
+/**
+ * @brief Stirrer motor with hardware tachometer and closed-loop speed control
+ *
+ * The motor is driven by an LEDC PWM channel. Hall sensor pulses are counted
+ * by a PCNT unit (with its glitch filter), so the CPU does no work per
+ * pulse; update() reads the counter once per control step and derives the
+ * speed over the last STIRRER_RPM_WINDOW steps, which keeps the reading
+ * steady at low speed where a step sees less than one pulse.
+ *
+ * A PID loop (output in PWM duty) regulates the measured RPM, with
+ * setpoint / STIRRER_MAX_RPM as feed-forward. A running motor that stays
+ * below STIRRER_STALL_RPM for STIRRER_STALL_MS latches a stall fault and
+ * is switched off; the next setTargetRPM() clears it.
+ *
+ * THREAD SAFETY: owned by the control task (ControlCore), like HeatingElement.
+ */
+class Stirrer
+{
+public:
+    /**
+     * @brief Construct a stirrer (hardware is set up by begin())
+     * @param pwmPin GPIO driving the motor (through its driver stage)
+     * @param tachPin GPIO of the hall sensor output
+     * @param pulsesPerRev Tachometer pulses per revolution
+     */
+    Stirrer(uint8_t pwmPin, uint8_t tachPin, uint8_t pulsesPerRev = STIRRER_PULSES_PER_REV);
+
+    /**
+     * @brief Set up the PWM channel and the pulse counter (motor off)
+     * @return true if the tachometer is available; otherwise the stirrer stays off
+     */
+    bool begin();
+
+    /**
+     * @brief Run one measurement and control step (control task)
+     * @param nowMs Current time in milliseconds
+     */
+    void update(uint32_t nowMs);
+
+    /**
+     * @brief Set the speed setpoint (clears a stall fault)
+     * @param rpm Target speed, clamped to STIRRER_MAX_RPM; 0 stops the motor
+     */
+    void setTargetRPM(int rpm);
+
+    /**
+     * @brief Measured speed
+     * @return float Revolutions per minute over the measurement window
+     */
+    float getRPM() const { return rpm; }
+
+    /**
+     * @brief Speed setpoint (0 when stopped)
+     */
+    int getTargetRPM() const { return targetRpm; }
+
+    /**
+     * @brief PWM duty currently applied, in [0, 1]
+     */
+    float getDuty() const { return duty; }
+
+    /**
+     * @brief Motor stalled and was switched off
+     */
+    bool hasFault() const { return fault; }
+
+private:
+    /**
+     * @brief Pulses counted since the previous call
+     */
+    uint32_t readPulses();
+
+    void applyDuty(float value);
+
+    uint8_t pwmPin;
+    uint8_t tachPin;
+    uint8_t pulsesPerRev;
+    bool available = false;
+
+    PidController pid;
+    int targetRpm = 0;
+    float duty = 0.0f;
+    float rpm = 0.0f;
+    bool fault = false;
+
+    int16_t lastCount = 0;
+    uint32_t totalPulses = 0;
+    uint32_t windowPulses[STIRRER_RPM_WINDOW] = {};   ///< totalPulses at each of the last steps
+    uint32_t windowMs[STIRRER_RPM_WINDOW] = {};
+    uint8_t windowHead = 0;
+    uint8_t windowCount = 0;
+
+    uint32_t lastUpdateMs = 0;
+    uint32_t lastMovingMs = 0;      ///< Last step at or above STIRRER_STALL_RPM (or the start)
+};
+
+#endif // STIRRER_H
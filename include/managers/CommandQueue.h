@@ -0,0 +1,100 @@
+#ifndef COMMANDQUEUE_H
+#define COMMANDQUEUE_H
+
+#include <Arduino.h>
+#include "managers/HeaterModeManager.h"
+#include "managers/ControlCore.h"
+
+struct SystemState;
+
+/**
+ * @brief One controlUpdate message: the fields it sets and their values
+ */
+struct ControlUpdate
+{
+    /**
+     * @brief Field bits for ControlUpdate::fields
+     */
+    enum Field : uint8_t
+    {
+        TEMP_SETPOINT = 1 << 0,
+        RPM_SETPOINT = 1 << 1,
+        MODE = 1 << 2,
+        DURATION = 1 << 3,
+        RESTART = 1 << 4            ///< With MODE: restart the mode even if it is already running
+    };
+
+    ControlUpdate() : fields(0), tempSetpoint(0.0f), rpmSetpoint(0), mode(HeaterModeManager::OFF), duration(0) {}
+
+    uint8_t fields;                 ///< Field bits present in this update
+    float tempSetpoint;             ///< Temperature setpoint (TEMP_SETPOINT)
+    int rpmSetpoint;                ///< RPM setpoint (RPM_SETPOINT)
+    HeaterModeManager::Mode mode;   ///< Operating mode (MODE)
+    int duration;                   ///< Duration in seconds (DURATION)
+};
+
+/**
+ * @brief Coalesces control updates from WebSocket clients into one batch per control tick
+ *
+ * This singleton collects controlUpdate messages (e.g. a burst of slider
+ * events) field by field, last writer wins. The state task applies the
+ * merged batch once per tick. A batch changes the state in one step and
+ * produces at most one broadcast. The batch reaches the mode manager as one
+ * ControlCore::configure() command. The mode is only (re)started when it
+ * actually changes, so setpoint changes do not reset a running RAMP or
+ * TIMER profile.
+ *
+ * THREAD SAFETY: submit() may be called from any task; the pending batch is
+ * guarded by a spinlock. apply() must be called by the state task, the
+ * only writer of the system state.
+ */
+class CommandQueue
+{
+public:
+    /**
+     * @brief Get the singleton instance
+     * @return CommandQueue& Reference to the singleton instance
+     */
+    static CommandQueue &getInstance();
+
+    /**
+     * @brief Merge an update into the pending batch
+     * @param update Fields to set; later values of a field replace earlier ones
+     */
+    void submit(const ControlUpdate &update);
+
+    /**
+     * @brief Apply the pending batch to the system state and send it to the control core
+     * @param state Working state of the state task (setpoints and duration are updated)
+     * @param control Control core to reconfigure (may be nullptr)
+     * @return true if a batch was applied
+     *
+     * The mode in state is the one the control core reports, so it only
+     * changes once the control core has applied the command. Until then a
+     * batch without MODE configures the mode this queue last submitted.
+     */
+    bool apply(SystemState &state, ControlCore *control);
+
+    /**
+     * @brief Updates merged into an earlier pending value since boot
+     * @return uint32_t Number of coalesced submissions
+     */
+    uint32_t coalescedCount() const { return coalesced; }
+
+private:
+    CommandQueue() = default;
+    CommandQueue(const CommandQueue &) = delete;
+    CommandQueue &operator=(const CommandQueue &) = delete;
+
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    ControlUpdate pending;
+    uint16_t pendingMessages = 0;
+    volatile uint32_t coalesced = 0;
+
+    // Last mode sent to the control core (state task only)
+    HeaterModeManager::Mode submittedMode = HeaterModeManager::OFF;
+    uint32_t submittedStep = 0;         ///< Control steps published when it was sent
+    bool modePending = false;           ///< The snapshot may not show submittedMode yet
+};
+
+#endif // COMMANDQUEUE_H
@@ -0,0 +1,220 @@
+#ifndef CONTROLCORE_H
+#define CONTROLCORE_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <TaskManager.h>
+#include "hardware/HeatingElement.h"
+#include "hardware/Stirrer.h"
+#include "managers/HeaterModeManager.h"
+#include "utilities/Mailbox.h"
+#include "config/Config.h"
+
+/**
+ * @brief Control outputs published after every control step
+ */
+struct ControlSnapshot
+{
+    float temperature = NAN;                        ///< Filtered temperature (C)
+    float targetTemperature = 0.0f;                 ///< Heater setpoint (C)
+    float probeTemperature = NAN;                   ///< Second sensor channel (C), NAN if not fitted
+    uint32_t sensorDropped = 0;                     ///< Sensor samples lost on the control channel
+    HeaterModeManager::Mode mode = HeaterModeManager::OFF;
+    bool heating = false;                           ///< Relay state
+    bool fault = false;                             ///< Heater latched a fault
+    float rpm = 0.0f;                               ///< Measured stirrer speed
+    int rpmTarget = 0;                              ///< Stirrer setpoint (0 = stopped)
+    float stirrerDuty = 0.0f;                       ///< Stirrer PWM duty in [0, 1]
+    bool stirrerFault = false;                      ///< Stirrer stalled and was stopped
+    int profileSegment = -1;                        ///< Running profile segment, -1 if none
+    uint32_t profileElapsed = 0;                    ///< Seconds in the profile segment
+    uint32_t steps = 0;                             ///< Control steps since begin()
+    uint32_t timeMs = 0;                            ///< millis() of the step
+};
+
+/**
+ * @brief Fixed-rate control core: sensor, safety, heater, stirrer and mode manager
+ *
+ * A periodic esp_timer wakes a dedicated task on CONTROL_CORE every
+ * HEATER_PERIOD_MS. That task is the only one that touches the
+ * HeatingElement, the Stirrer and the HeaterModeManager. Each step it
+ * - reads the sensor, runs the over-temperature check and the heater control,
+ * - applies queued mode, autotune and stirrer commands,
+ * - measures and regulates the stirrer speed,
+ * - advances the mode manager,
+ * - publishes a ControlSnapshot and wakes the listener (the state task).
+ *
+ * It takes no mutex and does no network or file I/O. Other tasks talk
+ * to it only through the command queue (setOff() ... configure(), which
+ * never wait) and the snapshot mailbox, so a web handler or flash
+ * operation holding a lock cannot delay a step. The task is subscribed
+ * to the task watchdog; a step that never finishes resets the chip, which
+ * drops the relay.
+ *
+ * THREAD SAFETY: every public method except begin() may be called from any task.
+ */
+class ControlCore
+{
+public:
+    /**
+     * @brief Construct the control core
+     * @param heater Heater driven by the control task
+     * @param modeManager Mode manager driven by the control task
+     * @param stirrer Stirrer driven by the control task (nullptr if none)
+     */
+    ControlCore(HeatingElement &heater, HeaterModeManager &modeManager, Stirrer *stirrer = nullptr);
+
+    /**
+     * @brief Start the control task and its timer
+     * @param tasks TaskManager that creates the task
+     * @param listener Task notified after every step (may be NULL)
+     * @return true on success
+     */
+    bool begin(TaskManager &tasks, TaskHandle_t listener);
+
+    /**
+     * @brief Turn the heater off
+     * @return true if the command was queued
+     */
+    bool setOff();
+
+    /**
+     * @brief Hold a temperature
+     * @param holdTemp Temperature in degrees Celsius
+     * @return true if the command was queued
+     */
+    bool setHold(float holdTemp);
+
+    /**
+     * @brief Ramp the setpoint linearly
+     * @param startTemp Start temperature in degrees Celsius
+     * @param endTemp End temperature in degrees Celsius
+     * @param durationSeconds Ramp length in seconds
+     * @return true if the command was queued
+     */
+    bool setRamp(float startTemp, float endTemp, unsigned long durationSeconds);
+
+    /**
+     * @brief Heat for a fixed time
+     * @param durationSeconds Duration in seconds
+     * @param targetTemp Target temperature in degrees Celsius
+     * @param useTemp Regulate to targetTemp (otherwise full power)
+     * @return true if the command was queued
+     */
+    bool setTimer(unsigned long durationSeconds, float targetTemp = 0, bool useTemp = false);
+
+    /**
+     * @brief Run a profile, starting from the temperature at the step that applies it
+     * @param program Program to run (copied)
+     * @return true if the command was queued
+     */
+    bool setProfile(const Profile::Program &program);
+
+    /**
+     * @brief Reconfigure the mode from the control settings
+     * @param mode Operating mode
+     * @param restart (Re)start the mode; otherwise only its parameters change
+     * @param tempSetpoint Temperature setpoint in degrees Celsius
+     * @param durationSeconds Mode duration in seconds
+     * @param applySetpoint Also move the running mode's target to tempSetpoint
+     * @return true if the command was queued
+     */
+    bool configure(HeaterModeManager::Mode mode, bool restart, float tempSetpoint, unsigned long durationSeconds, bool applySetpoint);
+
+    /**
+     * @brief Set the stirrer speed (clears a stall fault)
+     * @param rpm Target speed, 0 stops the motor
+     * @return true if the command was queued
+     */
+    bool setStirrer(int rpm);
+
+    /**
+     * @brief Hold a temperature and run the relay autotune around it
+     * @param setpoint Temperature in degrees Celsius
+     * @return true if the command was queued
+     *
+     * The hold is entered in the same step that requests the experiment,
+     * so the heater is enabled when the next update starts it.
+     */
+    bool startAutotune(float setpoint);
+
+    /**
+     * @brief Cancel a running or queued autotune (the hold stays)
+     * @return true if the command was queued
+     */
+    bool cancelAutotune();
+
+    /**
+     * @brief Latest published control outputs
+     */
+    ControlSnapshot snapshot() const { return published.read(); }
+
+    /**
+     * @brief Commands rejected because the queue was full
+     */
+    uint32_t droppedCommands() const { return dropped; }
+
+private:
+    /**
+     * @brief One queued request for the mode manager
+     */
+    struct Command
+    {
+        enum Type : uint8_t
+        {
+            OFF,
+            HOLD,
+            RAMP,
+            TIMER,
+            PROFILE,    ///< Program waits in the profile slot
+            CONFIGURE,
+            STIR,
+            AUTOTUNE    ///< Hold and start (flag) or cancel the autotune
+        };
+
+        Type type;
+        HeaterModeManager::Mode mode;   ///< CONFIGURE
+        bool flag;                      ///< TIMER: use temperature, CONFIGURE: restart, AUTOTUNE: start
+        bool applySetpoint;             ///< CONFIGURE: set the target temperature
+        float temperature;              ///< HOLD / TIMER / CONFIGURE / AUTOTUNE setpoint, RAMP end
+        float startTemperature;         ///< RAMP start
+        uint32_t duration;              ///< Seconds
+        int32_t rpm;                    ///< STIR target
+    };
+
+    bool post(const Command &command);
+
+    /**
+     * @brief Periodic timer callback (esp_timer task): wake the control task
+     */
+    static void onTimer(void *arg);
+
+    /**
+     * @brief TaskManager job: one control step
+     */
+    static void job(void *parameter);
+
+    void step();
+    void execute(const Command &command);
+
+    HeatingElement &heater;
+    HeaterModeManager &modeManager;
+    Stirrer *stirrer;
+
+    QueueHandle_t commands = NULL;
+    QueueHandle_t profiles = NULL;      ///< One-slot, overwritten: the program of the latest PROFILE command
+    StaticQueue_t commandQueue;
+    StaticQueue_t profileQueue;
+    uint8_t commandStorage[CONTROL_COMMAND_SLOTS * sizeof(Command)];
+    uint8_t profileStorage[sizeof(Profile::Program)];
+    TaskStack<CONTROL_TASK_STACK> taskMemory;   ///< Control task stack and control block
+    esp_timer_handle_t timer = nullptr;
+    TaskHandle_t task = NULL;
+    TaskHandle_t listener = NULL;
+
+    Mailbox<ControlSnapshot> published;
+    uint32_t steps = 0;
+    volatile uint32_t dropped = 0;
+};
+
+#endif // CONTROLCORE_H
@@ -0,0 +1,176 @@
+#ifndef FLEETMANAGER_H
+#define FLEETMANAGER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <AsyncUDP.h>
+#include <array>
+#include "utilities/TelemetryFrame.h"
+#include "config/Config.h"
+
+struct SystemState;
+
+/**
+ * @brief Telemetry sharing between plates on one network
+ *
+ * A publisher multicasts one small datagram (a Telemetry::Frame with the
+ * plate name and a sequence number) to FLEET_MULTICAST_GROUP whenever its
+ * telemetry changed, at most every FLEET_PUBLISH_MS and at least every
+ * FLEET_HEARTBEAT_MS. It announces itself as a _smartplate._udp mDNS
+ * service.
+ *
+ * A collector also publishes, and in addition listens to the group, browses
+ * mDNS for plates that have not been heard yet and keeps the latest frame,
+ * packet loss and a short temperature history per plate. The combined view
+ * is served by the web server (/fleet.json, fleet/index.html), so watching
+ * the fleet needs one browser connection to the collector.
+ *
+ * THREAD SAFETY: begin() once from any task (the role is set last),
+ * publish() from one task (the broadcast task), discover()
+ * from one task; datagrams arrive on the AsyncUDP task. The peer table is
+ * guarded by a spinlock, so writeJson() may be called from any task.
+ */
+class FleetManager
+{
+public:
+    /**
+     * @brief What this plate does in the fleet (FLEET_ROLE)
+     */
+    enum Role : uint8_t
+    {
+        OFF = 0,
+        PUBLISHER = 1,
+        COLLECTOR = 2
+    };
+
+    static constexpr uint8_t MAGIC = 0x5F;     ///< First byte of every fleet datagram
+    static constexpr uint8_t VERSION = 1;      ///< Bumped whenever the datagram layout changes
+
+    /**
+     * @brief Wire layout of a fleet datagram (little-endian, packed)
+     */
+    struct __attribute__((packed)) Datagram
+    {
+        uint8_t magic;                  ///< MAGIC
+        uint8_t version;                ///< VERSION
+        uint8_t role;                   ///< Role of the sender
+        uint8_t reserved;
+        uint32_t sequence;              ///< Incremented for every datagram sent
+        char name[FLEET_NAME_LEN];      ///< Sender hostname, NUL padded
+        Telemetry::Frame frame;         ///< Sender telemetry
+    };
+
+    static_assert(sizeof(Datagram) == 32 + sizeof(Telemetry::Frame), "Fleet datagram layout changed - bump VERSION");
+
+    /// ArduinoJson capacity for writeJson() (names and addresses are copied)
+    static constexpr size_t JSON_CAPACITY = JSON_OBJECT_SIZE(4) + JSON_ARRAY_SIZE(FLEET_MAX_PEERS) +
+                                            FLEET_MAX_PEERS * (JSON_OBJECT_SIZE(13) + FLEET_NAME_LEN + 1 + 16);
+    /// ArduinoJson capacity for writeHistoryJson()
+    static constexpr size_t HISTORY_JSON_CAPACITY = JSON_OBJECT_SIZE(3) + JSON_ARRAY_SIZE(FLEET_HISTORY_POINTS) + FLEET_NAME_LEN + 1;
+
+    /**
+     * @brief Get the singleton instance
+     * @return FleetManager& Reference to the singleton instance
+     */
+    static FleetManager &getInstance();
+
+    /**
+     * @brief Hostname for OTA and mDNS
+     * @return const char* OTA_HOSTNAME, or OTA_HOSTNAME-xxxxxx (MAC suffix) when the fleet is enabled
+     */
+    static const char *hostname();
+
+    /**
+     * @brief Start the fleet role (after WiFi and mDNS are up)
+     * @param role Role of this plate
+     * @return true if the role is active
+     */
+    bool begin(Role role);
+
+    /**
+     * @brief Send a datagram if the telemetry changed or the heartbeat is due
+     * @param state Published system state
+     */
+    void publish(const SystemState &state);
+
+    /**
+     * @brief Browse mDNS for plates (collector only; blocks for the query)
+     */
+    void discover();
+
+    /**
+     * @brief Describe the fleet
+     * @param doc Receives {"role","name","sent","peers":[...]}
+     */
+    void writeJson(JsonDocument &doc);
+
+    /**
+     * @brief Temperature history of one plate
+     * @param name Plate name
+     * @param doc Receives {"name","periodMs","temperatures":[oldest..newest]}
+     * @return true if the plate is known
+     */
+    bool writeHistoryJson(const char *name, JsonDocument &doc);
+
+    /**
+     * @brief Active role
+     */
+    Role getRole() const { return role; }
+
+    /**
+     * @brief Name of a role
+     */
+    static const char *roleName(Role role);
+
+private:
+    /**
+     * @brief Latest state of one plate
+     */
+    struct Peer
+    {
+        char name[FLEET_NAME_LEN + 1] = {};     ///< Empty if the slot is free
+        uint32_t ip = 0;                        ///< Last sender address
+        uint8_t role = OFF;
+        Telemetry::Frame frame = {};
+        bool heard = false;                     ///< A datagram arrived (not only found over mDNS)
+        uint32_t lastSeenMs = 0;
+        uint32_t sequence = 0;                  ///< Last datagram sequence number
+        uint32_t received = 0;
+        uint32_t lost = 0;                      ///< Sequence numbers skipped
+        uint32_t lastHistoryMs = 0;
+        uint16_t historyHead = 0;               ///< Next history slot
+        uint16_t historyCount = 0;
+        float history[FLEET_HISTORY_POINTS] = {};
+    };
+
+    FleetManager() = default;
+    FleetManager(const FleetManager &) = delete;
+    FleetManager &operator=(const FleetManager &) = delete;
+
+    void onPacket(AsyncUDPPacket &packet);
+
+    /**
+     * @brief Store a datagram in the peer table
+     * @param datagram Received (or own) datagram
+     * @param ip Sender address
+     */
+    void record(const Datagram &datagram, uint32_t ip);
+
+    /**
+     * @brief Find a peer by name or claim a slot for it (the free or longest silent one)
+     * @return Peer* Never nullptr; caller holds mux
+     */
+    Peer *slotFor(const char *name);
+
+    volatile Role role = OFF;       ///< Set last by begin(), read by the broadcast task
+    AsyncUDP udp;
+    Telemetry::Encoder encoder;     ///< Publisher side (publish() only)
+    Datagram outgoing = {};
+    uint32_t lastSentMs = 0;
+    uint32_t sent = 0;
+
+    std::array<Peer, FLEET_MAX_PEERS> peers;
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+};
+
+#endif // FLEETMANAGER_H
@@ -2,12 +2,15 @@
 
 #include <Arduino.h>
 #include "hardware/HeatingElement.h"
+#include "utilities/ProfileEngine.h"
 
 /**
  * @brief Manages different operating modes for the heating element
  * 
- * This class provides high-level control modes including OFF, RAMP, HOLD, and TIMER
- * modes with automatic temperature control and timing.
+ * This class provides high-level control modes including OFF, RAMP, HOLD, TIMER
+ * and PROFILE modes with automatic temperature control and timing. PROFILE
+ * runs a multi-segment Profile::Program through a ProfileEngine on every
+ * update(), i.e. at the control tick rate.
  */
 class HeaterModeManager
 {
@@ -20,9 +23,12 @@ public:
         OFF,    ///< Heater is off
         RAMP,   ///< Ramping temperature from start to end over time
         HOLD,   ///< Holding constant temperature
-        TIMER   ///< Running for a specific duration
+        TIMER,  ///< Running for a specific duration
+        PROFILE ///< Running a multi-segment profile
     };
 
+    static constexpr int MODE_COUNT = PROFILE + 1;    ///< Number of modes (the values double as telemetry mode codes)
+
     /**
      * @brief Construct a new Heater Mode Manager
      * @param heater Reference to the HeatingElement to control
@@ -55,6 +61,19 @@ public:
      * @param useTemp Whether to use temperature control (true) or just timing (false)
      */
     void setTimer(unsigned long durationSeconds, float targetTemp = 0, bool useTemp = false);
+
+    /**
+     * @brief Set profile mode - run a program from its first segment
+     * @param program Validated program (becomes the program used by setMode(PROFILE))
+     * @param currentTemp Current temperature in degrees Celsius, start of the first ramp
+     */
+    void setProfile(const Profile::Program &program, float currentTemp);
+
+    /**
+     * @brief Get the profile engine (progress of the running program)
+     * @return const ProfileEngine& Engine state
+     */
+    const ProfileEngine &getProfile() const { return profile; }
     
     /**
      * @brief Update the mode manager state - call regularly in loop
@@ -81,17 +100,24 @@ public:
     Mode getCurrentMode() const;
     
     /**
-     * @brief Convert Mode enum to human-readable string representation
+     * @brief Convert Mode enum to its display name
      * @param mode The Mode enum value to convert
-     * @return String representation of the mode ("Off", "Ramp", "Hold", "Timer", or "Unknown")
+     * @return const char* Static name ("Off", "Ramp", "Hold", "Timer", "Profile", or "Unknown")
      */
-    static String modeToString(Mode mode);
+    static const char *modeName(Mode mode);
 
     /**
-     * @brief Set the mode by string or enum
-     * @param modeStr The mode as a string ("Off", "Ramp", "Hold", "Timer")
+     * @brief Parse a mode name (case-insensitive; "Recrystallization" selects PROFILE)
+     * @param name Mode name as sent by clients
+     * @param mode Receives the mode
+     * @return true if the name is a known mode
+     */
+    static bool parseMode(const char *name, Mode &mode);
+
+    /**
+     * @brief Set the mode, using the stored parameters for that mode
+     * @param modeVal The mode to switch to
      */
-    void setMode(const String& modeStr);
     void setMode(Mode modeVal);
 
     /**
@@ -123,6 +149,11 @@ private:
     unsigned long timerDuration = 0, timerStartTime = 0;
     bool timerUseTemp = false;
 
+    // Profile
+    ProfileEngine profile;
+    Profile::Program program = Profile::recrystallization();
+    float lastTemp = NAN;
+
     // Callbacks
     void (*onComplete)() = nullptr;
     void (*onFault)() = nullptr;
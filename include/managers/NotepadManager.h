@@ -3,12 +3,22 @@
 
 #include <ArduinoJson.h>
 #include <Arduino.h>
+#include "config/Config.h"
 
 /**
  * @brief Manages notepad functionality for experiment notes
- * 
+ *
  * This singleton class provides functionality to save, load, and list
  * experiment notes stored in the file system.
+ *
+ * Notes are plain text files NOTES_DIR/<name>.txt. The directory is scanned
+ * once in begin() into a fixed in-RAM index (name and size), which save
+ * keeps up to date, so listing never touches flash. Notes are read and
+ * written in caller-sized chunks: a load returns the bytes at an offset, a
+ * save at offset 0 replaces the note and a save at the current size appends
+ * to it, so the editor can send only what was typed since the last save.
+ *
+ * Called from the AsyncTCP task only (after begin()), so no locking.
  */
 class NotepadManager
 {
@@ -19,38 +29,85 @@ public:
      */
     static NotepadManager &getInstance();
 
+    /**
+     * @brief Create the notes directory and build the index (call after LittleFS is mounted)
+     * @return true if the notes directory is usable
+     */
+    bool begin();
+
     /**
      * @brief List all available notes
-     * @param arr JsonArray to populate with note names
+     * @param arr JsonArray to populate with note names (stored by pointer into the index)
      */
     void listNotes(JsonArray &arr);
-    
+
+    /**
+     * @brief Read part of a note
+     * @param experiment Name of the experiment
+     * @param offset First byte to read
+     * @param out Receives the bytes (not terminated)
+     * @param maxLen Size of out
+     * @param total Receives the note size
+     * @return int Bytes read (shortened to end on a UTF-8 character boundary), -1 if the note does not exist
+     */
+    int loadNote(const char *experiment, size_t offset, char *out, size_t maxLen, size_t &total);
+
     /**
-     * @brief Load notes for a specific experiment
+     * @brief Write part of a note
      * @param experiment Name of the experiment
-     * @param outNotes String reference to store the loaded notes
-     * @return true if notes were successfully loaded
-     * @return false if loading failed
+     * @param offset 0 to replace the note, or its current size to append
+     * @param notes Bytes to write
+     * @param len Number of bytes
+     * @return true if the bytes were saved
+     * @return false on an invalid name, a full index, an offset other than 0 or the note size, or a write error
      */
-    bool loadNote(const String &experiment, String &outNotes);
-    
+    bool saveNote(const char *experiment, size_t offset, const char *notes, size_t len);
+
     /**
-     * @brief Save notes for a specific experiment
+     * @brief Current size of a note
      * @param experiment Name of the experiment
-     * @param notes Notes content to save
-     * @return true if notes were successfully saved
-     * @return false if saving failed
+     * @return long Size in bytes, -1 if the note does not exist
+     */
+    long noteSize(const char *experiment) const;
+
+    /**
+     * @brief Check a note name (letters, digits, space, '-', '_' and '.', no leading '.')
+     * @param experiment Name to check
+     * @return true if it can be used as a file name
      */
-    bool saveNote(const String &experiment, const String &notes);
+    static bool isValidName(const char *experiment);
 
 private:
+    /**
+     * @brief Index entry of one note
+     */
+    struct NoteEntry
+    {
+        char name[NOTE_NAME_MAX];
+        size_t size;
+    };
+
     /**
      * @brief Private constructor for singleton pattern
      */
     NotepadManager();
-    
+
     NotepadManager(const NotepadManager &) = delete;
     NotepadManager &operator=(const NotepadManager &) = delete;
+
+    /**
+     * @brief Find a note in the index
+     * @return int Index position, -1 if not found
+     */
+    int find(const char *experiment) const;
+
+    /**
+     * @brief Build the file path of a note
+     */
+    static void notePath(const char *experiment, char *out, size_t outLen);
+
+    NoteEntry notes[NOTES_MAX];
+    int noteCount = 0;
 };
 
 #endif // NOTEPADMANAGER_H
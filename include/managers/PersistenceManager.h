@@ -0,0 +1,156 @@
+#ifndef PERSISTENCEMANAGER_H
+#define PERSISTENCEMANAGER_H
+
+#include <Arduino.h>
+#include "managers/HeaterModeManager.h"
+#include "config/Config.h"
+
+struct SystemState;
+
+/**
+ * @brief Keeps the control settings (setpoints, alert thresholds, mode) across resets
+ *
+ * This singleton stores one compact, CRC-checked record in NVS. NVS
+ * writes are copy-on-write and spread across its pages, so the same key
+ * wears the partition evenly and a write cut by a brownout leaves the
+ * previous record in place.
+ *
+ * The state task reports every state it publishes with track(). This only
+ * compares the settings against the last tracked record, and marks the
+ * changed fields dirty. The persistence task calls service(). It writes
+ * once the settings have been quiet for PERSIST_DEBOUNCE_MS, or at the
+ * latest PERSIST_MAX_LATENCY_MS after the first unsaved change, so a
+ * slider drag costs one write, not one per controlUpdate. A record equal
+ * to the stored one is never written.
+ *
+ * restore() runs at boot before the control tasks start. It hands the
+ * stored settings to CommandQueue, so the first state tick applies them
+ * like any controlUpdate. Timed modes (RAMP, TIMER, PROFILE) come back OFF
+ * because their progress is not stored. HOLD resumes only if
+ * PERSIST_RESUME_HOLD is set.
+ *
+ * THREAD SAFETY: track() from the state task only (the tracked record is
+ * guarded by a spinlock). service() and flush() from any task; a mutex
+ * serializes the writes. begin() and restore() before those tasks exist.
+ */
+class PersistenceManager
+{
+public:
+    /**
+     * @brief Field bits of the dirty mask
+     */
+    enum Field : uint8_t
+    {
+        TEMP_SETPOINT = 1 << 0,
+        RPM_SETPOINT = 1 << 1,
+        MODE = 1 << 2,
+        DURATION = 1 << 3,
+        ALERTS = 1 << 4             ///< Any of the three alert thresholds
+    };
+
+    /**
+     * @brief Write statistics since boot
+     */
+    struct Stats
+    {
+        uint32_t writes;            ///< Records written to NVS
+        uint32_t failures;          ///< Writes NVS rejected
+        uint32_t coalesced;         ///< Changes folded into a later write
+        uint32_t unchanged;         ///< Dirty periods that ended equal to the stored record
+        uint32_t sequence;          ///< Sequence number of the stored record (survives resets)
+        uint32_t lastWriteMs;       ///< millis() of the last write, 0 if none
+        uint8_t dirty;              ///< Fields changed but not written yet (Field bits)
+    };
+
+    /**
+     * @brief Get the singleton instance
+     * @return PersistenceManager& Reference to the singleton instance
+     */
+    static PersistenceManager &getInstance();
+
+    /**
+     * @brief Open the NVS namespace and load the stored record
+     * @return true if a valid record was found
+     */
+    bool begin();
+
+    /**
+     * @brief Copy the stored settings into a state and queue them for the control core
+     * @param state Working state of the state task (setpoints, duration, alert thresholds)
+     * @return true if settings were restored
+     */
+    bool restore(SystemState &state);
+
+    /**
+     * @brief Note the settings of a published state
+     * @param state State the state task just published
+     */
+    void track(const SystemState &state);
+
+    /**
+     * @brief Write the settings if their debounce or latency bound has expired
+     * @return true if a record was written
+     */
+    bool service();
+
+    /**
+     * @brief Write pending settings now (e.g. before a restart)
+     * @return true if nothing is left unsaved
+     */
+    bool flush();
+
+    /**
+     * @brief Write statistics
+     */
+    Stats stats() const;
+
+private:
+    /**
+     * @brief Stored settings (format version RECORD_VERSION, little-endian)
+     */
+    struct __attribute__((packed)) Record
+    {
+        uint8_t version;
+        uint8_t mode;                   ///< HeaterModeManager::Mode
+        uint16_t reserved;
+        float tempSetpoint;
+        int32_t rpmSetpoint;
+        int32_t duration;
+        float alertTempThreshold;
+        float alertRpmThreshold;
+        int32_t alertTimerThreshold;
+        uint32_t sequence;              ///< Incremented by every write
+        uint32_t crc;                   ///< CRC-32 of the bytes above
+    };
+
+    static constexpr uint8_t RECORD_VERSION = 1;
+
+    PersistenceManager() = default;
+    PersistenceManager(const PersistenceManager &) = delete;
+    PersistenceManager &operator=(const PersistenceManager &) = delete;
+
+    static Record fromState(const SystemState &state);
+    static uint8_t diff(const Record &a, const Record &b);
+    static uint32_t checksum(const Record &record);
+    bool write(Record record);
+
+    mutable portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    Record latest = {};                 ///< Last tracked settings (mux)
+    uint8_t dirty = 0;                  ///< Fields of latest not in stored (mux)
+    uint32_t firstDirtyMs = 0;          ///< First unsaved change (mux)
+    uint32_t lastChangeMs = 0;          ///< Most recent change (mux)
+    bool tracking = false;              ///< latest holds a tracked state (mux)
+
+    Record stored = {};                 ///< Record in NVS (writeLock)
+    bool valid = false;                 ///< stored was loaded or written
+    bool opened = false;                ///< NVS namespace is open
+    SemaphoreHandle_t writeLock = NULL; ///< Guards stored and NVS writes
+
+    volatile uint32_t writes = 0;
+    volatile uint32_t failures = 0;
+    volatile uint32_t coalesced = 0;
+    volatile uint32_t unchanged = 0;
+    volatile uint32_t lastWriteMs = 0;
+};
+
+#endif // PERSISTENCEMANAGER_H
@@ -4,37 +4,34 @@
 #include "managers/WebServerManager.h" // For SystemState
 
 /**
- * @brief Manages global system state and provides state update utilities
+ * @brief Publishes the global system state
  * 
- * This static class manages the global system state including temperature,
- * RPM, mode, and setpoints, and provides logging functionality.
+ * The state task owns the working SystemState (temperature, RPM, mode and
+ * setpoints) and is its only writer. After every update it publishes a copy
+ * with publish(). All other tasks read snapshot(), which never blocks and
+ * never returns a half-written state (a sequence-locked Mailbox).
+ * Clients change setpoints and the mode through CommandQueue.
  * 
- * THREAD SAFETY: All methods accept a mutex parameter for protecting shared state access.
- * Callers must provide the stateMutex to ensure thread-safe operations.
+ * THREAD SAFETY: publish() from the state task only; snapshot() and
+ * logState() from any task.
  */
 class StateManager {
 public:
     /**
-     * @brief Update the global system state
-     * @param temperature Current temperature reading in degrees Celsius
-     * @param rpm Current RPM value
-     * @param mode Current operating mode as string
-     * @param tempSetpoint Temperature setpoint in degrees Celsius
-     * @param rpmSetpoint RPM setpoint
-     * @param duration Duration value in seconds
-     * @param modeManager Optional pointer to HeaterModeManager for additional context
-     * @param mutex FreeRTOS mutex for protecting shared state (pass nullptr to skip locking)
-     * 
-     * THREAD SAFETY: Acquires mutex before modifying state, releases after completion.
-     * Mutex acquisition timeout is 100ms. State updates are skipped if mutex cannot be acquired.
+     * @brief Publish a new system state
+     * @param state Working state of the state task
      */
-    static void updateState(float temperature, int rpm, const String &mode, float tempSetpoint, int rpmSetpoint, int duration, HeaterModeManager* modeManager = nullptr, SemaphoreHandle_t mutex = nullptr);
-    
+    static void publish(const SystemState &state);
+
+    /**
+     * @brief Get the latest published system state
+     * @return SystemState Consistent copy
+     */
+    static SystemState snapshot();
+
     /**
-     * @brief Log the current system state to serial output
-     * @param mutex FreeRTOS mutex for protecting shared state (pass nullptr to skip locking)
-     * 
-     * THREAD SAFETY: Acquires mutex before reading state, releases after completion.
+     * @brief Log a system state to serial output
+     * @param state State to log
      */
-    static void logState(SemaphoreHandle_t mutex = nullptr);
-};
\ No newline at end of file
+    static void logState(const SystemState &state);
+};
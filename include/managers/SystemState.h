@@ -0,0 +1,29 @@
+#pragma once
+#include "managers/HeaterModeManager.h"
+#include "config/Config.h"
+
+/**
+ * @brief Structure to maintain global system state
+ *
+ * Written by the state task only; other tasks read StateManager::snapshot().
+ */
+struct SystemState
+{
+    float temperature = 0.0;    ///< Current temperature reading
+    int rpm = 0;                ///< Current RPM value
+
+    float tempSetpoint = 0.0;   ///< Temperature setpoint
+    int rpmSetpoint = 0;        ///< RPM setpoint
+    HeaterModeManager::Mode mode = HeaterModeManager::HOLD;  ///< Current operating mode
+
+    int duration = 0;           ///< Duration setting in seconds
+
+    float alertTempThreshold = ALERT_TEMP_THRESHOLD;  ///< Alert threshold for temperature
+    float alertRpmThreshold = ALERT_RPM_THRESHOLD;    ///< Alert threshold for RPM
+    int alertTimerThreshold = ALERT_TIMER_THRESHOLD;  ///< Alert threshold for timer
+
+    unsigned long startTime = 0;  ///< System start time
+
+    int profileSegment = -1;      ///< Segment of the running profile, -1 when none runs
+    uint32_t profileElapsed = 0;  ///< Seconds into the current profile segment
+};
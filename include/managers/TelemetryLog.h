@@ -0,0 +1,171 @@
+#ifndef TELEMETRYLOG_H
+#define TELEMETRYLOG_H
+
+#include <Arduino.h>
+#include "config/Config.h"
+
+/**
+ * @brief Fixed-size record stored in every telemetry log tier
+ *
+ * Raw 1 s records carry the same value in all three temperature fields.
+ */
+struct TelemetryRecord
+{
+    uint32_t time;   ///< Log clock seconds at the start of the interval
+    float minTemp;   ///< Minimum temperature in the interval
+    float maxTemp;   ///< Maximum temperature in the interval
+    float avgTemp;   ///< Average temperature in the interval
+};
+
+/**
+ * @brief Persistent, downsampled time-series log of the plate temperature
+ *
+ * This singleton keeps three tiers on LittleFS (1 s raw, 10 s and 1 min
+ * min/max/avg rollups). Each tier is a sequence of append-only segment files
+ * of fixed-size records; records are buffered in RAM and written one whole
+ * TLOG_BLOCK_BYTES block at a time. The oldest segment of a tier is deleted
+ * once it exceeds its retention.
+ *
+ * The board has no RTC, so time is a log clock in seconds that continues
+ * from the newest persisted record after a reboot.
+ *
+ * THREAD SAFETY: addSample()/flush() must be called from one task; query()
+ * may be called from any task. All state is guarded by an internal mutex.
+ */
+class TelemetryLog
+{
+public:
+    /**
+     * @brief Storage tiers, finest first
+     */
+    enum Tier : uint8_t
+    {
+        TIER_RAW = 0,   ///< One record per second
+        TIER_10S,       ///< 10 second rollups
+        TIER_1MIN,      ///< 1 minute rollups
+        TIER_COUNT
+    };
+
+    /**
+     * @brief Get the singleton instance
+     * @return TelemetryLog& Reference to the singleton instance
+     */
+    static TelemetryLog &getInstance();
+
+    /**
+     * @brief Scan existing segments and restore the log clock (call after LittleFS is mounted)
+     * @return true if the log directory is usable
+     */
+    bool begin();
+
+    /**
+     * @brief Record one sample; call once per second
+     * @param temperature Temperature in degrees Celsius
+     */
+    void addSample(float temperature);
+
+    /**
+     * @brief Write all buffered records, including partial blocks (e.g. before a restart)
+     */
+    void flush();
+
+    /**
+     * @brief Current log clock
+     * @return uint32_t Seconds on the log time axis
+     */
+    uint32_t now() const;
+
+    /**
+     * @brief Read a time range from the tier that matches its length
+     * @param from Start of the window (log clock seconds, inclusive)
+     * @param to End of the window (log clock seconds, inclusive)
+     * @param out Output array
+     * @param maxPoints Capacity of out; records are merged down to fit
+     * @param tier Set to the tier that was read, TIER_COUNT if the log could not be read
+     *             (not ready, to < from, no capacity, or the log stayed locked)
+     * @return size_t Number of records written to out
+     */
+    size_t query(uint32_t from, uint32_t to, TelemetryRecord *out, size_t maxPoints, Tier &tier);
+
+    /**
+     * @brief Interval covered by one record of a tier
+     * @param tier Tier
+     * @return uint32_t Seconds per record
+     */
+    static uint32_t tierPeriod(Tier tier);
+
+    /**
+     * @brief Human-readable tier name ("1s", "10s", "1min")
+     * @param tier Tier
+     * @return const char* Tier name
+     */
+    static const char *tierName(Tier tier);
+
+private:
+    static constexpr size_t RECORDS_PER_BLOCK = TLOG_BLOCK_BYTES / sizeof(TelemetryRecord);
+    static constexpr size_t RECORDS_PER_SEGMENT = RECORDS_PER_BLOCK * TLOG_SEGMENT_BLOCKS;
+
+    /**
+     * @brief One segment file, in RAM index form
+     */
+    struct Segment
+    {
+        uint32_t serial;     ///< Monotonic segment number (part of the file name)
+        uint32_t firstTime;  ///< Time of the first record
+        uint32_t lastTime;   ///< Time of the last record
+        uint32_t records;    ///< Number of complete records in the file
+        bool sealed;         ///< File must not be appended to (full or torn)
+    };
+
+    /**
+     * @brief Per-tier segment index, write buffer and rollup accumulator
+     */
+    struct TierState
+    {
+        Segment segments[TLOG_MAX_SEGMENTS];
+        uint8_t segmentCount = 0;
+
+        TelemetryRecord block[RECORDS_PER_BLOCK];
+        uint16_t blockFill = 0;
+
+        uint32_t accStart = 0;
+        float accMin = 0, accMax = 0, accSum = 0;
+        uint16_t accCount = 0;
+    };
+
+    TelemetryLog() = default;
+    TelemetryLog(const TelemetryLog &) = delete;
+    TelemetryLog &operator=(const TelemetryLog &) = delete;
+
+    /**
+     * @brief Fold a sample into a rollup tier, emitting a record when its interval ends
+     */
+    void accumulate(Tier tier, uint32_t time, float temperature);
+
+    /**
+     * @brief Append a record to a tier's block buffer, writing it out when full
+     */
+    void pushRecord(Tier tier, const TelemetryRecord &rec);
+
+    /**
+     * @brief Append the buffered records of a tier to its current segment
+     */
+    bool writeBlock(Tier tier);
+
+    /**
+     * @brief Build the file path of a segment
+     */
+    static void segmentPath(Tier tier, uint32_t serial, char *out, size_t outSize);
+
+    /**
+     * @brief Add a segment found on flash to the index (kept sorted by serial)
+     */
+    void indexSegment(Tier tier, uint32_t serial);
+
+    TierState tiers[TIER_COUNT];
+    uint32_t clockBase = 0;
+    bool ready = false;
+    SemaphoreHandle_t mutex = nullptr;
+};
+
+#endif // TELEMETRYLOG_H
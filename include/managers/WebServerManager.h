@@ -8,14 +8,18 @@
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
 #include <LittleFS.h>
-#include <unordered_map>
-#include <functional>
+#include <array>
+#include <TaskManager.h>
 #include "managers/HeaterModeManager.h"
+#include "managers/ControlCore.h"
 #include "managers/NotepadManager.h"
+#include "managers/SystemState.h"
+#include "utilities/TelemetryFrame.h"
+#include "utilities/HistoryRing.h"
+#include "utilities/StaticAssets.h"
 #include "config/Config.h"
 
 // Constants
-#define HISTORY_SIZE 300
 #define MAX_EVENTS 100
 
 // Data structures
@@ -29,36 +33,6 @@ struct HistoryEntry
     float temperature;        ///< Temperature value in degrees Celsius
 };
 
-/**
- * @brief Structure to maintain global system state
- */
-struct SystemState
-{
-    float temperature = 0.0;    ///< Current temperature reading
-    int rpm = 0;                ///< Current RPM value
-
-    float tempSetpoint = 0.0;   ///< Temperature setpoint
-    int rpmSetpoint = 0;        ///< RPM setpoint
-    String mode = Modes::HOLD;  ///< Current operating mode
-
-    int duration = 0;           ///< Duration setting in seconds
-
-    float alertTempThreshold = ALERT_TEMP_THRESHOLD;  ///< Alert threshold for temperature
-    float alertRpmThreshold = ALERT_RPM_THRESHOLD;    ///< Alert threshold for RPM
-    int alertTimerThreshold = ALERT_TIMER_THRESHOLD;  ///< Alert threshold for timer
-
-    unsigned long startTime = 0;  ///< System start time
-};
-
-/**
- * @brief Structure to store system events
- */
-struct EventEntry
-{
-    unsigned long timestamp;  ///< Timestamp of the event
-    String description;       ///< Event description text
-};
-
 /**
  * @brief Manages web server, WebSocket connections, and system state
  * 
@@ -71,7 +45,7 @@ public:
     /**
      * @brief Construct a new Web Server Manager
      */
-    WebServerManager();
+    WebServerManager() = default;
 
     /**
      * @brief Get the singleton instance
@@ -79,15 +53,6 @@ public:
      */
     static WebServerManager *instance();
 
-    /**
-     * @brief Set the state mutex for thread-safe access
-     * @param mutex FreeRTOS mutex handle for protecting shared state
-     * 
-     * THREAD SAFETY: This must be called before any multi-threaded access.
-     * All state modifications will be protected by this mutex.
-     */
-    void setStateMutex(SemaphoreHandle_t mutex);
-
     /**
      * @brief Get reference to the web server
      * @return AsyncWebServer& Reference to the AsyncWebServer instance
@@ -95,11 +60,12 @@ public:
     static AsyncWebServer &getServer();
     
     /**
-     * @brief Initialize WiFi and web server
-     * @param ssid WiFi network SSID
-     * @param password WiFi network password
+     * @brief Start the web server
+     *
+     * Call once LittleFS is mounted and the station has an IP address; the
+     * WiFi connection itself belongs to the network manager.
      */
-    void begin(const char *ssid, const char *password);
+    void begin();
     
     /**
      * @brief Handle periodic tasks (call in main loop)
@@ -107,19 +73,41 @@ public:
     void handle();
     
     /**
-     * @brief Notify all connected WebSocket clients of state changes
+     * @brief Send state changes to the WebSocket clients that are due for them
+     *
+     * Binary-telemetry clients receive a Telemetry::Frame, all others the JSON
+     * "dataUpdate" message, limited to the fields and rate each client chose
+     * with "subscribe". A client whose queue or TCP send buffer is backed up
+     * is skipped and its rate backs off; the changes it missed go out with its
+     * next frame. When every client is due for the same complete message it is
+     * queued to all of them as one buffer. Call from the broadcast task only.
      */
     void notifyClients();
 
     /**
-     * @brief Attach a HeaterModeManager for coordinated control
-     * @param manager Pointer to HeaterModeManager instance
+     * @brief Attach the ControlCore that receives mode commands
+     * @param core Pointer to ControlCore instance
+     */
+    void attachControlCore(ControlCore *core);
+
+    /**
+     * @brief Attach the TaskManager whose tasks are reported by getMetrics
+     * @param manager Pointer to TaskManager instance
      */
-    void attachModeManager(HeaterModeManager *manager);
+    void attachTaskManager(TaskManager *manager);
+
+    /**
+     * @brief Attach the HeatingElement whose PID gains and autotune are exposed
+     * @param element Pointer to HeatingElement instance
+     */
+    void attachHeater(HeatingElement *element);
     
     /**
      * @brief Add a temperature reading to history
      * @param temperature Temperature value in degrees Celsius
+     *
+     * THREAD SAFETY: Wait-free, but must only be called from the control task
+     * (the single producer of the history ring).
      */
     void addHistoryEntry(float temperature);
     
@@ -127,6 +115,8 @@ public:
      * @brief Handle control update WebSocket message
      * @param client Pointer to WebSocket client
      * @param data JSON data with control parameters
+     *
+     * The fields are queued in CommandQueue and applied by the state task.
      */
     void handleControlUpdate(AsyncWebSocketClient *client, JsonVariant data);
 
@@ -134,6 +124,11 @@ public:
      * @brief Handle history retrieval WebSocket message
      * @param client Pointer to WebSocket client
      * @param data JSON data (may be empty)
+     *
+     * Snapshots the current history range and streams it to the client in
+     * HISTORY_CHUNK_ENTRIES-sized "history" messages from handle(). If data
+     * carries "window" (seconds back from now) or "from"/"to" (log clock
+     * seconds), the persistent TelemetryLog is queried instead.
      */
     void handleGetHistory(AsyncWebSocketClient *client, JsonVariant data);
     
@@ -147,207 +142,267 @@ public:
     /**
      * @brief Handle notepad load WebSocket message
      * @param client Pointer to WebSocket client
-     * @param data JSON data with notepad name
+     * @param data JSON data with notepad name and optional byte "offset"
      */
     void handleNotepadLoad(AsyncWebSocketClient *client, JsonVariant data);
     
     /**
      * @brief Handle notepad save WebSocket message
      * @param client Pointer to WebSocket client
-     * @param data JSON data with notepad name and content
+     * @param data JSON data with notepad name, content chunk, byte "offset" and "last"
      */
     void handleNotepadSave(AsyncWebSocketClient *client, JsonVariant data);
 
-private:
-    // Web server and websocket instances
-    static AsyncWebServer server;
-    static AsyncWebSocket ws;
+    /**
+     * @brief Handle telemetry format selection WebSocket message
+     * @param client Pointer to WebSocket client
+     * @param data JSON data with "format" ("binary" or "json")
+     */
+    void handleTelemetryFormat(AsyncWebSocketClient *client, JsonVariant data);
 
-    HeaterModeManager *modeManager = nullptr;
-    SemaphoreHandle_t stateMutex = nullptr;  ///< Mutex for protecting shared state access
+    /**
+     * @brief Handle subscribe WebSocket message
+     * @param client Pointer to WebSocket client
+     * @param data JSON data with optional "fields" (array of dataUpdate field names, default all)
+     *             and "maxRate" (updates per second, 0 = every state update)
+     */
+    void handleSubscribe(AsyncWebSocketClient *client, JsonVariant data);
 
     /**
-     * @brief Send acknowledgment message to WebSocket client
+     * @brief Handle metrics request WebSocket message
      * @param client Pointer to WebSocket client
-     * @param message Acknowledgment message text
+     * @param data JSON data; "reset": true clears the statistics after reporting
      */
-    void sendAck(AsyncWebSocketClient *client, const String &message);
-    
+    void handleGetMetrics(AsyncWebSocketClient *client, JsonVariant data);
+
     /**
-     * @brief Send error message to WebSocket client
+     * @brief Handle event log request WebSocket message
      * @param client Pointer to WebSocket client
-     * @param error Error message text
+     * @param data JSON data (unused)
      */
-    void sendError(AsyncWebSocketClient *client, const String &error);
+    void handleGetEvents(AsyncWebSocketClient *client, JsonVariant data);
 
     /**
-     * @brief Send JSON response to WebSocket client
+     * @brief Handle PID autotune WebSocket message
      * @param client Pointer to WebSocket client
-     * @param response JSON object to send
+     * @param data JSON data with "setpoint" to start (switches to HOLD there), or "cancel": true
      */
-    void sendJsonResponse(AsyncWebSocketClient *client, const JsonObject &response);
+    void handlePidAutotune(AsyncWebSocketClient *client, JsonVariant data);
 
     /**
-     * @brief Initialize WiFi connection
-     * @param ssid WiFi network SSID
-     * @param password WiFi network password
-     * @return true if WiFi connected successfully
-     * @return false if connection failed
+     * @brief Handle PID gains WebSocket message
+     * @param client Pointer to WebSocket client
+     * @param data JSON data with "kp", "ki" and "kd"
      */
-    bool beginWiFi(const char *ssid, const char *password);
-    
+    void handleSetPidGains(AsyncWebSocketClient *client, JsonVariant data);
+
     /**
-     * @brief Initialize LittleFS file system
-     * @return true if file system mounted successfully
-     * @return false if mount failed
+     * @brief Handle profile save WebSocket message
+     * @param client Pointer to WebSocket client
+     * @param data JSON data with "name" and "segments": [["ramp", temp, C/min], ["soak", s], ["wait", temp, band], ["loop", target, count]]
      */
-    bool beginFileSystem();
-    
+    void handleProfileSave(AsyncWebSocketClient *client, JsonVariant data);
+
     /**
-     * @brief Initialize and start the web server
+     * @brief Handle profile run WebSocket message
+     * @param client Pointer to WebSocket client
+     * @param data JSON data with "name" (stored or "Recrystallization"), or "stop": true
      */
-    void beginServer();
+    void handleProfileRun(AsyncWebSocketClient *client, JsonVariant data);
 
     /**
-     * @brief Static WebSocket event handler (dispatches to instance method)
-     * @param server Pointer to AsyncWebSocket server
+     * @brief Handle configuration request WebSocket message
      * @param client Pointer to WebSocket client
-     * @param type Event type
-     * @param arg Event argument
-     * @param data Event data buffer
-     * @param len Length of data buffer
+     * @param data JSON data (unused)
      */
-    static void onWsEventStatic(AsyncWebSocket *server, AsyncWebSocketClient *client,
-                                AwsEventType type, void *arg, uint8_t *data, size_t len);
-    
+    void handleGetConfig(AsyncWebSocketClient *client, JsonVariant data);
+
     /**
-     * @brief Instance WebSocket event handler
-     * @param server Pointer to AsyncWebSocket server
+     * @brief Handle system reset WebSocket message (flushes the telemetry log and settings, then reboots)
      * @param client Pointer to WebSocket client
-     * @param type Event type
-     * @param arg Event argument
-     * @param data Event data buffer
-     * @param len Length of data buffer
+     * @param data JSON data (unused)
      */
-    void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
-                   AwsEventType type, void *arg, uint8_t *data, size_t len);
+    void handleResetSystem(AsyncWebSocketClient *client, JsonVariant data);
 
     /**
-     * @brief Parse and dispatch WebSocket messages to appropriate handlers
+     * @brief Handle state update WebSocket message
      * @param client Pointer to WebSocket client
-     * @param data Message data buffer
-     * @param len Length of message data
+     * @param data JSON data with "temperature", "rpm" and "mode"
      */
-    void handleWebSocketMessage(AsyncWebSocketClient *client, uint8_t *data, size_t len);
+    void handleUpdateState(AsyncWebSocketClient *client, JsonVariant data);
 
-    // === Action handler dispatch system ===
-    using ActionHandler = std::function<void(WebServerManager*, AsyncWebSocketClient*, JsonVariant)>;
+private:
+    friend class Benchmarks;    ///< Times message dispatch and update serialization (env:bench)
+
+    // Web server and websocket instances
+    static AsyncWebServer server;
+    static AsyncWebSocket ws;
+    static StaticAssetHandler assets;
+
+    ControlCore *control = nullptr;
+    TaskManager *taskManager = nullptr;
+    HeatingElement *heater = nullptr;
 
     /**
-     * @brief Structure mapping action strings to handler functions
+     * @brief Per-connection bookkeeping for WebSocket clients
      */
-    struct ActionMapping {
-        const char* action;
-        ActionHandler handler;
+    struct WsClientInfo {
+        uint32_t id = 0;                ///< AsyncWebSocketClient id, 0 if slot is free
+        bool binaryTelemetry = false;   ///< Client opted in to binary telemetry frames
+        uint16_t fields = Telemetry::FIELD_ALL; ///< Subscribed fields
+        uint32_t intervalMs = 0;        ///< Minimum time between updates (subscribe "maxRate")
+        uint8_t resync = 0;             ///< Bumped to request a complete update
+
+        // Owned by notifyClients()
+        uint8_t resyncSent = 0;         ///< resync value of the last update sent
+        uint16_t pending = 0;           ///< Fields changed since the last update sent
+        uint32_t lastSentMs = 0;        ///< millis() of the last update sent
+        uint32_t backoffMs = 0;         ///< Extra interval while the client is slow
+        uint32_t skipped = 0;           ///< Updates held back because the client was slow
     };
 
-    static const ActionMapping actionMap[];
-    static const int actionMapSize;
+    std::array<WsClientInfo, MAX_WS_CLIENTS> clients = {};  ///< Connected clients
+    portMUX_TYPE clientsMux = portMUX_INITIALIZER_UNLOCKED; ///< Guards clients (AsyncTCP vs broadcast task)
+    Telemetry::Encoder telemetry;                           ///< Last encoded telemetry frame (broadcast task only)
 
-   
+    /**
+     * @brief Fill a JSON "dataUpdate" message
+     * @param doc Document to fill
+     * @param state State to report
+     * @param runningTime Seconds since the current run started
+     * @param fields Telemetry::Field bits to include
+     */
+    static void buildDataUpdate(JsonDocument &doc, const SystemState &state, uint32_t runningTime, uint16_t fields);
 
-    // Mode handler function type
-    using ModeHandler = std::function<void(const JsonObject&)>;
-    
     /**
-     * @brief Handle OFF mode request
-     * @param params JSON object with mode parameters
+     * @brief Make the next broadcast send a client every field
+     * @param id Client id
      */
-    void handleModeOff(const JsonObject& params);
-    
+    void requestFullUpdate(uint32_t id);
+
     /**
-     * @brief Handle HOLD mode request
-     * @param params JSON object with hold temperature
+     * @brief Progress of a getHistory response being streamed to one client
      */
-    void handleModeHold(const JsonObject& params);
-    
+    struct HistoryStream {
+        uint32_t clientId = 0;  ///< Receiving client, 0 if slot is free
+        uint32_t next = 0;      ///< Next history sequence number to send
+        uint32_t end = 0;       ///< One past the last sequence number in the snapshot
+        uint16_t chunk = 0;     ///< Index of the next chunk message
+    };
+
+    std::array<HistoryStream, MAX_WS_CLIENTS> historyStreams = {};  ///< Guarded by clientsMux
+
     /**
-     * @brief Handle RAMP mode request
-     * @param params JSON object with ramp parameters
+     * @brief Answer a getHistory range query from the persistent telemetry log
+     * @param client Pointer to WebSocket client
+     * @param data JSON data with "window" or "from"/"to"
      */
-    void handleModeRamp(const JsonObject& params);
-    
+    void handleHistoryRange(AsyncWebSocketClient *client, JsonObject data);
+
     /**
-     * @brief Handle TIMER mode request
-     * @param params JSON object with timer parameters
+     * @brief Send pending history chunks while client queues have room
      */
-    void handleModeTimer(const JsonObject& params);
-    
+    void pumpHistoryStreams();
+
     /**
-     * @brief Initialize mode handler map
+     * @brief Format one history chunk message into a buffer
+     * @param stream Stream to take entries from (advanced past the chunk)
+     * @param out Output buffer
+     * @param outSize Size of output buffer
+     * @return size_t Message length in bytes
      */
-    void initializeModeHandlers();
-    
+    size_t formatHistoryChunk(HistoryStream &stream, char *out, size_t outSize);
+
     /**
-     * @brief Update a float state property and log if changed
-     * @param var Reference to state variable
-     * @param val New value
-     * @param name Property name for logging
+     * @brief Build the metrics report (timed sections, tasks, heap, logging, client queues)
+     * @param doc Document receiving the report
+     *
+     * AsyncTCP task only (getMetrics, /metrics): it walks the library's client list.
      */
-    void updateStateProperty(float &var, float val, const char *name);
-    
+    void buildMetrics(JsonDocument &doc);
+
     /**
-     * @brief Update an integer state property and log if changed
-     * @param var Reference to state variable
-     * @param val New value
-     * @param name Property name for logging
+     * @brief Clear section and task statistics
      */
-    void updateStateProperty(int &var, int val, const char *name);
-    
+    void resetMetrics();
+
     /**
-     * @brief Update the system mode and log the change
-     * @param newMode New mode string
+     * @brief Register a newly connected client
+     * @param id Client id
      */
-    void updateMode(const String &newMode);
-    
+    void addClient(uint32_t id);
+
     /**
-     * @brief Log a system event
-     * @param desc Event description text
+     * @brief Forget a disconnected client
+     * @param id Client id
      */
-    void logEvent(const String &desc);
+    void removeClient(uint32_t id);
+
+    /**
+     * @brief Send acknowledgment message to WebSocket client
+     * @param client Pointer to WebSocket client
+     * @param message Acknowledgment message text
+     */
+    void sendAck(AsyncWebSocketClient *client, const String &message);
     
     /**
-     * @brief Hash functor for C-string keys in unordered_map
+     * @brief Send error message to WebSocket client
+     * @param client Pointer to WebSocket client
+     * @param error Error message text
      */
-    struct CStringHash {
-        std::size_t operator()(const char* str) const {
-            std::size_t hash = 0;
-            while (*str) {
-                hash = hash * 101 + *str++;
-            }
-            return hash;
-        }
-    };
+    void sendError(AsyncWebSocketClient *client, const String &error);
+
+    /**
+     * @brief Initialize and start the web server
+     */
+    void beginServer();
 
     /**
-     * @brief Equality functor for C-string keys in unordered_map
+     * @brief Static WebSocket event handler (dispatches to instance method)
+     * @param server Pointer to AsyncWebSocket server
+     * @param client Pointer to WebSocket client
+     * @param type Event type
+     * @param arg Event argument
+     * @param data Event data buffer
+     * @param len Length of data buffer
      */
-    struct CStringEqual {
-        bool operator()(const char* a, const char* b) const {
-            return strcmp(a, b) == 0;
-        }
-    };
+    static void onWsEventStatic(AsyncWebSocket *server, AsyncWebSocketClient *client,
+                                AwsEventType type, void *arg, uint8_t *data, size_t len);
+    
+    /**
+     * @brief Instance WebSocket event handler
+     * @param server Pointer to AsyncWebSocket server
+     * @param client Pointer to WebSocket client
+     * @param type Event type
+     * @param arg Event argument
+     * @param data Event data buffer
+     * @param len Length of data buffer
+     */
+    void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
+                   AwsEventType type, void *arg, uint8_t *data, size_t len);
 
-    std::unordered_map<const char*, ModeHandler, CStringHash, CStringEqual> modeHandlers;
-};
+    /**
+     * @brief Parse and dispatch WebSocket messages to appropriate handlers
+     * @param client Pointer to WebSocket client
+     * @param data Message data buffer
+     * @param len Length of message data
+     */
+    void handleWebSocketMessage(AsyncWebSocketClient *client, uint8_t *data, size_t len);
 
-/// Global shared system state
-extern SystemState state;
+    // === Action handler dispatch system ===
+    using ActionHandler = void (*)(WebServerManager*, AsyncWebSocketClient*, JsonVariant);
 
-/// Current index in the history circular buffer
-extern int historyIndex;
+    /**
+     * @brief Look up the handler of an action (case-insensitive)
+     * @param action Action name from the message
+     * @return ActionHandler Handler, nullptr if the action is unknown
+     *
+     * Switches on the compile-time hash of every action name.
+     */
+    static ActionHandler findAction(const char *action);
+};
 
-/// Current count of logged events
-extern int eventsCount;
+/// Temperature history, written by the control task only
+extern HistoryRing<HistoryEntry, HISTORY_SIZE> history;
 
 #endif // WEBSERVERMANAGER_H
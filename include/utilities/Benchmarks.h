@@ -0,0 +1,31 @@
+#pragma once
+#include <Arduino.h>
+
+class ControlCore;
+
+/**
+ * @brief On-target micro benchmarks of the hot paths (env:bench)
+ *
+ * run() times each operation with the CPU cycle counter and prints the
+ * mean and minimum cycles per call: heater control step, mode manager
+ * update, WebSocket message parse and dispatch, and telemetry
+ * serialization (JSON into a WebSocket buffer, and the binary frame).
+ * The heater and mode manager are private instances fed a reproducible
+ * ThermalSimulator trace, so the numbers compare across builds. Two
+ * checks then feed a heater a sensor FAULT and a sensor that stopped
+ * delivering (NO_DATA past SENSOR_STALE_MS), and print PASS if the heater
+ * latched a fault and switched off.
+ *
+ * Call from setup() before the tasks start: nothing else may run on
+ * the objects it touches.
+ */
+class Benchmarks
+{
+public:
+    /**
+     * @brief Run every benchmark and print the results
+     * @param control Control core attached to the web server for dispatch benchmarks
+     *                (its task need not run; getConfig posts no command)
+     */
+    static void run(ControlCore &control);
+};
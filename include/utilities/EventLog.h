@@ -0,0 +1,89 @@
+#pragma once
+#include <Arduino.h>
+#include "config/Config.h"
+
+/**
+ * @brief Ring of the last MAX_EVENTS system events in fixed-size records
+ *
+ * An event is a message ID and up to two numeric arguments; the text is
+ * only produced by format() when a client asks for the log. Recording is
+ * a 16-byte copy into the next slot (the oldest is overwritten), with no
+ * String and no heap.
+ *
+ * THREAD SAFETY: record() and snapshot() take a short spinlock; any task
+ * may record.
+ */
+class EventLog
+{
+public:
+    /**
+     * @brief Interned event messages (index into the message table)
+     */
+    enum Id : uint8_t
+    {
+        TEMP_SETPOINT,      ///< a: old, b: new setpoint (C)
+        RPM_SETPOINT,       ///< a: old, b: new setpoint (RPM)
+        DURATION,           ///< a: old, b: new duration (s)
+        MODE,               ///< a: old, b: new HeaterModeManager::Mode
+        MODE_COMPLETE,      ///< The running mode finished
+        HEATER_FAULT,       ///< Heater latched a fault and stopped
+        STIRRER_STALL,      ///< a: target RPM the stirrer stalled at
+        SETTINGS_RESTORED,  ///< a: sequence of the restored settings record
+        ID_COUNT
+    };
+
+    /**
+     * @brief One recorded event
+     */
+    struct Entry
+    {
+        uint32_t timeMs;    ///< millis() when recorded
+        Id id;              ///< Message
+        float a;            ///< First argument
+        float b;            ///< Second argument
+    };
+
+    /**
+     * @brief Get the singleton instance
+     * @return EventLog& Reference to the singleton instance
+     */
+    static EventLog &getInstance();
+
+    /**
+     * @brief Record an event
+     * @param id Message
+     * @param a First argument
+     * @param b Second argument
+     */
+    void record(Id id, float a = 0.0f, float b = 0.0f);
+
+    /**
+     * @brief Copy the retained events, oldest first
+     * @param out Receives up to MAX_EVENTS entries
+     * @return size_t Number of entries written
+     */
+    size_t snapshot(Entry *out) const;
+
+    /**
+     * @brief Events recorded since boot (retained or overwritten)
+     */
+    uint32_t total() const { return written; }
+
+    /**
+     * @brief Render an event as text
+     * @param entry Event to render
+     * @param out Output buffer
+     * @param outSize Capacity of out
+     * @return size_t Length written (snprintf semantics)
+     */
+    static size_t format(const Entry &entry, char *out, size_t outSize);
+
+private:
+    EventLog() = default;
+    EventLog(const EventLog &) = delete;
+    EventLog &operator=(const EventLog &) = delete;
+
+    mutable portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    Entry ring[MAX_EVENTS] = {};
+    volatile uint32_t written = 0;      ///< Next slot is written % MAX_EVENTS
+};
@@ -6,12 +6,43 @@
 #include <ESPAsyncWebServer.h>
 #include <LittleFS.h>
 #include <ArduinoJson.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include "config/Config.h"
 
 /**
  * @brief Provides web-based file system exploration and management
  * 
  * This class adds REST endpoints to an AsyncWebServer for listing, uploading,
  * downloading, and deleting files from the LittleFS file system.
+ *
+ * Downloads and listings are streamed with constant memory: downloads read
+ * whole FS_STREAM_BUFFER_BYTES blocks at block-aligned offsets and support
+ * single HTTP byte ranges (206 Partial Content), listings are written as
+ * chunked JSON one entry at a time. Streams come from fixed pools
+ * (FS_MAX_DOWNLOADS, FS_MAX_LISTINGS); a request beyond that gets 503.
+ * Files are closed when the client disconnects, including on abort.
+ *
+ * Uploads never touch flash in the AsyncTCP task. Each upload owns a context
+ * with two FS_STREAM_BUFFER_BYTES buffers: the network side fills one while
+ * writerTask() writes the other as a whole block. Data goes to
+ * "<path>.part", which is renamed over the target only after every block was
+ * written, so a failed or aborted upload leaves the old file intact.
+ *
+ * Backpressure never blocks the AsyncTCP task: upload data is received with
+ * ackLater() and acknowledged once the writer has put it on flash, so the TCP
+ * receive window (smaller than the two buffers) keeps the peer from sending
+ * more than fits. Should both buffers be queued anyway, the upload is dropped
+ * and answered with 503. The final handler does not wait for the commit
+ * either: its UploadResponse sends the result once the writer is done.
+ *
+ * All handlers run in the AsyncTCP task, so the pools need no locking. The
+ * writer task only touches an upload context through its queued jobs and
+ * the released counter; it never calls into the client (AsyncClient is not
+ * thread-safe). It pokes the connection's poll instead, and the AsyncTCP task
+ * acknowledges the released bytes there (or in the next onUpload()).
  */
 class FileSystemExplorer
 {
@@ -23,15 +54,222 @@ public:
     explicit FileSystemExplorer(AsyncWebServer &server);
 
     /**
-     * @brief Initialize the file explorer and register web server endpoints
+     * @brief Initialize the file explorer and register web server endpoints (call after LittleFS is mounted)
      */
     void begin();
 
+    /**
+     * @brief Upload writer task: writes queued upload blocks to flash
+     * @param parameter The FileSystemExplorer instance
+     */
+    static void writerTask(void *parameter);
+
 private:
+    /**
+     * @brief State of one streamed download
+     */
+    struct DownloadStream
+    {
+        bool inUse = false;
+        File file;
+        size_t start = 0;           ///< First byte of the range
+        size_t length = 0;          ///< Bytes in the range
+        size_t bufferOffset = 0;    ///< File offset of buffer[0]
+        size_t bufferFill = 0;      ///< Valid bytes in buffer
+        uint8_t buffer[FS_STREAM_BUFFER_BYTES];
+    };
+
+    /**
+     * @brief State of one streamed directory listing
+     */
+    struct ListStream
+    {
+        bool inUse = false;
+        File dir;
+        char dirPath[FS_PATH_MAX] = {};
+        char line[FS_LIST_LINE_BYTES] = {};   ///< Serialized entry not yet sent
+        size_t lineLen = 0;
+        size_t linePos = 0;
+        bool first = true;
+        bool done = false;
+    };
+
+    /**
+     * @brief State of one pipelined upload
+     *
+     * request, response, holding, active, fill and submitted are only touched
+     * in the AsyncTCP task, file and opened only in the writer task. failed
+     * and rejected are read once inUse is clear.
+     */
+    class UploadResponse;
+
+    struct UploadContext
+    {
+        std::atomic<bool> inUse{false};         ///< Cleared by the writer once the upload is committed or aborted
+        AsyncWebServerRequest *request = nullptr;
+        char path[FS_PATH_MAX] = {};
+        char tempPath[FS_PATH_MAX] = {};
+        uint8_t buffers[2][FS_STREAM_BUFFER_BYTES];
+        uint8_t active = 0;                     ///< Buffer being filled
+        size_t fill = 0;                        ///< Bytes in the active buffer
+        bool holding = false;                   ///< The network side owns the active buffer
+        bool submitted = false;                 ///< Commit or abort queued
+        bool failed = false;                    ///< Set by the writer on a flash error
+        bool rejected = false;                  ///< No free buffer (backpressure overflow), upload dropped
+        File file;
+        bool opened = false;
+        StaticSemaphore_t freeStorage;
+        SemaphoreHandle_t freeBuffers = nullptr;   ///< Counts buffers not queued for the writer
+        std::atomic<size_t> released{0};        ///< Bytes on flash, not acknowledged yet (SIZE_MAX: all)
+        std::atomic<tcp_pcb *> pcb{nullptr};    ///< Connection the writer pokes, nullptr once disconnected
+        UploadResponse *response = nullptr;     ///< Final response once handleUpload() sent it
+    };
+
+    /**
+     * @brief One unit of work for the writer task
+     */
+    struct UploadJob
+    {
+        enum Type : uint8_t
+        {
+            WRITE,      ///< Append a buffer
+            COMMIT,     ///< Append the last buffer, close and rename
+            ABORT       ///< Close and remove the temp file
+        };
+        UploadContext *upload;
+        Type type;
+        int8_t buffer;  ///< Buffer to write and release, -1 for none
+        uint16_t length;
+    };
+
+    /**
+     * @brief Handles /fs/download (needs the Range header, which server.on() handlers do not keep)
+     */
+    class DownloadHandler : public AsyncWebHandler
+    {
+    public:
+        explicit DownloadHandler(FileSystemExplorer &owner) : owner(owner) {}
+        bool canHandle(AsyncWebServerRequest *request) override;
+        void handleRequest(AsyncWebServerRequest *request) override { owner.handleDownload(request); }
+
+    private:
+        FileSystemExplorer &owner;
+    };
+
+    /**
+     * @brief Final /fs/upload response: answers once the writer has committed or aborted
+     *
+     * Until then it sends nothing; the request polls it (_ack) from the
+     * AsyncTCP task, so the reply needs no cross-task call.
+     */
+    class UploadResponse : public AsyncWebServerResponse
+    {
+    public:
+        explicit UploadResponse(UploadContext &upload) : upload(upload) {}
+        ~UploadResponse() override { delete result; }
+        void _respond(AsyncWebServerRequest *request) override { poll(request); }
+        size_t _ack(AsyncWebServerRequest *request, size_t len, uint32_t time) override;
+        bool _finished() const override { return result && result->_finished(); }
+        bool _failed() const override { return result && result->_failed(); }
+        bool _sourceValid() const override { return true; }
+
+    private:
+        /**
+         * @brief Start the result response if the writer is done
+         */
+        void poll(AsyncWebServerRequest *request);
+
+        UploadContext &upload;
+        AsyncWebServerResponse *result = nullptr;   ///< Status response, created on completion
+    };
+
+    /**
+     * @brief Copy the next part of a download range, refilling the block buffer as needed
+     * @param stream Download state
+     * @param out Response buffer
+     * @param maxLen Space in the response buffer
+     * @param index Bytes of the range already sent
+     * @return size_t Bytes written, 0 at the end of the range
+     */
+    static size_t readDownload(DownloadStream &stream, uint8_t *out, size_t maxLen, size_t index);
+
+    /**
+     * @brief Write the next part of a listing as JSON
+     * @param stream Listing state
+     * @param out Response buffer
+     * @param maxLen Space in the response buffer
+     * @return size_t Bytes written, 0 once the closing bracket was sent
+     */
+    static size_t readListing(ListStream &stream, uint8_t *out, size_t maxLen);
+
+    /**
+     * @brief Find the upload context owned by a request
+     * @return UploadContext* nullptr if the request has none
+     */
+    UploadContext *findUpload(AsyncWebServerRequest *request);
+
+    /**
+     * @brief Hand the active buffer (if held) to the writer
+     * @param upload Upload context
+     * @param type Job type
+     * @return true if the job was queued
+     */
+    bool submitUpload(UploadContext &upload, UploadJob::Type type);
+
+    /**
+     * @brief Queue an abort for an upload that has not been committed
+     * @param upload Upload context
+     */
+    void abortUpload(UploadContext &upload);
+
+    /**
+     * @brief Execute one job (writer task only)
+     * @param job Job to run
+     */
+    static void runJob(const UploadJob &job);
+
+    /**
+     * @brief Mark bytes as written and poke the connection to acknowledge them (writer task only)
+     * @param upload Upload context
+     * @param length Bytes on flash
+     */
+    static void releaseWindow(UploadContext &upload, size_t length);
+
+    /**
+     * @brief Have the tcpip thread raise a poll on the upload's connection (any task)
+     * @param upload Upload context
+     */
+    static void pokeConnection(UploadContext &upload);
+
+    /**
+     * @brief Acknowledge the bytes the writer released, reopening the TCP window (AsyncTCP task only)
+     * @param upload Upload context
+     * @param client Connection of the upload
+     */
+    static void ackReleased(UploadContext &upload, AsyncClient *client);
+
+    /**
+     * @brief Poll handler of an upload connection (AsyncTCP task): acknowledge, then poll the response
+     */
+    static void onUploadPoll(void *arg, AsyncClient *client);
+
+    /**
+     * @brief Raise a poll event on an upload connection (tcpip thread, queued by pokeConnection())
+     */
+    static void raisePoll(void *arg);
+
     AsyncWebServer &server;
+    DownloadHandler downloadHandler;
+    DownloadStream downloads[FS_MAX_DOWNLOADS];
+    ListStream listings[FS_MAX_LISTINGS];
+    UploadContext uploads[FS_MAX_UPLOADS];
+
+    StaticQueue_t jobQueueStorage;
+    uint8_t jobQueueBuffer[UPLOAD_QUEUE_LENGTH * sizeof(UploadJob)];
+    QueueHandle_t jobs = nullptr;
 
     /**
-     * @brief Handle HTTP request to list files in a directory
+     * @brief Handle HTTP request to list files in a directory (chunked JSON array)
      * @param request Pointer to the web server request
      */
     void handleList(AsyncWebServerRequest *request);
@@ -43,13 +281,13 @@ private:
     void handleDelete(AsyncWebServerRequest *request);
     
     /**
-     * @brief Handle HTTP request to download a file
+     * @brief Handle HTTP request to download a file (whole, or one byte range)
      * @param request Pointer to the web server request
      */
     void handleDownload(AsyncWebServerRequest *request);
 
     /**
-     * @brief Handle HTTP request to upload a file (final handler)
+     * @brief Handle HTTP request to upload a file (final handler, replies once committed)
      * @param request Pointer to the web server request
      */
     void handleUpload(AsyncWebServerRequest *request);
@@ -65,12 +303,6 @@ private:
      */
     void onUpload(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final);
 
-    /**
-     * @brief List files and directories inside a path
-     * @param path Path to list
-     * @param array JsonArray to populate with file information
-     */
-    void listDir(const String &path, JsonArray &array);
 };
 
 #endif // EXPLORER_H
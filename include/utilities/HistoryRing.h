@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Wait-free single-producer ring buffer with sequence-numbered reads
+ *
+ * Every pushed value gets a monotonically increasing sequence number. The
+ * producer never blocks; readers address entries by sequence number and a
+ * per-slot version (seqlock) tells them if the entry was overwritten while
+ * they were copying it.
+ *
+ * THREAD SAFETY: push() must only be called from one task. Any number of
+ * tasks may call begin()/end()/read() concurrently without locking.
+ *
+ * @tparam T Trivially copyable entry type
+ * @tparam N Capacity, must be a power of two
+ */
+template <typename T, size_t N>
+class HistoryRing
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "HistoryRing capacity must be a power of two");
+
+public:
+    /**
+     * @brief Append a value, overwriting the oldest entry when full
+     * @param value Value to store
+     */
+    void push(const T &value)
+    {
+        uint32_t seq = head.load(std::memory_order_relaxed);
+        Slot &slot = slots[seq & (N - 1)];
+
+        // Odd version marks the slot as being written
+        slot.version.store(seq * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.value = value;
+        slot.version.store(seq * 2 + 2, std::memory_order_release);
+
+        head.store(seq + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Sequence number of the oldest entry still held
+     * @return uint32_t First readable sequence number
+     */
+    uint32_t begin() const
+    {
+        uint32_t h = end();
+        return h > N ? h - N : 0;
+    }
+
+    /**
+     * @brief Sequence number the next push() will use
+     * @return uint32_t One past the newest entry
+     */
+    uint32_t end() const { return head.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Copy out the entry with the given sequence number
+     * @param seq Sequence number in [begin(), end())
+     * @param out Destination for the entry
+     * @return true if the entry was copied consistently
+     * @return false if it was never written or has been overwritten
+     */
+    bool read(uint32_t seq, T &out) const
+    {
+        const Slot &slot = slots[seq & (N - 1)];
+        const uint32_t expected = seq * 2 + 2;
+
+        if (slot.version.load(std::memory_order_acquire) != expected)
+            return false;
+        out = slot.value;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.version.load(std::memory_order_relaxed) == expected;
+    }
+
+    /**
+     * @brief Maximum number of entries held
+     */
+    static constexpr size_t capacity() { return N; }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint32_t> version{0};
+        T value{};
+    };
+
+    Slot slots[N];
+    std::atomic<uint32_t> head{0};
+};
@@ -0,0 +1,20 @@
+#pragma once
+#include <stddef.h>
+
+/**
+ * @brief HTTP Range header parsing (RFC 7233, single byte ranges)
+ *
+ * Kept free of Arduino String so downloads and the host tests share it.
+ */
+namespace HttpRange {
+
+    /**
+     * @brief Parse a "bytes=" Range header against a file size
+     * @param header Range header value
+     * @param size File size
+     * @param start Receives the first byte
+     * @param length Receives the range length
+     * @return true if the range is satisfiable (multi-range requests are not)
+     */
+    bool parse(const char *header, size_t size, size_t &start, size_t &length);
+}
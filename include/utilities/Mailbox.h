@@ -0,0 +1,70 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * @brief Single-writer latest-value mailbox (sequence lock)
+ *
+ * publish() makes the sequence odd, copies the value and makes it even
+ * again; it never waits. A reader copies the value and retries if the
+ * sequence was odd or changed meanwhile, so it never sees a torn value and
+ * never delays the writer. T must be trivially copyable.
+ *
+ * THREAD SAFETY: one writer task, any number of readers. A reader that can
+ * preempt the writer on the writer's core would spin in read() until the
+ * writer runs again, so the writer must have the higher priority there.
+ */
+template <typename T>
+class Mailbox
+{
+public:
+    /**
+     * @brief Replace the value (writer task only)
+     * @param next New value
+     */
+    void publish(const T &next)
+    {
+        uint32_t s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        value = next;
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy the value if no publish() overlapped the copy
+     * @param out Receives the value
+     * @return true if out is consistent
+     */
+    bool tryRead(T &out) const
+    {
+        uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1)
+            return false;
+        out = value;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return sequence.load(std::memory_order_relaxed) == before;
+    }
+
+    /**
+     * @brief Copy the value, retrying until the copy is consistent
+     * @return T Latest published value
+     */
+    T read() const
+    {
+        T out;
+        while (!tryRead(out))
+        {
+        }
+        return out;
+    }
+
+    /**
+     * @brief Number of publish() calls so far
+     */
+    uint32_t version() const { return sequence.load(std::memory_order_acquire) >> 1; }
+
+private:
+    T value = {};
+    std::atomic<uint32_t> sequence{0};
+};
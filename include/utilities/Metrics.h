@@ -0,0 +1,123 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "config/Config.h"
+
+/**
+ * @brief Set to 0 (e.g. -D METRICS_ENABLED=0) to compile out all METRICS_SCOPE timers
+ */
+#ifndef METRICS_ENABLED
+#define METRICS_ENABLED 1
+#endif
+
+/**
+ * @brief Lightweight timing instrumentation for named code sections
+ *
+ * Each section keeps count/min/max/total plus a log-linear histogram of its
+ * duration in CPU cycles (4 buckets per power of two, so percentiles are
+ * accurate to about 25%). Timers read the per-core cycle counter, so a timed
+ * scope must not migrate between cores - all application tasks are pinned.
+ *
+ * THREAD SAFETY: record() and the readers take a short spinlock; any task may
+ * time sections concurrently.
+ */
+class Metrics
+{
+public:
+    static constexpr int BUCKETS = 124;  ///< Histogram buckets covering 0..2^32 cycles
+
+    /**
+     * @brief Statistics of one named section
+     */
+    struct Section
+    {
+        const char *name = nullptr;      ///< Section name (string literal)
+        uint32_t count = 0;              ///< Number of samples
+        uint64_t totalCycles = 0;        ///< Sum of all samples
+        uint32_t minCycles = UINT32_MAX; ///< Shortest sample
+        uint32_t maxCycles = 0;          ///< Longest sample
+        uint32_t buckets[BUCKETS] = {};  ///< Duration histogram
+    };
+
+    /**
+     * @brief Records the cycles spent between construction and destruction
+     */
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Section *section) : section(section), start(ESP.getCycleCount()) {}
+        ~ScopedTimer()
+        {
+            if (section)
+                Metrics::getInstance().record(section, ESP.getCycleCount() - start);
+        }
+
+    private:
+        Section *section;
+        uint32_t start;
+    };
+
+    /**
+     * @brief Get the singleton instance
+     * @return Metrics& Reference to the singleton instance
+     */
+    static Metrics &getInstance();
+
+    /**
+     * @brief Find or register a section
+     * @param name Section name; must outlive the program (string literal)
+     * @return Section* Section, nullptr if METRICS_MAX_SECTIONS is exhausted
+     */
+    Section *section(const char *name);
+
+    /**
+     * @brief Add one duration sample to a section
+     * @param section Section to update
+     * @param cycles Duration in CPU cycles
+     */
+    void record(Section *section, uint32_t cycles);
+
+    /**
+     * @brief Clear all samples (sections stay registered)
+     */
+    void reset();
+
+    /**
+     * @brief Append one object per section to a JSON array
+     * @param out Array receiving {"name","count","minUs","avgUs","maxUs","p99Us"} objects
+     */
+    void writeJson(JsonArray out);
+
+private:
+    Metrics() = default;
+    Metrics(const Metrics &) = delete;
+    Metrics &operator=(const Metrics &) = delete;
+
+    /**
+     * @brief Histogram bucket of a duration
+     */
+    static int bucketOf(uint32_t cycles);
+
+    /**
+     * @brief Largest duration that falls into a bucket
+     */
+    static uint32_t bucketUpperBound(int bucket);
+
+    Section sections[METRICS_MAX_SECTIONS];
+    int sectionCount = 0;
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+};
+
+#define METRICS_CONCAT_(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_(a, b)
+
+#if METRICS_ENABLED
+/**
+ * @brief Time the rest of the enclosing scope under a section name
+ */
+#define METRICS_SCOPE(name)                                                                              \
+    static Metrics::Section *METRICS_CONCAT(metricsSection_, __LINE__) = Metrics::getInstance().section(name); \
+    Metrics::ScopedTimer METRICS_CONCAT(metricsTimer_, __LINE__)(METRICS_CONCAT(metricsSection_, __LINE__))
+#else
+#define METRICS_SCOPE(name) do { } while (0)
+#endif
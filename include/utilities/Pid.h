@@ -0,0 +1,183 @@
+#pragma once
+#include <Arduino.h>
+
+/**
+ * @brief PID gains (output is a heater duty cycle in [0, 1])
+ */
+struct PidGains
+{
+    float kp;   ///< Duty per degree of error
+    float ki;   ///< Duty per degree-second of accumulated error
+    float kd;   ///< Duty per degree/second of measurement slope
+};
+
+/**
+ * @brief PID controller with clamping anti-windup and derivative on measurement
+ */
+class PidController
+{
+public:
+    /**
+     * @brief Set controller gains
+     * @param gains New gains (the integral is stored in output units, so the output does not jump)
+     */
+    void setGains(const PidGains &gains);
+
+    /**
+     * @brief Get controller gains
+     * @return const PidGains& Current gains
+     */
+    const PidGains &getGains() const { return gains; }
+
+    /**
+     * @brief Forget integral and derivative history
+     */
+    void reset();
+
+    /**
+     * @brief Run one control step
+     * @param setpoint Target temperature
+     * @param measurement Current (filtered) temperature
+     * @param dt Seconds since the previous call
+     * @param feedForward Model-based duty added to the output; the integral only corrects what it misses
+     * @return float Duty cycle in [0, 1]
+     */
+    float compute(float setpoint, float measurement, float dt, float feedForward = 0.0f);
+
+private:
+    PidGains gains = {0.0f, 0.0f, 0.0f};
+    float integral = 0.0f;          ///< Integral term in output units
+    float lastMeasurement = NAN;
+};
+
+/**
+ * @brief Turns a duty cycle into relay on/off over a fixed time window
+ *
+ * The duty is sampled at the start of every window; the relay is on for the
+ * first duty * window milliseconds. Pulses shorter than the minimum switch
+ * time are dropped (or extended to the full window) so the relay switches at
+ * most twice per window.
+ */
+class TimeProportionalOutput
+{
+public:
+    /**
+     * @param windowMs Window length in milliseconds
+     * @param minSwitchMs Minimum on and off time in milliseconds
+     */
+    TimeProportionalOutput(uint32_t windowMs, uint32_t minSwitchMs) : windowMs(windowMs), minSwitchMs(minSwitchMs) {}
+
+    /**
+     * @brief Start a new window at the next update()
+     */
+    void restart() { started = false; }
+
+    /**
+     * @brief Compute the relay state
+     * @param duty Requested duty cycle in [0, 1]
+     * @param nowMs Current time in milliseconds
+     * @return true if the relay should be on
+     */
+    bool update(float duty, uint32_t nowMs);
+
+private:
+    uint32_t windowMs;
+    uint32_t minSwitchMs;
+    uint32_t windowStart = 0;
+    uint32_t onMs = 0;
+    bool started = false;
+};
+
+/**
+ * @brief Relay (Astrom-Hagglund) autotuner
+ *
+ * Drives the heater fully on below setpoint - hysteresis and fully off above
+ * setpoint + hysteresis, measures the period and amplitude of the resulting
+ * limit cycle and derives gains with the Tyreus-Luyben rules (less
+ * aggressive than Ziegler-Nichols, suited to lagging thermal plants).
+ */
+class PidAutotuner
+{
+public:
+    /**
+     * @brief Autotune progress
+     */
+    enum State : uint8_t
+    {
+        IDLE,       ///< Not running
+        RUNNING,    ///< Relay experiment in progress
+        DONE,       ///< Gains available
+        FAILED      ///< Timed out or no usable oscillation
+    };
+
+    /**
+     * @brief Start the relay experiment
+     * @param setpoint Temperature to oscillate around
+     * @param hysteresis Relay switching band around setpoint
+     * @param cycles Number of full oscillations to average (after one settling cycle)
+     * @param timeoutMs Give up after this long
+     * @param nowMs Current time in milliseconds
+     */
+    void begin(float setpoint, float hysteresis, int cycles, uint32_t timeoutMs, uint32_t nowMs);
+
+    /**
+     * @brief Abort the experiment
+     */
+    void cancel() { state = IDLE; }
+
+    /**
+     * @brief Feed one measurement
+     * @param temperature Current temperature
+     * @param nowMs Current time in milliseconds
+     * @return bool Relay state to apply while RUNNING
+     */
+    bool update(float temperature, uint32_t nowMs);
+
+    /**
+     * @brief Current progress
+     */
+    State getState() const { return state; }
+
+    /**
+     * @brief Tuned gains (valid in DONE)
+     */
+    const PidGains &getGains() const { return result; }
+
+    /**
+     * @brief Setpoint of the running experiment
+     */
+    float getSetpoint() const { return setpoint; }
+
+private:
+    State state = IDLE;
+    float setpoint = 0.0f;
+    float hysteresis = 0.0f;
+    int cyclesWanted = 0;
+    uint32_t startMs = 0;
+    uint32_t timeoutMs = 0;
+
+    bool relayOn = true;
+    int cycles = 0;                 ///< Completed on-transitions
+    uint32_t lastOnMs = 0;          ///< Time of the previous off->on switch
+    float cycleMax = -INFINITY;
+    float cycleMin = INFINITY;
+    float sumPeriodMs = 0.0f;
+    float sumAmplitude = 0.0f;
+    PidGains result = {0.0f, 0.0f, 0.0f};
+};
+
+/**
+ * @brief Load PID gains from LittleFS
+ * @param path JSON file path
+ * @param gains Receives the gains
+ * @return true if a valid file was read
+ */
+bool loadPidGains(const char *path, PidGains &gains);
+
+/**
+ * @brief Save PID gains to LittleFS
+ * @param path JSON file path
+ * @param gains Gains to store
+ * @return true on success
+ */
+bool savePidGains(const char *path, const PidGains &gains);
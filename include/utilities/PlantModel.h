@@ -0,0 +1,82 @@
+#pragma once
+#include <Arduino.h>
+
+/**
+ * @brief First-order thermal model of the plate, identified online
+ *
+ * The plate is modelled as
+ *
+ *     dT/dt = (gain * u - (T - ambient)) / tau
+ *
+ * with u the heater duty in [0, 1]. Every PLANT_SAMPLE_MS the measured slope
+ * and the mean duty of the interval feed a recursive least squares estimate
+ * of the linear form dT/dt = a * u - b * T + c (a = gain / tau, b = 1 / tau,
+ * c = ambient / tau). Old samples fade with PLANT_FORGETTING, so the model
+ * follows a changed load (a beaker, a different volume).
+ *
+ * The inverse of the model gives the duty that makes the plate follow a
+ * setpoint moving at a known rate, which is used as feed-forward for ramps.
+ */
+class PlantModel
+{
+public:
+    PlantModel() { reset(); }
+
+    /**
+     * @brief Forget everything learned and start from the default guesses
+     */
+    void reset();
+
+    /**
+     * @brief Feed one control step
+     * @param temperature Current (filtered) temperature
+     * @param heating Whether the relay was on since the previous call
+     * @param nowMs Current time in milliseconds
+     */
+    void update(float temperature, bool heating, uint32_t nowMs);
+
+    /**
+     * @brief Whether enough data was seen and the estimate is physically plausible
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Duty that holds the temperature on a setpoint moving at ratePerS
+     * @param setpoint Setpoint in degrees Celsius
+     * @param ratePerS Setpoint slope in degrees Celsius per second
+     * @return float Duty in [0, 1]
+     */
+    float feedForward(float setpoint, float ratePerS) const;
+
+    /**
+     * @brief Steady-state rise above ambient at full power (C)
+     */
+    float getGain() const { return theta[0] / theta[1]; }
+
+    /**
+     * @brief Time constant (s)
+     */
+    float getTimeConstant() const { return 1.0f / theta[1]; }
+
+    /**
+     * @brief Ambient temperature (C)
+     */
+    float getAmbient() const { return theta[2] / theta[1]; }
+
+    /**
+     * @brief Identification samples taken since reset()
+     */
+    uint32_t getSamples() const { return samples; }
+
+private:
+    float theta[3];             ///< a, b, c
+    float P[3][3];              ///< RLS covariance
+    uint32_t samples = 0;
+
+    // Current identification interval
+    bool started = false;
+    uint32_t intervalStart = 0;
+    uint32_t lastMs = 0;
+    float startTemp = 0.0f;
+    uint32_t onMs = 0;
+};
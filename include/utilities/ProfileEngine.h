@@ -0,0 +1,168 @@
+#pragma once
+#include <Arduino.h>
+#include "config/Config.h"
+
+/**
+ * @brief Binary profile format
+ *
+ * A profile file is a Header followed by Header::segmentCount Segments, all
+ * little-endian and packed. Execution ends after the last segment.
+ */
+namespace Profile {
+
+    constexpr uint32_t FILE_MAGIC = 0x46505053;   ///< "SPPF"
+    constexpr uint8_t FILE_VERSION = 1;           ///< Bumped whenever the layout changes
+
+    /**
+     * @brief Segment operations
+     */
+    enum Op : uint8_t {
+        RAMP_TO = 1,    ///< Move the setpoint to temperature at value C/min
+        SOAK = 2,       ///< Keep the setpoint for value seconds
+        WAIT_TEMP = 3,  ///< Set temperature and wait until within value C of it
+        LOOP = 4        ///< Jump back to segment target, count more times
+    };
+
+    /**
+     * @brief One program step
+     */
+    struct __attribute__((packed)) Segment {
+        uint8_t op;             ///< Op
+        uint8_t target;         ///< LOOP: segment to jump to (must be earlier)
+        uint16_t count;         ///< LOOP: number of repetitions
+        float temperature;      ///< RAMP_TO / WAIT_TEMP: temperature in degrees Celsius
+        float value;            ///< RAMP_TO: rate in C/min, SOAK: seconds, WAIT_TEMP: band in C
+    };
+
+    static_assert(sizeof(Segment) == 12, "Profile segment layout changed - bump FILE_VERSION");
+
+    /**
+     * @brief File header
+     */
+    struct __attribute__((packed)) Header {
+        uint32_t magic;         ///< FILE_MAGIC
+        uint8_t version;        ///< FILE_VERSION
+        uint8_t segmentCount;   ///< Segments following the header
+        uint16_t reserved;
+    };
+
+    /**
+     * @brief A named program
+     */
+    struct Program {
+        char name[PROFILE_NAME_MAX];
+        uint8_t count;
+        Segment segments[PROFILE_MAX_SEGMENTS];
+    };
+
+    /**
+     * @brief Check a program before it is stored or run
+     * @param program Program to check
+     * @return const char* nullptr if valid, otherwise the reason
+     */
+    const char *validate(const Program &program);
+
+    /**
+     * @brief Check a profile name (letters, digits, '-' and '_')
+     */
+    bool isValidName(const char *name);
+
+    /**
+     * @brief Load a program from PROFILES_DIR (or the built-in recrystallization program)
+     * @param name Profile name
+     * @param program Receives the program
+     * @return true if a valid program was read
+     */
+    bool load(const char *name, Program &program);
+
+    /**
+     * @brief Store a program in PROFILES_DIR
+     * @param program Valid program (its name is the file name)
+     * @return true on success
+     */
+    bool save(const Program &program);
+
+    /**
+     * @brief The built-in recrystallization program (Modes::RECRYSTALLIZATION)
+     */
+    const Program &recrystallization();
+}
+
+/**
+ * @brief Executes a Profile::Program one control tick at a time
+ *
+ * Time-based segments end at their scheduled time, not at the tick that
+ * noticed it, so a program takes the same time regardless of tick jitter.
+ * A ramp starts from the setpoint at which the previous segment ended (the
+ * measured temperature for the first segment).
+ */
+class ProfileEngine
+{
+public:
+    /**
+     * @brief Start a program
+     * @param program Program to run (copied)
+     * @param temperature Current temperature, start of the first ramp
+     * @param nowMs Current time in milliseconds
+     */
+    void start(const Profile::Program &program, float temperature, uint32_t nowMs);
+
+    /**
+     * @brief Stop the running program
+     */
+    void stop() { running = false; }
+
+    /**
+     * @brief Advance the program
+     * @param temperature Current (filtered) temperature
+     * @param nowMs Current time in milliseconds
+     * @return true while the program runs, false once it finished
+     */
+    bool update(float temperature, uint32_t nowMs);
+
+    /**
+     * @brief Setpoint computed by the last update()
+     */
+    float getSetpoint() const { return setpoint; }
+
+    /**
+     * @brief Slope of the setpoint in C/s (0 outside a ramp)
+     */
+    float getSetpointRate() const;
+
+    /**
+     * @brief Whether a program is running
+     */
+    bool isRunning() const { return running; }
+
+    /**
+     * @brief Index of the current segment, -1 when idle
+     */
+    int getSegment() const { return running ? index : -1; }
+
+    /**
+     * @brief Seconds since the current segment started
+     */
+    uint32_t getSegmentElapsed(uint32_t nowMs) const { return running ? (nowMs - segmentStart) / 1000 : 0; }
+
+    /**
+     * @brief Program being run (or last run)
+     */
+    const Profile::Program &getProgram() const { return program; }
+
+private:
+    /**
+     * @brief Enter a segment that starts at startMs
+     */
+    void enter(int segment, uint32_t startMs);
+
+    Profile::Program program = {};
+    bool running = false;
+    int index = 0;
+    uint32_t segmentStart = 0;
+    uint32_t segmentDuration = 0;       ///< RAMP_TO / SOAK length in milliseconds
+    float rampFrom = 0.0f;
+    float setpoint = 0.0f;
+    uint16_t loopRemaining[PROFILE_MAX_SEGMENTS] = {};
+    bool loopArmed[PROFILE_MAX_SEGMENTS] = {};
+};
@@ -6,6 +6,16 @@
 extern WiFiServer serialServer;
 extern WiFiClient serialClient;
 
+/**
+ * @brief Highest log severity compiled in (0 = ERROR, 1 = INFO, 2 = DEBUG)
+ *
+ * Override with a build flag, e.g. -D LOG_MAX_LEVEL=1 to strip DEBUG messages
+ * including their format strings.
+ */
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL 2
+#endif
+
 /**
  * @brief Log level enumeration for message severity
  */
@@ -15,26 +25,85 @@ enum class LogLevel {
     DEBUG   ///< Debug messages
 };
 
+/**
+ * @brief Severity rank of a log level (lower is more important)
+ * @param level Log level
+ * @return int 0 for ERROR, 1 for INFO, 2 for DEBUG
+ */
+constexpr int logSeverity(LogLevel level) {
+    return level == LogLevel::ERROR ? 0 : (level == LogLevel::INFO ? 1 : 2);
+}
+
+/**
+ * @brief Check whether a log level is compiled in
+ * @param level Log level
+ * @return true if messages of this level are kept
+ */
+constexpr bool logLevelEnabled(LogLevel level) {
+    return logSeverity(level) <= LOG_MAX_LEVEL;
+}
+
+/**
+ * @brief Queue a message for the log drain task (use logMessage instead)
+ * @param level Severity level of the message
+ * @param message Message text to log
+ */
+void logWrite(LogLevel level, const char* message);
+
+/**
+ * @brief Format and queue a message for the log drain task (use logMessagef instead)
+ * @param level Severity level of the message
+ * @param fmt Format string (printf style)
+ * @param ... Variable arguments for format string
+ */
+void logWritef(LogLevel level, const char* fmt, ...);
+
 /**
  * @brief Log a message with specified severity level
  * @param level Severity level of the message
  * @param message Message text to log
+ *
+ * Never blocks: the message is copied into a preallocated ring and printed
+ * by logDrainTask(). If the ring is full the message is dropped and counted.
  */
-void logMessage(LogLevel level, const char* message);
+inline void logMessage(LogLevel level, const char* message) {
+    if (logLevelEnabled(level))
+        logWrite(level, message);
+}
 
 /**
  * @brief Log a formatted message with specified severity level
  * @param level Severity level of the message
  * @param fmt Format string (printf style)
- * @param ... Variable arguments for format string
+ * @param args Arguments for format string
+ *
+ * Same non-blocking semantics as logMessage().
+ */
+template <typename... Args>
+inline void logMessagef(LogLevel level, const char* fmt, Args... args) {
+    if (logLevelEnabled(level))
+        logWritef(level, fmt, args...);
+}
+
+/**
+ * @brief Number of messages dropped because the log ring was full
+ * @return uint32_t Total dropped since boot
+ */
+uint32_t logDroppedCount();
+
+/**
+ * @brief FreeRTOS task that prints queued log messages to Serial and telnet
+ * @param pvParameters Task parameters (unused)
+ *
+ * Also services the remote serial server. Run it at low priority; until it
+ * starts, messages are printed synchronously by the caller.
  */
-void logMessagef(LogLevel level, const char* fmt, ...);
+void logDrainTask(void* pvParameters);
 
 /**
  * @brief Handle remote serial connections and data
  * 
- * Call this regularly to process incoming connections and data
- * from remote serial clients.
+ * Called by logDrainTask(), which owns serialClient.
  */
 void handleRemoteSerial();
 
@@ -42,4 +111,4 @@ void handleRemoteSerial();
  * @brief Setup remote serial server on specified port
  * @param port TCP port number to listen on (default 23 for telnet)
  */
-void setupRemoteSerial(int port = 23);
\ No newline at end of file
+void setupRemoteSerial(int port = 23);
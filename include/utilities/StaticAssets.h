@@ -0,0 +1,69 @@
+#ifndef STATICASSETS_H
+#define STATICASSETS_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <FS.h>
+#include "config/Config.h"
+
+/**
+ * @brief Serves the pre-compressed, content-hashed web bundle built by scripts/build_assets.py
+ *
+ * The manifest (ASSET_MANIFEST_PATH) lists every asset with the hash of its
+ * stored bytes and whether it is stored as <path>.gz. Matching requests are
+ * answered with:
+ * - Content-Encoding: gzip for compressed assets
+ * - a strong ETag, and 304 Not Modified when If-None-Match matches
+ * - Cache-Control: ASSET_CACHE_IMMUTABLE when the URL carries ?v=<etag>
+ *   (as rewritten into the HTML/CSS by the build), "no-cache" otherwise
+ *
+ * Paths not in the manifest are left to the next handler (serveStatic).
+ */
+class StaticAssetHandler : public AsyncWebHandler
+{
+public:
+    /**
+     * @brief Load the manifest (call after the filesystem is mounted)
+     * @param fs Filesystem holding the assets
+     * @param manifestPath Manifest file path
+     * @return true if a manifest was loaded
+     */
+    bool begin(fs::FS &fs, const char *manifestPath);
+
+    /**
+     * @brief Number of assets in the loaded manifest
+     */
+    int count() const { return assetCount; }
+
+    bool canHandle(AsyncWebServerRequest *request) override;
+    void handleRequest(AsyncWebServerRequest *request) override;
+
+private:
+    /**
+     * @brief One manifest entry
+     */
+    struct Asset
+    {
+        char path[ASSET_PATH_MAX];  ///< Served path, e.g. "/js/dashboard.js"
+        char hash[17];              ///< Content hash (the ?v= value)
+        char etag[20];              ///< Quoted strong ETag
+        bool gzip;                  ///< Stored as path + ".gz"
+    };
+
+    /**
+     * @brief Find the asset for a request URL ("/" and ".../" map to index.html)
+     * @return const Asset* Matching entry, nullptr if none
+     */
+    const Asset *find(const String &url) const;
+
+    /**
+     * @brief MIME type from the file extension
+     */
+    static const char *contentType(const char *path);
+
+    fs::FS *fs = nullptr;
+    Asset assets[MAX_STATIC_ASSETS];
+    int assetCount = 0;
+};
+
+#endif // STATICASSETS_H
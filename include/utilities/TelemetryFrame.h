@@ -0,0 +1,94 @@
+#pragma once
+#include <Arduino.h>
+
+struct SystemState;
+
+/**
+ * @brief Compact binary telemetry frames for WebSocket clients
+ *
+ * A frame is a fixed little-endian struct carrying the full system state plus
+ * a bitmask of the fields that changed since the previous frame. Clients opt
+ * in with the "telemetryFormat" action; all other clients keep receiving the
+ * JSON "dataUpdate" message.
+ */
+namespace Telemetry {
+
+    constexpr uint8_t FRAME_MAGIC = 0xA5;   ///< First byte of every binary frame
+    constexpr uint8_t FRAME_VERSION = 2;    ///< Bumped whenever the layout changes
+
+    /**
+     * @brief Dirty-mask bits, one per telemetry field
+     */
+    enum Field : uint16_t {
+        FIELD_TEMPERATURE       = 1u << 0,
+        FIELD_RPM               = 1u << 1,
+        FIELD_MODE              = 1u << 2,
+        FIELD_TEMP_SETPOINT     = 1u << 3,
+        FIELD_RPM_SETPOINT      = 1u << 4,
+        FIELD_DURATION          = 1u << 5,
+        FIELD_ALERT_TEMP        = 1u << 6,
+        FIELD_ALERT_RPM         = 1u << 7,
+        FIELD_ALERT_TIMER       = 1u << 8,
+        FIELD_RUNNING_TIME      = 1u << 9,
+        FIELD_PROFILE           = 1u << 10,
+        FIELD_ALL               = (1u << 11) - 1
+    };
+
+    /**
+     * @brief Field bit for a JSON "dataUpdate" key, as used by the "subscribe" action
+     * @param name Key, e.g. "temperature"; "profile" selects both profile keys
+     * @return uint16_t Field bit, 0 if the name is unknown
+     */
+    uint16_t fieldByName(const char *name);
+
+    /**
+     * @brief Wire layout of a telemetry frame (little-endian, packed)
+     *
+     * Keep in sync with decodeTelemetryFrame() in data/js/dashboard.js.
+     */
+    struct __attribute__((packed)) Frame {
+        uint8_t magic;               ///< FRAME_MAGIC
+        uint8_t version;             ///< FRAME_VERSION
+        uint16_t dirtyMask;          ///< Fields changed since the previous frame
+        uint32_t sequence;           ///< Incremented for every frame sent
+        float temperature;           ///< Current temperature in degrees Celsius
+        int32_t rpm;                 ///< Current RPM
+        float tempSetpoint;          ///< Temperature setpoint
+        int32_t rpmSetpoint;         ///< RPM setpoint
+        int32_t duration;            ///< Duration setting in seconds
+        float alertTempThreshold;    ///< Temperature alert threshold
+        float alertRpmThreshold;     ///< RPM alert threshold
+        int32_t alertTimerThreshold; ///< Timer alert threshold in seconds
+        uint32_t runningTime;        ///< Seconds since the current run started
+        uint8_t mode;                ///< Mode code (HeaterModeManager::Mode value)
+        uint8_t profileSegment;      ///< Running profile segment, 0xFF when no profile runs
+        uint32_t profileElapsed;     ///< Seconds into the current profile segment
+    };
+
+    static_assert(sizeof(Frame) == 50, "Telemetry frame layout changed - update dashboard.js");
+
+    /**
+     * @brief Builds frames from SystemState and tracks which fields changed
+     */
+    class Encoder {
+    public:
+        /**
+         * @brief Refresh the frame from the current state
+         * @param state System state to encode (a StateManager snapshot)
+         * @param runningTime Seconds since the current run started
+         * @param force Mark every field dirty (e.g. for a newly subscribed client)
+         * @return true if at least one field is dirty and a frame should be sent
+         */
+        bool update(const SystemState &state, uint32_t runningTime, bool force = false);
+
+        /**
+         * @brief Get the most recently encoded frame
+         * @return const Frame& Frame ready to be sent as a binary message
+         */
+        const Frame &frame() const { return current; }
+
+    private:
+        Frame current = {};
+        bool hasPrevious = false;
+    };
+}
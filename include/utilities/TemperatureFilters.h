@@ -0,0 +1,246 @@
+#pragma once
+#include <math.h>
+#include <type_traits>
+#include "hardware/ITemperatureFilter.h"
+#include "config/Config.h"
+
+/**
+ * @brief Allocation-free filter stages and the chain built from Config.h
+ *
+ * Stages are plain classes with apply()/reset(); StageChain composes them
+ * at compile time (no virtual calls between stages). Every stage starts from
+ * its first sample, so there is no start-up transient.
+ */
+namespace TemperatureFilters {
+
+    /**
+     * @brief Stage that returns its input (used for disabled stages)
+     */
+    class PassThrough {
+    public:
+        float apply(float x) { return x; }
+        void reset() {}
+    };
+
+    /**
+     * @brief Sliding median of the last N samples (spike rejection)
+     * @tparam N Window length (odd values give a true median)
+     */
+    template <int N>
+    class Median {
+        static_assert(N > 0, "Median window must be positive");
+
+    public:
+        float apply(float x)
+        {
+            window[next] = x;
+            next = (next + 1) % N;
+            if (count < N)
+                count++;
+
+            // Insertion sort of at most N values
+            float sorted[N];
+            for (int i = 0; i < count; i++)
+            {
+                float v = window[i];
+                int j = i;
+                for (; j > 0 && sorted[j - 1] > v; j--)
+                    sorted[j] = sorted[j - 1];
+                sorted[j] = v;
+            }
+            return sorted[count / 2];
+        }
+
+        void reset()
+        {
+            count = 0;
+            next = 0;
+        }
+
+    private:
+        float window[N] = {};
+        int count = 0;
+        int next = 0;
+    };
+
+    /**
+     * @brief First-order exponential moving average
+     */
+    class Ema {
+    public:
+        /**
+         * @param alpha Weight of the new sample (0 < alpha <= 1)
+         */
+        explicit Ema(float alpha) : alpha(alpha) {}
+
+        float apply(float x)
+        {
+            if (!primed)
+            {
+                y = x;
+                primed = true;
+            }
+            y += alpha * (x - y);
+            return y;
+        }
+
+        void reset() { primed = false; }
+
+    private:
+        float alpha;
+        float y = 0.0f;
+        bool primed = false;
+    };
+
+    /**
+     * @brief Second-order low-pass (RBJ cookbook, transposed direct form II)
+     */
+    class BiquadLowPass {
+    public:
+        /**
+         * @param cutoffHz -3 dB frequency
+         * @param sampleHz Rate at which apply() is called
+         * @param q Quality factor (0.7071 = Butterworth)
+         */
+        BiquadLowPass(float cutoffHz, float sampleHz, float q)
+        {
+            const float w0 = 2.0f * (float)M_PI * cutoffHz / sampleHz;
+            const float cw = cosf(w0);
+            const float alpha = sinf(w0) / (2.0f * q);
+            const float a0 = 1.0f + alpha;
+            b0 = (1.0f - cw) / 2.0f / a0;
+            b1 = (1.0f - cw) / a0;
+            b2 = b0;
+            a1 = -2.0f * cw / a0;
+            a2 = (1.0f - alpha) / a0;
+        }
+
+        float apply(float x)
+        {
+            if (!primed)
+            {
+                // Steady state for a constant input x (unity DC gain)
+                z1 = x * (1.0f - b0);
+                z2 = x * (b2 - a2);
+                primed = true;
+            }
+            float y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            return y;
+        }
+
+        void reset() { primed = false; }
+
+    private:
+        float b0, b1, b2, a1, a2;
+        float z1 = 0.0f, z2 = 0.0f;
+        bool primed = false;
+    };
+
+    /**
+     * @brief Scalar Kalman filter with a random-walk temperature model
+     */
+    class Kalman {
+    public:
+        /**
+         * @param processNoise Variance added per sample (how fast the true temperature may move)
+         * @param measurementNoise Sensor noise variance
+         */
+        Kalman(float processNoise, float measurementNoise) : q(processNoise), r(measurementNoise) {}
+
+        float apply(float z)
+        {
+            if (!primed)
+            {
+                x = z;
+                p = r;
+                primed = true;
+                return x;
+            }
+            p += q;
+            const float k = p / (p + r);
+            x += k * (z - x);
+            p *= 1.0f - k;
+            return x;
+        }
+
+        void reset() { primed = false; }
+
+    private:
+        float q, r;
+        float x = 0.0f, p = 0.0f;
+        bool primed = false;
+    };
+
+    /**
+     * @brief Compile-time composition of stages, applied left to right
+     */
+    template <typename... Stages>
+    class StageChain;
+
+    template <>
+    class StageChain<> {
+    public:
+        float apply(float x) { return x; }
+        void reset() {}
+    };
+
+    template <typename First, typename... Rest>
+    class StageChain<First, Rest...> {
+    public:
+        float apply(float x) { return rest.apply(first.apply(x)); }
+        void reset()
+        {
+            first.reset();
+            rest.reset();
+        }
+
+    private:
+        First first;
+        StageChain<Rest...> rest;
+    };
+
+    /**
+     * @brief ITemperatureFilter wrapper around a stage chain
+     */
+    template <typename... Stages>
+    class Pipeline : public ITemperatureFilter {
+    public:
+        float apply(float sample) override { return chain.apply(sample); }
+        void reset() override { chain.reset(); }
+
+    private:
+        StageChain<Stages...> chain;
+    };
+
+    // --- Stages bound to Config.h ---
+
+    /// Filter input rate: HeatingElement::update() runs once per heater period
+    constexpr float SAMPLE_HZ = 1000.0f / HEATER_PERIOD_MS;
+
+    class ConfiguredEma : public Ema {
+    public:
+        ConfiguredEma() : Ema(TEMP_EMA_ALPHA) {}
+    };
+
+    class ConfiguredBiquad : public BiquadLowPass {
+    public:
+        ConfiguredBiquad() : BiquadLowPass(TEMP_BIQUAD_CUTOFF_HZ, SAMPLE_HZ, TEMP_BIQUAD_Q) {}
+    };
+
+    class ConfiguredKalman : public Kalman {
+    public:
+        ConfiguredKalman() : Kalman(TEMP_KALMAN_PROCESS_NOISE, TEMP_KALMAN_MEASUREMENT_NOISE) {}
+    };
+
+    using MedianStage = typename std::conditional<(TEMP_MEDIAN_SIZE > 1), Median<(TEMP_MEDIAN_SIZE > 1 ? TEMP_MEDIAN_SIZE : 1)>, PassThrough>::type;
+
+    using LowPassStage = typename std::conditional<TEMP_LOWPASS == TempLowPass::EMA, ConfiguredEma,
+                         typename std::conditional<TEMP_LOWPASS == TempLowPass::BIQUAD, ConfiguredBiquad, PassThrough>::type>::type;
+
+    using KalmanStage = typename std::conditional<TEMP_KALMAN_ENABLED, ConfiguredKalman, PassThrough>::type;
+
+    /// Filter used by the heating element: median -> low-pass -> Kalman
+    using ConfiguredPipeline = Pipeline<MedianStage, LowPassStage, KalmanStage>;
+}
@@ -11,6 +11,23 @@ class WebServerManager;
  * like control updates, history retrieval, and notepad operations.
  */
 namespace WebServerActions {
+    /**
+     * @brief ASCII lower-case (action names are matched case-insensitively)
+     */
+    constexpr char foldCase(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    /**
+     * @brief Case-insensitive 32-bit FNV-1a hash of an action name
+     * @param name Null-terminated action name
+     * @param hash Running hash (leave at the default)
+     * @return uint32_t Hash, usable as a case label
+     */
+    constexpr uint32_t actionHash(const char* name, uint32_t hash = 2166136261u) {
+        return *name ? actionHash(name + 1, (hash ^ static_cast<uint8_t>(foldCase(*name))) * 16777619u) : hash;
+    }
+
     /**
      * @brief Handle control update messages from client
      * @param mgr Pointer to WebServerManager instance
@@ -50,4 +67,84 @@ namespace WebServerActions {
      * @param data JSON data containing notepad name and content
      */
     void handleNotepadSave(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data);
+
+    /**
+     * @brief Handle telemetry format selection (binary frames or JSON)
+     * @param mgr Pointer to WebServerManager instance
+     * @param client Pointer to WebSocket client
+     * @param data JSON data containing "format"
+     */
+    void handleTelemetryFormat(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data);
+
+    /**
+     * @brief Handle telemetry subscription (fields and maximum rate)
+     * @param mgr Pointer to WebServerManager instance
+     * @param client Pointer to WebSocket client
+     * @param data JSON data with optional "fields" and "maxRate"
+     */
+    void handleSubscribe(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data);
+
+    /**
+     * @brief Handle metrics request
+     * @param mgr Pointer to WebServerManager instance
+     * @param client Pointer to WebSocket client
+     * @param data JSON data (may contain "reset")
+     */
+    void handleGetMetrics(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data);
+
+    /**
+     * @brief Handle PID autotune start/cancel
+     * @param mgr Pointer to WebServerManager instance
+     * @param client Pointer to WebSocket client
+     * @param data JSON data containing "setpoint" or "cancel"
+     */
+    void handlePidAutotune(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data);
+
+    /**
+     * @brief Handle PID gains update
+     * @param mgr Pointer to WebServerManager instance
+     * @param client Pointer to WebSocket client
+     * @param data JSON data containing "kp", "ki" and "kd"
+     */
+    void handleSetPidGains(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data);
+
+    /**
+     * @brief Handle profile save
+     * @param mgr Pointer to WebServerManager instance
+     * @param client Pointer to WebSocket client
+     * @param data JSON data containing "name" and "segments"
+     */
+    void handleProfileSave(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data);
+
+    /**
+     * @brief Handle profile start/stop
+     * @param mgr Pointer to WebServerManager instance
+     * @param client Pointer to WebSocket client
+     * @param data JSON data containing "name" or "stop"
+     */
+    void handleProfileRun(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data);
+
+    /**
+     * @brief Handle configuration request
+     * @param mgr Pointer to WebServerManager instance
+     * @param client Pointer to WebSocket client
+     * @param data JSON data (unused)
+     */
+    void handleGetConfig(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data);
+
+    /**
+     * @brief Handle system reset request
+     * @param mgr Pointer to WebServerManager instance
+     * @param client Pointer to WebSocket client
+     * @param data JSON data (unused)
+     */
+    void handleResetSystem(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data);
+
+    /**
+     * @brief Handle full state update
+     * @param mgr Pointer to WebServerManager instance
+     * @param client Pointer to WebSocket client
+     * @param data JSON data containing "temperature", "rpm" and "mode"
+     */
+    void handleUpdateState(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data);
 }
\ No newline at end of file
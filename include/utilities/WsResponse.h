@@ -0,0 +1,60 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+
+/**
+ * @brief The one path for JSON messages to WebSocket clients
+ *
+ * A document is sized with measureJson() and serialized straight into an
+ * AsyncWebSocketMessageBuffer, which the library queues as is: no String,
+ * no copy per client. The buffer is reference counted, so a broadcast
+ * queues that one buffer to every client and the library frees it when
+ * the last client has sent it.
+ *
+ * THREAD SAFETY: any task; the library locks its client list.
+ */
+namespace WsResponse {
+    /**
+     * @brief Serialize a document into a new message buffer
+     * @param ws WebSocket server that owns the buffer
+     * @param doc Document to serialize
+     * @return AsyncWebSocketMessageBuffer* Buffer holding exactly the JSON text, nullptr if out of memory
+     */
+    AsyncWebSocketMessageBuffer *serialize(AsyncWebSocket &ws, const JsonDocument &doc);
+
+    /**
+     * @brief Send a document to one client
+     * @param client Destination (ignored unless connected)
+     * @param doc Document to send
+     * @return true if the message was queued
+     */
+    bool send(AsyncWebSocketClient *client, const JsonDocument &doc);
+
+    /**
+     * @brief Send a document to every connected client, sharing one buffer
+     * @param ws WebSocket server
+     * @param doc Document to send
+     * @return true if the message was queued
+     */
+    bool broadcast(AsyncWebSocket &ws, const JsonDocument &doc);
+
+    /**
+     * @brief Send {"type":"ack","message":...}
+     * @param client Destination
+     * @param message Acknowledgment text
+     */
+    void sendAck(AsyncWebSocketClient *client, const char *message);
+
+    /**
+     * @brief Send {"type":"error","message":...}
+     * @param client Destination
+     * @param error Error text
+     */
+    void sendError(AsyncWebSocketClient *client, const char *error);
+
+    /**
+     * @brief Messages dropped because no buffer could be allocated
+     */
+    uint32_t allocFailures();
+}
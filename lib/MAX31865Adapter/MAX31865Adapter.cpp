@@ -0,0 +1,193 @@
+#include "MAX31865Adapter.h"
+#include <SPI.h>
+#include <esp_timer.h>
+
+// Register map (read addresses)
+static constexpr uint8_t REG_RTD_MSB = 0x01;
+static constexpr uint8_t REG_FAULT_STATUS = 0x07;
+static const SPISettings MAX31865_SPI(1000000, MSBFIRST, SPI_MODE1);
+
+MAX31865Adapter::MAX31865Adapter(uint8_t csPin, int probeCsPin)
+    : chips{{(int8_t)csPin}, {(int8_t)probeCsPin}}, count(probeCsPin >= 0 ? 2 : 1) {
+    channels[0].csPin = csPin;
+    channels[1].csPin = probeCsPin;
+}
+
+bool MAX31865Adapter::begin() {
+    for (uint8_t i = 0; i < count; i++) {
+        chips[i].begin(MAX31865_3WIRE);
+    }
+    return true;
+}
+
+bool MAX31865Adapter::beginContinuous(TaskHandle_t acquisitionTask, int drdyPin, bool filter50Hz, int probeDrdyPin) {
+    for (uint8_t i = 0; i < count; i++) {
+        Channel& ch = channels[i];
+        if (!ch.samples) {
+            ch.samples = xQueueCreateStatic(QUEUE_LENGTH, sizeof(RtdSample), ch.queueBuffer, &ch.queueStorage);
+            if (!ch.samples) return false;
+        }
+    }
+
+    // Precompute Callendar-Van Dusen at every LUT_STEP codes; linear
+    // interpolation between them is accurate to well below 0.01 C.
+    // All chips use the same RTD and reference, so they share the table.
+    for (int i = 0; i < LUT_SIZE; i++) {
+        uint16_t code = LUT_FIRST_CODE + (i << LUT_STEP_SHIFT);
+        lut[i] = chips[0].calculateTemperature(code, RNOMINAL, RREF);
+    }
+
+    const int drdyPins[MAX_CHANNELS] = {drdyPin, probeDrdyPin};
+    for (uint8_t i = 0; i < count; i++) {
+        Channel& ch = channels[i];
+        chips[i].begin(MAX31865_3WIRE);
+        chips[i].enable50Hz(filter50Hz);
+        chips[i].clearFault();
+        chips[i].enableBias(true);
+        chips[i].autoConvert(true);
+
+        ch.notifyTask = acquisitionTask;
+        ch.drdyPin = drdyPins[i];
+        if (ch.drdyPin >= 0) {
+            pinMode(ch.drdyPin, INPUT_PULLUP);
+            attachInterruptArg(ch.drdyPin, onDataReady, &ch, FALLING);
+        }
+    }
+    continuous = true;
+    return true;
+}
+
+void IRAM_ATTR MAX31865Adapter::onDataReady(void* arg) {
+    Channel* ch = static_cast<Channel*>(arg);
+    ch->ready = true;
+    if (!ch->notifyTask) return;
+    BaseType_t higherPriorityWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(ch->notifyTask, &higherPriorityWoken);
+    if (higherPriorityWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void MAX31865Adapter::readRegisters(int8_t csPin, uint8_t addr, uint8_t* out, size_t len) {
+    SPI.beginTransaction(MAX31865_SPI);
+    digitalWrite(csPin, LOW);
+    SPI.transfer(addr & 0x7F);
+    for (size_t i = 0; i < len; i++) {
+        out[i] = SPI.transfer(0xFF);
+    }
+    digitalWrite(csPin, HIGH);
+    SPI.endTransaction();
+}
+
+void MAX31865Adapter::acquire() {
+    if (!continuous) return;
+
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    for (uint8_t i = 0; i < count; i++) {
+        Channel& ch = channels[i];
+        // DRDY stays low until the RTD registers are read, so a missed edge would
+        // stop the channel for good; read it anyway once it is overdue
+        if (ch.drdyPin >= 0 && !ch.ready && now - ch.lastReadUs < DRDY_TIMEOUT_US) continue;
+        ch.ready = false;
+        ch.lastReadUs = now;
+        readChannel(i, now);
+    }
+}
+
+void MAX31865Adapter::readChannel(uint8_t index, uint32_t nowUs) {
+    Channel& ch = channels[index];
+    uint8_t raw[2];
+    readRegisters(ch.csPin, REG_RTD_MSB, raw, sizeof(raw));
+
+    // Bit 0 of the LSB register flags a fault; only then is the fault register worth a transaction.
+    // Read the status register directly: Adafruit readFault() starts a fault-detection
+    // cycle that turns continuous conversion off.
+    if (raw[1] & 0x01) {
+        uint8_t fault;
+        readRegisters(ch.csPin, REG_FAULT_STATUS, &fault, 1);
+        ch.latchedFault = fault;
+        chips[index].clearFault();
+        return;
+    }
+
+    RtdSample sample;
+    sample.timestampUs = nowUs;
+    sample.code = ((uint16_t)raw[0] << 8 | raw[1]) >> 1;
+    if (xQueueSend(ch.samples, &sample, 0) != pdTRUE) {
+        ch.dropped++;
+    }
+}
+
+float MAX31865Adapter::codeToTemperature(uint16_t code) {
+    int32_t offset = (int32_t)code - LUT_FIRST_CODE;
+    int32_t index = offset >> LUT_STEP_SHIFT;
+    if (offset < 0 || index >= LUT_SIZE - 1) {
+        return chips[0].calculateTemperature(code, RNOMINAL, RREF);
+    }
+    float frac = (float)(offset & ((1 << LUT_STEP_SHIFT) - 1)) / (1 << LUT_STEP_SHIFT);
+    return lut[index] + (lut[index + 1] - lut[index]) * frac;
+}
+
+ITemperatureSensor::Batch MAX31865Adapter::poll(uint8_t channel, Sample* samples, size_t maxSamples) {
+    Batch batch;
+    if (channel >= count) return batch;
+    Channel& ch = channels[channel];
+
+    if (!continuous) {
+        // One-shot: the Adafruit library waits for the conversion
+        if (maxSamples) {
+            samples[0].temperature = chips[channel].temperature(RNOMINAL, RREF);
+            samples[0].timestampUs = (uint32_t)esp_timer_get_time();
+            batch.count = 1;
+        }
+        batch.faultCode = chips[channel].readFault();
+    } else {
+        RtdSample sample;
+        while (batch.count < maxSamples && xQueueReceive(ch.samples, &sample, 0) == pdTRUE) {
+            samples[batch.count].timestampUs = sample.timestampUs;
+            samples[batch.count].temperature = codeToTemperature(sample.code);
+            batch.count++;
+        }
+        batch.faultCode = ch.latchedFault;
+        batch.dropped = ch.dropped;
+    }
+
+    batch.status = batch.faultCode ? FAULT : batch.count ? OK : NO_DATA;
+    return batch;
+}
+
+void MAX31865Adapter::clearFault(uint8_t channel) {
+    if (channel >= count) return;
+    if (!continuous) {
+        chips[channel].clearFault();
+        return;
+    }
+    // The chip's fault status is cleared by readChannel() when it is latched
+    channels[channel].latchedFault = 0;
+}
+
+float MAX31865Adapter::readTemperature() {
+    static constexpr size_t CHUNK = 16;
+    Sample chunk[CHUNK];
+    float sum = 0.0f;
+    size_t total = 0;
+    Batch batch;
+    bool faulted = false;
+    do {
+        batch = poll(0, chunk, CHUNK);
+        faulted |= batch.status == FAULT;
+        for (size_t i = 0; i < batch.count; i++) {
+            sum += chunk[i].temperature;
+        }
+        total += batch.count;
+    } while (continuous && batch.count == CHUNK);
+
+    // A faulted RTD must not keep reporting its last good value: NAN stops
+    // the heater, and the fault stays latched until clearFault(0)
+    if (faulted) {
+        lastTemperature = NAN;
+    } else if (total) {
+        lastTemperature = sum / total;
+    }
+    return lastTemperature;
+}
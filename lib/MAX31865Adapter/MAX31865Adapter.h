@@ -1,46 +1,157 @@
 #pragma once
 #include "hardware/ITemperatureSensor.h"
 #include <Adafruit_MAX31865.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
 
 /**
- * @brief Adapter class for MAX31865 RTD temperature sensor
- * 
- * This class implements the ITemperatureSensor interface for the
- * Adafruit MAX31865 RTD sensor, configured for PT100 3-wire mode.
+ * @brief Adapter class for MAX31865 RTD temperature sensors
+ *
+ * This class implements the ITemperatureSensor interface for up to
+ * MAX_CHANNELS Adafruit MAX31865 RTD boards (PT100, 3-wire) sharing one
+ * SPI bus: channel 0 is the plate probe, channel 1 an optional second
+ * probe (e.g. in the liquid) with its own chip select.
+ *
+ * Two acquisition modes are supported:
+ * - One-shot (begin()): poll() runs a blocking ~75 ms conversion
+ *   through the Adafruit library.
+ * - Continuous (beginContinuous()): the chips convert at 50/60 Hz. DRDY
+ *   wakes an acquisition task, which calls acquire() to read the raw RTD
+ *   codes of the channels that have a new conversion into one sample queue
+ *   per channel. poll() then only drains a queue and converts through a
+ *   lookup table, with no SPI traffic.
  */
 class MAX31865Adapter : public ITemperatureSensor {
 public:
+    static constexpr float RNOMINAL = 100.0f;   ///< PT100 nominal resistance
+    static constexpr float RREF = 424.0f;       ///< Reference resistor on the breakout
+    static constexpr int QUEUE_LENGTH = 64;     ///< Buffered samples per channel (>1 s at 50 Hz)
+    static constexpr uint8_t MAX_CHANNELS = 2;  ///< Chips on the bus
+    static constexpr uint32_t DRDY_TIMEOUT_US = 50000;  ///< A channel is read without DRDY after this long (missed edge)
+
+    /**
+     * @brief Raw conversion result as read in the acquisition task
+     */
+    struct RtdSample {
+        uint32_t timestampUs;   ///< esp_timer time of the read
+        uint16_t code;          ///< 15-bit RTD code (fault bit removed)
+    };
+
     /**
      * @brief Construct a new MAX31865 Adapter
-     * @param csPin Chip select pin for SPI communication
+     * @param csPin Chip select pin of the first (plate) channel
+     * @param probeCsPin Chip select pin of the second channel, -1 if not fitted
+     */
+    MAX31865Adapter(uint8_t csPin, int probeCsPin = -1);
+
+    /**
+     * @brief Initialize every chip in 3-wire one-shot mode
+     * @return true (the MAX31865 has no identification register to check)
      */
-    MAX31865Adapter(uint8_t csPin) : sensor(csPin) {}
-    
+    bool begin() override;
+
     /**
-     * @brief Initialize the MAX31865 sensor in 3-wire mode
+     * @brief Switch to continuous conversion
+     * @param acquisitionTask Task that calls acquire() when notified
+     * @param drdyPin DRDY GPIO of channel 0, or -1 if not wired (poll acquire() instead)
+     * @param filter50Hz true for 50 Hz mains rejection (20 ms conversions), false for 60 Hz
+     * @param probeDrdyPin DRDY GPIO of channel 1, or -1 if not wired
+     * @return true if the sample queues could be created
      */
-    void begin() { sensor.begin(MAX31865_3WIRE); }
-    
+    bool beginContinuous(TaskHandle_t acquisitionTask, int drdyPin, bool filter50Hz = true, int probeDrdyPin = -1);
+
     /**
-     * @brief Read temperature from the sensor
-     * @return float Temperature in degrees Celsius using PT100 calibration
+     * @brief Read the latest conversions into the sample queues (acquisition task only)
+     *
+     * Reads the two RTD registers of every channel whose DRDY fired (or
+     * that has no DRDY, or was last read DRDY_TIMEOUT_US ago), one SPI
+     * transaction per chip. The fault register is only read (and latched
+     * for poll()) when the RTD code's fault bit is set.
      */
-    float readTemperature() override {
-        constexpr float RNOMINAL = 100.0f;
-        constexpr float RREF = 424.0f;
-        return sensor.temperature(RNOMINAL, RREF);
-    }
-    
+    void acquire();
+
+    /**
+     * @brief Number of fitted chips
+     */
+    uint8_t channelCount() const override { return count; }
+
+    /**
+     * @brief Collect the samples of one channel acquired since the previous call
+     * @param channel Channel index
+     * @param samples Receives up to maxSamples samples (oldest first)
+     * @param maxSamples Capacity of samples
+     * @return Batch FAULT takes precedence over OK; samples read before the fault are still returned
+     *
+     * In one-shot mode this blocks for one conversion and returns one sample.
+     */
+    Batch poll(uint8_t channel, Sample *samples, size_t maxSamples) override;
+
     /**
-     * @brief Read fault status from the sensor
-     * @return uint8_t Fault code (0 if no fault)
+     * @brief Clear the fault of a channel
+     * @param channel Channel index
      */
-    uint8_t readFault() { return sensor.readFault(); }
-    
+    void clearFault(uint8_t channel) override;
+
     /**
-     * @brief Clear any fault conditions
+     * @brief Read temperature from the first channel
+     * @return float Temperature in degrees Celsius using PT100 calibration
+     *
+     * The mean of all samples polled by this call, or the previous value if
+     * none arrived. NAN until the first sample, and NAN from a fault until
+     * clearFault(0). Do not mix with poll() on channel 0.
      */
-    void clearFault() { sensor.clearFault(); }
+    float readTemperature() override;
+
 private:
-    Adafruit_MAX31865 sensor;
-};
\ No newline at end of file
+    static constexpr uint16_t LUT_FIRST_CODE = 6144;   ///< ~ -52 C
+    static constexpr uint16_t LUT_STEP_SHIFT = 6;      ///< 64 codes (~2 C) per entry
+    static constexpr int LUT_SIZE = 162;               ///< Up to ~ +302 C
+
+    /**
+     * @brief Acquisition state of one chip
+     */
+    struct Channel {
+        int8_t csPin = -1;
+        int8_t drdyPin = -1;
+        volatile bool ready = false;        ///< Set by the DRDY interrupt
+        uint32_t lastReadUs = 0;
+        TaskHandle_t notifyTask = nullptr;
+
+        StaticQueue_t queueStorage;
+        uint8_t queueBuffer[QUEUE_LENGTH * sizeof(RtdSample)];
+        QueueHandle_t samples = nullptr;
+
+        volatile uint8_t latchedFault = 0;
+        volatile uint32_t dropped = 0;
+    };
+
+    /**
+     * @brief DRDY falling-edge handler
+     * @param arg Channel
+     */
+    static void IRAM_ATTR onDataReady(void* arg);
+
+    /**
+     * @brief Read one or more consecutive registers in a single SPI transaction
+     */
+    static void readRegisters(int8_t csPin, uint8_t addr, uint8_t* out, size_t len);
+
+    /**
+     * @brief Read one conversion of a channel into its queue
+     */
+    void readChannel(uint8_t index, uint32_t nowUs);
+
+    /**
+     * @brief Convert an RTD code with the lookup table (Callendar-Van Dusen outside it)
+     */
+    float codeToTemperature(uint16_t code);
+
+    Adafruit_MAX31865 chips[MAX_CHANNELS];
+    Channel channels[MAX_CHANNELS];
+    uint8_t count;
+    bool continuous = false;
+
+    float lastTemperature = NAN;
+    float lut[LUT_SIZE];
+};
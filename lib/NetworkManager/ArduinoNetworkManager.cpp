@@ -1,30 +1,97 @@
 #include "ArduinoNetworkManager.h"
 
-ArduinoNetworkManager::ArduinoNetworkManager() : ipAddress(""), otaInitialized(false) {}
+ArduinoNetworkManager::ArduinoNetworkManager() {}
+
+namespace {
+    constexpr char PREFS_NAMESPACE[] = "wifi";      ///< NVS namespace of the stored access point
+}
 
 bool ArduinoNetworkManager::connectWiFi(const char* ssid, const char* password) {
-    Serial.println("[NetworkManager] Connecting to WiFi...");
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(ssid, password);
-    
-    // Non-blocking connection with timeout
-    unsigned long startAttempt = millis();
-    const unsigned long timeout = 20000; // 20 second timeout
-    
-    while (WiFi.status() != WL_CONNECTED && millis() - startAttempt < timeout) {
-        delay(500);
-        Serial.print(".");
+    this->ssid = ssid;
+    this->password = password;
+
+    WiFi.onEvent([this](arduino_event_id_t event, arduino_event_info_t info) { onWiFiEvent(event, info); });
+    WiFi.persistent(false);      // Credentials come from Config.h; no flash write per begin()
+    WiFi.setAutoReconnect(true);
+    if (!WiFi.mode(WIFI_STA)) {
+        Serial.println("[NetworkManager] Failed to start the WiFi station");
+        return false;
     }
-    Serial.println();
-    
-    if (WiFi.status() == WL_CONNECTED) {
-        ipAddress = WiFi.localIP().toString();
-        Serial.printf("[NetworkManager] Connected! IP: %s\n", ipAddress.c_str());
-        return true;
+
+    uint8_t bssid[6] = {};
+    uint8_t channel = 0;
+    Preferences prefs;
+    if (prefs.begin(PREFS_NAMESPACE, true)) {
+        channel = prefs.getUChar("channel", 0);
+        if (prefs.getBytes("bssid", bssid, sizeof(bssid)) != sizeof(bssid))
+            channel = 0;
+        prefs.end();
+    }
+
+    connectStart = millis();
+    fastAttempt = channel != 0;
+    if (fastAttempt) {
+        Serial.printf("[NetworkManager] Connecting to WiFi (channel %u, stored BSSID)...\n", channel);
+        WiFi.begin(ssid, password, channel, bssid);
     } else {
-        Serial.println("[NetworkManager] WiFi connection failed!");
-        return false;
+        Serial.println("[NetworkManager] Connecting to WiFi...");
+        WiFi.begin(ssid, password);
+    }
+    return true;
+}
+
+void ArduinoNetworkManager::setOnConnectedCallback(Callback callback) {
+    onConnected = callback;
+}
+
+void ArduinoNetworkManager::onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+    switch (event) {
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            snprintf(ipAddress, sizeof(ipAddress), "%s", WiFi.localIP().toString().c_str());
+            Serial.printf("[NetworkManager] Connected in %lu ms%s! IP: %s\n", millis() - connectStart,
+                          fastAttempt ? " (fast reconnect)" : "", ipAddress);
+            fastAttempt = false;
+            storeAccessPoint();
+            if (onConnected)
+                onConnected();
+            break;
+
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            if (fastAttempt) {
+                // The access point moved or changed channel: scan for it instead
+                Serial.println("[NetworkManager] Fast reconnect failed - scanning");
+                fastAttempt = false;
+                connectStart = millis();
+                WiFi.begin(ssid, password);
+            } else if (ipAddress[0]) {
+                Serial.println("[NetworkManager] WiFi lost - reconnecting");
+                ipAddress[0] = '\0';
+                connectStart = millis();
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void ArduinoNetworkManager::storeAccessPoint() {
+    const uint8_t* bssid = WiFi.BSSID();
+    uint8_t channel = WiFi.channel();
+    if (!bssid || channel == 0)
+        return;
+
+    Preferences prefs;
+    if (!prefs.begin(PREFS_NAMESPACE, false))
+        return;
+    uint8_t stored[6] = {};
+    // Only write when the access point changed, to spare the flash
+    if (prefs.getUChar("channel", 0) != channel || prefs.getBytes("bssid", stored, sizeof(stored)) != sizeof(stored) ||
+        memcmp(stored, bssid, sizeof(stored)) != 0) {
+        prefs.putUChar("channel", channel);
+        prefs.putBytes("bssid", bssid, sizeof(stored));
     }
+    prefs.end();
 }
 
 bool ArduinoNetworkManager::setupOTA(const char* hostname) {
@@ -80,5 +147,5 @@ bool ArduinoNetworkManager::isConnected() const {
 }
 
 const char* ArduinoNetworkManager::getLocalIP() const {
-    return ipAddress.c_str();
+    return ipAddress;
 }
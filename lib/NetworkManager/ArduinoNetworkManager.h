@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <ArduinoOTA.h>
+#include <Preferences.h>
 
 /**
  * @brief Arduino-based implementation of network management
@@ -11,6 +12,11 @@
  * This class implements the INetworkManager interface using Arduino
  * WiFi and OTA libraries. It isolates Arduino-specific APIs behind
  * the interface to enable future migration to ESP-IDF.
+ *
+ * The connection is driven by WiFi events, nothing waits for it. The
+ * channel and BSSID of the last access point are kept in NVS; the next
+ * boot connects to them directly instead of scanning all channels, and
+ * falls back to a full scan if that first attempt fails.
  */
 class ArduinoNetworkManager : public INetworkManager {
 public:
@@ -20,12 +26,18 @@ public:
     ArduinoNetworkManager();
     
     /**
-     * @brief Initialize and connect to WiFi network
-     * @param ssid WiFi network SSID
-     * @param password WiFi network password
-     * @return true if connection successful, false otherwise
+     * @brief Start connecting to a WiFi network; returns without waiting
+     * @param ssid WiFi network SSID (must outlive the manager)
+     * @param password WiFi network password (must outlive the manager)
+     * @return true if the connection attempt was started, false otherwise
      */
     bool connectWiFi(const char* ssid, const char* password) override;
+
+    /**
+     * @brief Set the function called whenever the station got an IP address
+     * @param callback Runs in the WiFi event task; keep it short
+     */
+    void setOnConnectedCallback(Callback callback) override;
     
     /**
      * @brief Initialize OTA update functionality
@@ -52,8 +64,24 @@ public:
     const char* getLocalIP() const override;
 
 private:
-    String ipAddress;  ///< Cached IP address string
+    char ipAddress[16] = "";  ///< Dotted IP address, written by the event handler
     bool otaInitialized = false;  ///< OTA initialization state
+
+    const char* ssid = nullptr;
+    const char* password = nullptr;
+    Callback onConnected = nullptr;
+    volatile bool fastAttempt = false;  ///< Current attempt uses the stored channel/BSSID
+    unsigned long connectStart = 0;     ///< millis() of the current attempt
+
+    /**
+     * @brief WiFi event handler (WiFi event task)
+     */
+    void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info);
+
+    /**
+     * @brief Remember the access point of the current connection for the next boot
+     */
+    void storeAccessPoint();
     
     /**
      * @brief Setup OTA event callbacks
@@ -14,12 +14,26 @@ public:
     virtual ~INetworkManager() = default;
     
     /**
-     * @brief Initialize and connect to WiFi network
-     * @param ssid WiFi network SSID
-     * @param password WiFi network password
-     * @return true if connection successful, false otherwise
+     * @brief Callback without arguments
+     */
+    typedef void (*Callback)();
+
+    /**
+     * @brief Start connecting to a WiFi network; returns without waiting
+     * @param ssid WiFi network SSID (must outlive the manager)
+     * @param password WiFi network password (must outlive the manager)
+     * @return true if the connection attempt was started, false otherwise
+     *
+     * The connection is completed, and re-established after a drop, in the
+     * background; the connected callback reports each time it is up.
      */
     virtual bool connectWiFi(const char* ssid, const char* password) = 0;
+
+    /**
+     * @brief Set the function called whenever the station got an IP address
+     * @param callback Runs in the network event task; keep it short (set a flag, notify a task)
+     */
+    virtual void setOnConnectedCallback(Callback callback) = 0;
     
     /**
      * @brief Initialize OTA update functionality
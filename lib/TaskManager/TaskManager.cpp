@@ -1,9 +1,15 @@
 #include "TaskManager.h"
+#include <esp_timer.h>
+
+TaskManager::Job TaskManager::jobs[TaskManager::MAX_TASKS];
+uint32_t TaskManager::jobCount = 0;
 
 TaskManager::TaskManager() : taskCount(0) {
     // Initialize task handle array
     for (uint32_t i = 0; i < MAX_TASKS; i++) {
         tasks[i] = NULL;
+        stackSizes[i] = 0;
+        staticTasks[i] = false;
     }
 }
 
@@ -24,31 +30,199 @@ TaskHandle_t TaskManager::createTask(
     UBaseType_t priority,
     BaseType_t coreId
 ) {
+    return startTask({name, stackSize, priority, coreId, nullptr, nullptr}, taskFunction, parameter);
+}
+
+TaskHandle_t TaskManager::createTask(const TaskConfig& config, TaskFunction taskFunction, void* parameter) {
+    return startTask(config, taskFunction, parameter);
+}
+
+TaskHandle_t TaskManager::startTask(const TaskConfig& config, TaskFunction taskFunction, void* parameter) {
     if (taskCount >= MAX_TASKS) {
         Serial.printf("[TaskManager] Error: Maximum task count (%d) reached\n", MAX_TASKS);
         return NULL;
     }
-    
+
     TaskHandle_t taskHandle = NULL;
-    BaseType_t result = xTaskCreatePinnedToCore(
-        taskFunction,
-        name,
-        stackSize,
-        parameter,
-        priority,
-        &taskHandle,
-        coreId
-    );
-    
-    if (result == pdPASS && taskHandle != NULL) {
-        tasks[taskCount] = taskHandle;
-        taskCount++;
-        Serial.printf("[TaskManager] Created task '%s' (count: %d)\n", name, taskCount);
-        return taskHandle;
-    } else {
-        Serial.printf("[TaskManager] Failed to create task '%s'\n", name);
+    bool isStatic = config.stackBuffer != nullptr && config.taskBuffer != nullptr;
+    if (isStatic) {
+        // Stack depth is in bytes on ESP-IDF, like stackSize
+        taskHandle = xTaskCreateStaticPinnedToCore(
+            taskFunction,
+            config.name,
+            config.stackSize,
+            parameter,
+            config.priority,
+            config.stackBuffer,
+            config.taskBuffer,
+            config.coreId
+        );
+    } else if (xTaskCreatePinnedToCore(taskFunction, config.name, config.stackSize, parameter,
+                                       config.priority, &taskHandle, config.coreId) != pdPASS) {
+        taskHandle = NULL;
+    }
+
+    if (taskHandle == NULL) {
+        Serial.printf("[TaskManager] Failed to create task '%s'\n", config.name);
         return NULL;
     }
+    tasks[taskCount] = taskHandle;
+    stackSizes[taskCount] = config.stackSize;
+    staticTasks[taskCount] = isStatic;
+    taskCount++;
+    Serial.printf("[TaskManager] Created task '%s' (%u bytes %s stack, count: %d)\n",
+                  config.name, (unsigned)config.stackSize, isStatic ? "static" : "heap", taskCount);
+    return taskHandle;
+}
+
+TaskHandle_t TaskManager::createPeriodicTask(const TaskConfig& config, JobFunction job, void* parameter, uint32_t periodMs) {
+    Job spec;
+    spec.function = job;
+    spec.parameter = parameter;
+    spec.ticks = pdMS_TO_TICKS(periodMs) ? pdMS_TO_TICKS(periodMs) : 1;
+    spec.eventDriven = false;
+    return createJobTask(config, spec);
+}
+
+TaskHandle_t TaskManager::createEventTask(const TaskConfig& config, JobFunction job, void* parameter, uint32_t timeoutMs) {
+    Job spec;
+    spec.function = job;
+    spec.parameter = parameter;
+    spec.ticks = timeoutMs ? pdMS_TO_TICKS(timeoutMs) : portMAX_DELAY;
+    spec.eventDriven = true;
+    return createJobTask(config, spec);
+}
+
+TaskHandle_t TaskManager::createJobTask(const TaskConfig& config, const Job& job) {
+    if (jobCount >= MAX_TASKS) {
+        Serial.printf("[TaskManager] Error: Maximum job count (%d) reached\n", MAX_TASKS);
+        return NULL;
+    }
+    Job* slot = &jobs[jobCount];
+    *slot = job;
+    TaskHandle_t handle = createTask(config, jobTrampoline, slot);
+    if (handle != NULL) {
+        slot->handle = handle;
+        jobCount++;
+    }
+    return handle;
+}
+
+TaskManager::Job* IRAM_ATTR TaskManager::findJob(TaskHandle_t taskHandle) {
+    for (uint32_t i = 0; i < jobCount; i++) {
+        if (jobs[i].handle == taskHandle) {
+            return &jobs[i];
+        }
+    }
+    return nullptr;
+}
+
+void TaskManager::recordRun(Job* job, uint32_t latencyUs, bool hasLatency, uint32_t runUs) {
+    job->runs++;
+    if (hasLatency) {
+        job->lastLatencyUs = latencyUs;
+        job->avgLatencyUs = job->avgLatencyUs - job->avgLatencyUs / 16 + latencyUs / 16;
+        if (latencyUs > job->maxLatencyUs) job->maxLatencyUs = latencyUs;
+    }
+    job->avgRunUs = job->avgRunUs - job->avgRunUs / 16 + runUs / 16;
+    if (runUs > job->maxRunUs) job->maxRunUs = runUs;
+}
+
+void TaskManager::jobTrampoline(void* parameter) {
+    Job* job = static_cast<Job*>(parameter);
+    const uint32_t tickUs = portTICK_PERIOD_MS * 1000;
+
+    // Start on a tick boundary so release times can be converted to microseconds
+    vTaskDelay(1);
+    TickType_t lastWake = xTaskGetTickCount();
+    TickType_t anchorTick = lastWake;
+    uint32_t anchorUs = (uint32_t)esp_timer_get_time();
+
+    while (true) {
+        uint32_t latencyUs = 0;
+        bool hasLatency = false;
+
+        if (job->eventDriven) {
+            ulTaskNotifyTake(pdTRUE, job->ticks);
+            uint32_t notifiedAt = job->notifiedAtUs;
+            job->notifiedAtUs = 0;
+            if (notifiedAt) {
+                latencyUs = (uint32_t)esp_timer_get_time() - notifiedAt;
+                hasLatency = true;
+            }
+        } else {
+            vTaskDelayUntil(&lastWake, job->ticks);
+            uint32_t nowUs = (uint32_t)esp_timer_get_time();
+            // After an overrun, re-anchor instead of firing back-to-back catch-up runs
+            TickType_t now = xTaskGetTickCount();
+            if (now - lastWake >= job->ticks) {
+                lastWake = now;
+                anchorTick = now;
+                anchorUs = nowUs;
+            } else {
+                latencyUs = nowUs - (anchorUs + (lastWake - anchorTick) * tickUs);
+                hasLatency = (int32_t)latencyUs >= 0;
+            }
+        }
+
+        uint32_t startUs = (uint32_t)esp_timer_get_time();
+        job->function(job->parameter);
+        recordRun(job, latencyUs, hasLatency, (uint32_t)esp_timer_get_time() - startUs);
+    }
+}
+
+uint32_t TaskManager::getTaskStats(TaskStats* out, uint32_t maxCount) const {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < taskCount && count < maxCount; i++) {
+        if (tasks[i] == NULL) continue;
+        TaskStats& st = out[count++];
+        memset(&st, 0, sizeof(st));
+        st.name = pcTaskGetName(tasks[i]);
+        st.stackSize = stackSizes[i];
+        st.stackHighWaterMark = uxTaskGetStackHighWaterMark(tasks[i]);
+        st.staticMemory = staticTasks[i];
+        const Job* job = findJob(tasks[i]);
+        if (job) {
+            st.isJob = true;
+            st.runs = job->runs;
+            st.lastLatencyUs = job->lastLatencyUs;
+            st.avgLatencyUs = job->avgLatencyUs;
+            st.maxLatencyUs = job->maxLatencyUs;
+            st.avgRunUs = job->avgRunUs;
+            st.maxRunUs = job->maxRunUs;
+        }
+    }
+    return count;
+}
+
+void TaskManager::resetTaskStats() {
+    for (uint32_t i = 0; i < jobCount; i++) {
+        jobs[i].runs = 0;
+        jobs[i].maxLatencyUs = 0;
+        jobs[i].maxRunUs = 0;
+    }
+}
+
+void TaskManager::notify(TaskHandle_t taskHandle) {
+    if (taskHandle == NULL) return;
+    Job* job = findJob(taskHandle);
+    if (job && job->notifiedAtUs == 0) {
+        job->notifiedAtUs = (uint32_t)esp_timer_get_time() | 1;
+    }
+    xTaskNotifyGive(taskHandle);
+}
+
+void IRAM_ATTR TaskManager::notifyFromISR(TaskHandle_t taskHandle) {
+    if (taskHandle == NULL) return;
+    Job* job = findJob(taskHandle);
+    if (job && job->notifiedAtUs == 0) {
+        job->notifiedAtUs = (uint32_t)esp_timer_get_time() | 1;
+    }
+    BaseType_t higherPriorityWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(taskHandle, &higherPriorityWoken);
+    if (higherPriorityWoken) {
+        portYIELD_FROM_ISR();
+    }
 }
 
 void TaskManager::deleteTask(TaskHandle_t taskHandle) {
@@ -61,6 +235,8 @@ void TaskManager::deleteTask(TaskHandle_t taskHandle) {
             // Shift remaining tasks down
             for (uint32_t j = i; j < taskCount - 1; j++) {
                 tasks[j] = tasks[j + 1];
+                stackSizes[j] = stackSizes[j + 1];
+                staticTasks[j] = staticTasks[j + 1];
             }
             tasks[taskCount - 1] = NULL;
             taskCount--;
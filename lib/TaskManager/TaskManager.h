@@ -6,11 +6,76 @@
 #include <freertos/semphr.h>
 #include <functional>
 
+/**
+ * @brief Placement and sizing of a task
+ *
+ * With stackBuffer and taskBuffer set (see TaskStack) the task lives in
+ * them; otherwise its stack and control block come from the heap.
+ */
+struct TaskConfig {
+    const char* name;       ///< Task name for debugging
+    uint32_t stackSize;     ///< Stack size in bytes
+    UBaseType_t priority;   ///< Task priority (0-configMAX_PRIORITIES-1)
+    BaseType_t coreId;      ///< CPU core to pin task to (0, 1, or tskNO_AFFINITY)
+    StackType_t* stackBuffer;   ///< Static stack of stackSize bytes, nullptr for a heap stack
+    StaticTask_t* taskBuffer;   ///< Static task control block, nullptr for a heap one
+};
+
+/**
+ * @brief Statically allocated stack and control block of one task
+ * @tparam StackBytes Stack size in bytes
+ *
+ * Define one per task at namespace scope (or as a member of the owning
+ * object) so the memory is placed at link time and never fragments the heap.
+ * The task must not be deleted while the memory is reused.
+ */
+template <uint32_t StackBytes>
+struct TaskStack {
+    alignas(16) StackType_t stack[StackBytes / sizeof(StackType_t)];
+    StaticTask_t tcb;
+
+    /**
+     * @brief Config of a task running in this memory
+     * @param name Task name for debugging
+     * @param priority Task priority
+     * @param coreId CPU core to pin the task to
+     */
+    TaskConfig config(const char* name, UBaseType_t priority, BaseType_t coreId) {
+        return {name, StackBytes, priority, coreId, stack, &tcb};
+    }
+};
+
+/**
+ * @brief Runtime statistics of a managed task
+ *
+ * Latency is how late a job started: for periodic jobs relative to its
+ * scheduled release, for event jobs relative to the notify() call. Raw tasks
+ * created with createTask() only report their stack.
+ */
+struct TaskStats {
+    const char* name;               ///< Task name
+    uint32_t stackSize;             ///< Stack size in bytes
+    uint32_t stackHighWaterMark;    ///< Minimum free stack since start, in bytes
+    bool staticMemory;              ///< Stack and control block are static (TaskStack)
+    bool isJob;                     ///< Scheduled job (the fields below are valid)
+    uint32_t runs;                  ///< Job iterations since the last reset
+    uint32_t lastLatencyUs;         ///< Latency of the most recent run
+    uint32_t avgLatencyUs;          ///< Moving average latency (1/16 weight per run)
+    uint32_t maxLatencyUs;          ///< Worst latency since the last reset
+    uint32_t avgRunUs;              ///< Moving average job run time
+    uint32_t maxRunUs;              ///< Worst job run time since the last reset
+};
+
 /**
  * @brief Manages FreeRTOS tasks and inter-task communication
  * 
  * This class provides a centralized way to create, manage, and coordinate
  * FreeRTOS tasks with proper synchronization primitives.
+ *
+ * Besides raw tasks it runs scheduled jobs: a job is a function that performs
+ * one iteration of work and returns. Periodic jobs are released on a fixed
+ * grid with vTaskDelayUntil (no drift from the job's own run time); event
+ * jobs sleep until another task calls notify() or an optional timeout expires.
  */
 class TaskManager {
 public:
@@ -18,6 +83,11 @@ public:
      * @brief Task function signature
      */
     using TaskFunction = void (*)(void*);
+
+    /**
+     * @brief Job function signature (one iteration, must return)
+     */
+    using JobFunction = void (*)(void*);
     
     /**
      * @brief Construct a new Task Manager
@@ -48,6 +118,52 @@ public:
         BaseType_t coreId
     );
     
+    /**
+     * @brief Create a new FreeRTOS task from a config
+     * @param config Name, stack (heap or static), priority and core of the task
+     * @param taskFunction Function to execute in task
+     * @param parameter Parameter to pass to task function
+     * @return TaskHandle_t Handle to created task, NULL on failure
+     */
+    TaskHandle_t createTask(const TaskConfig& config, TaskFunction taskFunction, void* parameter);
+
+    /**
+     * @brief Run a job at a fixed period
+     * @param config Name, stack, priority and core of the task
+     * @param job Function called once per period
+     * @param parameter Parameter to pass to the job
+     * @param periodMs Period in milliseconds
+     * @return TaskHandle_t Handle to created task, NULL on failure
+     *
+     * If a run overruns its period the next one starts immediately; missed
+     * periods are not replayed.
+     */
+    TaskHandle_t createPeriodicTask(const TaskConfig& config, JobFunction job, void* parameter, uint32_t periodMs);
+
+    /**
+     * @brief Run a job whenever the task is notified
+     * @param config Name, stack, priority and core of the task
+     * @param job Function called once per wake-up
+     * @param parameter Parameter to pass to the job
+     * @param timeoutMs Also run the job after this long without a notification (0 = wait forever)
+     * @return TaskHandle_t Handle to created task, NULL on failure
+     *
+     * Notifications that arrive while the job runs are coalesced into one more run.
+     */
+    TaskHandle_t createEventTask(const TaskConfig& config, JobFunction job, void* parameter, uint32_t timeoutMs = 0);
+
+    /**
+     * @brief Wake an event task
+     * @param taskHandle Task to notify (ignored if NULL)
+     */
+    static void notify(TaskHandle_t taskHandle);
+
+    /**
+     * @brief Wake an event task from an interrupt handler
+     * @param taskHandle Task to notify (ignored if NULL)
+     */
+    static void IRAM_ATTR notifyFromISR(TaskHandle_t taskHandle);
+
     /**
      * @brief Delete a task
      * @param taskHandle Handle to task to delete
@@ -86,9 +202,73 @@ public:
      */
     uint32_t getTaskCount() const { return taskCount; }
 
+    /**
+     * @brief Collect stack and timing statistics of all tracked tasks
+     * @param out Output array
+     * @param maxCount Capacity of out
+     * @return uint32_t Number of entries written
+     */
+    uint32_t getTaskStats(TaskStats* out, uint32_t maxCount) const;
+
+    /**
+     * @brief Clear run counts and worst-case latency/run time of all jobs
+     */
+    void resetTaskStats();
+
 private:
+    /**
+     * @brief Scheduling parameters of a job task
+     */
+    struct Job {
+        JobFunction function = nullptr;
+        void* parameter = nullptr;
+        TickType_t ticks = 0;       ///< Period, or notification timeout
+        bool eventDriven = false;
+        TaskHandle_t handle = NULL; ///< Task running the job
+
+        // Statistics; written by the job's task (notifiedAtUs by notify())
+        volatile uint32_t notifiedAtUs = 0;  ///< Time of the first pending notification, 0 if none
+        uint32_t runs = 0;
+        uint32_t lastLatencyUs = 0;
+        uint32_t avgLatencyUs = 0;
+        uint32_t maxLatencyUs = 0;
+        uint32_t avgRunUs = 0;
+        uint32_t maxRunUs = 0;
+    };
+
+    /**
+     * @brief Task body shared by all job tasks
+     * @param parameter Pointer to the task's Job slot
+     */
+    static void jobTrampoline(void* parameter);
+
+    /**
+     * @brief Update a job's statistics after one run
+     */
+    static void recordRun(Job* job, uint32_t latencyUs, bool hasLatency, uint32_t runUs);
+
+    /**
+     * @brief Find the job run by a task
+     * @return Job* Job, nullptr for raw tasks
+     */
+    static Job* findJob(TaskHandle_t taskHandle);
+
+    /**
+     * @brief Reserve a job slot and start its task
+     */
+    TaskHandle_t createJobTask(const TaskConfig& config, const Job& job);
+
+    /**
+     * @brief Create a task and track it
+     */
+    TaskHandle_t startTask(const TaskConfig& config, TaskFunction taskFunction, void* parameter);
+
     uint32_t taskCount = 0;  ///< Number of tasks created
     
-    static const uint32_t MAX_TASKS = 10;  ///< Maximum number of tasks
+    static const uint32_t MAX_TASKS = 12;  ///< Maximum number of tasks
     TaskHandle_t tasks[MAX_TASKS];  ///< Array of task handles
+    uint32_t stackSizes[MAX_TASKS]; ///< Stack size of each tracked task
+    bool staticTasks[MAX_TASKS];    ///< Task runs in a TaskStack
+    static Job jobs[MAX_TASKS];     ///< Job parameters, never freed (tasks hold a pointer)
+    static uint32_t jobCount;       ///< Number of job slots used
 };
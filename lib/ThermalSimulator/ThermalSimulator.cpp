@@ -0,0 +1,70 @@
+#include "ThermalSimulator.h"
+#include <esp_timer.h>
+#include <math.h>
+
+ThermalSimulator::ThermalSimulator(float ambient, float gain, float plateTauS, float elementTauS, float noise)
+    : ambient(ambient), gain(gain), plateTauS(plateTauS), elementTauS(elementTauS), noise(noise),
+      element(ambient), plate(ambient) {}
+
+bool ThermalSimulator::begin() {
+    lastSampleUs = (uint32_t)esp_timer_get_time();
+    return true;
+}
+
+void ThermalSimulator::reset(float temperature) {
+    element = temperature;
+    plate = temperature;
+}
+
+void ThermalSimulator::step(float dtS, bool heating) {
+    // Exact discretization of each first-order node over dtS
+    float target = ambient + (heating ? gain : 0.0f);
+    element += (target - element) * (1.0f - expf(-dtS / elementTauS));
+    plate += (element - plate) * (1.0f - expf(-dtS / plateTauS));
+}
+
+float ThermalSimulator::reading() {
+    // xorshift32: cheap and reproducible
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    float uniform = (rng >> 8) * (1.0f / 16777216.0f);
+    return plate + (2.0f * uniform - 1.0f) * noise;
+}
+
+ITemperatureSensor::Batch ThermalSimulator::poll(uint8_t channel, Sample* samples, size_t maxSamples) {
+    Batch batch;
+    if (channel != 0) return batch;
+
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    bool heating = heaterInput && heaterInput();
+    size_t limit = maxSamples < MAX_CATCH_UP ? maxSamples : MAX_CATCH_UP;
+    // After a long pause, jump over the gap instead of simulating every sample in it
+    uint32_t behindUs = now - lastSampleUs;
+    if (behindUs > MAX_CATCH_UP * SAMPLE_PERIOD_US) {
+        uint32_t skipUs = behindUs - MAX_CATCH_UP * SAMPLE_PERIOD_US;
+        step(skipUs / 1e6f, heating);
+        lastSampleUs += skipUs;
+        dropped += skipUs / SAMPLE_PERIOD_US;
+    }
+    while (now - lastSampleUs >= SAMPLE_PERIOD_US) {
+        lastSampleUs += SAMPLE_PERIOD_US;
+        step(SAMPLE_PERIOD_US / 1e6f, heating);
+        if (batch.count < limit) {
+            samples[batch.count].timestampUs = lastSampleUs;
+            samples[batch.count].temperature = reading();
+            batch.count++;
+        } else {
+            dropped++;
+        }
+    }
+    batch.dropped = dropped;
+    batch.status = batch.count ? OK : NO_DATA;
+    return batch;
+}
+
+float ThermalSimulator::readTemperature() {
+    Sample samples[MAX_CATCH_UP];
+    poll(0, samples, MAX_CATCH_UP);
+    return reading();
+}
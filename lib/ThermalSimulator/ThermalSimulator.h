@@ -0,0 +1,100 @@
+#pragma once
+#include "hardware/ITemperatureSensor.h"
+#include <Arduino.h>
+
+/**
+ * @brief Simulated hot plate behind the ITemperatureSensor interface
+ *
+ * A two-node thermal model: the heating element follows the relay with
+ * its own time constant, and the plate (where the RTD sits) follows the
+ * element. This gives the lag a real plate shows, which a single first
+ * order model would hide. Readings carry a little uniform noise.
+ *
+ * The plant advances either with the clock (poll() produces one sample
+ * per SAMPLE_PERIOD_US since the previous call, like a DRDY-driven RTD)
+ * or explicitly through step(), which benchmarks use to get a
+ * reproducible trace.
+ *
+ * The relay state comes from a function (usually the heater's
+ * isRelayOn()), so the GPIO itself needs nothing attached.
+ */
+class ThermalSimulator : public ITemperatureSensor {
+public:
+    using HeaterInput = bool (*)();
+
+    static constexpr uint32_t SAMPLE_PERIOD_US = 20000;  ///< One sample per 50 Hz conversion
+    static constexpr size_t MAX_CATCH_UP = 64;          ///< Samples generated at most per poll()
+
+    /**
+     * @brief Construct a plant at ambient temperature
+     * @param ambient Ambient temperature (C)
+     * @param gain Plate rise above ambient at full power (C)
+     * @param plateTauS Plate time constant (s)
+     * @param elementTauS Heating element time constant (s)
+     * @param noise Peak reading noise (C)
+     */
+    ThermalSimulator(float ambient, float gain, float plateTauS, float elementTauS, float noise);
+
+    /**
+     * @brief Set where the relay state is read from
+     * @param input Returns true while the heater is on (nullptr: always off)
+     */
+    void attachHeater(HeaterInput input) { heaterInput = input; }
+
+    /**
+     * @brief Start the clock at the current time
+     * @return true
+     */
+    bool begin() override;
+
+    /**
+     * @brief Advance the plant to now and return the samples due since the previous call
+     * @param channel Must be 0
+     * @param samples Receives the samples
+     * @param maxSamples Capacity of samples
+     * @return Batch OK, NO_DATA between samples, UNAVAILABLE for other channels
+     */
+    Batch poll(uint8_t channel, Sample *samples, size_t maxSamples) override;
+
+    /**
+     * @brief No faults are simulated
+     */
+    void clearFault(uint8_t channel) override {}
+
+    /**
+     * @brief Advance the clock and return the latest reading
+     */
+    float readTemperature() override;
+
+    /**
+     * @brief Advance the plant by a fixed time (independent of the clock)
+     * @param dtS Seconds to advance
+     * @param heating Relay state during the step
+     */
+    void step(float dtS, bool heating);
+
+    /**
+     * @brief Current plate temperature with reading noise
+     */
+    float reading();
+
+    /**
+     * @brief Put both nodes at a temperature
+     * @param temperature Degrees Celsius
+     */
+    void reset(float temperature);
+
+private:
+    float ambient;
+    float gain;
+    float plateTauS;
+    float elementTauS;
+    float noise;
+
+    float element;                      ///< Element temperature (C)
+    float plate;                        ///< Plate temperature (C)
+    uint32_t lastSampleUs = 0;
+    uint32_t dropped = 0;               ///< Samples not handed out (poll() buffer full or a pause)
+    uint32_t rng = 0x2545F491;
+    HeaterInput heaterInput = nullptr;
+};
@@ -0,0 +1,111 @@
+Import("env")
+import gzip
+import hashlib
+import json
+import os
+import re
+import shutil
+
+# Builds the LittleFS image contents from data/ into .pio/data:
+# - compressible assets are stored only as <name>.gz (served with Content-Encoding: gzip)
+# - local references in HTML/CSS get ?v=<hash> so the server can mark them immutable
+# - assets.json maps every served path to its ETag (hash of the stored bytes) and encoding
+
+print("[build_assets.py] Script loaded")
+
+PROJECT_DIR = env.subst("$PROJECT_DIR")
+SOURCE_DIR = os.path.join(PROJECT_DIR, "data")
+OUTPUT_DIR = env.subst("$PROJECT_DATA_DIR")
+MANIFEST_NAME = "assets.json"
+
+COMPRESSIBLE = {".html", ".htm", ".js", ".css", ".json", ".svg", ".ttf", ".otf", ".ico", ".txt", ".map"}
+REWRITTEN = {".html", ".htm", ".css"}
+
+# src="..." / href="..." in HTML, url(...) in CSS; only relative, local references
+REFERENCE = re.compile(r'''(?P<pre>(?:src|href)\s*=\s*["']|url\(\s*["']?)(?P<ref>[^"')?#:]+)(?P<post>["')])''')
+
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:16]
+
+
+def served_path(rel):
+    return "/" + rel.replace(os.sep, "/")
+
+
+def resolve(base_rel, ref):
+    if ref.startswith("/"):
+        return ref
+    base = os.path.dirname(base_rel)
+    return served_path(os.path.normpath(os.path.join(base, ref)))
+
+
+def rewrite_references(rel, text, hashes):
+    def replace(match):
+        target = resolve(rel, match.group("ref"))
+        if target not in hashes:
+            return match.group(0)
+        return match.group("pre") + match.group("ref") + "?v=" + hashes[target] + match.group("post")
+    return REFERENCE.sub(replace, text)
+
+
+def build_assets(*args, **kwargs):
+    if not os.path.isdir(SOURCE_DIR):
+        print("[build_assets.py] No data/ directory, nothing to do")
+        return
+    if os.path.abspath(OUTPUT_DIR) == os.path.abspath(SOURCE_DIR):
+        print("[build_assets.py] data_dir must not be data/ (sources would be overwritten)")
+        env.Exit(1)
+
+    shutil.rmtree(OUTPUT_DIR, ignore_errors=True)
+
+    sources = []
+    for root, _, files in os.walk(SOURCE_DIR):
+        for name in sorted(files):
+            sources.append(os.path.relpath(os.path.join(root, name), SOURCE_DIR))
+
+    # Referenced files first, so their hashes are known when HTML/CSS is rewritten.
+    # CSS is rewritten before HTML because HTML references CSS.
+    order = {".html": 2, ".htm": 2, ".css": 1}
+    sources.sort(key=lambda rel: (order.get(os.path.splitext(rel)[1].lower(), 0), rel))
+
+    hashes = {}
+    manifest = {}
+    total_in = total_out = 0
+    for rel in sources:
+        ext = os.path.splitext(rel)[1].lower()
+        with open(os.path.join(SOURCE_DIR, rel), "rb") as f:
+            data = f.read()
+        total_in += len(data)
+
+        if ext in REWRITTEN:
+            data = rewrite_references(rel, data.decode("utf-8"), hashes).encode("utf-8")
+
+        stored = data
+        gz = False
+        if ext in COMPRESSIBLE:
+            # mtime=0 keeps the output (and so the ETag) reproducible
+            compressed = gzip.compress(data, compresslevel=9, mtime=0)
+            if len(compressed) < len(data):
+                stored = compressed
+                gz = True
+
+        out_path = os.path.join(OUTPUT_DIR, rel + (".gz" if gz else ""))
+        os.makedirs(os.path.dirname(out_path), exist_ok=True)
+        with open(out_path, "wb") as f:
+            f.write(stored)
+        total_out += len(stored)
+
+        path = served_path(rel)
+        hashes[path] = content_hash(stored)
+        manifest[path] = {"etag": hashes[path], "gz": gz}
+
+    with open(os.path.join(OUTPUT_DIR, MANIFEST_NAME), "w") as f:
+        json.dump(manifest, f, separators=(",", ":"), sort_keys=True)
+
+    print("[build_assets.py] %d assets, %d -> %d bytes" % (len(manifest), total_in, total_out))
+
+
+# Regenerate whenever a filesystem image is built or uploaded
+if any(target in ("buildfs", "uploadfs", "uploadfsota") for target in COMMAND_LINE_TARGETS):
+    build_assets()
@@ -0,0 +1,335 @@
+#!/usr/bin/env python3
+"""Load generator for the SmartPlate web server.
+
+Opens N WebSocket clients against /ws, each replaying a weighted mix of
+controlUpdate / getHistory / notepadSave requests (one outstanding request
+per client, exponential think time), while HTTP workers pull the static
+assets listed in /assets.json and a monitor polls /metrics.
+
+Reported per run:
+- request latency percentiles per action (send -> ack / last chunk / notepadSaved),
+  errors and timeouts
+- telemetry frames received and dropped (gaps in the binary frame sequence),
+  disconnects and failed connects
+- HTTP latency percentiles and failures
+- device side: free heap, largest free block, WebSocket queue depth,
+  allocation failures (from /metrics)
+
+It changes the plate's setpoint and writes notes named loadtest-<n>: run
+it against a bench board (pio run -e bench), not a plate in use.
+
+Requires aiohttp (pip install aiohttp).
+
+    scripts/loadtest.py 192.168.1.9 --clients 8 --duration 120 --json run.json
+"""
+import argparse
+import asyncio
+import json
+import random
+import struct
+import sys
+import time
+
+try:
+    import aiohttp
+except ImportError:
+    sys.exit("loadtest.py needs aiohttp: pip install aiohttp")
+
+# Telemetry::Frame header: magic, version, dirtyMask, sequence (little-endian)
+FRAME_HEADER = struct.Struct("<BBHI")
+FRAME_MAGIC = 0xA5          # Telemetry::FRAME_MAGIC
+DEFAULT_ASSETS = ["/", "/js/dashboard.js", "/js/chart.min.js", "/js/jquery.min.js", "/css/adminlte.min.css"]
+
+
+def percentile(values, p):
+    """Nearest-rank percentile of a list (None if empty)."""
+    if not values:
+        return None
+    ordered = sorted(values)
+    rank = max(0, min(len(ordered) - 1, int(round(p / 100.0 * len(ordered) + 0.5)) - 1))
+    return ordered[rank]
+
+
+def summarize(values):
+    return {
+        "count": len(values),
+        "p50": percentile(values, 50),
+        "p90": percentile(values, 90),
+        "p99": percentile(values, 99),
+        "max": max(values) if values else None,
+    }
+
+
+def parse_mix(text):
+    mix = {}
+    for part in text.split(","):
+        name, _, weight = part.partition("=")
+        mix[name.strip()] = float(weight or 1)
+    unknown = set(mix) - set(REQUESTS)
+    if unknown:
+        raise argparse.ArgumentTypeError("unknown actions: %s" % ", ".join(sorted(unknown)))
+    return mix
+
+
+class Stats:
+    def __init__(self):
+        self.latency = {}           # action -> [ms]
+        self.errors = {}            # action -> count
+        self.timeouts = {}          # action -> count
+        self.frames = 0
+        self.json_updates = 0
+        self.dropped_frames = 0
+        self.connects = 0
+        self.connect_failures = 0
+        self.disconnects = 0
+        self.connect_ms = []
+        self.http_ms = []
+        self.http_failures = 0
+        self.http_bytes = 0
+        self.metrics = []           # one dict per /metrics poll
+
+    def count(self, table, action):
+        table[action] = table.get(action, 0) + 1
+
+
+# Each request: message builder and the predicate that recognizes its reply
+def control_update(client):
+    return {"action": "controlUpdate", "data": {"temp_setpoint": round(random.uniform(25.0, 30.0), 1)}}
+
+
+def get_history(client):
+    return {"action": "getHistory"}
+
+
+def notepad_save(client):
+    notes = "".join(random.choice("abcdefghij klmnop\n") for _ in range(client.args.note_size))
+    return {"action": "notepadSave", "data": {"experiment": "loadtest-%d" % client.index, "notes": notes, "offset": 0, "last": True}}
+
+
+REQUESTS = {
+    "controlUpdate": (control_update, lambda m: m.get("type") == "ack" and m.get("message") == "Update received"),
+    "getHistory": (get_history, lambda m: m.get("type") == "history" and m.get("last")),
+    "notepadSave": (notepad_save, lambda m: m.get("type") == "notepadSaved"),
+}
+
+
+class Client:
+    """One simulated tablet: a reader and a closed-loop request worker."""
+
+    def __init__(self, index, args, session, stats, deadline):
+        self.index = index
+        self.args = args
+        self.session = session
+        self.stats = stats
+        self.deadline = deadline
+        self.pending = None         # (predicate, future) of the outstanding request
+        self.last_sequence = None
+
+    async def run(self):
+        url = "ws://%s/ws" % self.args.host
+        while time.monotonic() < self.deadline:
+            start = time.monotonic()
+            try:
+                async with self.session.ws_connect(url, heartbeat=None, timeout=self.args.timeout) as ws:
+                    self.stats.connects += 1
+                    self.stats.connect_ms.append((time.monotonic() - start) * 1000.0)
+                    self.last_sequence = None
+                    if self.args.format == "binary":
+                        await ws.send_json({"action": "telemetryFormat", "data": {"format": "binary"}})
+                    reader = asyncio.ensure_future(self.read(ws))
+                    await self.work(ws, reader)
+                    if not reader.done():
+                        reader.cancel()
+                        return
+                    self.stats.disconnects += 1
+            except (aiohttp.ClientError, asyncio.TimeoutError, OSError):
+                self.stats.connect_failures += 1
+            await asyncio.sleep(1.0)
+
+    async def read(self, ws):
+        async for msg in ws:
+            if msg.type == aiohttp.WSMsgType.BINARY:
+                self.on_frame(msg.data)
+            elif msg.type == aiohttp.WSMsgType.TEXT:
+                try:
+                    self.on_message(json.loads(msg.data))
+                except ValueError:
+                    pass
+            elif msg.type in (aiohttp.WSMsgType.CLOSE, aiohttp.WSMsgType.ERROR):
+                break
+
+    def on_frame(self, data):
+        if len(data) < FRAME_HEADER.size:
+            return
+        magic, _, _, sequence = FRAME_HEADER.unpack_from(data)
+        if magic != FRAME_MAGIC:
+            return
+        self.stats.frames += 1
+        # The sequence counts every frame encoded; a gap is a frame this client was not sent
+        if self.last_sequence is not None and sequence > self.last_sequence + 1:
+            self.stats.dropped_frames += sequence - self.last_sequence - 1
+        self.last_sequence = sequence
+
+    def on_message(self, message):
+        if message.get("type") == "dataUpdate":
+            self.stats.json_updates += 1
+            return
+        if not self.pending:
+            return
+        predicate, future = self.pending
+        if message.get("type") == "error":
+            future.set_result(False)
+        elif predicate(message):
+            future.set_result(True)
+
+    async def work(self, ws, reader):
+        actions = list(self.args.mix)
+        weights = [self.args.mix[a] for a in actions]
+        while time.monotonic() < self.deadline and not reader.done():
+            await asyncio.sleep(random.expovariate(1.0 / self.args.think))
+            action = random.choices(actions, weights)[0]
+            build, predicate = REQUESTS[action]
+            future = asyncio.get_event_loop().create_future()
+            self.pending = (predicate, future)
+            start = time.monotonic()
+            try:
+                await ws.send_json(build(self))
+                ok = await asyncio.wait_for(asyncio.shield(future), self.args.timeout)
+                if ok:
+                    self.stats.latency.setdefault(action, []).append((time.monotonic() - start) * 1000.0)
+                else:
+                    self.stats.count(self.stats.errors, action)
+            except asyncio.TimeoutError:
+                self.stats.count(self.stats.timeouts, action)
+            except (aiohttp.ClientError, ConnectionError):
+                break
+            finally:
+                self.pending = None
+
+
+async def fetch_assets(session, args):
+    try:
+        async with session.get("http://%s/assets.json" % args.host) as response:
+            manifest = await response.json(content_type=None)
+            return sorted(manifest) or DEFAULT_ASSETS
+    except (aiohttp.ClientError, asyncio.TimeoutError, ValueError):
+        return DEFAULT_ASSETS
+
+
+async def http_worker(session, args, stats, assets, deadline):
+    while time.monotonic() < deadline:
+        path = random.choice(assets)
+        start = time.monotonic()
+        try:
+            async with session.get("http://%s%s" % (args.host, path)) as response:
+                body = await response.read()
+                if response.status != 200:
+                    stats.http_failures += 1
+                    continue
+                stats.http_bytes += len(body)
+                stats.http_ms.append((time.monotonic() - start) * 1000.0)
+        except (aiohttp.ClientError, asyncio.TimeoutError):
+            stats.http_failures += 1
+        await asyncio.sleep(random.expovariate(1.0 / args.http_think))
+
+
+async def monitor(session, args, stats, deadline, started):
+    while time.monotonic() < deadline:
+        try:
+            async with session.get("http://%s/metrics" % args.host) as response:
+                m = await response.json(content_type=None)
+            clients = m.get("clients", [])
+            stats.metrics.append({
+                "t": round(time.monotonic() - started, 1),
+                "freeHeap": m["heap"]["free"],
+                "minFreeHeap": m["heap"]["minFree"],
+                "largestBlock": m["heap"]["maxAlloc"],
+                "fragmentation": m["heap"].get("fragmentation"),
+                "wsClients": len(clients),
+                "wsQueued": m.get("wsQueued", 0),
+                "maxClientQueue": max([c.get("queueLen", 0) for c in clients] or [0]),
+                "wsAllocFailures": m.get("wsAllocFailures", 0),
+                "logDropped": m.get("logDropped", 0),
+            })
+        except (aiohttp.ClientError, asyncio.TimeoutError, ValueError, KeyError):
+            stats.metrics.append({"t": round(time.monotonic() - started, 1), "unreachable": True})
+        await asyncio.sleep(args.metrics_interval)
+
+
+def report(args, stats, elapsed):
+    def ms(value):
+        return "%8.1f" % value if value is not None else "       -"
+
+    print("\n%d WebSocket clients, %d HTTP workers, %.0f s (%s telemetry)" % (args.clients, args.http, elapsed, args.format))
+    print("%-14s %7s %6s %8s %8s %8s %8s %8s" % ("request", "ok", "err", "timeout", "p50 ms", "p90 ms", "p99 ms", "max ms"))
+    for action in args.mix:
+        s = summarize(stats.latency.get(action, []))
+        print("%-14s %7d %6d %8d %s %s %s %s" % (action, s["count"], stats.errors.get(action, 0), stats.timeouts.get(action, 0),
+                                                 ms(s["p50"]), ms(s["p90"]), ms(s["p99"]), ms(s["max"])))
+    h = summarize(stats.http_ms)
+    print("%-14s %7d %6d %8s %s %s %s %s" % ("http", h["count"], stats.http_failures, "-", ms(h["p50"]), ms(h["p90"]), ms(h["p99"]), ms(h["max"])))
+
+    print("\ntelemetry: %d frames, %d dropped, %d JSON updates" % (stats.frames, stats.dropped_frames, stats.json_updates))
+    c = summarize(stats.connect_ms)
+    print("websocket: %d connects (p50 %s ms), %d failed, %d disconnects" % (stats.connects, ms(c["p50"]).strip(), stats.connect_failures, stats.disconnects))
+    print("http: %.1f kB transferred" % (stats.http_bytes / 1024.0))
+
+    samples = [m for m in stats.metrics if not m.get("unreachable")]
+    if samples:
+        print("device: free heap min %d, largest block min %d, fragmentation max %s%%, WS queue max %d (per client %d), alloc failures %d" % (
+            min(m["freeHeap"] for m in samples), min(m["largestBlock"] for m in samples),
+            max(m["fragmentation"] or 0 for m in samples), max(m["wsQueued"] for m in samples),
+            max(m["maxClientQueue"] for m in samples), samples[-1]["wsAllocFailures"] - samples[0]["wsAllocFailures"]))
+    unreachable = len(stats.metrics) - len(samples)
+    if unreachable:
+        print("device: /metrics unreachable %d of %d polls" % (unreachable, len(stats.metrics)))
+
+
+async def main(args):
+    stats = Stats()
+    started = time.monotonic()
+    deadline = started + args.duration
+    timeout = aiohttp.ClientTimeout(total=args.timeout)
+    # One connection per HTTP worker, like separate tablets; WebSockets get their own
+    connector = aiohttp.TCPConnector(limit=0, force_close=args.no_keepalive)
+    async with aiohttp.ClientSession(timeout=timeout, connector=connector) as session:
+        assets = await fetch_assets(session, args)
+        tasks = [Client(i, args, session, stats, deadline).run() for i in range(args.clients)]
+        tasks += [http_worker(session, args, stats, assets, deadline) for _ in range(args.http)]
+        tasks.append(monitor(session, args, stats, deadline, started))
+        await asyncio.gather(*tasks)
+    elapsed = time.monotonic() - started
+
+    report(args, stats, elapsed)
+    if args.json:
+        result = {
+            "args": {k: v for k, v in vars(args).items() if k != "json"},
+            "elapsed": elapsed,
+            "requests": {a: dict(summarize(stats.latency.get(a, [])), errors=stats.errors.get(a, 0), timeouts=stats.timeouts.get(a, 0)) for a in args.mix},
+            "http": dict(summarize(stats.http_ms), failures=stats.http_failures, bytes=stats.http_bytes),
+            "telemetry": {"frames": stats.frames, "dropped": stats.dropped_frames, "jsonUpdates": stats.json_updates},
+            "websocket": dict(summarize(stats.connect_ms), connects=stats.connects, failures=stats.connect_failures, disconnects=stats.disconnects),
+            "device": stats.metrics,
+        }
+        with open(args.json, "w") as f:
+            json.dump(result, f, indent=2)
+        print("\nwrote %s" % args.json)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="SmartPlate WebSocket/HTTP load generator")
+    parser.add_argument("host", help="device address, e.g. 192.168.1.9")
+    parser.add_argument("--clients", type=int, default=6, help="WebSocket clients (default 6)")
+    parser.add_argument("--duration", type=float, default=60.0, help="run time in seconds (default 60)")
+    parser.add_argument("--mix", type=parse_mix, default=parse_mix("controlUpdate=6,getHistory=1,notepadSave=2"),
+                        help="request weights (default controlUpdate=6,getHistory=1,notepadSave=2)")
+    parser.add_argument("--think", type=float, default=2.0, help="mean seconds between requests per client (default 2)")
+    parser.add_argument("--format", choices=("binary", "json"), default="binary", help="telemetry format (default binary)")
+    parser.add_argument("--note-size", type=int, default=512, help="notepadSave payload bytes (default 512)")
+    parser.add_argument("--http", type=int, default=2, help="concurrent static asset fetchers (default 2)")
+    parser.add_argument("--http-think", type=float, default=1.0, help="mean seconds between asset fetches (default 1)")
+    parser.add_argument("--no-keepalive", action="store_true", help="new TCP connection per asset fetch")
+    parser.add_argument("--metrics-interval", type=float, default=2.0, help="seconds between /metrics polls (default 2)")
+    parser.add_argument("--timeout", type=float, default=5.0, help="request / connect timeout in seconds (default 5)")
+    parser.add_argument("--json", help="write the results (with the /metrics time series) to this file")
+    asyncio.run(main(parser.parse_args()))
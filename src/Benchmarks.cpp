@@ -0,0 +1,172 @@
+#ifdef SMARTPLATE_BENCH
+
+#include "utilities/Benchmarks.h"
+#include <ThermalSimulator.h>
+#include <esp_timer.h>
+#include "hardware/HeatingElement.h"
+#include "managers/HeaterModeManager.h"
+#include "managers/WebServerManager.h"
+#include "utilities/TemperatureFilters.h"
+#include "utilities/TelemetryFrame.h"
+#include "utilities/WsResponse.h"
+#include "utilities/SerialRemote.h"
+
+namespace
+{
+    constexpr uint32_t ITERATIONS = 2000;
+    constexpr size_t TRACE_LENGTH = 600;    ///< One minute of control steps
+
+    float trace[TRACE_LENGTH];
+
+    /**
+     * @brief Time op(i) for i in [0, iterations) and print cycles per call
+     */
+    template <typename Op>
+    void measure(const char *name, uint32_t iterations, Op op)
+    {
+        uint64_t total = 0;
+        uint32_t best = UINT32_MAX;
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            uint32_t start = ESP.getCycleCount();
+            op(i);
+            uint32_t cycles = ESP.getCycleCount() - start;
+            total += cycles;
+            if (cycles < best)
+                best = cycles;
+        }
+        uint32_t mean = (uint32_t)(total / iterations);
+        logMessagef(LogLevel::INFO, "[Bench] %-26s %8u cycles/op (min %u, %.2f us)",
+                    name, (unsigned)mean, (unsigned)best, mean / (float)ESP.getCpuFreqMHz());
+    }
+
+    /**
+     * @brief Sensor whose poll() status is set by the test
+     */
+    class ScriptedSensor : public ITemperatureSensor
+    {
+    public:
+        Status status = OK;
+        float temperature = SIM_AMBIENT_C;
+
+        bool begin() override { return true; }
+        Batch poll(uint8_t channel, Sample *samples, size_t maxSamples) override
+        {
+            Batch batch;
+            if (channel != 0)
+                return batch;
+            batch.status = status;
+            batch.faultCode = status == FAULT ? 0x80 : 0;   // RTD high threshold
+            if (status == OK && maxSamples)
+            {
+                samples[0].timestampUs = (uint32_t)esp_timer_get_time();
+                samples[0].temperature = temperature;
+                batch.count = 1;
+            }
+            return batch;
+        }
+        void clearFault(uint8_t channel) override {}
+        float readTemperature() override { return temperature; }
+    };
+}
+
+// Static: the heater and its filter are too large for the loop task stack
+static ThermalSimulator plant(SIM_AMBIENT_C, SIM_GAIN_C, SIM_PLATE_TAU_S, SIM_ELEMENT_TAU_S, SIM_NOISE_C);
+static TemperatureFilters::ConfiguredPipeline benchFilter;
+static HeatingElement benchHeater(RELAY_PIN, MAX_TEMP_LIMIT, &plant, &benchFilter);
+static HeaterModeManager benchModes(benchHeater);
+static ScriptedSensor scripted;
+static HeatingElement scriptedHeater(RELAY_PIN, MAX_TEMP_LIMIT, &scripted);
+
+/**
+ * @brief Heat on a good reading, switch the sensor to a failure and check the heater latched it
+ * @param name Case name
+ * @param status Status the sensor reports after the first reading
+ * @param waitMs Time the failure lasts before the next control step
+ */
+static void checkSensorFailure(const char *name, ITemperatureSensor::Status status, uint32_t waitMs)
+{
+    scripted.status = ITemperatureSensor::OK;
+    scriptedHeater.begin();
+    scriptedHeater.setTargetTemperature(SIM_AMBIENT_C + 20.0f, 0.5f);
+    scriptedHeater.start();
+    scriptedHeater.update();
+    bool heating = scriptedHeater.isRunningState() && !scriptedHeater.hasFault();
+
+    scripted.status = status;
+    delay(waitMs);
+    scriptedHeater.update();
+    bool latched = scriptedHeater.hasFault() && !scriptedHeater.isRunningState() && !scriptedHeater.isRelayOn() &&
+                   isnan(scriptedHeater.getCurrentTemperature());
+
+    // Good samples clear the fault; the heater stays off until started again
+    scripted.status = ITemperatureSensor::OK;
+    scriptedHeater.update();
+    bool recovered = !scriptedHeater.hasFault() && !scriptedHeater.isRunningState();
+
+    logMessagef(heating && latched && recovered ? LogLevel::INFO : LogLevel::ERROR,
+                "[Bench] %-26s %s (heating %d, latched %d, recovered %d)", name,
+                heating && latched && recovered ? "PASS" : "FAIL", heating, latched, recovered);
+}
+
+void Benchmarks::run(ControlCore &control)
+{
+    logMessagef(LogLevel::INFO, "[Bench] %u iterations per benchmark at %u MHz", (unsigned)ITERATIONS, (unsigned)ESP.getCpuFreqMHz());
+
+    // Reproducible heating trace: the plant under a 50% relay pattern
+    plant.reset(SIM_AMBIENT_C);
+    for (size_t i = 0; i < TRACE_LENGTH; i++)
+    {
+        plant.step(HEATER_PERIOD_MS / 1000.0f, (i / 10) % 2 == 0);
+        trace[i] = plant.reading();
+    }
+
+    benchHeater.setTargetTemperature(trace[TRACE_LENGTH / 2], 0.5f);
+    benchHeater.start();
+    measure("heater.addTemperatureReading", ITERATIONS, [](uint32_t i)
+            { benchHeater.addTemperatureReading(trace[i % TRACE_LENGTH]); });
+
+    benchModes.setRamp(SIM_AMBIENT_C, SIM_AMBIENT_C + 40.0f, 600);
+    measure("modes.update (ramp)", ITERATIONS, [](uint32_t i)
+            { benchModes.update(trace[i % TRACE_LENGTH]); });
+    benchModes.setOff();
+    benchHeater.stop();
+
+    // Messages are parsed in place, so each run gets a fresh copy
+    WebServerManager *web = WebServerManager::instance();
+    ControlCore *attached = web->control;
+    web->control = &control;
+    static const char getConfig[] = "{\"action\":\"getConfig\"}";
+    static const char unknown[] = "{\"action\":\"noSuchAction\",\"data\":{\"value\":1}}";
+    static char message[sizeof(unknown)];
+    measure("ws.dispatch getConfig", ITERATIONS, [web](uint32_t)
+            {
+                memcpy(message, getConfig, sizeof(getConfig));
+                web->handleWebSocketMessage(nullptr, (uint8_t *)message, sizeof(getConfig) - 1); });
+    measure("ws.dispatch unknown", ITERATIONS / 10, [web](uint32_t)
+            {
+                memcpy(message, unknown, sizeof(unknown));
+                web->handleWebSocketMessage(nullptr, (uint8_t *)message, sizeof(unknown) - 1); });
+    web->control = attached;
+
+    checkSensorFailure("sensor fault stops heater", ITemperatureSensor::FAULT, 0);
+    checkSensorFailure("stale sensor stops heater", ITemperatureSensor::NO_DATA, SENSOR_STALE_MS + HEATER_PERIOD_MS);
+
+    SystemState state;
+    state.startTime = 0;
+    measure("notify.json FIELD_ALL", ITERATIONS, [&state](uint32_t i)
+            {
+                StaticJsonDocument<512> doc;
+                state.temperature = trace[i % TRACE_LENGTH];
+                WebServerManager::buildDataUpdate(doc, state, i, Telemetry::FIELD_ALL);
+                AsyncWebSocketMessageBuffer *buffer = WsResponse::serialize(WebServerManager::ws, doc);
+                delete buffer; });
+
+    Telemetry::Encoder encoder;
+    measure("notify.binary frame", ITERATIONS, [&state, &encoder](uint32_t i)
+            {
+                state.temperature = trace[i % TRACE_LENGTH];
+                encoder.update(state, i); });
+}
+
+#endif // SMARTPLATE_BENCH
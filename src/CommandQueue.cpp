@@ -0,0 +1,98 @@
+#include "managers/CommandQueue.h"
+#include "managers/WebServerManager.h" // For SystemState
+#include "utilities/SerialRemote.h"
+#include "utilities/EventLog.h"
+
+CommandQueue &CommandQueue::getInstance()
+{
+    static CommandQueue instance;
+    return instance;
+}
+
+void CommandQueue::submit(const ControlUpdate &update)
+{
+    if (!update.fields)
+        return;
+
+    portENTER_CRITICAL(&mux);
+    if (pending.fields & update.fields)
+        coalesced++;
+    if (update.fields & ControlUpdate::TEMP_SETPOINT)
+        pending.tempSetpoint = update.tempSetpoint;
+    if (update.fields & ControlUpdate::RPM_SETPOINT)
+        pending.rpmSetpoint = update.rpmSetpoint;
+    if (update.fields & ControlUpdate::MODE)
+        pending.mode = update.mode;
+    if (update.fields & ControlUpdate::DURATION)
+        pending.duration = update.duration;
+    pending.fields |= update.fields;
+    pendingMessages++;
+    portEXIT_CRITICAL(&mux);
+}
+
+bool CommandQueue::apply(SystemState &state, ControlCore *control)
+{
+    portENTER_CRITICAL(&mux);
+    ControlUpdate batch = pending;
+    uint16_t messages = pendingMessages;
+    pending = ControlUpdate();
+    pendingMessages = 0;
+    portEXIT_CRITICAL(&mux);
+
+    if (!batch.fields)
+        return false;
+
+    EventLog &events = EventLog::getInstance();
+    if ((batch.fields & ControlUpdate::TEMP_SETPOINT) && batch.tempSetpoint != state.tempSetpoint)
+    {
+        events.record(EventLog::TEMP_SETPOINT, state.tempSetpoint, batch.tempSetpoint);
+        state.tempSetpoint = batch.tempSetpoint;
+    }
+    if ((batch.fields & ControlUpdate::RPM_SETPOINT) && batch.rpmSetpoint != state.rpmSetpoint)
+    {
+        events.record(EventLog::RPM_SETPOINT, state.rpmSetpoint, batch.rpmSetpoint);
+        state.rpmSetpoint = batch.rpmSetpoint;
+    }
+    if ((batch.fields & ControlUpdate::DURATION) && batch.duration != state.duration)
+    {
+        events.record(EventLog::DURATION, state.duration, batch.duration);
+        state.duration = batch.duration;
+    }
+
+    // A mode submitted in an earlier tick may not have reached the snapshot yet.
+    // A command posted during step N runs in step N + 1 at the latest, so two
+    // published steps later the snapshot reflects it.
+    HeaterModeManager::Mode current = state.mode;
+    uint32_t step = 0;
+    if (control)
+    {
+        ControlSnapshot snapshot = control->snapshot();
+        current = snapshot.mode;
+        step = snapshot.steps;
+    }
+    if (modePending && step - submittedStep >= 2)
+        modePending = false;
+    if (modePending)
+        current = submittedMode;
+
+    HeaterModeManager::Mode mode = (batch.fields & ControlUpdate::MODE) ? batch.mode : current;
+    bool modeChanged = (batch.fields & ControlUpdate::MODE) &&
+                       (batch.mode != current || (batch.fields & ControlUpdate::RESTART));
+
+    // Reconfigure the mode in place; only a mode change (re)starts it
+    if (control && control->configure(mode, modeChanged, state.tempSetpoint, state.duration,
+                                      batch.fields & ControlUpdate::TEMP_SETPOINT) &&
+        (batch.fields & ControlUpdate::MODE))
+    {
+        submittedMode = mode;
+        submittedStep = step;
+        modePending = true;
+    }
+    if (control && (batch.fields & ControlUpdate::RPM_SETPOINT))
+        control->setStirrer(state.rpmSetpoint);
+
+    logMessagef(LogLevel::INFO, "[CommandQueue] Applied %u update(s): Temp=%.2f°C, RPM=%d, Mode=%s%s",
+                messages, state.tempSetpoint, state.rpmSetpoint, HeaterModeManager::modeName(mode),
+                modeChanged ? " (restarted)" : "");
+    return true;
+}
@@ -0,0 +1,259 @@
+#include "managers/ControlCore.h"
+#include <esp_task_wdt.h>
+#include "utilities/SerialRemote.h"
+#include "utilities/Metrics.h"
+
+ControlCore::ControlCore(HeatingElement &heater, HeaterModeManager &modeManager, Stirrer *stirrer)
+    : heater(heater), modeManager(modeManager), stirrer(stirrer) {}
+
+bool ControlCore::begin(TaskManager &tasks, TaskHandle_t listenerTask)
+{
+    listener = listenerTask;
+    commands = xQueueCreateStatic(CONTROL_COMMAND_SLOTS, sizeof(Command), commandStorage, &commandQueue);
+    profiles = xQueueCreateStatic(1, sizeof(Profile::Program), profileStorage, &profileQueue);
+    if (!commands || !profiles)
+    {
+        logMessage(LogLevel::ERROR, "[ControlCore] Failed to create command queues");
+        return false;
+    }
+
+    // The timeout keeps control running (late) should the timer ever stop
+    task = tasks.createEventTask(taskMemory.config("ControlTask", CONTROL_TASK_PRIORITY, CONTROL_CORE), job, this, CONTROL_TIMEOUT_MS);
+    if (!task)
+    {
+        logMessage(LogLevel::ERROR, "[ControlCore] Failed to create control task");
+        return false;
+    }
+    if (esp_task_wdt_add(task) != ESP_OK)
+        logMessage(LogLevel::ERROR, "[ControlCore] Task watchdog unavailable");
+
+    esp_timer_create_args_t args = {};
+    args.callback = onTimer;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "control";
+    if (esp_timer_create(&args, &timer) != ESP_OK ||
+        esp_timer_start_periodic(timer, HEATER_PERIOD_MS * 1000ULL) != ESP_OK)
+    {
+        logMessage(LogLevel::ERROR, "[ControlCore] Failed to start control timer - running on the task timeout");
+        return false;
+    }
+    logMessagef(LogLevel::INFO, "[ControlCore] Control loop every %u ms on core %d", HEATER_PERIOD_MS, CONTROL_CORE);
+    return true;
+}
+
+void ControlCore::onTimer(void *arg)
+{
+    TaskManager::notify(static_cast<ControlCore *>(arg)->task);
+}
+
+void ControlCore::job(void *parameter)
+{
+    static_cast<ControlCore *>(parameter)->step();
+}
+
+void ControlCore::step()
+{
+    METRICS_SCOPE("control.step");
+    esp_task_wdt_reset();
+
+    // Sensor and safety first, so commands never delay an over-temperature stop
+    heater.update();
+
+    Command command;
+    for (int i = 0; i < CONTROL_COMMAND_SLOTS && xQueueReceive(commands, &command, 0) == pdTRUE; i++)
+        execute(command);
+
+    uint32_t now = millis();
+    if (stirrer)
+        stirrer->update(now);
+
+    float temperature = heater.getCurrentTemperature();
+    modeManager.update(temperature);
+
+    ControlSnapshot snapshot;
+    snapshot.temperature = temperature;
+    snapshot.targetTemperature = heater.getTargetTemperature();
+    snapshot.probeTemperature = heater.getProbeTemperature();
+    snapshot.sensorDropped = heater.getDroppedSamples();
+    snapshot.mode = modeManager.getCurrentMode();
+    snapshot.heating = heater.isRelayOn();
+    snapshot.fault = heater.hasFault();
+    if (stirrer)
+    {
+        snapshot.rpm = stirrer->getRPM();
+        snapshot.rpmTarget = stirrer->getTargetRPM();
+        snapshot.stirrerDuty = stirrer->getDuty();
+        snapshot.stirrerFault = stirrer->hasFault();
+    }
+    snapshot.timeMs = now;
+    snapshot.profileSegment = modeManager.getProfile().getSegment();
+    snapshot.profileElapsed = modeManager.getProfile().getSegmentElapsed(snapshot.timeMs);
+    snapshot.steps = ++steps;
+    published.publish(snapshot);
+
+    TaskManager::notify(listener);
+}
+
+void ControlCore::execute(const Command &command)
+{
+    switch (command.type)
+    {
+    case Command::OFF:
+        modeManager.setOff();
+        break;
+
+    case Command::HOLD:
+        modeManager.setHold(command.temperature);
+        break;
+
+    case Command::RAMP:
+        modeManager.setRamp(command.startTemperature, command.temperature, command.duration);
+        break;
+
+    case Command::TIMER:
+        modeManager.setTimer(command.duration, command.temperature, command.flag);
+        break;
+
+    case Command::PROFILE:
+    {
+        // Static: too large for the task stack, and only this task uses it
+        static Profile::Program program;
+        if (xQueueReceive(profiles, &program, 0) == pdTRUE)
+            modeManager.setProfile(program, heater.getCurrentTemperature());
+        break;
+    }
+
+    case Command::CONFIGURE:
+        // Reconfigure the mode in place; only a restart re-enters it
+        switch (command.mode)
+        {
+        case HeaterModeManager::HOLD:
+            modeManager.setHoldTemp(command.temperature);
+            break;
+        case HeaterModeManager::RAMP:
+            if (command.flag)
+                modeManager.setRampParams(command.temperature, command.temperature, command.duration);
+            break;
+        case HeaterModeManager::TIMER:
+            modeManager.setTimerParams(command.duration, command.temperature, true);
+            break;
+        default:
+            break;
+        }
+        if (command.flag)
+            modeManager.setMode(command.mode);
+        if (command.applySetpoint)
+            modeManager.setTargetTemperature(command.temperature);
+        break;
+
+    case Command::STIR:
+        if (stirrer)
+            stirrer->setTargetRPM(command.rpm);
+        break;
+
+    case Command::AUTOTUNE:
+        // Enable the heater before the request: the next update() starts the
+        // experiment, and control() aborts it at once if the heater is off
+        if (command.flag)
+        {
+            modeManager.setHold(command.temperature);
+            heater.requestAutotune(command.temperature);
+        }
+        else
+        {
+            heater.cancelAutotune();
+        }
+        break;
+    }
+}
+
+bool ControlCore::post(const Command &command)
+{
+    if (commands && xQueueSend(commands, &command, 0) == pdTRUE)
+        return true;
+    dropped++;
+    logMessage(LogLevel::ERROR, "[ControlCore] Command queue full - command dropped");
+    return false;
+}
+
+bool ControlCore::setOff()
+{
+    Command command = {};
+    command.type = Command::OFF;
+    return post(command);
+}
+
+bool ControlCore::setHold(float holdTemp)
+{
+    Command command = {};
+    command.type = Command::HOLD;
+    command.temperature = holdTemp;
+    return post(command);
+}
+
+bool ControlCore::setRamp(float startTemp, float endTemp, unsigned long durationSeconds)
+{
+    Command command = {};
+    command.type = Command::RAMP;
+    command.startTemperature = startTemp;
+    command.temperature = endTemp;
+    command.duration = durationSeconds;
+    return post(command);
+}
+
+bool ControlCore::setTimer(unsigned long durationSeconds, float targetTemp, bool useTemp)
+{
+    Command command = {};
+    command.type = Command::TIMER;
+    command.temperature = targetTemp;
+    command.duration = durationSeconds;
+    command.flag = useTemp;
+    return post(command);
+}
+
+bool ControlCore::setProfile(const Profile::Program &program)
+{
+    if (!profiles)
+        return false;
+    xQueueOverwrite(profiles, &program);
+    Command command = {};
+    command.type = Command::PROFILE;
+    return post(command);
+}
+
+bool ControlCore::configure(HeaterModeManager::Mode mode, bool restart, float tempSetpoint, unsigned long durationSeconds, bool applySetpoint)
+{
+    Command command = {};
+    command.type = Command::CONFIGURE;
+    command.mode = mode;
+    command.flag = restart;
+    command.temperature = tempSetpoint;
+    command.duration = durationSeconds;
+    command.applySetpoint = applySetpoint;
+    return post(command);
+}
+
+bool ControlCore::setStirrer(int rpm)
+{
+    Command command = {};
+    command.type = Command::STIR;
+    command.rpm = rpm;
+    return post(command);
+}
+
+bool ControlCore::startAutotune(float setpoint)
+{
+    Command command = {};
+    command.type = Command::AUTOTUNE;
+    command.temperature = setpoint;
+    command.flag = true;
+    return post(command);
+}
+
+bool ControlCore::cancelAutotune()
+{
+    Command command = {};
+    command.type = Command::AUTOTUNE;
+    return post(command);
+}
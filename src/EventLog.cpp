@@ -0,0 +1,52 @@
+#include "utilities/EventLog.h"
+#include "managers/HeaterModeManager.h"
+
+// Indexed by EventLog::Id; MODE takes mode names, the rest numbers.
+// The texts contain no quotes or backslashes, so they embed in JSON as is.
+static const char *const MESSAGES[EventLog::ID_COUNT] = {
+    "Temperature setpoint %.2f -> %.2f C",
+    "RPM setpoint %.0f -> %.0f",
+    "Duration %.0f -> %.0f s",
+    "Mode %s -> %s",
+    "Operation complete",
+    "Heater fault, heater stopped",
+    "Stirrer stalled at %.0f RPM, stopped",
+    "Settings #%.0f restored",
+};
+
+EventLog &EventLog::getInstance()
+{
+    static EventLog instance;
+    return instance;
+}
+
+void EventLog::record(Id id, float a, float b)
+{
+    Entry entry = {millis(), id, a, b};
+    portENTER_CRITICAL(&mux);
+    ring[written % MAX_EVENTS] = entry;
+    written = written + 1;
+    portEXIT_CRITICAL(&mux);
+}
+
+size_t EventLog::snapshot(Entry *out) const
+{
+    portENTER_CRITICAL(&mux);
+    uint32_t end = written;
+    uint32_t begin = end > (uint32_t)MAX_EVENTS ? end - MAX_EVENTS : 0;
+    for (uint32_t i = begin; i < end; i++)
+        out[i - begin] = ring[i % MAX_EVENTS];
+    portEXIT_CRITICAL(&mux);
+    return end - begin;
+}
+
+size_t EventLog::format(const Entry &entry, char *out, size_t outSize)
+{
+    if (entry.id >= ID_COUNT)
+        return snprintf(out, outSize, "Event %u", (unsigned)entry.id);
+    if (entry.id == MODE)
+        return snprintf(out, outSize, MESSAGES[entry.id],
+                        HeaterModeManager::modeName((HeaterModeManager::Mode)entry.a),
+                        HeaterModeManager::modeName((HeaterModeManager::Mode)entry.b));
+    return snprintf(out, outSize, MESSAGES[entry.id], entry.a, entry.b);
+}
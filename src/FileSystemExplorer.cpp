@@ -4,31 +4,38 @@
 #include "utilities/FileSystemExplorer.h"
 #include <LittleFS.h>
 #include <ArduinoJson.h>
+#include <lwip/opt.h>
+#include <lwip/tcpip.h>
+#include <lwip/priv/tcp_priv.h>
 #include "config/Config.h"
 #include "managers/HeaterModeManager.h" // For LogLevel
 #include "utilities/SerialRemote.h"
+#include "utilities/HttpRange.h"
+
+// The peer sends at most one receive window (plus a segment the web server
+// buffers itself) beyond what the writer acknowledged; it must fit the buffers
+static_assert(2 * FS_STREAM_BUFFER_BYTES >= TCP_WND + TCP_MSS, "Upload buffers smaller than the TCP receive window");
+// Bytes are only acknowledged once a whole block is written; a smaller window never fills one
+static_assert(TCP_WND >= FS_STREAM_BUFFER_BYTES, "TCP receive window smaller than an upload block");
 
 // Constructor for FileSystemExplorer class
-FileSystemExplorer::FileSystemExplorer(AsyncWebServer &srv) : server(srv) {}
+FileSystemExplorer::FileSystemExplorer(AsyncWebServer &srv) : server(srv), downloadHandler(*this) {}
 
-// Initialize the file system and set up server routes
+// Set up the upload queue and server routes (LittleFS is mounted by setup())
 void FileSystemExplorer::begin()
 {
-    if (!LittleFS.begin())
+    jobs = xQueueCreateStatic(UPLOAD_QUEUE_LENGTH, sizeof(UploadJob), jobQueueBuffer, &jobQueueStorage);
+    for (UploadContext &upload : uploads)
     {
-        logMessagef(LogLevel::ERROR, "LittleFS Mount Failed");
-        return;
+        upload.freeBuffers = xSemaphoreCreateCountingStatic(2, 2, &upload.freeStorage);
     }
 
     // Define server routes for file system operations
     server.on("/fs/list", HTTP_GET, std::bind(&FileSystemExplorer::handleList, this, std::placeholders::_1));
     server.on("/fs/delete", HTTP_GET, std::bind(&FileSystemExplorer::handleDelete, this, std::placeholders::_1));
-    server.on("/fs/download", HTTP_GET, std::bind(&FileSystemExplorer::handleDownload, this, std::placeholders::_1));
+    server.addHandler(&downloadHandler);
 
-    server.on("/fs/upload", HTTP_POST, [](AsyncWebServerRequest *request)
-              {
-                  // Send response when upload is done
-                  request->send(200, "text/plain", "Upload complete"); }, std::bind(&FileSystemExplorer::onUpload, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, std::placeholders::_5, std::placeholders::_6));
+    server.on("/fs/upload", HTTP_POST, std::bind(&FileSystemExplorer::handleUpload, this, std::placeholders::_1), std::bind(&FileSystemExplorer::onUpload, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, std::placeholders::_5, std::placeholders::_6));
 }
 
 // Handle listing files in a directory
@@ -41,9 +48,11 @@ void FileSystemExplorer::handleList(AsyncWebServerRequest *request)
         if (!dir.startsWith("/"))
             dir = "/" + dir;
     }
-
-    DynamicJsonDocument doc(4096);
-    JsonArray arr = doc.to<JsonArray>();
+    if (dir.length() >= FS_PATH_MAX)
+    {
+        request->send(400, "text/plain", "Directory path too long");
+        return;
+    }
 
     File root = LittleFS.open(dir);
     if (!root || !root.isDirectory())
@@ -52,26 +61,83 @@ void FileSystemExplorer::handleList(AsyncWebServerRequest *request)
         return;
     }
 
-    File file = root.openNextFile();
-    while (file)
+    ListStream *stream = nullptr;
+    for (ListStream &s : listings)
+    {
+        if (!s.inUse)
+        {
+            stream = &s;
+            break;
+        }
+    }
+    if (!stream)
+    {
+        request->send(503, "text/plain", "Too many listings in progress");
+        return;
+    }
+
+    *stream = ListStream();
+    stream->inUse = true;
+    stream->dir = root;
+    strlcpy(stream->dirPath, dir.c_str(), sizeof(stream->dirPath));
+
+    AsyncWebServerResponse *response = request->beginChunkedResponse("application/json",
+        [stream](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+        { return readListing(*stream, buffer, maxLen); });
+    request->onDisconnect([stream]()
+                          {
+        stream->dir.close();
+        stream->inUse = false; });
+    request->send(response);
+}
+
+size_t FileSystemExplorer::readListing(ListStream &stream, uint8_t *out, size_t maxLen)
+{
+    size_t written = 0;
+    while (written < maxLen)
     {
-        JsonObject obj = arr.createNestedObject();
+        // Flush the pending entry first; a response buffer may end mid-entry
+        if (stream.linePos < stream.lineLen)
+        {
+            size_t take = min(stream.lineLen - stream.linePos, maxLen - written);
+            memcpy(out + written, stream.line + stream.linePos, take);
+            stream.linePos += take;
+            written += take;
+            continue;
+        }
+        if (stream.done)
+            break;
+
+        File file = stream.dir.openNextFile();
+        if (!file)
+        {
+            // Close the array ("[]" if the directory was empty)
+            const char *tail = stream.first ? "[]" : "]";
+            stream.lineLen = strlcpy(stream.line, tail, sizeof(stream.line));
+            stream.linePos = 0;
+            stream.done = true;
+            stream.dir.close();
+            continue;
+        }
 
         String name = file.name();
-        if (name.startsWith(dir))
-            name = name.substring(dir.length()); // relative name for display
+        size_t dirLen = strlen(stream.dirPath);
+        if (strncmp(name.c_str(), stream.dirPath, dirLen) == 0)
+            name = name.substring(dirLen); // relative name for display
 
-        obj["name"] = name;        // short name shown in UI
-        obj["path"] = file.name(); // full path sent for operations (download, delete)
-        obj["size"] = file.size();
-        obj["isDir"] = file.isDirectory();
+        StaticJsonDocument<FS_LIST_LINE_BYTES> entry;
+        entry["name"] = name;        // short name shown in UI
+        entry["path"] = file.name(); // full path sent for operations (download, delete)
+        entry["size"] = file.size();
+        entry["isDir"] = file.isDirectory();
+        file.close();
 
-        file = root.openNextFile();
+        stream.line[0] = stream.first ? '[' : ',';
+        stream.first = false;
+        stream.lineLen = 1 + serializeJson(entry, stream.line + 1, sizeof(stream.line) - 1);
+        stream.linePos = 0;
     }
-
-    String out;
-    serializeJson(arr, out);
-    request->send(200, "application/json", out);
+    return written;
 }
 
 // Handle deleting a file
@@ -101,6 +167,15 @@ void FileSystemExplorer::handleDelete(AsyncWebServerRequest *request)
         request->send(500, "text/plain", "Failed to delete");
 }
 
+// Download requests need the Range header kept by the request parser
+bool FileSystemExplorer::DownloadHandler::canHandle(AsyncWebServerRequest *request)
+{
+    if (request->method() != HTTP_GET || request->url() != "/fs/download")
+        return false;
+    request->addInterestingHeader("Range");
+    return true;
+}
+
 // Handle downloading a file
 void FileSystemExplorer::handleDownload(AsyncWebServerRequest *request)
 {
@@ -127,48 +202,373 @@ void FileSystemExplorer::handleDownload(AsyncWebServerRequest *request)
         return;
     }
 
-    // Use beginResponse with size specified:
-    AsyncWebServerResponse *response = request->beginResponse("application/octet-stream", file.size(), [file](uint8_t *buffer, size_t maxLen, size_t index) mutable -> size_t
-                                                              {
-        if (!file)
-            return 0;
-        size_t bytesRead = file.read(buffer, maxLen);
-        if (bytesRead == 0)
+    size_t size = file.size();
+    size_t start = 0;
+    size_t length = size;
+    bool partial = request->hasHeader("Range");
+    if (partial && !HttpRange::parse(request->header("Range").c_str(), size, start, length))
+    {
+        file.close();
+        AsyncWebServerResponse *response = request->beginResponse(416, "text/plain", "Range not satisfiable");
+        response->addHeader("Content-Range", "bytes */" + String(size));
+        request->send(response);
+        return;
+    }
+
+    DownloadStream *stream = nullptr;
+    for (DownloadStream &s : downloads)
+    {
+        if (!s.inUse)
         {
-            file.close();
+            stream = &s;
+            break;
         }
-        return bytesRead; });
+    }
+    if (!stream)
+    {
+        file.close();
+        request->send(503, "text/plain", "Too many downloads in progress");
+        return;
+    }
+
+    stream->inUse = true;
+    stream->file = file;
+    stream->start = start;
+    stream->length = length;
+    stream->bufferOffset = 0;
+    stream->bufferFill = 0;
+
+    AsyncWebServerResponse *response = request->beginResponse("application/octet-stream", length,
+        [stream](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+        { return readDownload(*stream, buffer, maxLen, index); });
+    // Runs on completion and on abort alike, so the file is always closed
+    request->onDisconnect([stream]()
+                          {
+        stream->file.close();
+        stream->inUse = false; });
 
+    response->addHeader("Accept-Ranges", "bytes");
+    if (partial)
+    {
+        response->setCode(206);
+        response->addHeader("Content-Range", "bytes " + String(start) + "-" + String(start + length - 1) + "/" + String(size));
+    }
     response->addHeader("Content-Disposition", "attachment; filename=\"" + path.substring(path.lastIndexOf('/') + 1) + "\"");
     request->send(response);
 }
 
-// Handle file upload (not used, actual upload handled in onUpload)
+size_t FileSystemExplorer::readDownload(DownloadStream &stream, uint8_t *out, size_t maxLen, size_t index)
+{
+    size_t pos = stream.start + index;
+    size_t remaining = stream.length - index;
+    size_t written = 0;
+
+    while (written < maxLen && remaining > 0)
+    {
+        if (pos < stream.bufferOffset || pos >= stream.bufferOffset + stream.bufferFill)
+        {
+            // Refill with one whole block at a block-aligned offset
+            size_t blockStart = pos - pos % FS_STREAM_BUFFER_BYTES;
+            if (stream.file.position() != blockStart)
+                stream.file.seek(blockStart);
+            stream.bufferOffset = blockStart;
+            stream.bufferFill = stream.file.read(stream.buffer, FS_STREAM_BUFFER_BYTES);
+            if (pos >= stream.bufferOffset + stream.bufferFill)
+                break; // Read error or file shrank
+        }
+
+        size_t take = min(min(stream.bufferOffset + stream.bufferFill - pos, maxLen - written), remaining);
+        memcpy(out + written, stream.buffer + (pos - stream.bufferOffset), take);
+        written += take;
+        pos += take;
+        remaining -= take;
+    }
+    return written;
+}
+
+FileSystemExplorer::UploadContext *FileSystemExplorer::findUpload(AsyncWebServerRequest *request)
+{
+    for (UploadContext &upload : uploads)
+    {
+        if (upload.request == request)
+            return &upload;
+    }
+    return nullptr;
+}
+
+bool FileSystemExplorer::submitUpload(UploadContext &upload, UploadJob::Type type)
+{
+    UploadJob job = {&upload, type, (int8_t)(upload.holding ? upload.active : -1), (uint16_t)upload.fill};
+    // The queue has room for every buffer and the final job of every upload
+    if (xQueueSend(jobs, &job, 0) != pdTRUE)
+        return false;
+    upload.holding = false;
+    upload.fill = 0;
+    if (type != UploadJob::WRITE)
+        upload.submitted = true;
+    return true;
+}
+
+void FileSystemExplorer::abortUpload(UploadContext &upload)
+{
+    if (!upload.submitted)
+    {
+        upload.fill = 0;
+        submitUpload(upload, UploadJob::ABORT);
+    }
+}
+
+// Handle the end of the upload request: the reply follows once the file is committed
 void FileSystemExplorer::handleUpload(AsyncWebServerRequest *request)
 {
+    UploadContext *upload = findUpload(request);
+    if (!upload)
+    {
+        request->send(503, "text/plain", "Upload rejected (invalid name or too many uploads)");
+        return;
+    }
+
+    if (!upload->submitted && !submitUpload(*upload, UploadJob::COMMIT))
+        abortUpload(*upload);
+
+    // The last block, close and rename take a few milliseconds; the context
+    // stays owned by the request until it disconnects
+    upload->response = new UploadResponse(*upload);
+    request->send(upload->response);
+}
+
+size_t FileSystemExplorer::UploadResponse::_ack(AsyncWebServerRequest *request, size_t len, uint32_t time)
+{
+    if (result)
+        return result->_ack(request, len, time);
+    poll(request);
+    return 0;
 }
 
-// Handle the upload process
+void FileSystemExplorer::UploadResponse::poll(AsyncWebServerRequest *request)
+{
+    if (result || upload.inUse.load())
+        return;
+
+    if (upload.rejected)
+        result = request->beginResponse(503, "text/plain", "Upload rejected: filesystem too slow, try again");
+    else if (upload.failed)
+        result = request->beginResponse(500, "text/plain", "Upload failed");
+    else
+        result = request->beginResponse(200, "text/plain", "Upload complete");
+    result->_respond(request);
+}
+
+// Copy upload data into the block buffers; flash is written by writerTask()
 void FileSystemExplorer::onUpload(AsyncWebServerRequest *request, String filename, size_t index,
                                   uint8_t *data, size_t len, bool final)
 {
-    String path = "/" + filename;
-    static File uploadFile;
+    UploadContext *upload = findUpload(request);
 
-    if (index == 0)
+    if (index == 0 && !upload)
     {
-        if (LittleFS.exists(path))
-            LittleFS.remove(path);
-        uploadFile = LittleFS.open(path, "w");
+        String path = "/" + filename;
+        if (filename.length() == 0 || filename.indexOf("..") >= 0 || path.length() + 5 >= FS_PATH_MAX)
+        {
+            logMessagef(LogLevel::ERROR, "[FS] Rejected upload name '%s'", filename.c_str());
+            return;
+        }
+        for (UploadContext &u : uploads)
+        {
+            if (!u.inUse.load() && !u.request)
+            {
+                upload = &u;
+                break;
+            }
+        }
+        if (!upload)
+            return; // handleUpload() answers 503
+
+        upload->inUse.store(true);
+        upload->request = request;
+        strlcpy(upload->path, path.c_str(), sizeof(upload->path));
+        snprintf(upload->tempPath, sizeof(upload->tempPath), "%s.part", upload->path);
+        upload->fill = 0;
+        upload->holding = false;
+        upload->submitted = false;
+        upload->failed = false;
+        upload->rejected = false;
+        upload->released.store(0);
+        upload->response = nullptr;
+        upload->pcb.store(request->client()->pcb());
+        // Replaces the request's own poll handler, which only polls the
+        // response; onUploadPoll() does that too
+        request->client()->onPoll(onUploadPoll, upload);
+
+        // Runs on completion and on abort alike; the context is free once the writer is done
+        request->onDisconnect([this, request]()
+                              {
+            UploadContext *u = findUpload(request);
+            if (!u)
+                return;
+            u->pcb.store(nullptr);
+            abortUpload(*u);
+            u->response = nullptr;
+            u->request = nullptr; });
     }
+    if (!upload || upload->submitted)
+        return;
+
+    // Acknowledged once it is on flash (releaseWindow(), then ackReleased())
+    ackReleased(*upload, request->client());
+    request->client()->ackLater();
 
-    if (uploadFile)
+    while (len > 0)
     {
-        uploadFile.write(data, len);
+        if (!upload->holding)
+        {
+            // The receive window should keep a buffer free; if not, drop the upload
+            if (xSemaphoreTake(upload->freeBuffers, 0) != pdTRUE)
+            {
+                logMessagef(LogLevel::ERROR, "[FS] Upload of %s overran the writer, aborting", upload->path);
+                upload->rejected = true;
+                abortUpload(*upload);
+                return;
+            }
+            upload->holding = true;
+            upload->active ^= 1;
+            upload->fill = 0;
+        }
+
+        size_t take = min(len, FS_STREAM_BUFFER_BYTES - upload->fill);
+        memcpy(upload->buffers[upload->active] + upload->fill, data, take);
+        upload->fill += take;
+        data += take;
+        len -= take;
+
+        if (upload->fill == FS_STREAM_BUFFER_BYTES && !submitUpload(*upload, UploadJob::WRITE))
+        {
+            upload->rejected = true;
+            abortUpload(*upload);
+            return;
+        }
     }
 
     if (final)
+        submitUpload(*upload, UploadJob::COMMIT);
+}
+
+void FileSystemExplorer::writerTask(void *parameter)
+{
+    FileSystemExplorer *self = static_cast<FileSystemExplorer *>(parameter);
+    UploadJob job;
+    for (;;)
+    {
+        if (self->jobs && xQueueReceive(self->jobs, &job, portMAX_DELAY) == pdTRUE)
+            runJob(job);
+        else
+            vTaskDelay(pdMS_TO_TICKS(100)); // begin() not run yet
+    }
+}
+
+void FileSystemExplorer::runJob(const UploadJob &job)
+{
+    UploadContext &upload = *job.upload;
+
+    if (!upload.opened && job.type != UploadJob::ABORT)
     {
-        uploadFile.close();
+        upload.file = LittleFS.open(upload.tempPath, "w");
+        upload.opened = true;
+        if (!upload.file)
+        {
+            logMessagef(LogLevel::ERROR, "[FS] Failed to open %s", upload.tempPath);
+            upload.failed = true;
+        }
     }
+
+    if (job.buffer >= 0)
+    {
+        if (job.type != UploadJob::ABORT && !upload.failed && job.length > 0 &&
+            upload.file.write(upload.buffers[job.buffer], job.length) != job.length)
+        {
+            logMessagef(LogLevel::ERROR, "[FS] Write to %s failed", upload.tempPath);
+            upload.failed = true;
+        }
+        xSemaphoreGive(upload.freeBuffers);
+    }
+
+    if (job.type == UploadJob::WRITE)
+    {
+        releaseWindow(upload, job.length);
+        return;
+    }
+
+    if (upload.file)
+        upload.file.close();
+    // LittleFS rename replaces an existing target atomically
+    if (job.type == UploadJob::COMMIT && !upload.failed && !LittleFS.rename(upload.tempPath, upload.path))
+    {
+        logMessagef(LogLevel::ERROR, "[FS] Failed to rename %s", upload.tempPath);
+        upload.failed = true;
+    }
+    if (job.type == UploadJob::ABORT || upload.failed)
+    {
+        if (upload.opened)
+            LittleFS.remove(upload.tempPath);
+    }
+    else
+    {
+        logMessagef(LogLevel::INFO, "[FS] Uploaded %s", upload.path);
+    }
+
+    upload.opened = false;
+    // Nothing more is stored: let the rest of the request (or the abort) through.
+    // The poll follows inUse, so it also finds the result ready.
+    upload.released.store(SIZE_MAX);
+    upload.inUse.store(false);
+    pokeConnection(upload);
+}
+
+void FileSystemExplorer::releaseWindow(UploadContext &upload, size_t length)
+{
+    upload.released.fetch_add(length);
+    pokeConnection(upload);
+}
+
+void FileSystemExplorer::pokeConnection(UploadContext &upload)
+{
+    // With the window closed no onUpload() follows, and the regular poll is
+    // 500 ms away; if the tcpip queue is full, that poll acknowledges instead
+    if (upload.pcb.load())
+        tcpip_try_callback(raisePoll, &upload);
+}
+
+void FileSystemExplorer::raisePoll(void *arg)
+{
+    // lwIP frees pcbs in this thread, so one still in the active list is alive.
+    // A pcb reused by another connection only gets a spurious poll.
+    tcp_pcb *pcb = static_cast<UploadContext *>(arg)->pcb.load();
+    for (tcp_pcb *active = tcp_active_pcbs; pcb && active; active = active->next)
+    {
+        if (active == pcb)
+        {
+            if (pcb->poll)
+                pcb->poll(pcb->callback_arg, pcb);
+            return;
+        }
+    }
+}
+
+void FileSystemExplorer::ackReleased(UploadContext &upload, AsyncClient *client)
+{
+    // ack() updates AsyncClient state that _recv() also changes, so it runs in this task only
+    size_t length = upload.released.exchange(0);
+    if (length && client)
+        client->ack(length);
+}
+
+void FileSystemExplorer::onUploadPoll(void *arg, AsyncClient *client)
+{
+    UploadContext &upload = *static_cast<UploadContext *>(arg);
+    if (!upload.request)
+        return;
+    ackReleased(upload, client);
+    // What the request's poll handler does for its response
+    if (upload.response && client->canSend() && !upload.response->_finished())
+        upload.response->_ack(upload.request, 0, 0);
 }
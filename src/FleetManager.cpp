@@ -0,0 +1,275 @@
+#include "managers/FleetManager.h"
+#include <WiFi.h>
+#include <ESPmDNS.h>
+#include "managers/WebServerManager.h"
+#include "utilities/SerialRemote.h"
+
+FleetManager &FleetManager::getInstance()
+{
+    static FleetManager instance;
+    return instance;
+}
+
+const char *FleetManager::hostname()
+{
+    if (FLEET_ROLE == OFF)
+        return OTA_HOSTNAME;
+
+    static char name[FLEET_NAME_LEN];
+    if (!name[0])
+    {
+        // Last three bytes of the station MAC, as printed on the module
+        uint64_t mac = ESP.getEfuseMac();
+        snprintf(name, sizeof(name), "%s-%02x%02x%02x", OTA_HOSTNAME,
+                 (unsigned)(mac >> 24) & 0xFF, (unsigned)(mac >> 32) & 0xFF, (unsigned)(mac >> 40) & 0xFF);
+    }
+    return name;
+}
+
+const char *FleetManager::roleName(Role role)
+{
+    switch (role)
+    {
+    case PUBLISHER:
+        return "publisher";
+    case COLLECTOR:
+        return "collector";
+    default:
+        return "off";
+    }
+}
+
+bool FleetManager::begin(Role fleetRole)
+{
+    // The broadcast task publishes as soon as role is set, so it is set last
+    if (fleetRole == OFF)
+        return false;
+    if (WiFi.status() != WL_CONNECTED)
+    {
+        logMessage(LogLevel::ERROR, "[FleetManager] WiFi not connected - fleet disabled");
+        return false;
+    }
+
+    outgoing.magic = MAGIC;
+    outgoing.version = VERSION;
+    outgoing.role = fleetRole;
+    strncpy(outgoing.name, hostname(), sizeof(outgoing.name));
+
+    // ArduinoOTA has started the responder under hostname()
+    MDNS.addService("smartplate", "udp", FLEET_PORT);
+    MDNS.addServiceTxt("smartplate", "udp", "role", roleName(fleetRole));
+
+    if (fleetRole == COLLECTOR)
+    {
+        IPAddress group(FLEET_MULTICAST_GROUP[0], FLEET_MULTICAST_GROUP[1], FLEET_MULTICAST_GROUP[2], FLEET_MULTICAST_GROUP[3]);
+        if (!udp.listenMulticast(group, FLEET_PORT))
+        {
+            logMessage(LogLevel::ERROR, "[FleetManager] Cannot join the fleet multicast group - publishing only");
+            fleetRole = PUBLISHER;
+            outgoing.role = fleetRole;
+        }
+        else
+        {
+            udp.onPacket([this](AsyncUDPPacket &packet)
+                         { onPacket(packet); });
+        }
+    }
+
+    role = fleetRole;
+    logMessagef(LogLevel::INFO, "[FleetManager] %s as %s on port %u", roleName(role), hostname(), FLEET_PORT);
+    return true;
+}
+
+void FleetManager::publish(const SystemState &state)
+{
+    if (role == OFF)
+        return;
+    uint32_t now = millis();
+    if (sent && now - lastSentMs < FLEET_PUBLISH_MS)
+        return;
+
+    // Encode only when a datagram may go out, so its dirty mask covers everything since the last one
+    uint32_t runningTime = (now - state.startTime) / 1000;
+    bool changed = encoder.update(state, runningTime);
+    if (!changed && sent && now - lastSentMs < FLEET_HEARTBEAT_MS)
+        return;
+
+    outgoing.sequence++;
+    outgoing.frame = encoder.frame();
+    IPAddress group(FLEET_MULTICAST_GROUP[0], FLEET_MULTICAST_GROUP[1], FLEET_MULTICAST_GROUP[2], FLEET_MULTICAST_GROUP[3]);
+    if (udp.writeTo(reinterpret_cast<const uint8_t *>(&outgoing), sizeof(outgoing), group, FLEET_PORT) == sizeof(outgoing))
+        sent++;
+    lastSentMs = now;
+
+    // The collector lists itself like any other plate
+    if (role == COLLECTOR)
+        record(outgoing, (uint32_t)WiFi.localIP());
+}
+
+void FleetManager::onPacket(AsyncUDPPacket &packet)
+{
+    if (packet.length() != sizeof(Datagram))
+        return;
+    Datagram datagram;
+    memcpy(&datagram, packet.data(), sizeof(datagram));
+    if (datagram.magic != MAGIC || datagram.version != VERSION ||
+        datagram.frame.magic != Telemetry::FRAME_MAGIC || datagram.frame.version != Telemetry::FRAME_VERSION)
+        return;
+
+    datagram.name[FLEET_NAME_LEN - 1] = '\0';
+    // Our own datagrams come back through multicast loopback
+    if (strcmp(datagram.name, outgoing.name) == 0)
+        return;
+    record(datagram, (uint32_t)packet.remoteIP());
+}
+
+FleetManager::Peer *FleetManager::slotFor(const char *name)
+{
+    Peer *slot = nullptr;
+    for (Peer &p : peers)
+    {
+        if (strcmp(p.name, name) == 0)
+            return &p;
+        if (!slot || (slot->name[0] && (!p.name[0] || p.lastSeenMs < slot->lastSeenMs)))
+            slot = &p;
+    }
+    *slot = Peer();
+    strncpy(slot->name, name, FLEET_NAME_LEN);
+    return slot;
+}
+
+void FleetManager::record(const Datagram &datagram, uint32_t ip)
+{
+    char name[FLEET_NAME_LEN + 1] = {};
+    strncpy(name, datagram.name, FLEET_NAME_LEN);
+    uint32_t now = millis();
+
+    taskENTER_CRITICAL(&mux);
+    Peer *p = slotFor(name);
+    // A lower sequence number means the plate restarted
+    if (p->heard && datagram.sequence > p->sequence)
+        p->lost += datagram.sequence - p->sequence - 1;
+    p->sequence = datagram.sequence;
+    p->received++;
+    p->ip = ip;
+    p->role = datagram.role;
+    p->frame = datagram.frame;
+    p->heard = true;
+    p->lastSeenMs = now;
+    if (p->historyCount == 0 || now - p->lastHistoryMs >= FLEET_HISTORY_PERIOD_MS)
+    {
+        p->history[p->historyHead] = datagram.frame.temperature;
+        p->historyHead = (p->historyHead + 1) % FLEET_HISTORY_POINTS;
+        if (p->historyCount < FLEET_HISTORY_POINTS)
+            p->historyCount++;
+        p->lastHistoryMs = now;
+    }
+    taskEXIT_CRITICAL(&mux);
+}
+
+void FleetManager::discover()
+{
+    if (role != COLLECTOR)
+        return;
+
+    int found = MDNS.queryService("smartplate", "udp");
+    int added = 0;
+    for (int i = 0; i < found; i++)
+    {
+        String host = MDNS.hostname(i);
+        if (host.isEmpty() || host == outgoing.name)
+            continue;
+        uint32_t ip = (uint32_t)MDNS.IP(i);
+
+        // Plates found over mDNS are listed (offline) until they are heard;
+        // they only take free slots, never those of plates that were heard
+        taskENTER_CRITICAL(&mux);
+        Peer *known = nullptr;
+        Peer *empty = nullptr;
+        for (Peer &p : peers)
+        {
+            if (strncmp(p.name, host.c_str(), FLEET_NAME_LEN) == 0)
+                known = &p;
+            else if (!empty && !p.name[0])
+                empty = &p;
+        }
+        if (!known && empty)
+        {
+            strncpy(empty->name, host.c_str(), FLEET_NAME_LEN);
+            empty->ip = ip;
+            added++;
+        }
+        taskEXIT_CRITICAL(&mux);
+    }
+    logMessagef(LogLevel::DEBUG, "[FleetManager] mDNS: %d plates, %d new", found, added);
+}
+
+void FleetManager::writeJson(JsonDocument &doc)
+{
+    doc["role"] = roleName(role);
+    doc["name"] = (const char *)outgoing.name;
+    doc["sent"] = sent;
+    JsonArray out = doc.createNestedArray("peers");
+
+    uint32_t now = millis();
+    for (size_t i = 0; i < peers.size(); i++)
+    {
+        Peer p;
+        taskENTER_CRITICAL(&mux);
+        p = peers[i];
+        taskEXIT_CRITICAL(&mux);
+        if (!p.name[0])
+            continue;
+
+        JsonObject peer = out.createNestedObject();
+        peer["name"] = p.name; // Copied: p is a local
+        peer["ip"] = IPAddress(p.ip).toString();
+        peer["role"] = roleName((Role)p.role);
+        peer["online"] = p.heard && now - p.lastSeenMs < FLEET_PEER_TIMEOUT_MS;
+        if (!p.heard)
+            continue;
+        peer["ageMs"] = now - p.lastSeenMs;
+        peer["received"] = p.received;
+        peer["lost"] = p.lost;
+        // Frame members are packed: copy them out instead of binding references
+        peer["temperature"] = (float)p.frame.temperature;
+        peer["temp_setpoint"] = (float)p.frame.tempSetpoint;
+        peer["rpm"] = (int32_t)p.frame.rpm;
+        peer["mode"] = HeaterModeManager::modeName((HeaterModeManager::Mode)p.frame.mode);
+        peer["running_time"] = (uint32_t)p.frame.runningTime;
+        peer["profile_segment"] = p.frame.profileSegment == 0xFF ? -1 : (int)p.frame.profileSegment;
+    }
+}
+
+bool FleetManager::writeHistoryJson(const char *name, JsonDocument &doc)
+{
+    static float temperatures[FLEET_HISTORY_POINTS]; // Copy outside the lock; AsyncTCP task only
+    char peerName[FLEET_NAME_LEN + 1] = {};
+    uint16_t count = 0;
+    bool found = false;
+
+    taskENTER_CRITICAL(&mux);
+    for (const Peer &p : peers)
+    {
+        if (p.name[0] && strcmp(p.name, name) == 0)
+        {
+            found = true;
+            strncpy(peerName, p.name, FLEET_NAME_LEN);
+            count = p.historyCount;
+            uint16_t first = (p.historyHead + FLEET_HISTORY_POINTS - count) % FLEET_HISTORY_POINTS;
+            for (uint16_t k = 0; k < count; k++)
+                temperatures[k] = p.history[(first + k) % FLEET_HISTORY_POINTS];
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&mux);
+    if (!found)
+        return false;
+
+    doc["name"] = peerName;
+    doc["periodMs"] = FLEET_HISTORY_PERIOD_MS;
+    JsonArray out = doc.createNestedArray("temperatures");
+    for (uint16_t k = 0; k < count; k++)
+        out.add(temperatures[k]);
+    return true;
+}
@@ -1,11 +1,25 @@
 #include "managers/HeaterModeManager.h"
+#include "config/Config.h"
+#include "utilities/SerialRemote.h"
+
+// Indexed by Mode
+static constexpr const char *MODE_NAMES[HeaterModeManager::MODE_COUNT] = {
+    Modes::OFF,
+    Modes::RAMP,
+    Modes::HOLD,
+    Modes::TIMER,
+    Modes::PROFILE,
+};
 
 HeaterModeManager::HeaterModeManager(HeatingElement &heater) : heater(heater) {}
 
 void HeaterModeManager::setOff()
 {
     mode = OFF;
+    profile.stop();
     heater.stop();
+    heater.clearTargetTemperature();
+    heater.setSetpointRate(0.0f);
 }
 
 void HeaterModeManager::setRamp(float startTemp, float endTemp, unsigned long durationSeconds)
@@ -37,11 +51,25 @@ void HeaterModeManager::setTimer(unsigned long durationSeconds, float targetTemp
     {
         heater.setTargetTemperature(targetTemp, 0.5f); // Added tolerance argument
     }
+    else
+    {
+        heater.clearTargetTemperature();
+    }
+    heater.start();
+}
+
+void HeaterModeManager::setProfile(const Profile::Program &newProgram, float currentTemp)
+{
+    mode = PROFILE;
+    program = newProgram;
+    profile.start(program, currentTemp, millis());
+    logMessagef(LogLevel::INFO, "[HeaterModeManager] Running profile %s (%u segments)", program.name, program.count);
     heater.start();
 }
 
 void HeaterModeManager::update(float currentTemp)
 {
+    lastTemp = currentTemp;
     if (heater.hasFault())
     {
         if (onFault)
@@ -50,6 +78,8 @@ void HeaterModeManager::update(float currentTemp)
         return;
     }
 
+    // Setpoint slope for the heater's feed-forward, 0 unless a ramp is running
+    float rate = 0.0f;
     switch (mode)
     {
     case OFF:
@@ -70,6 +100,7 @@ void HeaterModeManager::update(float currentTemp)
         {
             float newTarget = rampStartTemp + (rampEndTemp - rampStartTemp) * ((float)elapsed / rampDuration);
             heater.setTargetTemperature(newTarget, 0.5f); // Added tolerance argument
+            rate = (rampEndTemp - rampStartTemp) / (rampDuration / 1000.0f);
             if (!heater.isRunningState())
                 heater.start();
         }
@@ -77,14 +108,9 @@ void HeaterModeManager::update(float currentTemp)
     }
 
     case HOLD:
-        if (!heater.isRunningState() && currentTemp < heater.getTargetTemperature() - 1.0f)
-        {
+        // Regulation around the setpoint is done by the heater's control loop
+        if (!heater.isRunningState())
             heater.start();
-        }
-        else if (heater.isRunningState() && currentTemp >= heater.getTargetTemperature())
-        {
-            heater.stop();
-        }
         break;
 
     case TIMER:
@@ -100,41 +126,52 @@ void HeaterModeManager::update(float currentTemp)
         }
         break;
     }
+
+    case PROFILE:
+        if (!profile.update(currentTemp, millis()))
+        {
+            logMessagef(LogLevel::INFO, "[HeaterModeManager] Profile %s complete", program.name);
+            if (onComplete)
+                onComplete();
+            setOff();
+            break;
+        }
+        heater.setTargetTemperature(profile.getSetpoint(), 0.5f);
+        rate = profile.getSetpointRate();
+        if (!heater.isRunningState())
+            heater.start();
+        break;
     }
+    heater.setSetpointRate(rate);
 }
 
 void HeaterModeManager::setOnCompleteCallback(void (*cb)()) { onComplete = cb; }
 void HeaterModeManager::setOnFaultCallback(void (*cb)()) { onFault = cb; }
 HeaterModeManager::Mode HeaterModeManager::getCurrentMode() const { return mode; }
 
-String HeaterModeManager::modeToString(Mode mode)
+const char *HeaterModeManager::modeName(Mode mode)
 {
-    switch (mode)
-    {
-    case OFF:
-        return "Off";
-    case RAMP:
-        return "Ramp";
-    case HOLD:
-        return "Hold";
-    case TIMER:
-        return "Timer";
-    default:
-        return "Unknown";
-    }
+    return (mode >= 0 && mode < MODE_COUNT) ? MODE_NAMES[mode] : "Unknown";
 }
 
-void HeaterModeManager::setMode(const String& modeStr) {
-    if (modeStr.equalsIgnoreCase("Off")) {
-        setOff();
-    } else if (modeStr.equalsIgnoreCase("Ramp")) {
-        // Default ramp values, or you may want to require parameters
-        setRamp(rampStartTemp, rampEndTemp, rampDuration / 1000UL);
-    } else if (modeStr.equalsIgnoreCase("Hold")) {
-        setHold(rampEndTemp); // Or use a default hold temp
-    } else if (modeStr.equalsIgnoreCase("Timer")) {
-        setTimer(timerDuration / 1000UL, rampEndTemp, timerUseTemp);
+bool HeaterModeManager::parseMode(const char *name, Mode &mode)
+{
+    if (!name)
+        return false;
+    if (strcasecmp(name, Modes::RECRYSTALLIZATION) == 0)
+    {
+        mode = PROFILE;
+        return true;
     }
+    for (int i = 0; i < MODE_COUNT; i++)
+    {
+        if (strcasecmp(name, MODE_NAMES[i]) == 0)
+        {
+            mode = static_cast<Mode>(i);
+            return true;
+        }
+    }
+    return false;
 }
 
 void HeaterModeManager::setMode(Mode modeVal) {
@@ -151,6 +188,9 @@ void HeaterModeManager::setMode(Mode modeVal) {
         case TIMER:
             setTimer(timerDuration / 1000UL, rampEndTemp, timerUseTemp);
             break;
+        case PROFILE:
+            setProfile(program, isnan(lastTemp) ? heater.getCurrentTemperature() : lastTemp);
+            break;
     }
 }
 
@@ -1,84 +1,31 @@
 #include "hardware/HeatingElement.h"
-#include <Adafruit_MAX31865.h>
-#include <MAX31865Adapter.h>
 #include "utilities/SerialRemote.h"
-// Constants for PT100 sensor and reference resistor
-constexpr float RREF = 424.0f;
-constexpr float RNOMINAL = 100.0f;
+#include "utilities/Metrics.h"
 
-HeatingElement::HeatingElement(uint8_t relayPin, float maxTempLimit, int filterSize, ITemperatureSensor* sensor)
-    : relayPin(relayPin), maxTemp(maxTempLimit), tempFilterSize(filterSize), tempSensor(sensor)
+HeatingElement::HeatingElement(uint8_t relayPin, float maxTempLimit, ITemperatureSensor* sensor, ITemperatureFilter* filter)
+    : relayPin(relayPin), enabled(false), maxTemp(maxTempLimit),
+      window(PID_WINDOW_MS, PID_MIN_SWITCH_MS), tempFilter(filter), tempSensor(sensor)
 {
     pinMode(relayPin, OUTPUT);
     digitalWrite(relayPin, LOW);
-    tempBuffer = new float[tempFilterSize]();
     currentTemp = NAN;
+    rawTemp = NAN;
     onTemperatureChanged = nullptr;
-}
-
-HeatingElement::~HeatingElement()
-{
-    delete[] tempBuffer;
+    setPidGains({PID_KP, PID_KI, PID_KD});
 }
 
 void HeatingElement::begin()
 {
-    // Assume tempSensor is a MAX31865Adapter if you call begin()
-    auto* max = static_cast<MAX31865Adapter*>(tempSensor);
-    if (max) max->begin();
-}
-
-void HeatingElement::update()
-{
-    float temp = tempSensor->readTemperature();
-    addTemperatureReading(temp);
-
-    // Assume tempSensor is a MAX31865Adapter if you want to access fault methods
-    auto* max = static_cast<MAX31865Adapter*>(tempSensor);
-    if (max) {
-        uint8_t faultCode = max->readFault();
-        if (faultCode)
-        {
-            logMessagef(LogLevel::INFO, "MAX31865 Fault: 0x%02X", faultCode);
-            max->clearFault();
-        }
-    }
-}
-
-void HeatingElement::start()
-{
-    if (!isRunning && !fault)
-        setRelayWithCallback(true, onHeaterOn, "Starting heater");
-}
-
-void HeatingElement::stop()
-{
-    if (isRunning)
-        setRelayWithCallback(false, onHeaterOff, nullptr);
-}
-
-void HeatingElement::addTemperatureReading(float temp)
-{
-    tempBuffer[tempIndex] = temp;
-    tempIndex = (tempIndex + 1) % tempFilterSize;
-    float previousTemp = currentTemp;
-    currentTemp = temp;
-    triggerIfChanged(onTemperatureChanged, previousTemp, currentTemp);
-    checkOverTemperature();
-    bangBangControl();
-    checkTargetReached();
-}
-
-void HeatingElement::setTargetTemperature(float target, float tolerance)
-{
-    targetTemp = target;
-    targetTolerance = tolerance;
-    targetTempSet = true;
-    targetReachedTriggered = false;
+    if (tempSensor && !tempSensor->begin())
+        logMessage(LogLevel::ERROR, "[HeatingElement] Temperature sensor not responding");
+    // The first conversions get SENSOR_STALE_MS like any later gap
+    sensor.lastSampleMs = probe.lastSampleMs = millis();
 }
 
 float HeatingElement::getCurrentTemperature() const { return currentTemp; }
-bool HeatingElement::isRunningState() const { return isRunning; }
+float HeatingElement::getRawTemperature() const { return rawTemp; }
+bool HeatingElement::isRunningState() const { return enabled; }
+bool HeatingElement::isRelayOn() const { return relayOn; }
 bool HeatingElement::hasFault() const { return fault; }
 float HeatingElement::getTargetTemperature() const { return targetTemp; }
 
@@ -90,20 +37,18 @@ void HeatingElement::setOnTemperatureChangedCallback(void (*cb)(float)) { onTemp
 
 void HeatingElement::setRelay(bool on)
 {
+    if (on == relayOn)
+        return;
     digitalWrite(relayPin, on ? HIGH : LOW);
-    Serial.printf("HeatingElement: Relay %s\n", on ? "ON" : "OFF");
-    updateRunningState(on);
+    relayOn = on;
+    logMessagef(LogLevel::DEBUG, "[HeatingElement] Relay %s", on ? "ON" : "OFF");
+    Callback cb = on ? onHeaterOn : onHeaterOff;
+    if (cb)
+        cb();
 }
 
 // --- Helper functions ---
 
-void HeatingElement::setRelayWithCallback(bool on, Callback cb, const char* msg)
-{
-    setRelay(on);
-    if (msg) Serial.println(String("HeatingElement: ") + msg);
-    if (cb) cb();
-}
-
 void HeatingElement::triggerIfChanged(void (*cb)(float), float prev, float curr)
 {
     if (cb && (isnan(prev) || fabs(curr - prev) > 0.01f))
@@ -112,9 +57,12 @@ void HeatingElement::triggerIfChanged(void (*cb)(float), float prev, float curr)
 
 void HeatingElement::checkOverTemperature()
 {
-    if (currentTemp >= maxTemp)
+    bool overTemp = rawTemp >= maxTemp || currentTemp >= maxTemp;
+    // NAN compares false above, so a failed sensor is a fault of its own
+    if (overTemp || sensor.failed)
     {
-        Serial.println("HeatingElement: Fault detected - over temperature!");
+        if (overTemp)
+            logMessage(LogLevel::ERROR, "[HeatingElement] Fault detected - over temperature!");
         fault = true;
         stop();
         if (onFault)
@@ -126,20 +74,97 @@ void HeatingElement::checkOverTemperature()
     }
 }
 
+void HeatingElement::control()
+{
+    if (!enabled || fault || isnan(currentTemp))
+    {
+        if (autotuner.getState() == PidAutotuner::RUNNING)
+        {
+            autotuner.cancel();
+            logMessage(LogLevel::INFO, "[HeatingElement] Autotune aborted - heater stopped");
+        }
+        setRelay(false);
+        return;
+    }
+    if (autotuner.getState() == PidAutotuner::RUNNING)
+    {
+        autotuneControl();
+        return;
+    }
+    if (!targetTempSet)
+    {
+        // No setpoint (e.g. timer without temperature): full power
+        setRelay(true);
+        return;
+    }
+
+    if (HEATER_CONTROL_MODE == HeaterControl::PID)
+        pidControl();
+    else
+        bangBangControl();
+}
+
 void HeatingElement::bangBangControl()
 {
-    if (targetTempSet && !fault)
+    // Switch against where the setpoint will be, so a ramp is not trailed by the plant lag
+    const float target = targetTemp + setpointRate * (PLANT_LEAD_MS / 1000.0f);
+    if (currentTemp < target - targetTolerance)
+        setRelay(true);
+    else if (currentTemp >= target + targetTolerance)
+        setRelay(false);
+}
+
+void HeatingElement::pidControl()
+{
+    uint32_t now = millis();
+    if (!pidArmed)
     {
-        if (currentTemp < targetTemp - targetTolerance)
-            setRelay(true);
-        else if (currentTemp >= targetTemp + targetTolerance)
-            setRelay(false);
+        pid.reset();
+        window.restart();
+        lastControlMs = now;
+        pidArmed = true;
     }
+    float dt = (now - lastControlMs) / 1000.0f;
+    lastControlMs = now;
+
+    // The window holds the duty chosen now for PID_WINDOW_MS; aim the feed-forward at its middle
+    const float rate = setpointRate;
+    float feedForward = 0.0f;
+    if (plant.isValid())
+        feedForward = plant.feedForward(targetTemp + rate * (PLANT_LEAD_MS / 1000.0f), rate);
+
+    float duty = pid.compute(targetTemp, currentTemp, dt, feedForward);
+    setRelay(window.update(duty, now));
+}
+
+void HeatingElement::autotuneControl()
+{
+    bool on = autotuner.update(currentTemp, millis());
+    PidAutotuner::State result = autotuner.getState();
+
+    if (result == PidAutotuner::DONE)
+    {
+        const PidGains &gains = autotuner.getGains();
+        logMessagef(LogLevel::INFO, "[HeatingElement] Autotune done: Kp=%.4f Ki=%.6f Kd=%.3f", gains.kp, gains.ki, gains.kd);
+        setPidGains(gains, true);
+        pidArmed = false;
+    }
+    else if (result == PidAutotuner::FAILED)
+    {
+        logMessage(LogLevel::ERROR, "[HeatingElement] Autotune failed - keeping previous gains");
+        pidArmed = false;
+    }
+
+    portENTER_CRITICAL(&requestMux);
+    publishedAutotune = result;
+    portEXIT_CRITICAL(&requestMux);
+
+    setRelay(on);
 }
 
 void HeatingElement::checkTargetReached()
 {
-    if (isRunning && !fault && targetTempSet &&
+    if (enabled && !fault && targetTempSet &&
         currentTemp >= targetTemp - targetTolerance &&
         !targetReachedTriggered)
     {
@@ -153,20 +178,258 @@ void HeatingElement::checkTargetReached()
     }
 }
 
-void HeatingElement::updateRunningState(bool relayOn)
+void HeatingElement::applyRequests()
 {
-    if (relayOn && !isRunning)
+    portENTER_CRITICAL(&requestMux);
+    bool haveGains = gainsRequested;
+    PidGains gains = requestedGains;
+    float autotuneSetpoint = requestedAutotune;
+    bool cancel = cancelRequested;
+    gainsRequested = false;
+    requestedAutotune = NAN;
+    cancelRequested = false;
+    portEXIT_CRITICAL(&requestMux);
+
+    if (haveGains)
+        setPidGains(gains, true);
+    if (cancel && autotuner.getState() == PidAutotuner::RUNNING)
     {
-        isRunning = true;
-        if (onHeaterOn)
-            onHeaterOn();
+        autotuner.cancel();
+        pidArmed = false;
+        logMessage(LogLevel::INFO, "[HeatingElement] Autotune cancelled");
     }
-    else if (!relayOn && isRunning)
+    if (!isnan(autotuneSetpoint))
     {
-        isRunning = false;
-        if (onHeaterOff)
-            onHeaterOff();
+        autotuner.begin(autotuneSetpoint, AUTOTUNE_HYSTERESIS, AUTOTUNE_CYCLES, AUTOTUNE_TIMEOUT_MS, millis());
+        logMessagef(LogLevel::INFO, "[HeatingElement] Autotune started at %.1f°C", autotuneSetpoint);
     }
+
+    portENTER_CRITICAL(&requestMux);
+    publishedAutotune = autotuner.getState();
+    portEXIT_CRITICAL(&requestMux);
 }
 
+void HeatingElement::setPidGains(const PidGains &gains, bool save)
+{
+    pid.setGains(gains);
+    portENTER_CRITICAL(&requestMux);
+    publishedGains = gains;
+    gainsUnsaved |= save;
+    portEXIT_CRITICAL(&requestMux);
+}
 
+void HeatingElement::savePendingGains()
+{
+    portENTER_CRITICAL(&requestMux);
+    bool save = gainsUnsaved;
+    PidGains gains = publishedGains;
+    gainsUnsaved = false;
+    portEXIT_CRITICAL(&requestMux);
+
+    if (save && !savePidGains(PID_GAINS_PATH, gains))
+        logMessage(LogLevel::ERROR, "[HeatingElement] Failed to save PID gains");
+}
+
+// --- PID configuration ---
+
+void HeatingElement::loadPidGains()
+{
+    PidGains gains;
+    if (::loadPidGains(PID_GAINS_PATH, gains))
+    {
+        setPidGains(gains);
+        logMessagef(LogLevel::INFO, "[HeatingElement] Loaded PID gains Kp=%.4f Ki=%.6f Kd=%.3f", gains.kp, gains.ki, gains.kd);
+    }
+    else
+    {
+        logMessage(LogLevel::INFO, "[HeatingElement] Using default PID gains");
+    }
+}
+
+void HeatingElement::requestPidGains(const PidGains &gains)
+{
+    portENTER_CRITICAL(&requestMux);
+    requestedGains = gains;
+    gainsRequested = true;
+    portEXIT_CRITICAL(&requestMux);
+}
+
+void HeatingElement::requestAutotune(float setpoint)
+{
+    portENTER_CRITICAL(&requestMux);
+    requestedAutotune = setpoint;
+    cancelRequested = false;
+    portEXIT_CRITICAL(&requestMux);
+}
+
+void HeatingElement::cancelAutotune()
+{
+    portENTER_CRITICAL(&requestMux);
+    requestedAutotune = NAN;
+    cancelRequested = true;
+    portEXIT_CRITICAL(&requestMux);
+}
+
+PidGains HeatingElement::getPidGains() const
+{
+    portENTER_CRITICAL(&requestMux);
+    PidGains gains = publishedGains;
+    portEXIT_CRITICAL(&requestMux);
+    return gains;
+}
+
+PidAutotuner::State HeatingElement::getAutotuneState() const
+{
+    portENTER_CRITICAL(&requestMux);
+    PidAutotuner::State result = publishedAutotune;
+    portEXIT_CRITICAL(&requestMux);
+    return result;
+}
+
+void HeatingElement::update()
+{
+    METRICS_SCOPE("heater.update");
+    applyRequests();
+    {
+        METRICS_SCOPE("sensor.read");
+        pollSensor(0, sensor);
+    }
+    addTemperatureReading(sensor.temperature);
+
+    if (tempSensor->channelCount() > 1)
+        pollSensor(1, probe);
+}
+
+void HeatingElement::pollSensor(uint8_t channel, SensorChannel &state)
+{
+    ITemperatureSensor::Sample samples[SENSOR_BATCH_MAX];
+    ITemperatureSensor::Batch batch = tempSensor->poll(channel, samples, SENSOR_BATCH_MAX);
+    uint32_t now = millis();
+    state.dropped = batch.dropped;
+
+    bool failed = true;
+    switch (batch.status)
+    {
+    case ITemperatureSensor::FAULT:
+        // Samples of a faulted batch are not trusted; clearing rearms the channel
+        if (!state.failed)
+            logMessagef(LogLevel::ERROR, "[HeatingElement] Sensor channel %u fault: 0x%02X", channel, batch.faultCode);
+        tempSensor->clearFault(channel);
+        break;
+    case ITemperatureSensor::UNAVAILABLE:
+        if (!state.failed)
+            logMessagef(LogLevel::ERROR, "[HeatingElement] Sensor channel %u unavailable", channel);
+        break;
+    case ITemperatureSensor::NO_DATA:
+        // A failed channel stays failed until it delivers samples again
+        failed = state.failed || now - state.lastSampleMs > SENSOR_STALE_MS;
+        if (failed && !state.failed)
+            logMessagef(LogLevel::ERROR, "[HeatingElement] Sensor channel %u silent for %lu ms", channel,
+                        (unsigned long)(now - state.lastSampleMs));
+        break;
+    case ITemperatureSensor::OK:
+    {
+        float sum = 0.0f;
+        for (size_t i = 0; i < batch.count; i++)
+            sum += samples[i].temperature;
+        state.temperature = sum / batch.count;
+        state.lastSampleMs = now;
+        if (state.failed)
+            logMessagef(LogLevel::INFO, "[HeatingElement] Sensor channel %u recovered", channel);
+        failed = false;
+        break;
+    }
+    }
+
+    state.failed = failed;
+    if (failed)
+        state.temperature = NAN;
+}
+
+void HeatingElement::start()
+{
+    if (fault || enabled)
+        return;
+    // The next control step resets the PID history and starts a fresh window
+    pidArmed = false;
+    enabled = true;
+    logMessage(LogLevel::INFO, "[HeatingElement] Starting heater");
+}
+
+void HeatingElement::stop()
+{
+    if (enabled)
+        logMessage(LogLevel::INFO, "[HeatingElement] Stopping heater");
+    enabled = false;
+    setRelay(false);
+}
+
+void HeatingElement::addTemperatureReading(float temp)
+{
+    rawTemp = temp;
+    float previousTemp = currentTemp;
+    // NAN (no reading) bypasses the filter so a dead sensor stays visible
+    currentTemp = (tempFilter && !isnan(temp)) ? tempFilter->apply(temp) : temp;
+    triggerIfChanged(onTemperatureChanged, previousTemp, currentTemp);
+    checkOverTemperature();
+    // The relay state still is the one applied since the previous reading
+    plant.update(currentTemp, relayOn, millis());
+    control();
+    trackRamp();
+    checkTargetReached();
+}
+
+void HeatingElement::setTargetTemperature(float target, float tolerance)
+{
+    targetTemp = target;
+    targetTolerance = tolerance;
+    targetTempSet = true;
+    targetReachedTriggered = false;
+}
+
+void HeatingElement::clearTargetTemperature()
+{
+    targetTempSet = false;
+    targetReachedTriggered = false;
+}
+
+void HeatingElement::setSetpointRate(float ratePerS)
+{
+    setpointRate = ratePerS;
+}
+
+void HeatingElement::trackRamp()
+{
+    const bool ramp = enabled && targetTempSet && setpointRate != 0.0f && !isnan(currentTemp);
+    if (ramp && !ramping)
+    {
+        tracking.samples = 0;
+        tracking.maxError = 0.0f;
+        rampErrorSq = 0.0f;
+    }
+    ramping = ramp;
+    if (ramp)
+    {
+        tracking.error = targetTemp - currentTemp;
+        tracking.samples++;
+        rampErrorSq += tracking.error * tracking.error;
+        tracking.rmsError = sqrtf(rampErrorSq / tracking.samples);
+        tracking.maxError = max(tracking.maxError, fabsf(tracking.error));
+    }
+    tracking.modelValid = plant.isValid();
+    tracking.gain = plant.getGain();
+    tracking.timeConstant = plant.getTimeConstant();
+    tracking.ambient = plant.getAmbient();
+
+    portENTER_CRITICAL(&requestMux);
+    publishedTracking = tracking;
+    portEXIT_CRITICAL(&requestMux);
+}
+
+HeatingElement::RampTracking HeatingElement::getRampTracking() const
+{
+    portENTER_CRITICAL(&requestMux);
+    RampTracking result = publishedTracking;
+    portEXIT_CRITICAL(&requestMux);
+    return result;
+}
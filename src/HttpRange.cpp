@@ -0,0 +1,50 @@
+#include "utilities/HttpRange.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace HttpRange {
+
+    static const char *skipSpace(const char *s)
+    {
+        while (isspace((unsigned char)*s))
+            s++;
+        return s;
+    }
+
+    bool parse(const char *header, size_t size, size_t &start, size_t &length)
+    {
+        if (!header || strncmp(header, "bytes=", 6) != 0 || strchr(header, ',') || size == 0)
+            return false;
+
+        const char *first = skipSpace(header + 6);
+        const char *dash = strchr(first, '-');
+        if (!dash)
+            return false;
+
+        const char *last = skipSpace(dash + 1);
+        if (dash == first)
+        {
+            // Suffix range: the last N bytes
+            size_t suffix = strtoul(last, nullptr, 10);
+            if (suffix == 0)
+                return false;
+            start = suffix >= size ? 0 : size - suffix;
+            length = size - start;
+            return true;
+        }
+
+        size_t end = size - 1;
+        start = strtoul(first, nullptr, 10);
+        if (*last)
+        {
+            size_t requested = strtoul(last, nullptr, 10);
+            if (requested < end)
+                end = requested;
+        }
+        if (start > end)
+            return false;
+        length = end - start + 1;
+        return true;
+    }
+}
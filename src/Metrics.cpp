@@ -0,0 +1,119 @@
+#include "utilities/Metrics.h"
+
+Metrics &Metrics::getInstance()
+{
+    static Metrics instance;
+    return instance;
+}
+
+Metrics::Section *Metrics::section(const char *name)
+{
+    Section *found = nullptr;
+    portENTER_CRITICAL(&mux);
+    for (int i = 0; i < sectionCount; i++)
+    {
+        if (strcmp(sections[i].name, name) == 0)
+        {
+            found = &sections[i];
+            break;
+        }
+    }
+    if (!found && sectionCount < METRICS_MAX_SECTIONS)
+    {
+        found = &sections[sectionCount++];
+        found->name = name;
+    }
+    portEXIT_CRITICAL(&mux);
+    return found;
+}
+
+int Metrics::bucketOf(uint32_t cycles)
+{
+    // Values below 4 get a bucket each; above that, 4 buckets per power of two
+    if (cycles < 4)
+        return cycles;
+    int msb = 31 - __builtin_clz(cycles);
+    return (msb - 1) * 4 + ((cycles >> (msb - 2)) & 3);
+}
+
+uint32_t Metrics::bucketUpperBound(int bucket)
+{
+    if (bucket < 4)
+        return bucket;
+    if (bucket >= BUCKETS - 1)
+        return UINT32_MAX;
+    int next = bucket + 1;
+    int msb = next / 4 + 1;
+    return ((uint32_t)(4 + next % 4) << (msb - 2)) - 1;
+}
+
+void Metrics::record(Section *section, uint32_t cycles)
+{
+    int bucket = bucketOf(cycles);
+    portENTER_CRITICAL(&mux);
+    section->count++;
+    section->totalCycles += cycles;
+    if (cycles < section->minCycles)
+        section->minCycles = cycles;
+    if (cycles > section->maxCycles)
+        section->maxCycles = cycles;
+    section->buckets[bucket]++;
+    portEXIT_CRITICAL(&mux);
+}
+
+void Metrics::reset()
+{
+    portENTER_CRITICAL(&mux);
+    for (int i = 0; i < sectionCount; i++)
+    {
+        const char *name = sections[i].name;
+        sections[i] = Section();
+        sections[i].name = name;
+    }
+    portEXIT_CRITICAL(&mux);
+}
+
+void Metrics::writeJson(JsonArray out)
+{
+    const float cyclesPerUs = getCpuFrequencyMhz();
+    static Section snapshot; // Readers run in the AsyncTCP task only
+
+    for (int i = 0;; i++)
+    {
+        portENTER_CRITICAL(&mux);
+        if (i >= sectionCount)
+        {
+            portEXIT_CRITICAL(&mux);
+            break;
+        }
+        snapshot = sections[i];
+        portEXIT_CRITICAL(&mux);
+
+        // p99: smallest bucket bound with at least 99% of the samples at or below it
+        uint32_t p99 = 0;
+        if (snapshot.count)
+        {
+            uint32_t threshold = snapshot.count - snapshot.count / 100;
+            uint32_t seen = 0;
+            for (int b = 0; b < BUCKETS; b++)
+            {
+                seen += snapshot.buckets[b];
+                if (seen >= threshold)
+                {
+                    p99 = bucketUpperBound(b);
+                    break;
+                }
+            }
+            if (p99 > snapshot.maxCycles)
+                p99 = snapshot.maxCycles;
+        }
+
+        JsonObject obj = out.createNestedObject();
+        obj["name"] = snapshot.name;
+        obj["count"] = snapshot.count;
+        obj["minUs"] = snapshot.count ? snapshot.minCycles / cyclesPerUs : 0;
+        obj["avgUs"] = snapshot.count ? (float)(snapshot.totalCycles / snapshot.count) / cyclesPerUs : 0;
+        obj["maxUs"] = snapshot.maxCycles / cyclesPerUs;
+        obj["p99Us"] = p99 / cyclesPerUs;
+    }
+}
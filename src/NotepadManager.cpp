@@ -3,6 +3,10 @@
 #include <ArduinoJson.h>
 #include "managers/NotepadManager.h"
 #include "utilities/SerialRemote.h"
+
+static constexpr char NOTE_EXTENSION[] = ".txt";
+static constexpr size_t NOTE_PATH_MAX = sizeof(NOTES_DIR) + NOTE_NAME_MAX + sizeof(NOTE_EXTENSION);
+
 // Singleton instance getter
 NotepadManager &NotepadManager::getInstance()
 {
@@ -10,129 +14,175 @@ NotepadManager &NotepadManager::getInstance()
     return instance;
 }
 
-NotepadManager::NotepadManager()
+NotepadManager::NotepadManager() {}
+
+// Scan the notes directory once; afterwards the index is maintained by saveNote()
+bool NotepadManager::begin()
 {
-    // Ensure LittleFS is mounted (should already be done, but safe)
-    if (!LittleFS.begin(true))
+    if (!LittleFS.exists(NOTES_DIR) && !LittleFS.mkdir(NOTES_DIR))
     {
-        logMessagef(LogLevel::ERROR, "[NotepadManager] Failed to mount LittleFS");
+        logMessagef(LogLevel::ERROR, "[NotepadManager] Failed to create %s", NOTES_DIR);
+        return false;
     }
-}
 
-// List all saved note filenames (without extension) into the JSON array "experiments"
-void NotepadManager::listNotes(JsonArray &arr)
-{
-    logMessagef(LogLevel::INFO, "[NotepadManager] listNotes() called");
-
-    // Open the root directory
-    File root = LittleFS.open("/");
-    if (!root || !root.isDirectory())
+    File dir = LittleFS.open(NOTES_DIR);
+    if (!dir || !dir.isDirectory())
     {
-        Serial.println(F("[NotepadManager] Failed to open or invalid root directory"));
-        return;
+        logMessagef(LogLevel::ERROR, "[NotepadManager] %s is not a directory", NOTES_DIR);
+        return false;
     }
 
-    logMessagef(LogLevel::INFO, "[NotepadManager] Opened root directory, scanning files...");
-
-    int fileCount = 0;
-    int noteCount = 0;
-
-    // Iterate through all files in the root directory
-    File file = root.openNextFile();
-    while (file)
+    noteCount = 0;
+    int skipped = 0;
+    for (File file = dir.openNextFile(); file; file = dir.openNextFile())
     {
-        fileCount++;
-
-        if (file.isDirectory())
+        // Short name: strip the directory (older cores return the full path) and the extension
+        const char *name = strrchr(file.name(), '/');
+        name = name ? name + 1 : file.name();
+        size_t nameLen = strlen(name);
+        const size_t extLen = sizeof(NOTE_EXTENSION) - 1;
+
+        if (file.isDirectory() || nameLen <= extLen || strcmp(name + nameLen - extLen, NOTE_EXTENSION) != 0 ||
+            nameLen - extLen >= NOTE_NAME_MAX || noteCount >= NOTES_MAX)
         {
-            Serial.printf("[NotepadManager] Skipping directory: %s\n", file.name());
+            skipped++;
+            continue;
         }
-        else
+        NoteEntry &entry = notes[noteCount];
+        memcpy(entry.name, name, nameLen - extLen);
+        entry.name[nameLen - extLen] = '\0';
+        if (!isValidName(entry.name))
         {
-            String name = file.name();
-            Serial.printf("[NotepadManager] Found file: %s\n", name.c_str());
-
-            // Check if the file is a JSON file
-            if (name.endsWith(".json"))
-            {
-                // Strip leading '/' and '.json' extension
-                String expName = name.substring(0, name.length() - 5);
-                arr.add(expName);
-                noteCount++;
-                Serial.printf("[NotepadManager] Added note: %s\n", expName.c_str());
-            }
-            else
-            {
-                Serial.printf("[NotepadManager] Skipped non-json file: %s\n", name.c_str());
-            }
+            skipped++;
+            continue;
         }
+        entry.size = file.size();
+        noteCount++;
+    }
+    dir.close();
 
-        file = root.openNextFile();
+    logMessagef(LogLevel::INFO, "[NotepadManager] %d notes indexed (%d files skipped)", noteCount, skipped);
+    return true;
+}
+
+// List note names from the index
+void NotepadManager::listNotes(JsonArray &arr)
+{
+    for (int i = 0; i < noteCount; i++)
+        arr.add((const char *)notes[i].name);
+}
+
+int NotepadManager::loadNote(const char *experiment, size_t offset, char *out, size_t maxLen, size_t &total)
+{
+    int slot = find(experiment);
+    if (slot < 0)
+        return -1;
+
+    total = notes[slot].size;
+    if (offset >= total || maxLen == 0)
+        return 0;
+
+    char path[NOTE_PATH_MAX];
+    notePath(experiment, path, sizeof(path));
+    File file = LittleFS.open(path, "r");
+    if (!file)
+    {
+        logMessagef(LogLevel::ERROR, "[NotepadManager] Failed to open %s", path);
+        return -1;
     }
+    if (offset > 0)
+        file.seek(offset);
+    size_t len = file.read(reinterpret_cast<uint8_t *>(out), min(maxLen, total - offset));
+    file.close();
 
-    Serial.printf("[NotepadManager] Scan complete. Total files: %d, Notes found: %d\n", fileCount, noteCount);
+    // Do not split a multi-byte character: the chunk is sent as a JSON string
+    if (offset + len < total && len > 0)
+    {
+        size_t lead = len - 1;
+        while (lead > 0 && (out[lead] & 0xC0) == 0x80)
+            lead--;
+        uint8_t c = out[lead];
+        size_t seqLen = c < 0x80 ? 1 : c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+        if (lead + seqLen > len && lead > 0)
+            len = lead;
+    }
+    return (int)len;
 }
 
-// Load a note by experiment name into the provided string, returns true on success
-bool NotepadManager::loadNote(const String &experiment, String &outNotes)
+bool NotepadManager::saveNote(const char *experiment, size_t offset, const char *data, size_t len)
 {
-    // Construct the file path for the note
-    String path = "/" + experiment + ".json";
-    Serial.printf("[NotepadManager] Attempting to load note from path: %s\n", path.c_str());
+    if (!isValidName(experiment))
+        return false;
 
-    // Check if the file exists
-    if (!LittleFS.exists(path))
+    int slot = find(experiment);
+    size_t current = slot < 0 ? 0 : notes[slot].size;
+    if (offset != 0 && offset != current)
+        return false;
+    if (slot < 0 && noteCount >= NOTES_MAX)
     {
-        Serial.printf("[NotepadManager] Note file does NOT exist: %s\n", path.c_str());
+        logMessagef(LogLevel::ERROR, "[NotepadManager] Index full (%d notes)", NOTES_MAX);
         return false;
     }
 
-    // Open the file for reading
-    File file = LittleFS.open(path, "r");
+    char path[NOTE_PATH_MAX];
+    notePath(experiment, path, sizeof(path));
+    File file = LittleFS.open(path, offset == 0 ? "w" : "a");
     if (!file)
     {
-        Serial.printf("[NotepadManager] Failed to open note file: %s\n", path.c_str());
+        logMessagef(LogLevel::ERROR, "[NotepadManager] Failed to open %s for writing", path);
         return false;
     }
-
-    Serial.printf("[NotepadManager] Successfully opened note file: %s\n", path.c_str());
-
-    // Read the file content into the output string
-    outNotes = file.readString();
+    size_t written = file.write(reinterpret_cast<const uint8_t *>(data), len);
     file.close();
 
-    Serial.printf("[NotepadManager] Read %u bytes from file %s\n", outNotes.length(), path.c_str());
+    if (slot < 0)
+    {
+        slot = noteCount++;
+        strlcpy(notes[slot].name, experiment, sizeof(notes[slot].name));
+    }
+    notes[slot].size = offset + written;
 
-    // Check if the file content is empty
-    if (outNotes.length() == 0)
+    if (written != len)
     {
-        Serial.printf("[NotepadManager] Note file is empty: %s\n", path.c_str());
+        logMessagef(LogLevel::ERROR, "[NotepadManager] Failed to write full note to %s", path);
         return false;
     }
-
+    logMessagef(LogLevel::DEBUG, "[NotepadManager] Saved %u bytes at %u to %s", (unsigned)len, (unsigned)offset, path);
     return true;
 }
 
-// Save a note for the given experiment name, returns true on success
-bool NotepadManager::saveNote(const String &experiment, const String &notes)
+long NotepadManager::noteSize(const char *experiment) const
 {
-    String path = "/" + experiment + ".json";
+    int slot = find(experiment);
+    return slot < 0 ? -1 : (long)notes[slot].size;
+}
 
-    File file = LittleFS.open(path, "w");
-    if (!file)
-    {
-        Serial.printf("[NotepadManager] Failed to open note file %s for writing\n", path.c_str());
+bool NotepadManager::isValidName(const char *experiment)
+{
+    if (!experiment || experiment[0] == '\0' || experiment[0] == '.')
         return false;
+    size_t len = 0;
+    for (const char *c = experiment; *c; c++, len++)
+    {
+        if (!isalnum((unsigned char)*c) && *c != ' ' && *c != '-' && *c != '_' && *c != '.')
+            return false;
     }
+    return len < NOTE_NAME_MAX;
+}
 
-    size_t written = file.print(notes);
-    file.close();
-
-    if (written != notes.length())
+int NotepadManager::find(const char *experiment) const
+{
+    if (!experiment)
+        return -1;
+    for (int i = 0; i < noteCount; i++)
     {
-        Serial.printf("[NotepadManager] Failed to write full note to %s\n", path.c_str());
-        return false;
+        if (strcmp(notes[i].name, experiment) == 0)
+            return i;
     }
-    Serial.printf("[NotepadManager] Saved note %s (%u bytes)\n", path.c_str(), (unsigned)written);
-    return true;
+    return -1;
+}
+
+void NotepadManager::notePath(const char *experiment, char *out, size_t outLen)
+{
+    snprintf(out, outLen, "%s/%s%s", NOTES_DIR, experiment, NOTE_EXTENSION);
 }
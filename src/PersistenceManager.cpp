@@ -0,0 +1,231 @@
+#include "managers/PersistenceManager.h"
+#include "managers/WebServerManager.h" // For SystemState
+#include "managers/CommandQueue.h"
+#include "utilities/SerialRemote.h"
+#include "utilities/EventLog.h"
+#include <Preferences.h>
+#include <rom/crc.h>
+#include <stddef.h>
+
+static Preferences prefs;
+
+static constexpr uint8_t ALL_FIELDS = PersistenceManager::TEMP_SETPOINT | PersistenceManager::RPM_SETPOINT |
+                                      PersistenceManager::MODE | PersistenceManager::DURATION |
+                                      PersistenceManager::ALERTS;
+
+PersistenceManager &PersistenceManager::getInstance()
+{
+    static PersistenceManager instance;
+    return instance;
+}
+
+uint32_t PersistenceManager::checksum(const Record &record)
+{
+    return crc32_le(0, reinterpret_cast<const uint8_t *>(&record), offsetof(Record, crc));
+}
+
+PersistenceManager::Record PersistenceManager::fromState(const SystemState &state)
+{
+    Record record = {};
+    record.version = RECORD_VERSION;
+    record.mode = (uint8_t)state.mode;
+    record.tempSetpoint = state.tempSetpoint;
+    record.rpmSetpoint = state.rpmSetpoint;
+    record.duration = state.duration;
+    record.alertTempThreshold = state.alertTempThreshold;
+    record.alertRpmThreshold = state.alertRpmThreshold;
+    record.alertTimerThreshold = state.alertTimerThreshold;
+    return record;
+}
+
+uint8_t PersistenceManager::diff(const Record &a, const Record &b)
+{
+    uint8_t fields = 0;
+    if (a.tempSetpoint != b.tempSetpoint)
+        fields |= TEMP_SETPOINT;
+    if (a.rpmSetpoint != b.rpmSetpoint)
+        fields |= RPM_SETPOINT;
+    if (a.mode != b.mode)
+        fields |= MODE;
+    if (a.duration != b.duration)
+        fields |= DURATION;
+    if (a.alertTempThreshold != b.alertTempThreshold || a.alertRpmThreshold != b.alertRpmThreshold ||
+        a.alertTimerThreshold != b.alertTimerThreshold)
+        fields |= ALERTS;
+    return fields;
+}
+
+bool PersistenceManager::begin()
+{
+    if (!writeLock)
+        writeLock = xSemaphoreCreateMutex();
+    opened = prefs.begin(PERSIST_NAMESPACE, false);
+    if (!opened)
+    {
+        logMessage(LogLevel::ERROR, "[Persistence] NVS namespace unavailable - settings will not survive a reset");
+        return false;
+    }
+
+    size_t length = prefs.getBytesLength(PERSIST_KEY);
+    if (length == 0)
+    {
+        logMessage(LogLevel::INFO, "[Persistence] No stored settings, using defaults");
+        return false;
+    }
+
+    Record record;
+    if (length != sizeof(record) || prefs.getBytes(PERSIST_KEY, &record, sizeof(record)) != sizeof(record) ||
+        record.version != RECORD_VERSION || record.crc != checksum(record) ||
+        record.mode >= HeaterModeManager::MODE_COUNT)
+    {
+        logMessagef(LogLevel::ERROR, "[Persistence] Stored settings invalid (%u bytes), using defaults", (unsigned)length);
+        return false;
+    }
+    stored = record;
+    valid = true;
+    return true;
+}
+
+bool PersistenceManager::restore(SystemState &state)
+{
+    if (!valid)
+        return false;
+
+    state.tempSetpoint = stored.tempSetpoint;
+    state.rpmSetpoint = stored.rpmSetpoint;
+    state.duration = stored.duration;
+    state.alertTempThreshold = stored.alertTempThreshold;
+    state.alertRpmThreshold = stored.alertRpmThreshold;
+    state.alertTimerThreshold = stored.alertTimerThreshold;
+
+    // The first state tick forwards the settings to the control core
+    ControlUpdate update;
+    update.fields = ControlUpdate::TEMP_SETPOINT | ControlUpdate::RPM_SETPOINT | ControlUpdate::DURATION;
+    update.tempSetpoint = stored.tempSetpoint;
+    update.rpmSetpoint = stored.rpmSetpoint;
+    update.duration = stored.duration;
+    HeaterModeManager::Mode mode = (HeaterModeManager::Mode)stored.mode;
+    bool resume = mode == HeaterModeManager::HOLD && PERSIST_RESUME_HOLD;
+    if (resume)
+    {
+        update.fields |= ControlUpdate::MODE;
+        update.mode = mode;
+    }
+    CommandQueue::getInstance().submit(update);
+    EventLog::getInstance().record(EventLog::SETTINGS_RESTORED, stored.sequence);
+
+    logMessagef(LogLevel::INFO, "[Persistence] Restored settings #%lu: Temp=%.2f°C, RPM=%d, Mode=%s%s",
+                (unsigned long)stored.sequence, stored.tempSetpoint, (int)stored.rpmSetpoint,
+                HeaterModeManager::modeName(mode),
+                resume || mode == HeaterModeManager::OFF ? "" : " (not resumed)");
+    return true;
+}
+
+void PersistenceManager::track(const SystemState &state)
+{
+    Record record = fromState(state);
+    uint32_t now = millis();
+
+    portENTER_CRITICAL(&mux);
+    // The first state is compared with the stored record once; after that only changes count
+    uint8_t changed = tracking ? diff(record, latest) : ALL_FIELDS;
+    if (changed)
+    {
+        if (dirty)
+            coalesced++;
+        else
+            firstDirtyMs = now;
+        dirty |= changed;
+        lastChangeMs = now;
+        latest = record;
+        tracking = true;
+    }
+    portEXIT_CRITICAL(&mux);
+}
+
+bool PersistenceManager::service()
+{
+    uint32_t now = millis();
+    portENTER_CRITICAL(&mux);
+    bool due = dirty && (now - lastChangeMs >= PERSIST_DEBOUNCE_MS || now - firstDirtyMs >= PERSIST_MAX_LATENCY_MS);
+    portEXIT_CRITICAL(&mux);
+    if (!due || !writeLock || xSemaphoreTake(writeLock, 0) != pdTRUE)
+        return false;
+
+    portENTER_CRITICAL(&mux);
+    Record record = latest;
+    dirty = 0;
+    portEXIT_CRITICAL(&mux);
+
+    bool written = write(record);
+    xSemaphoreGive(writeLock);
+    return written;
+}
+
+bool PersistenceManager::flush()
+{
+    if (!writeLock || xSemaphoreTake(writeLock, pdMS_TO_TICKS(PERSIST_FLUSH_WAIT_MS)) != pdTRUE)
+        return false;
+
+    portENTER_CRITICAL(&mux);
+    bool pending = dirty != 0;
+    Record record = latest;
+    dirty = 0;
+    portEXIT_CRITICAL(&mux);
+
+    bool ok = !pending || write(record) || diff(record, stored) == 0;
+    xSemaphoreGive(writeLock);
+    return ok;
+}
+
+bool PersistenceManager::write(Record record)
+{
+    // A change that was undone before the debounce expired costs no flash write
+    uint8_t fields = valid ? diff(record, stored) : ALL_FIELDS;
+    if (!fields)
+    {
+        unchanged++;
+        return false;
+    }
+
+    record.version = RECORD_VERSION;
+    record.sequence = stored.sequence + 1;
+    record.crc = checksum(record);
+    if (!opened || prefs.putBytes(PERSIST_KEY, &record, sizeof(record)) != sizeof(record))
+    {
+        failures++;
+        logMessage(LogLevel::ERROR, "[Persistence] Failed to store settings");
+        // Try again after the next debounce period
+        uint32_t now = millis();
+        portENTER_CRITICAL(&mux);
+        if (!dirty)
+            firstDirtyMs = now;
+        dirty |= fields;
+        lastChangeMs = now;
+        portEXIT_CRITICAL(&mux);
+        return false;
+    }
+
+    stored = record;
+    valid = true;
+    writes++;
+    lastWriteMs = millis();
+    logMessagef(LogLevel::DEBUG, "[Persistence] Stored settings #%lu (fields 0x%02x)",
+                (unsigned long)record.sequence, fields);
+    return true;
+}
+
+PersistenceManager::Stats PersistenceManager::stats() const
+{
+    Stats out;
+    out.writes = writes;
+    out.failures = failures;
+    out.coalesced = coalesced;
+    out.unchanged = unchanged;
+    out.sequence = stored.sequence;
+    out.lastWriteMs = lastWriteMs;
+    portENTER_CRITICAL(&mux);
+    out.dirty = dirty;
+    portEXIT_CRITICAL(&mux);
+    return out;
+}
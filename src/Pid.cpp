@@ -0,0 +1,173 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+#include "utilities/Pid.h"
+#include "utilities/SerialRemote.h"
+
+// --- PidController ---
+
+void PidController::setGains(const PidGains &newGains)
+{
+    gains = newGains;
+}
+
+void PidController::reset()
+{
+    integral = 0.0f;
+    lastMeasurement = NAN;
+}
+
+float PidController::compute(float setpoint, float measurement, float dt, float feedForward)
+{
+    const float error = setpoint - measurement;
+
+    // Derivative on measurement: no kick when the setpoint steps or ramps
+    float derivative = 0.0f;
+    if (!isnan(lastMeasurement) && dt > 0.0f)
+        derivative = -(measurement - lastMeasurement) / dt;
+    lastMeasurement = measurement;
+
+    const float pd = gains.kp * error + gains.kd * derivative;
+    float candidate = integral + gains.ki * error * dt;
+
+    // Clamping anti-windup: only integrate while the output is not saturated in that direction
+    float output = pd + candidate + feedForward;
+    if ((output > 1.0f && error > 0.0f) || (output < 0.0f && error < 0.0f))
+        candidate = integral;
+    // Integral plus feed-forward stays a valid duty
+    integral = constrain(candidate, -feedForward, 1.0f - feedForward);
+
+    return constrain(pd + integral + feedForward, 0.0f, 1.0f);
+}
+
+// --- TimeProportionalOutput ---
+
+bool TimeProportionalOutput::update(float duty, uint32_t nowMs)
+{
+    if (!started || nowMs - windowStart >= windowMs)
+    {
+        windowStart = started ? windowStart + windowMs * ((nowMs - windowStart) / windowMs) : nowMs;
+        started = true;
+
+        onMs = (uint32_t)(constrain(duty, 0.0f, 1.0f) * windowMs);
+        if (onMs < minSwitchMs)
+            onMs = 0;
+        else if (windowMs - onMs < minSwitchMs)
+            onMs = windowMs;
+    }
+    return nowMs - windowStart < onMs;
+}
+
+// --- PidAutotuner ---
+
+void PidAutotuner::begin(float sp, float hyst, int cyclesToAverage, uint32_t timeout, uint32_t nowMs)
+{
+    setpoint = sp;
+    hysteresis = hyst;
+    cyclesWanted = cyclesToAverage;
+    timeoutMs = timeout;
+    startMs = nowMs;
+    relayOn = true;
+    cycles = 0;
+    cycleMax = -INFINITY;
+    cycleMin = INFINITY;
+    sumPeriodMs = 0.0f;
+    sumAmplitude = 0.0f;
+    state = RUNNING;
+}
+
+bool PidAutotuner::update(float temperature, uint32_t nowMs)
+{
+    if (state != RUNNING)
+        return false;
+
+    if (nowMs - startMs > timeoutMs)
+    {
+        state = FAILED;
+        return false;
+    }
+
+    cycleMax = max(cycleMax, temperature);
+    cycleMin = min(cycleMin, temperature);
+
+    if (relayOn && temperature > setpoint + hysteresis)
+    {
+        relayOn = false;
+    }
+    else if (!relayOn && temperature < setpoint - hysteresis)
+    {
+        relayOn = true;
+        // One full oscillation ends at each off->on switch; the first one is settling
+        if (cycles > 0)
+        {
+            sumPeriodMs += nowMs - lastOnMs;
+            sumAmplitude += (cycleMax - cycleMin) / 2.0f;
+        }
+        cycles++;
+        lastOnMs = nowMs;
+        cycleMax = -INFINITY;
+        cycleMin = INFINITY;
+
+        if (cycles > cyclesWanted)
+        {
+            const float periodS = sumPeriodMs / cyclesWanted / 1000.0f;
+            const float amplitude = sumAmplitude / cyclesWanted;
+            if (amplitude <= 0.0f || periodS <= 0.0f)
+            {
+                state = FAILED;
+                return false;
+            }
+
+            // Relay of amplitude 0.5 around 0.5 duty: Ku = 4d / (pi a)
+            const float ku = 4.0f * 0.5f / ((float)M_PI * amplitude);
+            const float kp = ku / 2.2f;
+            const float ti = 2.2f * periodS;
+            const float td = periodS / 6.3f;
+            result.kp = kp;
+            result.ki = kp / ti;
+            result.kd = kp * td;
+            state = DONE;
+            return false;
+        }
+    }
+    return relayOn;
+}
+
+// --- Persistence ---
+
+bool loadPidGains(const char *path, PidGains &gains)
+{
+    File file = LittleFS.open(path, "r");
+    if (!file)
+        return false;
+
+    StaticJsonDocument<128> doc;
+    DeserializationError err = deserializeJson(doc, file);
+    file.close();
+    if (err || !doc.containsKey("kp") || !doc.containsKey("ki") || !doc.containsKey("kd"))
+    {
+        logMessagef(LogLevel::ERROR, "[PID] Invalid gains file %s", path);
+        return false;
+    }
+    gains.kp = doc["kp"];
+    gains.ki = doc["ki"];
+    gains.kd = doc["kd"];
+    return true;
+}
+
+bool savePidGains(const char *path, const PidGains &gains)
+{
+    File file = LittleFS.open(path, "w");
+    if (!file)
+    {
+        logMessagef(LogLevel::ERROR, "[PID] Failed to open %s for writing", path);
+        return false;
+    }
+    StaticJsonDocument<128> doc;
+    doc["kp"] = gains.kp;
+    doc["ki"] = gains.ki;
+    doc["kd"] = gains.kd;
+    bool ok = serializeJson(doc, file) > 0;
+    file.close();
+    return ok;
+}
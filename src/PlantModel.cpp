@@ -0,0 +1,88 @@
+#include <Arduino.h>
+#include "utilities/PlantModel.h"
+#include "config/Config.h"
+
+void PlantModel::reset()
+{
+    theta[0] = PLANT_DEFAULT_GAIN / PLANT_DEFAULT_TAU_S;
+    theta[1] = 1.0f / PLANT_DEFAULT_TAU_S;
+    theta[2] = PLANT_DEFAULT_AMBIENT / PLANT_DEFAULT_TAU_S;
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            P[i][j] = i == j ? PLANT_RLS_P0 : 0.0f;
+    samples = 0;
+    started = false;
+}
+
+void PlantModel::update(float temperature, bool heating, uint32_t nowMs)
+{
+    if (isnan(temperature))
+    {
+        started = false;
+        return;
+    }
+    if (!started)
+    {
+        started = true;
+        intervalStart = lastMs = nowMs;
+        startTemp = temperature;
+        onMs = 0;
+        return;
+    }
+
+    if (heating)
+        onMs += nowMs - lastMs;
+    lastMs = nowMs;
+
+    uint32_t elapsed = nowMs - intervalStart;
+    if (elapsed < PLANT_SAMPLE_MS)
+        return;
+
+    // Regress the interval's slope on its mean duty and mean temperature
+    const float h = elapsed / 1000.0f;
+    const float y = (temperature - startTemp) / h;
+    const float phi[3] = {(float)onMs / elapsed, -(temperature + startTemp) / 2.0f, 1.0f};
+
+    intervalStart = nowMs;
+    startTemp = temperature;
+    onMs = 0;
+
+    float Pphi[3];
+    float denom = PLANT_FORGETTING;
+    for (int i = 0; i < 3; i++)
+    {
+        Pphi[i] = P[i][0] * phi[0] + P[i][1] * phi[1] + P[i][2] * phi[2];
+        denom += phi[i] * Pphi[i];
+    }
+    const float error = y - (theta[0] * phi[0] + theta[1] * phi[1] + theta[2] * phi[2]);
+
+    float trace = 0.0f;
+    for (int i = 0; i < 3; i++)
+    {
+        theta[i] += Pphi[i] / denom * error;
+        for (int j = 0; j < 3; j++)
+            P[i][j] -= Pphi[i] * Pphi[j] / denom;
+        trace += P[i][i];
+    }
+    // Forgetting inflates P while nothing changes (heater off at ambient);
+    // stop dividing once it is back at its initial size
+    if (trace < 3.0f * PLANT_RLS_P0)
+    {
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                P[i][j] /= PLANT_FORGETTING;
+    }
+    samples++;
+}
+
+bool PlantModel::isValid() const
+{
+    // Time constant between 5 s and 1 h, heating raises the temperature
+    return samples >= PLANT_MIN_SAMPLES && theta[0] > 0.0f && theta[1] > 1.0f / 3600.0f && theta[1] < 1.0f / 5.0f;
+}
+
+float PlantModel::feedForward(float setpoint, float ratePerS) const
+{
+    // Model inverse: u = (dT/dt + b * T - c) / a
+    return constrain((ratePerS + theta[1] * setpoint - theta[2]) / theta[0], 0.0f, 1.0f);
+}
@@ -0,0 +1,243 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "utilities/ProfileEngine.h"
+#include "utilities/SerialRemote.h"
+
+namespace Profile {
+
+    static const Program RECRYSTALLIZATION_PROGRAM = {
+        "Recrystallization",
+        3,
+        {
+            {RAMP_TO, 0, 0, RECRYST_DISSOLVE_TEMP, RECRYST_HEAT_RATE},
+            {SOAK, 0, 0, 0.0f, (float)RECRYST_DISSOLVE_S},
+            {RAMP_TO, 0, 0, RECRYST_END_TEMP, RECRYST_COOL_RATE},
+        },
+    };
+
+    const Program &recrystallization() { return RECRYSTALLIZATION_PROGRAM; }
+
+    const char *validate(const Program &program)
+    {
+        if (program.count == 0 || program.count > PROFILE_MAX_SEGMENTS)
+            return "Profile has no segments or too many";
+
+        for (int i = 0; i < program.count; i++)
+        {
+            const Segment &s = program.segments[i];
+            switch (s.op)
+            {
+            case RAMP_TO:
+                if (!(s.value > 0.0f))
+                    return "Ramp rate must be positive";
+                // fall through
+            case WAIT_TEMP:
+                if (!(s.temperature >= 0.0f && s.temperature <= MAX_TEMP_LIMIT))
+                    return "Segment temperature out of range";
+                if (s.op == WAIT_TEMP && !(s.value > 0.0f))
+                    return "Wait band must be positive";
+                break;
+            case SOAK:
+                if (!(s.value >= 0.0f))
+                    return "Soak time must not be negative";
+                break;
+            case LOOP:
+                // Backward jumps only, so every program ends
+                if (s.target >= i)
+                    return "Loop target must be an earlier segment";
+                break;
+            default:
+                return "Unknown segment op";
+            }
+        }
+        return nullptr;
+    }
+
+    bool isValidName(const char *name)
+    {
+        if (!name || !name[0])
+            return false;
+        size_t len = 0;
+        for (const char *c = name; *c; c++, len++)
+        {
+            if (!isalnum((unsigned char)*c) && *c != '-' && *c != '_')
+                return false;
+        }
+        return len < PROFILE_NAME_MAX;
+    }
+
+    static void profilePath(const char *name, char *out, size_t outLen)
+    {
+        snprintf(out, outLen, "%s/%s.bin", PROFILES_DIR, name);
+    }
+
+    bool load(const char *name, Program &program)
+    {
+        if (name && strcasecmp(name, RECRYSTALLIZATION_PROGRAM.name) == 0)
+        {
+            program = RECRYSTALLIZATION_PROGRAM;
+            return true;
+        }
+        if (!isValidName(name))
+            return false;
+
+        char path[sizeof(PROFILES_DIR) + PROFILE_NAME_MAX + 5];
+        profilePath(name, path, sizeof(path));
+        File file = LittleFS.open(path, "r");
+        if (!file)
+            return false;
+
+        Header header;
+        bool ok = file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) == sizeof(header) &&
+                  header.magic == FILE_MAGIC && header.version == FILE_VERSION &&
+                  header.segmentCount > 0 && header.segmentCount <= PROFILE_MAX_SEGMENTS;
+        if (ok)
+        {
+            size_t bytes = header.segmentCount * sizeof(Segment);
+            ok = file.read(reinterpret_cast<uint8_t *>(program.segments), bytes) == bytes;
+        }
+        file.close();
+
+        if (ok)
+        {
+            strlcpy(program.name, name, sizeof(program.name));
+            program.count = header.segmentCount;
+            ok = validate(program) == nullptr;
+        }
+        if (!ok)
+            logMessagef(LogLevel::ERROR, "[Profile] Invalid profile file %s", path);
+        return ok;
+    }
+
+    bool save(const Program &program)
+    {
+        if (!isValidName(program.name) || validate(program))
+            return false;
+        if (!LittleFS.exists(PROFILES_DIR) && !LittleFS.mkdir(PROFILES_DIR))
+        {
+            logMessagef(LogLevel::ERROR, "[Profile] Failed to create %s", PROFILES_DIR);
+            return false;
+        }
+
+        char path[sizeof(PROFILES_DIR) + PROFILE_NAME_MAX + 5];
+        profilePath(program.name, path, sizeof(path));
+        File file = LittleFS.open(path, "w");
+        if (!file)
+        {
+            logMessagef(LogLevel::ERROR, "[Profile] Failed to open %s for writing", path);
+            return false;
+        }
+
+        Header header = {FILE_MAGIC, FILE_VERSION, program.count, 0};
+        size_t bytes = program.count * sizeof(Segment);
+        bool ok = file.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header)) == sizeof(header) &&
+                  file.write(reinterpret_cast<const uint8_t *>(program.segments), bytes) == bytes;
+        file.close();
+        return ok;
+    }
+}
+
+// --- ProfileEngine ---
+
+void ProfileEngine::start(const Profile::Program &newProgram, float temperature, uint32_t nowMs)
+{
+    program = newProgram;
+    memset(loopArmed, 0, sizeof(loopArmed));
+    setpoint = temperature;
+    running = program.count > 0;
+    enter(0, nowMs);
+}
+
+void ProfileEngine::enter(int segment, uint32_t startMs)
+{
+    index = segment;
+    segmentStart = startMs;
+    rampFrom = setpoint;
+    segmentDuration = 0;
+    if (index >= program.count)
+        return;
+
+    const Profile::Segment &s = program.segments[index];
+    if (s.op == Profile::RAMP_TO)
+        segmentDuration = (uint32_t)(fabsf(s.temperature - rampFrom) / s.value * 60000.0f);
+    else if (s.op == Profile::SOAK)
+        segmentDuration = (uint32_t)(s.value * 1000.0f);
+}
+
+float ProfileEngine::getSetpointRate() const
+{
+    if (!running || index >= program.count || segmentDuration == 0)
+        return 0.0f;
+    const Profile::Segment &s = program.segments[index];
+    if (s.op != Profile::RAMP_TO)
+        return 0.0f;
+    return (s.temperature > rampFrom ? s.value : -s.value) / 60.0f;
+}
+
+bool ProfileEngine::update(float temperature, uint32_t nowMs)
+{
+    if (!running)
+        return false;
+
+    // Zero-length segments and loop jumps are passed in the same tick; the
+    // bound keeps a loop around zero-length segments from spinning
+    for (int steps = 0; steps < 2 * PROFILE_MAX_SEGMENTS; steps++)
+    {
+        if (index >= program.count)
+        {
+            running = false;
+            return false;
+        }
+
+        const Profile::Segment &s = program.segments[index];
+        uint32_t elapsed = nowMs - segmentStart;
+        switch (s.op)
+        {
+        case Profile::RAMP_TO:
+            if (elapsed < segmentDuration)
+            {
+                setpoint = rampFrom + (s.temperature - rampFrom) * ((float)elapsed / segmentDuration);
+                return true;
+            }
+            setpoint = s.temperature;
+            enter(index + 1, segmentStart + segmentDuration);
+            break;
+
+        case Profile::SOAK:
+            if (elapsed < segmentDuration)
+                return true;
+            enter(index + 1, segmentStart + segmentDuration);
+            break;
+
+        case Profile::WAIT_TEMP:
+            setpoint = s.temperature;
+            if (isnan(temperature) || fabsf(temperature - s.temperature) > s.value)
+                return true;
+            enter(index + 1, nowMs);
+            break;
+
+        case Profile::LOOP:
+            if (!loopArmed[index])
+            {
+                loopArmed[index] = true;
+                loopRemaining[index] = s.count;
+            }
+            if (loopRemaining[index] > 0)
+            {
+                loopRemaining[index]--;
+                enter(s.target, segmentStart);
+            }
+            else
+            {
+                loopArmed[index] = false; // re-arm for an enclosing loop
+                enter(index + 1, segmentStart);
+            }
+            break;
+
+        default:
+            running = false;
+            return false;
+        }
+    }
+    return true;
+}
@@ -1,10 +1,98 @@
 #include "utilities/SerialRemote.h"
+#include "config/Config.h"
 #include <stdarg.h>
+#include <atomic>
 #include <WiFi.h> // Add this include
 
 WiFiServer serialServer(23);
 WiFiClient serialClient;
 
+static_assert((LOG_QUEUE_SLOTS & (LOG_QUEUE_SLOTS - 1)) == 0, "LOG_QUEUE_SLOTS must be a power of two");
+
+namespace {
+    /**
+     * @brief One preformatted log message
+     *
+     * seq implements a bounded multi-producer queue (Vyukov): producers claim
+     * a position with a CAS on writePos, format in place and publish by
+     * storing pos + 1; the drain task frees the slot by storing
+     * pos + LOG_QUEUE_SLOTS.
+     */
+    struct LogSlot {
+        std::atomic<uint32_t> seq;
+        LogLevel level;
+        char text[LOG_LINE_MAX];
+    };
+
+    LogSlot slots[LOG_QUEUE_SLOTS];
+    std::atomic<uint32_t> writePos{0};
+    uint32_t readPos = 0;               // Only touched by the drain task
+    std::atomic<uint32_t> dropped{0};
+    std::atomic<TaskHandle_t> drainTask{nullptr}; // Set once the ring is initialised
+
+    const char* levelString(LogLevel level) {
+        switch (level) {
+            case LogLevel::INFO: return "[INFO]";
+            case LogLevel::ERROR: return "[ERROR]";
+            case LogLevel::DEBUG: return "[DEBUG]";
+        }
+        return "";
+    }
+
+    void printLine(LogLevel level, const char* text) {
+        const char* levelStr = levelString(level);
+        Serial.printf("%s %s\n", levelStr, text);
+        if (serialClient && serialClient.connected()) {
+            serialClient.printf("%s %s\n", levelStr, text);
+        }
+    }
+
+    void initSlots() {
+        for (uint32_t i = 0; i < LOG_QUEUE_SLOTS; i++)
+            slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Claim a free slot without blocking
+     * @return LogSlot* Claimed slot (publish with publishSlot), nullptr if the ring is full
+     */
+    LogSlot* claimSlot(uint32_t& pos) {
+        pos = writePos.load(std::memory_order_relaxed);
+        for (;;) {
+            LogSlot& slot = slots[pos & (LOG_QUEUE_SLOTS - 1)];
+            int32_t diff = (int32_t)(slot.seq.load(std::memory_order_acquire) - pos);
+            if (diff == 0) {
+                if (writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    return &slot;
+            } else if (diff < 0) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            } else {
+                pos = writePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void publishSlot(LogSlot* slot, uint32_t pos) {
+        slot->seq.store(pos + 1, std::memory_order_release);
+        xTaskNotifyGive(drainTask.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Print every published message
+     */
+    void drainSlots() {
+        for (;;) {
+            LogSlot& slot = slots[readPos & (LOG_QUEUE_SLOTS - 1)];
+            if (slot.seq.load(std::memory_order_acquire) != readPos + 1)
+                return;
+            printLine(slot.level, slot.text);
+            slot.seq.store(readPos + LOG_QUEUE_SLOTS, std::memory_order_release);
+            readPos++;
+        }
+    }
+}
+
 void setupRemoteSerial(int port) {
     serialServer.begin(port);
     serialServer.setNoDelay(true);
@@ -29,35 +117,61 @@ void handleRemoteSerial() {
     }
 }
 
-void logMessage(LogLevel level, const char* message) {
-    const char* levelStr = "";
-    switch (level) {
-        case LogLevel::INFO: levelStr = "[INFO]"; break;
-        case LogLevel::ERROR: levelStr = "[ERROR]"; break;
-        case LogLevel::DEBUG: levelStr = "[DEBUG]"; break;
-    }
-    String logLine = String(levelStr) + " " + message;
-    Serial.println(logLine);
-    if (serialClient && serialClient.connected()) {
-        serialClient.println(logLine);
+void logWrite(LogLevel level, const char* message) {
+    if (!drainTask.load(std::memory_order_acquire)) {
+        // No drain task yet (early setup) - print synchronously
+        printLine(level, message);
+        return;
     }
+    uint32_t pos;
+    LogSlot* slot = claimSlot(pos);
+    if (!slot) return;
+    slot->level = level;
+    strlcpy(slot->text, message, sizeof(slot->text));
+    publishSlot(slot, pos);
 }
 
-void logMessagef(LogLevel level, const char* fmt, ...) {
-    const char* levelStr = "";
-    switch (level) {
-        case LogLevel::INFO: levelStr = "[INFO]"; break;
-        case LogLevel::ERROR: levelStr = "[ERROR]"; break;
-        case LogLevel::DEBUG: levelStr = "[DEBUG]"; break;
-    }
-    char msgBuf[128];
+void logWritef(LogLevel level, const char* fmt, ...) {
     va_list args;
     va_start(args, fmt);
-    vsnprintf(msgBuf, sizeof(msgBuf), fmt, args);
+    if (!drainTask.load(std::memory_order_acquire)) {
+        char msgBuf[LOG_LINE_MAX];
+        vsnprintf(msgBuf, sizeof(msgBuf), fmt, args);
+        va_end(args);
+        printLine(level, msgBuf);
+        return;
+    }
+    uint32_t pos;
+    LogSlot* slot = claimSlot(pos);
+    if (slot) {
+        slot->level = level;
+        vsnprintf(slot->text, sizeof(slot->text), fmt, args);
+        publishSlot(slot, pos);
+    }
     va_end(args);
-    String logLine = String(levelStr) + " " + msgBuf;
-    Serial.println(logLine);
-    if (serialClient && serialClient.connected()) {
-        serialClient.println(logLine);
+}
+
+uint32_t logDroppedCount() {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+void logDrainTask(void* pvParameters) {
+    initSlots();
+    drainTask.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+
+    uint32_t reportedDrops = 0;
+    while (true) {
+        drainSlots();
+
+        uint32_t drops = logDroppedCount();
+        if (drops != reportedDrops) {
+            char msgBuf[48];
+            snprintf(msgBuf, sizeof(msgBuf), "[Log] %u messages dropped", (unsigned)(drops - reportedDrops));
+            printLine(LogLevel::ERROR, msgBuf);
+            reportedDrops = drops;
+        }
+
+        handleRemoteSerial();
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOG_DRAIN_INTERVAL_MS));
     }
 }
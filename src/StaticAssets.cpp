@@ -0,0 +1,131 @@
+#include "utilities/StaticAssets.h"
+#include <ArduinoJson.h>
+#include "utilities/SerialRemote.h"
+
+bool StaticAssetHandler::begin(fs::FS &filesystem, const char *manifestPath)
+{
+    fs = &filesystem;
+    assetCount = 0;
+
+    File file = filesystem.open(manifestPath, "r");
+    if (!file)
+    {
+        logMessagef(LogLevel::INFO, "[StaticAssets] No manifest %s - serving files as stored", manifestPath);
+        return false;
+    }
+
+    DynamicJsonDocument doc(ASSET_MANIFEST_JSON_CAPACITY);
+    DeserializationError err = deserializeJson(doc, file);
+    file.close();
+    if (err)
+    {
+        logMessagef(LogLevel::ERROR, "[StaticAssets] Invalid manifest: %s", err.c_str());
+        return false;
+    }
+
+    for (JsonPair entry : doc.as<JsonObject>())
+    {
+        const char *path = entry.key().c_str();
+        const char *hash = entry.value()["etag"] | "";
+        if (assetCount >= MAX_STATIC_ASSETS || strlen(path) >= ASSET_PATH_MAX || !*hash || strlen(hash) >= sizeof(Asset::hash))
+        {
+            logMessagef(LogLevel::ERROR, "[StaticAssets] Skipping %s", path);
+            continue;
+        }
+        Asset &asset = assets[assetCount++];
+        strlcpy(asset.path, path, sizeof(asset.path));
+        strlcpy(asset.hash, hash, sizeof(asset.hash));
+        snprintf(asset.etag, sizeof(asset.etag), "\"%s\"", hash);
+        asset.gzip = entry.value()["gz"] | false;
+    }
+
+    logMessagef(LogLevel::INFO, "[StaticAssets] %d assets in manifest", assetCount);
+    return true;
+}
+
+const StaticAssetHandler::Asset *StaticAssetHandler::find(const String &url) const
+{
+    String path = url.endsWith("/") ? url + "index.html" : url;
+    for (int i = 0; i < assetCount; i++)
+    {
+        if (path == assets[i].path)
+            return &assets[i];
+    }
+    return nullptr;
+}
+
+bool StaticAssetHandler::canHandle(AsyncWebServerRequest *request)
+{
+    if (!(request->method() & (HTTP_GET | HTTP_HEAD)) || !find(request->url()))
+        return false;
+    request->addInterestingHeader("If-None-Match");
+    return true;
+}
+
+void StaticAssetHandler::handleRequest(AsyncWebServerRequest *request)
+{
+    const Asset *asset = find(request->url());
+    if (!asset)
+    {
+        request->send(404);
+        return;
+    }
+
+    // Only URLs stamped with the current hash may be cached forever
+    bool versioned = request->hasParam("v") && request->getParam("v")->value() == asset->hash;
+    const char *cacheControl = versioned ? ASSET_CACHE_IMMUTABLE : "no-cache";
+
+    if (request->hasHeader("If-None-Match"))
+    {
+        const String &ifNoneMatch = request->header("If-None-Match");
+        if (ifNoneMatch == "*" || ifNoneMatch.indexOf(asset->etag) >= 0)
+        {
+            AsyncWebServerResponse *response = request->beginResponse(304);
+            response->addHeader("ETag", asset->etag);
+            response->addHeader("Cache-Control", cacheControl);
+            request->send(response);
+            return;
+        }
+    }
+
+    String file = asset->gzip ? String(asset->path) + ".gz" : String(asset->path);
+    AsyncWebServerResponse *response = request->beginResponse(*fs, file, contentType(asset->path));
+    if (asset->gzip)
+        response->addHeader("Content-Encoding", "gzip");
+    response->addHeader("ETag", asset->etag);
+    response->addHeader("Cache-Control", cacheControl);
+    request->send(response);
+}
+
+const char *StaticAssetHandler::contentType(const char *path)
+{
+    static const struct
+    {
+        const char *extension;
+        const char *type;
+    } TYPES[] = {
+        {".html", "text/html"},
+        {".htm", "text/html"},
+        {".css", "text/css"},
+        {".js", "application/javascript"},
+        {".json", "application/json"},
+        {".svg", "image/svg+xml"},
+        {".ttf", "font/ttf"},
+        {".otf", "font/otf"},
+        {".woff2", "font/woff2"},
+        {".ico", "image/x-icon"},
+        {".png", "image/png"},
+        {".txt", "text/plain"},
+    };
+
+    const char *dot = strrchr(path, '.');
+    if (dot)
+    {
+        for (const auto &t : TYPES)
+        {
+            if (strcasecmp(dot, t.extension) == 0)
+                return t.type;
+        }
+    }
+    return "application/octet-stream";
+}
@@ -0,0 +1,120 @@
+#include "hardware/Stirrer.h"
+#include "utilities/SerialRemote.h"
+
+static const pcnt_unit_t TACH_UNIT = static_cast<pcnt_unit_t>(STIRRER_PCNT_UNIT);
+
+Stirrer::Stirrer(uint8_t pwmPin, uint8_t tachPin, uint8_t pulsesPerRev)
+    : pwmPin(pwmPin), tachPin(tachPin), pulsesPerRev(pulsesPerRev > 0 ? pulsesPerRev : 1) {}
+
+bool Stirrer::begin()
+{
+    ledcSetup(STIRRER_PWM_CHANNEL, STIRRER_PWM_FREQ_HZ, STIRRER_PWM_BITS);
+    ledcAttachPin(pwmPin, STIRRER_PWM_CHANNEL);
+    ledcWrite(STIRRER_PWM_CHANNEL, 0);
+
+    // Count rising edges only; the unit restarts at 0 when it reaches the limit
+    pcnt_config_t config = {};
+    config.pulse_gpio_num = tachPin;
+    config.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+    config.lctrl_mode = PCNT_MODE_KEEP;
+    config.hctrl_mode = PCNT_MODE_KEEP;
+    config.pos_mode = PCNT_COUNT_INC;
+    config.neg_mode = PCNT_COUNT_DIS;
+    config.counter_h_lim = STIRRER_PCNT_LIMIT;
+    config.counter_l_lim = 0;
+    config.unit = TACH_UNIT;
+    config.channel = PCNT_CHANNEL_0;
+    if (pcnt_unit_config(&config) != ESP_OK)
+    {
+        logMessage(LogLevel::ERROR, "[Stirrer] Pulse counter unavailable - stirrer disabled");
+        return false;
+    }
+    pcnt_set_filter_value(TACH_UNIT, STIRRER_PCNT_FILTER);
+    pcnt_filter_enable(TACH_UNIT);
+    pcnt_counter_pause(TACH_UNIT);
+    pcnt_counter_clear(TACH_UNIT);
+    pcnt_counter_resume(TACH_UNIT);
+
+    pid.setGains({STIRRER_KP, STIRRER_KI, STIRRER_KD});
+    available = true;
+    logMessagef(LogLevel::INFO, "[Stirrer] PWM on GPIO %u, tachometer on GPIO %u (%u pulses/rev)", pwmPin, tachPin, pulsesPerRev);
+    return true;
+}
+
+uint32_t Stirrer::readPulses()
+{
+    int16_t count = 0;
+    if (pcnt_get_counter_value(TACH_UNIT, &count) != ESP_OK)
+        return 0;
+    int32_t delta = (int32_t)count - lastCount;
+    if (delta < 0)
+        delta += STIRRER_PCNT_LIMIT; // Wrapped at the limit since the last step
+    lastCount = count;
+    return (uint32_t)delta;
+}
+
+void Stirrer::applyDuty(float value)
+{
+    duty = constrain(value, 0.0f, 1.0f);
+    ledcWrite(STIRRER_PWM_CHANNEL, (uint32_t)lroundf(duty * ((1u << STIRRER_PWM_BITS) - 1)));
+}
+
+void Stirrer::setTargetRPM(int value)
+{
+    if (!available)
+        return;
+    if (value > 0)
+        value = constrain(value, STIRRER_MIN_RPM, STIRRER_MAX_RPM);
+    else
+        value = 0;
+
+    // Starting (or restarting after a stall) gives the motor STIRRER_STALL_MS to spin up
+    if (value && (!targetRpm || fault))
+    {
+        pid.reset();
+        lastMovingMs = millis();
+    }
+    fault = false;
+    targetRpm = value;
+}
+
+void Stirrer::update(uint32_t nowMs)
+{
+    if (!available)
+        return;
+
+    totalPulses += readPulses();
+    windowPulses[windowHead] = totalPulses;
+    windowMs[windowHead] = nowMs;
+    windowHead = (windowHead + 1) % STIRRER_RPM_WINDOW;
+    if (windowCount < STIRRER_RPM_WINDOW)
+        windowCount++;
+    uint8_t oldest = (windowHead + STIRRER_RPM_WINDOW - windowCount) % STIRRER_RPM_WINDOW;
+    uint32_t elapsedMs = nowMs - windowMs[oldest];
+    if (elapsedMs > 0)
+        rpm = (totalPulses - windowPulses[oldest]) * 60000.0f / (pulsesPerRev * (float)elapsedMs);
+
+    float dt = lastUpdateMs ? (nowMs - lastUpdateMs) / 1000.0f : HEATER_PERIOD_MS / 1000.0f;
+    lastUpdateMs = nowMs;
+
+    if (!targetRpm || fault)
+    {
+        applyDuty(0.0f);
+        return;
+    }
+
+    if (rpm >= STIRRER_STALL_RPM)
+    {
+        lastMovingMs = nowMs;
+    }
+    else if (nowMs - lastMovingMs >= STIRRER_STALL_MS)
+    {
+        logMessagef(LogLevel::ERROR, "[Stirrer] Stalled at %.0f RPM (duty %.2f) - motor stopped", rpm, duty);
+        fault = true;
+        pid.reset();
+        applyDuty(0.0f);
+        return;
+    }
+
+    applyDuty(pid.compute(targetRpm, rpm, dt, targetRpm / (float)STIRRER_MAX_RPM));
+}
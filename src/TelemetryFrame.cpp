@@ -0,0 +1,73 @@
+#include "utilities/TelemetryFrame.h"
+#include "managers/SystemState.h"
+#include "config/Config.h"
+
+namespace Telemetry {
+
+    uint16_t fieldByName(const char *name)
+    {
+        static const struct
+        {
+            const char *name;
+            uint16_t bit;
+        } FIELDS[] = {
+            {"temperature", FIELD_TEMPERATURE},
+            {"rpm", FIELD_RPM},
+            {"mode", FIELD_MODE},
+            {"temp_setpoint", FIELD_TEMP_SETPOINT},
+            {"rpm_setpoint", FIELD_RPM_SETPOINT},
+            {"duration", FIELD_DURATION},
+            {"alertTempThreshold", FIELD_ALERT_TEMP},
+            {"alertRpmThreshold", FIELD_ALERT_RPM},
+            {"alertTimerThreshold", FIELD_ALERT_TIMER},
+            {"running_time", FIELD_RUNNING_TIME},
+            {"profile", FIELD_PROFILE},
+        };
+        for (const auto &field : FIELDS)
+        {
+            if (strcmp(name, field.name) == 0)
+                return field.bit;
+        }
+        return 0;
+    }
+
+    // Flag a field dirty if it differs (frame members are packed, so pass by value)
+    template <typename T>
+    static T markIfChanged(T previous, T value, uint16_t bit, uint16_t &mask)
+    {
+        if (previous != value)
+            mask |= bit;
+        return value;
+    }
+
+    bool Encoder::update(const SystemState &state, uint32_t runningTime, bool force)
+    {
+        uint16_t mask = 0;
+
+        current.temperature = markIfChanged(current.temperature, state.temperature, FIELD_TEMPERATURE, mask);
+        current.rpm = markIfChanged(current.rpm, (int32_t)state.rpm, FIELD_RPM, mask);
+        current.mode = markIfChanged(current.mode, (uint8_t)state.mode, FIELD_MODE, mask);
+        current.tempSetpoint = markIfChanged(current.tempSetpoint, state.tempSetpoint, FIELD_TEMP_SETPOINT, mask);
+        current.rpmSetpoint = markIfChanged(current.rpmSetpoint, (int32_t)state.rpmSetpoint, FIELD_RPM_SETPOINT, mask);
+        current.duration = markIfChanged(current.duration, (int32_t)state.duration, FIELD_DURATION, mask);
+        current.alertTempThreshold = markIfChanged(current.alertTempThreshold, state.alertTempThreshold, FIELD_ALERT_TEMP, mask);
+        current.alertRpmThreshold = markIfChanged(current.alertRpmThreshold, state.alertRpmThreshold, FIELD_ALERT_RPM, mask);
+        current.alertTimerThreshold = markIfChanged(current.alertTimerThreshold, (int32_t)state.alertTimerThreshold, FIELD_ALERT_TIMER, mask);
+        current.runningTime = markIfChanged(current.runningTime, runningTime, FIELD_RUNNING_TIME, mask);
+        current.profileSegment = markIfChanged(current.profileSegment, (uint8_t)(state.profileSegment < 0 ? 0xFF : state.profileSegment), FIELD_PROFILE, mask);
+        current.profileElapsed = markIfChanged(current.profileElapsed, state.profileElapsed, FIELD_PROFILE, mask);
+
+        if (force || !hasPrevious)
+            mask = FIELD_ALL;
+
+        if (mask == 0)
+            return false;
+
+        current.magic = FRAME_MAGIC;
+        current.version = FRAME_VERSION;
+        current.dirtyMask = mask;
+        current.sequence++;
+        hasPrevious = true;
+        return true;
+    }
+}
@@ -0,0 +1,361 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "managers/TelemetryLog.h"
+#include "utilities/SerialRemote.h"
+#include "utilities/Metrics.h"
+
+namespace {
+    constexpr uint32_t TIER_PERIODS[TelemetryLog::TIER_COUNT] = {1, 10, 60};
+    constexpr const char *TIER_NAMES[TelemetryLog::TIER_COUNT] = {"1s", "10s", "1min"};
+
+    /**
+     * @brief Merges consecutive records so a query fits into maxPoints
+     */
+    struct RecordMerger
+    {
+        TelemetryRecord *out;
+        size_t maxPoints;
+        size_t stride;
+        size_t count = 0;
+        TelemetryRecord cur = {};
+        size_t curCount = 0;
+
+        RecordMerger(TelemetryRecord *out, size_t maxPoints, size_t stride)
+            : out(out), maxPoints(maxPoints), stride(stride ? stride : 1) {}
+
+        void add(const TelemetryRecord &rec)
+        {
+            if (curCount == 0)
+            {
+                cur = rec;
+            }
+            else
+            {
+                cur.minTemp = min(cur.minTemp, rec.minTemp);
+                cur.maxTemp = max(cur.maxTemp, rec.maxTemp);
+                cur.avgTemp += rec.avgTemp;
+            }
+            if (++curCount == stride)
+                emit();
+        }
+
+        void emit()
+        {
+            if (curCount == 0 || count >= maxPoints)
+                return;
+            cur.avgTemp /= curCount;
+            out[count++] = cur;
+            curCount = 0;
+        }
+    };
+}
+
+TelemetryLog &TelemetryLog::getInstance()
+{
+    static TelemetryLog instance;
+    return instance;
+}
+
+uint32_t TelemetryLog::tierPeriod(Tier tier) { return TIER_PERIODS[tier]; }
+const char *TelemetryLog::tierName(Tier tier) { return TIER_NAMES[tier]; }
+
+uint32_t TelemetryLog::now() const { return clockBase + millis() / 1000; }
+
+void TelemetryLog::segmentPath(Tier tier, uint32_t serial, char *out, size_t outSize)
+{
+    snprintf(out, outSize, "%s/%u_%08lu.bin", TLOG_DIR, (unsigned)tier, (unsigned long)serial);
+}
+
+bool TelemetryLog::begin()
+{
+    if (!mutex)
+        mutex = xSemaphoreCreateMutex();
+
+    if (!LittleFS.exists(TLOG_DIR) && !LittleFS.mkdir(TLOG_DIR))
+    {
+        logMessagef(LogLevel::ERROR, "[TelemetryLog] Cannot create %s", TLOG_DIR);
+        return false;
+    }
+
+    File dir = LittleFS.open(TLOG_DIR);
+    if (!dir || !dir.isDirectory())
+    {
+        logMessagef(LogLevel::ERROR, "[TelemetryLog] Cannot open %s", TLOG_DIR);
+        return false;
+    }
+
+    File file = dir.openNextFile();
+    while (file)
+    {
+        // file.name() may or may not include the directory depending on core version
+        const char *name = strrchr(file.name(), '/');
+        name = name ? name + 1 : file.name();
+        unsigned tier = 0;
+        unsigned long serial = 0;
+        if (!file.isDirectory() && sscanf(name, "%u_%lu.bin", &tier, &serial) == 2 && tier < TIER_COUNT)
+            indexSegment((Tier)tier, serial);
+        file = dir.openNextFile();
+    }
+
+    // Read the time bounds of every indexed segment
+    uint32_t newest = 0;
+    for (int t = 0; t < TIER_COUNT; t++)
+    {
+        TierState &ts = tiers[t];
+        for (uint8_t i = 0; i < ts.segmentCount; i++)
+        {
+            Segment &seg = ts.segments[i];
+            char path[40];
+            segmentPath((Tier)t, seg.serial, path, sizeof(path));
+            File f = LittleFS.open(path, "r");
+            if (!f)
+                continue;
+            size_t size = f.size();
+            seg.records = size / sizeof(TelemetryRecord);
+            // A torn write leaves a partial record: never append behind it
+            seg.sealed = (size % sizeof(TelemetryRecord)) != 0 || seg.records >= RECORDS_PER_SEGMENT;
+            TelemetryRecord rec;
+            if (seg.records > 0 && f.read((uint8_t *)&rec, sizeof(rec)) == sizeof(rec))
+                seg.firstTime = rec.time;
+            if (seg.records > 0 && f.seek((seg.records - 1) * sizeof(rec)) && f.read((uint8_t *)&rec, sizeof(rec)) == sizeof(rec))
+                seg.lastTime = rec.time;
+            f.close();
+            newest = max(newest, seg.lastTime);
+        }
+    }
+
+    // Continue the time axis after the newest persisted record
+    clockBase = newest ? newest + 1 : 0;
+    ready = true;
+    logMessagef(LogLevel::INFO, "[TelemetryLog] Ready: %u/%u/%u segments, clock starts at %lu",
+                tiers[TIER_RAW].segmentCount, tiers[TIER_10S].segmentCount, tiers[TIER_1MIN].segmentCount,
+                (unsigned long)clockBase);
+    return true;
+}
+
+void TelemetryLog::indexSegment(Tier tier, uint32_t serial)
+{
+    TierState &ts = tiers[tier];
+    if (ts.segmentCount >= TLOG_MAX_SEGMENTS)
+    {
+        // More files than we can index (retention was lowered): drop the oldest
+        char path[40];
+        uint32_t victim = min(serial, ts.segments[0].serial);
+        segmentPath(tier, victim, path, sizeof(path));
+        LittleFS.remove(path);
+        if (victim == serial)
+            return;
+        memmove(&ts.segments[0], &ts.segments[1], sizeof(Segment) * (ts.segmentCount - 1));
+        ts.segmentCount--;
+    }
+
+    // Insertion sort by serial
+    uint8_t pos = ts.segmentCount;
+    while (pos > 0 && ts.segments[pos - 1].serial > serial)
+    {
+        ts.segments[pos] = ts.segments[pos - 1];
+        pos--;
+    }
+    ts.segments[pos] = Segment{serial, 0, 0, 0, true};
+    ts.segmentCount++;
+}
+
+void TelemetryLog::addSample(float temperature)
+{
+    if (!ready || isnan(temperature))
+        return;
+    METRICS_SCOPE("tlog.addSample");
+
+    uint32_t t = now();
+    if (xSemaphoreTake(mutex, pdMS_TO_TICKS(1000)) != pdTRUE)
+        return;
+
+    pushRecord(TIER_RAW, TelemetryRecord{t, temperature, temperature, temperature});
+    accumulate(TIER_10S, t, temperature);
+    accumulate(TIER_1MIN, t, temperature);
+
+    xSemaphoreGive(mutex);
+}
+
+void TelemetryLog::accumulate(Tier tier, uint32_t time, float temperature)
+{
+    TierState &ts = tiers[tier];
+    uint32_t bucket = time - time % TIER_PERIODS[tier];
+
+    if (ts.accCount > 0 && bucket != ts.accStart)
+    {
+        pushRecord(tier, TelemetryRecord{ts.accStart, ts.accMin, ts.accMax, ts.accSum / ts.accCount});
+        ts.accCount = 0;
+    }
+
+    if (ts.accCount == 0)
+    {
+        ts.accStart = bucket;
+        ts.accMin = ts.accMax = temperature;
+        ts.accSum = 0;
+    }
+    ts.accMin = min(ts.accMin, temperature);
+    ts.accMax = max(ts.accMax, temperature);
+    ts.accSum += temperature;
+    ts.accCount++;
+}
+
+void TelemetryLog::pushRecord(Tier tier, const TelemetryRecord &rec)
+{
+    TierState &ts = tiers[tier];
+    ts.block[ts.blockFill++] = rec;
+    if (ts.blockFill == RECORDS_PER_BLOCK)
+        writeBlock(tier);
+}
+
+bool TelemetryLog::writeBlock(Tier tier)
+{
+    TierState &ts = tiers[tier];
+    if (ts.blockFill == 0)
+        return true;
+
+    Segment *seg = ts.segmentCount ? &ts.segments[ts.segmentCount - 1] : nullptr;
+    if (!seg || seg->sealed || seg->records + ts.blockFill > RECORDS_PER_SEGMENT)
+    {
+        if (seg)
+            seg->sealed = true;
+
+        // Enforce retention before starting a new segment
+        while (ts.segmentCount >= TLOG_SEGMENTS_PER_TIER[tier])
+        {
+            char oldPath[40];
+            segmentPath(tier, ts.segments[0].serial, oldPath, sizeof(oldPath));
+            LittleFS.remove(oldPath);
+            memmove(&ts.segments[0], &ts.segments[1], sizeof(Segment) * (ts.segmentCount - 1));
+            ts.segmentCount--;
+        }
+
+        uint32_t serial = ts.segmentCount ? ts.segments[ts.segmentCount - 1].serial + 1 : 0;
+        seg = &ts.segments[ts.segmentCount++];
+        *seg = Segment{serial, ts.block[0].time, ts.block[0].time, 0, false};
+    }
+
+    char path[40];
+    segmentPath(tier, seg->serial, path, sizeof(path));
+    File f = LittleFS.open(path, "a");
+    if (!f)
+    {
+        logMessagef(LogLevel::ERROR, "[TelemetryLog] Cannot open %s", path);
+        ts.blockFill = 0;
+        return false;
+    }
+    size_t bytes = ts.blockFill * sizeof(TelemetryRecord);
+    size_t written = f.write((const uint8_t *)ts.block, bytes);
+    f.close();
+
+    if (written != bytes)
+    {
+        logMessagef(LogLevel::ERROR, "[TelemetryLog] Short write to %s (%u/%u)", path, (unsigned)written, (unsigned)bytes);
+        seg->records += written / sizeof(TelemetryRecord);
+        seg->sealed = true;
+    }
+    else
+    {
+        seg->records += ts.blockFill;
+    }
+    seg->lastTime = ts.block[ts.blockFill - 1].time;
+    if (seg->records >= RECORDS_PER_SEGMENT)
+        seg->sealed = true;
+    ts.blockFill = 0;
+    return written == bytes;
+}
+
+void TelemetryLog::flush()
+{
+    if (!ready || xSemaphoreTake(mutex, pdMS_TO_TICKS(1000)) != pdTRUE)
+        return;
+    for (int t = 0; t < TIER_COUNT; t++)
+        writeBlock((Tier)t);
+    xSemaphoreGive(mutex);
+}
+
+size_t TelemetryLog::query(uint32_t from, uint32_t to, TelemetryRecord *out, size_t maxPoints, Tier &tier)
+{
+    tier = TIER_COUNT;
+    if (!ready || to < from || maxPoints == 0)
+        return 0;
+    if (xSemaphoreTake(mutex, pdMS_TO_TICKS(500)) != pdTRUE)
+        return 0;
+
+    // Finest tier that both covers the window start and stays within the scan budget
+    uint32_t span = to - from;
+    tier = TIER_1MIN;
+    for (int t = 0; t < TIER_COUNT - 1; t++)
+    {
+        const TierState &ts = tiers[t];
+        uint32_t oldest = ts.segmentCount ? ts.segments[0].firstTime : (ts.blockFill ? ts.block[0].time : UINT32_MAX);
+        if (span / TIER_PERIODS[t] <= (uint32_t)TLOG_MAX_QUERY_RECORDS && oldest <= from)
+        {
+            tier = (Tier)t;
+            break;
+        }
+    }
+
+    TierState &ts = tiers[tier];
+    size_t expected = span / TIER_PERIODS[tier] + 1;
+    RecordMerger merger(out, maxPoints, (expected + maxPoints - 1) / maxPoints);
+
+    TelemetryRecord buf[16];
+    for (uint8_t i = 0; i < ts.segmentCount && merger.count < maxPoints; i++)
+    {
+        const Segment &seg = ts.segments[i];
+        if (seg.records == 0 || seg.lastTime < from || seg.firstTime > to)
+            continue;
+
+        char path[40];
+        segmentPath(tier, seg.serial, path, sizeof(path));
+        File f = LittleFS.open(path, "r");
+        if (!f)
+            continue;
+
+        // Binary search for the first record at or after 'from'
+        uint32_t lo = 0, hi = seg.records;
+        while (lo < hi)
+        {
+            uint32_t mid = (lo + hi) / 2;
+            TelemetryRecord rec;
+            f.seek(mid * sizeof(rec));
+            if (f.read((uint8_t *)&rec, sizeof(rec)) != sizeof(rec))
+                break;
+            if (rec.time < from)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        f.seek(lo * sizeof(TelemetryRecord));
+        bool done = false;
+        while (!done)
+        {
+            size_t n = f.read((uint8_t *)buf, sizeof(buf)) / sizeof(TelemetryRecord);
+            if (n == 0)
+                break;
+            for (size_t k = 0; k < n; k++)
+            {
+                if (buf[k].time > to)
+                {
+                    done = true;
+                    break;
+                }
+                merger.add(buf[k]);
+            }
+        }
+        f.close();
+    }
+
+    // Records still waiting in RAM for their block to fill
+    for (uint16_t k = 0; k < ts.blockFill; k++)
+    {
+        if (ts.block[k].time >= from && ts.block[k].time <= to)
+            merger.add(ts.block[k]);
+    }
+    merger.emit();
+
+    xSemaphoreGive(mutex);
+    return merger.count;
+}
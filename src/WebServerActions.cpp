@@ -3,69 +3,75 @@
 #include "managers/StateManager.h"
 #include "managers/NotepadManager.h"
 #include "utilities/SerialRemote.h"
+#include "utilities/WsResponse.h"
 namespace WebServerActions {
-    void sendAck(AsyncWebSocketClient *client, const String &message)
-    {
-        logMessagef(LogLevel::INFO, "[WebServerActions] Sending ACK: %s", message.c_str());
-        StaticJsonDocument<128> doc;
-        doc["type"] = "ack";
-        doc["message"] = message;
-        String json;
-        serializeJson(doc, json);
-        client->text(json);
-    }
-
-    void sendError(AsyncWebSocketClient *client, const String &error)
-    {
-        logMessagef(LogLevel::ERROR, "[WebServerActions] Sending ERROR: %s", error.c_str());
-        StaticJsonDocument<128> doc;
-        doc["type"] = "error";
-        doc["message"] = error;
-        String json;
-        serializeJson(doc, json);
-        client->text(json);
-    }
-    
-
 void handleControlUpdate(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data) {
-    logMessagef(LogLevel::INFO, "[WebServerActions] handleControlUpdate called");
-    serializeJsonPretty(data, Serial);
-    Serial.println();
+    logMessage(LogLevel::DEBUG, "[WebServerActions] handleControlUpdate called");
     mgr->handleControlUpdate(client, data);
 }
 void handleGetHistory(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data) {
-    logMessagef(LogLevel::INFO, "[WebServerActions] handleGetHistory called");
-    serializeJsonPretty(data, Serial);
-    Serial.println();
+    logMessage(LogLevel::DEBUG, "[WebServerActions] handleGetHistory called");
     mgr->handleGetHistory(client, data);
 }
 void handleNotepadList(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data) {
-    logMessagef(LogLevel::INFO, "[WebServerActions] handleNotepadList called");
-    serializeJsonPretty(data, Serial);
-    Serial.println();
+    logMessage(LogLevel::DEBUG, "[WebServerActions] handleNotepadList called");
     mgr->handleNotepadList(client, data);
 }
 void handleNotepadLoad(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data) {
-    logMessagef(LogLevel::INFO, "[WebServerActions] handleNotepadLoad called");
-    serializeJsonPretty(data, Serial);
-    Serial.println();
+    logMessage(LogLevel::DEBUG, "[WebServerActions] handleNotepadLoad called");
     if (!data.isNull())
     {
-        logMessagef(LogLevel::INFO, "[WebServerActions] notepadLoad: data field present");
         mgr->handleNotepadLoad(client, data);
     }
     else
     {
-        logMessagef(LogLevel::INFO, "[WebServerActions] notepadLoad: data field MISSING");
-        sendError(client, "Missing 'data' field for notepadLoad");
+        WsResponse::sendError(client, "Missing 'data' field for notepadLoad");
     }
 }
 void handleNotepadSave(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data) {
-    logMessagef(LogLevel::INFO, "[WebServerActions] handleNotepadSave called");
-    serializeJsonPretty(data, Serial);
-    Serial.println();
+    logMessage(LogLevel::DEBUG, "[WebServerActions] handleNotepadSave called");
     mgr->handleNotepadSave(client, data);
 }
+void handleTelemetryFormat(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data) {
+    logMessage(LogLevel::DEBUG, "[WebServerActions] handleTelemetryFormat called");
+    mgr->handleTelemetryFormat(client, data);
+}
+void handleSubscribe(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data) {
+    logMessage(LogLevel::DEBUG, "[WebServerActions] handleSubscribe called");
+    mgr->handleSubscribe(client, data);
+}
+void handleGetMetrics(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data) {
+    logMessage(LogLevel::DEBUG, "[WebServerActions] handleGetMetrics called");
+    mgr->handleGetMetrics(client, data);
+}
+void handlePidAutotune(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data) {
+    logMessage(LogLevel::DEBUG, "[WebServerActions] handlePidAutotune called");
+    mgr->handlePidAutotune(client, data);
+}
+void handleSetPidGains(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data) {
+    logMessage(LogLevel::DEBUG, "[WebServerActions] handleSetPidGains called");
+    mgr->handleSetPidGains(client, data);
+}
+void handleProfileSave(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data) {
+    logMessage(LogLevel::DEBUG, "[WebServerActions] handleProfileSave called");
+    mgr->handleProfileSave(client, data);
+}
+void handleProfileRun(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data) {
+    logMessage(LogLevel::DEBUG, "[WebServerActions] handleProfileRun called");
+    mgr->handleProfileRun(client, data);
+}
+void handleGetConfig(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data) {
+    logMessage(LogLevel::DEBUG, "[WebServerActions] handleGetConfig called");
+    mgr->handleGetConfig(client, data);
+}
+void handleResetSystem(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data) {
+    logMessage(LogLevel::DEBUG, "[WebServerActions] handleResetSystem called");
+    mgr->handleResetSystem(client, data);
+}
+void handleUpdateState(WebServerManager* mgr, AsyncWebSocketClient* client, JsonVariant data) {
+    logMessage(LogLevel::DEBUG, "[WebServerActions] handleUpdateState called");
+    mgr->handleUpdateState(client, data);
+}
 
 
 }
\ No newline at end of file
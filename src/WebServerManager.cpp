@@ -12,19 +12,37 @@
 #include "utilities/WebServerActions.h"
 #include "utilities/SerialRemote.h"
 #include "managers/StateManager.h"
+#include "managers/TelemetryLog.h"
+#include "managers/CommandQueue.h"
+#include "managers/FleetManager.h"
+#include "managers/PersistenceManager.h"
+#include "utilities/Metrics.h"
+#include "utilities/WsResponse.h"
+#include "utilities/EventLog.h"
 #include <array>
 // Define the static server members
 AsyncWebServer WebServerManager::server(SERVER_PORT);
 AsyncWebSocket WebServerManager::ws(WEBSOCKET_PATH);
-
-// Define shared state
-SystemState state;
-
-// History buffer as circular buffer
-std::array<HistoryEntry, HISTORY_SIZE> history = {}; // Only define here, declare as extern in header
-std::array<EventEntry, MAX_EVENTS> events = {};
-int historyIndex = 0;
-int eventsCount = 0;
+StaticAssetHandler WebServerManager::assets;
+
+// History buffer as single-producer ring (control task writes, web handlers read)
+HistoryRing<HistoryEntry, HISTORY_SIZE> history;
+
+// Response documents are built on the AsyncTCP task only (HTTP and WebSocket handlers), one at a time:
+// a static arena instead of a 4 KB heap block per request or a large document on that task's stack
+static StaticJsonDocument<RESPONSE_JSON_CAPACITY> responseArena;
+static_assert(RESPONSE_JSON_CAPACITY >= METRICS_JSON_CAPACITY && RESPONSE_JSON_CAPACITY >= FleetManager::JSON_CAPACITY &&
+                  RESPONSE_JSON_CAPACITY >= FleetManager::HISTORY_JSON_CAPACITY,
+              "RESPONSE_JSON_CAPACITY too small");
+
+/**
+ * @brief The response arena, cleared (AsyncTCP task only)
+ */
+static JsonDocument &responseDocument()
+{
+    responseArena.clear();
+    return responseArena;
+}
 
 // Forward declarations of action handlers (must match signature)
 AsyncWebServer &WebServerManager::getServer()
@@ -32,82 +50,40 @@ AsyncWebServer &WebServerManager::getServer()
     return server; // Your internal AsyncWebServer instance
 }
 
-// Action map array and size
-const WebServerManager::ActionMapping WebServerManager::actionMap[] = {
-    {"controlUpdate", [](WebServerManager *mgr, AsyncWebSocketClient *client, JsonVariant data)
-     { WebServerActions::handleControlUpdate(mgr, client, data); }},
-    {"getHistory", [](WebServerManager *mgr, AsyncWebSocketClient *client, JsonVariant data)
-     { WebServerActions::handleGetHistory(mgr, client, data); }},
-    {"notepadList", [](WebServerManager *mgr, AsyncWebSocketClient *client, JsonVariant data)
-     { WebServerActions::handleNotepadList(mgr, client, data); }},
-    {"notepadLoad", [](WebServerManager *mgr, AsyncWebSocketClient *client, JsonVariant data)
-     { WebServerActions::handleNotepadLoad(mgr, client, data); }},
-    {"notepadSave", [](WebServerManager *mgr, AsyncWebSocketClient *client, JsonVariant data)
-     { WebServerActions::handleNotepadSave(mgr, client, data); }},
-    {"getConfig", [](WebServerManager *mgr, AsyncWebSocketClient *client, JsonVariant data) {
-        // Acquire mutex for thread-safe state access
-        bool haveLock = false;
-        if (mgr->stateMutex && xSemaphoreTake(mgr->stateMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-            haveLock = true;
-        }
-        
-        StaticJsonDocument<512> configDoc;
-        configDoc["tempSetpoint"] = state.tempSetpoint;
-        configDoc["rpmSetpoint"] = state.rpmSetpoint;
-        configDoc["alertTempThreshold"] = state.alertTempThreshold;
-        configDoc["alertRpmThreshold"] = state.alertRpmThreshold;
-        configDoc["alertTimerThreshold"] = state.alertTimerThreshold;
-        String configJson;
-        serializeJson(configDoc, configJson);
-        
-        // Release mutex before network operation
-        if (haveLock) {
-            xSemaphoreGive(mgr->stateMutex);
-        }
-        
-        client->text(configJson);
-    }},
-    {"resetSystem", [](WebServerManager *mgr, AsyncWebSocketClient *client, JsonVariant data) {
-        logMessagef(LogLevel::INFO, "[WebServerManager] Resetting system...");
-        ESP.restart();
-    }},
-    {"updateState", [](WebServerManager *mgr, AsyncWebSocketClient *client, JsonVariant json) {
-        if (json.is<JsonObject>()) {
-            JsonObject data = json.as<JsonObject>();
-            if (data.containsKey("temperature") && data.containsKey("rpm") && data.containsKey("mode")) {
-                float temperature = data["temperature"];
-                int rpm = data["rpm"];
-                String mode = data["mode"].as<String>();
-                
-                // Acquire mutex to read setpoints
-                float tempSetpoint = 0;
-                int rpmSetpoint = 0;
-                int duration = 0;
-                if (mgr->stateMutex && xSemaphoreTake(mgr->stateMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                    tempSetpoint = state.tempSetpoint;
-                    rpmSetpoint = state.rpmSetpoint;
-                    duration = state.duration;
-                    xSemaphoreGive(mgr->stateMutex);
-                }
-                
-                StateManager::updateState(temperature, rpm, mode, tempSetpoint, rpmSetpoint, duration, mgr->modeManager, mgr->stateMutex);
-                mgr->notifyClients();
-            } else {
-                mgr->sendError(client, "Incomplete state data");
-            }
-        } else {
-            mgr->sendError(client, "Missing 'data' field for state update");
-        }
-    }}
-};
-const int WebServerManager::actionMapSize = sizeof(WebServerManager::actionMap) / sizeof(WebServerManager::actionMap[0]);
+// Compile-time action lookup: a duplicate hash is a duplicate case label and fails the build.
+// The name is compared once more so an unknown action can never alias a known one.
+#define ACTION(name, handler) \
+    case WebServerActions::actionHash(name): \
+        return strcasecmp(action, name) == 0 ? handler : nullptr;
 
-// Constructor
-WebServerManager::WebServerManager()
+WebServerManager::ActionHandler WebServerManager::findAction(const char *action)
 {
-    initializeModeHandlers();
+    using namespace WebServerActions;
+    switch (actionHash(action))
+    {
+        ACTION("controlUpdate", handleControlUpdate)
+        ACTION("getHistory", handleGetHistory)
+        ACTION("notepadList", handleNotepadList)
+        ACTION("notepadLoad", handleNotepadLoad)
+        ACTION("notepadSave", handleNotepadSave)
+        ACTION("telemetryFormat", handleTelemetryFormat)
+        ACTION("subscribe", handleSubscribe)
+        ACTION("getMetrics", handleGetMetrics)
+        ACTION("getEvents", handleGetEvents)
+        ACTION("pidAutotune", handlePidAutotune)
+        ACTION("setPidGains", handleSetPidGains)
+        ACTION("profileSave", handleProfileSave)
+        ACTION("profileRun", handleProfileRun)
+        ACTION("getConfig", handleGetConfig)
+        ACTION("resetSystem", handleResetSystem)
+        ACTION("updateState", handleUpdateState)
+    default:
+        return nullptr;
+    }
 }
 
+#undef ACTION
+
 // Singleton accessor
 WebServerManager *WebServerManager::instance()
 {
@@ -115,83 +91,64 @@ WebServerManager *WebServerManager::instance()
     return &inst;
 }
 
-// Set state mutex for thread-safe access
-void WebServerManager::setStateMutex(SemaphoreHandle_t mutex)
-{
-    stateMutex = mutex;
-}
-
 // --- Helper methods for WebSocket communication ---
 void WebServerManager::sendAck(AsyncWebSocketClient *client, const String &message)
 {
-    StaticJsonDocument<128> doc;
-    doc["type"] = "ack";
-    doc["message"] = message;
-    String json;
-    serializeJson(doc, json);
-    client->text(json);
+    WsResponse::sendAck(client, message.c_str());
 }
 
 void WebServerManager::sendError(AsyncWebSocketClient *client, const String &error)
 {
-    StaticJsonDocument<128> doc;
-    doc["type"] = "error";
-    doc["message"] = error;
-    String json;
-    serializeJson(doc, json);
-    client->text(json);
-}
-
-void WebServerManager::sendJsonResponse(AsyncWebSocketClient *client, const JsonObject& response) {
-    String jsonString;
-    serializeJson(response, jsonString);
-    if (client && client->status() == WS_CONNECTED) {
-        client->text(jsonString);
-    }
+    WsResponse::sendError(client, error.c_str());
 }
 
 // --- Initialization methods ---
-bool WebServerManager::beginWiFi(const char *ssid, const char *password)
-{
-    Serial.println(F("[WebServerManager] Connecting to WiFi..."));
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(ssid, password);
-
-    unsigned long startAttempt = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - startAttempt < 10000)
-    {
-        delay(500);
-        Serial.print(".");
-    }
-    if (WiFi.status() != WL_CONNECTED)
-    {
-        Serial.println(F("\n[WebServerManager] WiFi connection timeout."));
-        return false;
-    }
-
-    Serial.println();
-    Serial.printf("[WebServerManager] Connected! IP: %s\n", WiFi.localIP().toString().c_str());
-    return true;
-}
-
-bool WebServerManager::beginFileSystem()
-{
-    if (!LittleFS.begin(true))
-    {
-        Serial.println(F("[WebServerManager] Failed to mount LittleFS!"));
-        return false;
-    }
-    Serial.println(F("[WebServerManager] File system mounted."));
-    return true;
-}
-
 void WebServerManager::beginServer()
 {
-    server.serveStatic("/", LittleFS, "/").setDefaultFile("index.html");
+    // Manifest assets (gzip, ETag, long-lived caching) first; anything else,
+    // e.g. files uploaded through the explorer, falls through to serveStatic
+    assets.begin(LittleFS, ASSET_MANIFEST_PATH);
+    server.addHandler(&assets);
+    server.serveStatic("/", LittleFS, "/").setDefaultFile("index.html").setCacheControl("no-cache");
 
     ws.onEvent(onWsEventStatic);
     server.addHandler(&ws);
 
+    server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request)
+              {
+        WebServerManager *mgr = WebServerManager::instance();
+        JsonDocument &doc = responseDocument();
+        mgr->buildMetrics(doc);
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        serializeJson(doc, *response);
+        if (request->hasParam("reset"))
+            mgr->resetMetrics();
+        request->send(response); });
+
+    // Combined fleet view (peers are only tracked in the collector role); ?name= returns one plate's history
+    server.on("/fleet.json", HTTP_GET, [](AsyncWebServerRequest *request)
+              {
+        FleetManager &fleet = FleetManager::getInstance();
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        if (request->hasParam("name"))
+        {
+            JsonDocument &doc = responseDocument();
+            if (!fleet.writeHistoryJson(request->getParam("name")->value().c_str(), doc))
+            {
+                delete response;
+                request->send(404, "text/plain", "Unknown plate");
+                return;
+            }
+            serializeJson(doc, *response);
+        }
+        else
+        {
+            JsonDocument &doc = responseDocument();
+            fleet.writeJson(doc);
+            serializeJson(doc, *response);
+        }
+        request->send(response); });
+
     server.onNotFound([](AsyncWebServerRequest *request)
                       { request->send(404, "text/plain", "Not Found"); });
 
@@ -199,76 +156,250 @@ void WebServerManager::beginServer()
     Serial.println(F("[WebServerManager] Server started on port 80."));
 }
 
-// Main initialization method
-void WebServerManager::begin(const char *ssid, const char *password)
+// Main initialization method; LittleFS is mounted and the network is up
+void WebServerManager::begin()
 {
-    if (!beginWiFi(ssid, password))
-    {
-        Serial.println(F("[WebServerManager] WiFi connection failed."));
-        return;
-    }
-
-    if (!beginFileSystem())
-    {
-        Serial.println(F("[WebServerManager] File system mount failed."));
-        return;
-    }
-
     beginServer();
-
-    state.startTime = millis();
     Serial.println(F("[WebServerManager] Web server fully initialized."));
 }
 
-void WebServerManager::attachModeManager(HeaterModeManager *manager)
+void WebServerManager::attachControlCore(ControlCore *core)
+{
+    Serial.println(F("[WebServerManager] Control core attached"));
+    control = core;
+}
+
+void WebServerManager::attachTaskManager(TaskManager *manager)
+{
+    taskManager = manager;
+}
+
+void WebServerManager::attachHeater(HeatingElement *element)
 {
-    Serial.println(F("[WebServerManager] Mode manager attached"));
-    modeManager = manager;
+    heater = element;
 }
 
 void WebServerManager::handle()
 {
     ws.cleanupClients();
+    pumpHistoryStreams();
 }
 
 void WebServerManager::notifyClients()
 {
     if (ws.count() == 0)
         return;
+    METRICS_SCOPE("ws.notifyClients");
+
+    // Snapshot the client table so the send loop does not race with connects
+    std::array<WsClientInfo, MAX_WS_CLIENTS> targets;
+    taskENTER_CRITICAL(&clientsMux);
+    targets = clients;
+    taskEXIT_CRITICAL(&clientsMux);
+
+    // Consistent copy of the published state; the state task is never blocked by this
+    SystemState state = StateManager::snapshot();
+
+    uint32_t runningTime = (millis() - state.startTime) / 1000;
+    uint16_t changed = telemetry.update(state, runningTime) ? telemetry.frame().dirtyMask : 0;
+
+    // Decide per client: due for an update, held back (rate or slow client) or idle
+    uint32_t now = millis();
+    bool send[MAX_WS_CLIENTS] = {};
+    int sendCount = 0;
+    int clientCount = 0;
+    bool shareable = true; // Every client gets the same complete message
+    bool anyBinary = false;
+    bool anyJson = false;
+    uint16_t sharedMask = 0;
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        WsClientInfo &c = targets[i];
+        if (c.id == 0)
+            continue;
+        clientCount++;
 
-    // Acquire mutex for thread-safe state access
-    bool haveLock = false;
-    if (stateMutex && xSemaphoreTake(stateMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        haveLock = true;
+        c.pending |= changed;
+        if (c.resync != c.resyncSent)
+            c.pending = Telemetry::FIELD_ALL;
+        uint16_t wanted = c.pending & c.fields;
+        if (!wanted || now - c.lastSentMs < max(c.intervalMs, c.backoffMs))
+        {
+            shareable = false;
+            continue;
+        }
+
+        // Hold frames back instead of growing the AsyncTCP queue; the
+        // pending mask keeps every change for the next frame that goes out
+        AsyncWebSocketClient *client = ws.client(c.id);
+        if (!client || client->status() != WS_CONNECTED)
+        {
+            shareable = false;
+            continue;
+        }
+        if (client->queueIsFull() || client->client()->space() < WS_SLOW_CLIENT_TCP_SPACE)
+        {
+            c.backoffMs = min(max(c.backoffMs * 2, WS_BACKOFF_MIN_MS), WS_BACKOFF_MAX_MS);
+            c.skipped++;
+            shareable = false;
+            continue;
+        }
+        c.backoffMs = c.backoffMs / 2 < WS_BACKOFF_MIN_MS ? 0 : c.backoffMs / 2;
+
+        send[i] = true;
+        sendCount++;
+        anyBinary |= c.binaryTelemetry;
+        anyJson |= !c.binaryTelemetry;
+        if (c.fields != Telemetry::FIELD_ALL || (sharedMask && sharedMask != wanted))
+            shareable = false;
+        sharedMask = wanted;
     }
 
-    DynamicJsonDocument doc(512);
+    if (sendCount > 0)
+    {
+        Telemetry::Frame frame = telemetry.frame();
+        StaticJsonDocument<512> doc;
+        shareable = shareable && sendCount == clientCount && sendCount == (int)ws.count() && !(anyBinary && anyJson);
+
+        if (shareable && anyBinary)
+        {
+            frame.dirtyMask = sharedMask;
+            ws.binaryAll((uint8_t *)&frame, sizeof(frame));
+        }
+        else if (shareable)
+        {
+            // One buffer, queued to every client
+            buildDataUpdate(doc, state, runningTime, Telemetry::FIELD_ALL);
+            WsResponse::broadcast(ws, doc);
+        }
+        else
+        {
+            for (size_t i = 0; i < targets.size(); i++)
+            {
+                const WsClientInfo &c = targets[i];
+                if (!send[i])
+                    continue;
+                if (c.binaryTelemetry)
+                {
+                    frame.dirtyMask = c.pending & c.fields;
+                    ws.binary(c.id, (uint8_t *)&frame, sizeof(frame));
+                }
+                else
+                {
+                    doc.clear();
+                    buildDataUpdate(doc, state, runningTime, c.fields);
+                    WsResponse::send(ws.client(c.id), doc);
+                }
+            }
+        }
+    }
+
+    // Write back only what this task owns; subscriptions may have changed meanwhile
+    taskENTER_CRITICAL(&clientsMux);
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        const WsClientInfo &t = targets[i];
+        WsClientInfo &c = clients[i];
+        if (t.id == 0 || c.id != t.id)
+            continue;
+        c.backoffMs = t.backoffMs;
+        c.skipped = t.skipped;
+        if (send[i])
+        {
+            c.pending = 0;
+            c.lastSentMs = now;
+            c.resyncSent = t.resync;
+        }
+        else
+        {
+            c.pending = t.pending;
+        }
+    }
+    taskEXIT_CRITICAL(&clientsMux);
+
+    if (changed)
+        StateManager::logState(state);
+}
+
+void WebServerManager::buildDataUpdate(JsonDocument &doc, const SystemState &state, uint32_t runningTime, uint16_t fields)
+{
+    using namespace Telemetry;
     doc["type"] = "dataUpdate";
     JsonObject data = doc.createNestedObject("data");
 
-    data["temperature"] = state.temperature;
-    data["rpm"] = state.rpm;
-    data["mode"] = state.mode;
-    data["temp_setpoint"] = state.tempSetpoint;
-    data["rpm_setpoint"] = state.rpmSetpoint;
-    data["duration"] = state.duration;
-    data["alertTempThreshold"] = state.alertTempThreshold;
-    data["alertRpmThreshold"] = state.alertRpmThreshold;
-    data["alertTimerThreshold"] = state.alertTimerThreshold;
-    data["running_time"] = (millis() - state.startTime) / 1000;
-    String json;
-    serializeJson(doc, json);
-    
-    // Release mutex before sending (network I/O should not be done while holding lock)
-    if (haveLock) {
-        xSemaphoreGive(stateMutex);
-        haveLock = false;
-    }
-    
-    ws.textAll(json);
-
-    // Log the state after notifying clients (with mutex protection)
-    StateManager::logState(stateMutex);
+    if (fields & FIELD_TEMPERATURE)
+        data["temperature"] = state.temperature;
+    if (fields & FIELD_RPM)
+        data["rpm"] = state.rpm;
+    if (fields & FIELD_MODE)
+        data["mode"] = HeaterModeManager::modeName(state.mode);
+    if (fields & FIELD_TEMP_SETPOINT)
+        data["temp_setpoint"] = state.tempSetpoint;
+    if (fields & FIELD_RPM_SETPOINT)
+        data["rpm_setpoint"] = state.rpmSetpoint;
+    if (fields & FIELD_DURATION)
+        data["duration"] = state.duration;
+    if (fields & FIELD_ALERT_TEMP)
+        data["alertTempThreshold"] = state.alertTempThreshold;
+    if (fields & FIELD_ALERT_RPM)
+        data["alertRpmThreshold"] = state.alertRpmThreshold;
+    if (fields & FIELD_ALERT_TIMER)
+        data["alertTimerThreshold"] = state.alertTimerThreshold;
+    if (fields & FIELD_RUNNING_TIME)
+        data["running_time"] = runningTime;
+    if (fields & FIELD_PROFILE)
+    {
+        data["profile_segment"] = state.profileSegment;
+        data["profile_elapsed"] = state.profileElapsed;
+    }
+}
+
+void WebServerManager::requestFullUpdate(uint32_t id)
+{
+    taskENTER_CRITICAL(&clientsMux);
+    for (WsClientInfo &c : clients)
+    {
+        if (c.id == id)
+            c.resync++;
+    }
+    taskEXIT_CRITICAL(&clientsMux);
+}
+
+// --- Client bookkeeping ---
+void WebServerManager::addClient(uint32_t id)
+{
+    taskENTER_CRITICAL(&clientsMux);
+    for (WsClientInfo &c : clients)
+    {
+        if (c.id == 0)
+        {
+            c = WsClientInfo();
+            c.id = id;
+            c.resync = 1; // Complete update with the next broadcast
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&clientsMux);
+}
+
+void WebServerManager::removeClient(uint32_t id)
+{
+    taskENTER_CRITICAL(&clientsMux);
+    for (WsClientInfo &c : clients)
+    {
+        if (c.id == id)
+        {
+            c = WsClientInfo();
+        }
+    }
+    for (HistoryStream &h : historyStreams)
+    {
+        if (h.clientId == id)
+        {
+            h = HistoryStream();
+        }
+    }
+    taskEXIT_CRITICAL(&clientsMux);
 }
 
 // WebSocket event handlers (static calls instance method)
@@ -285,412 +416,863 @@ void WebServerManager::onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *c
     {
     case WS_EVT_CONNECT:
         Serial.printf("Client %u connected via WebSocket\n", client->id());
-        notifyClients();
+        // Only the new client gets a complete update, with the next broadcast
+        addClient(client->id());
         break;
 
     case WS_EVT_DISCONNECT:
         Serial.printf("Client %u disconnected\n", client->id());
+        removeClient(client->id());
         break;
 
     case WS_EVT_DATA:
-        handleWebSocketMessage(client, data, len); // Restored call to handleWebSocketMessage
+    {
+        // Actions are single-frame text messages; the in-place parse needs the whole payload
+        AwsFrameInfo *info = static_cast<AwsFrameInfo *>(arg);
+        if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT)
+            handleWebSocketMessage(client, data, len);
+        else
+            sendError(client, "Fragmented or binary messages are not supported");
         break;
+    }
 
     default:
         break;
     }
 }
 
-// Improved WebSocket message handler with better error handling
+// Parse a complete text message in place and dispatch it through findAction()
 void WebServerManager::handleWebSocketMessage(AsyncWebSocketClient *client, uint8_t *data, size_t len)
 {
-    if (!modeManager)
+    if (!control)
     {
-        Serial.println(F("[WebServerManager] modeManager is null!"));
-        sendError(client, "Mode manager not attached");
+        logMessage(LogLevel::ERROR, "[WebServerManager] control core is null!");
+        sendError(client, "Control core not attached");
         return;
     }
 
-    StaticJsonDocument<1024> doc;
-    DeserializationError err = deserializeJson(doc, data, len);
+    // Only the AsyncTCP task dispatches messages, so one document is reused.
+    // Zero-copy parse (char* input): strings point into the frame buffer,
+    // which stays valid until the handler returns.
+    static StaticJsonDocument<WS_MESSAGE_JSON_CAPACITY> doc;
+    DeserializationError err = deserializeJson(doc, reinterpret_cast<char *>(data), len);
     if (err)
     {
-        Serial.printf("[WebServerManager] Failed to parse JSON: %s\n", err.c_str());
+        logMessagef(LogLevel::ERROR, "[WebServerManager] Failed to parse JSON: %s", err.c_str());
         sendError(client, "Invalid JSON format");
         return;
     }
 
-    JsonVariant json = doc.as<JsonVariant>();
-    if (json.containsKey("action")) {
-        String action = json["action"].as<String>();
-        Serial.printf("[WebServerManager] Received action: %s\n", action.c_str());
-
-        // Use actionMap for dispatch
-        for (int i = 0; i < actionMapSize; ++i) {
-            if (action.equalsIgnoreCase(actionMap[i].action)) {
-                JsonVariant dataVariant;
-                if (json.containsKey("data")) {
-                    dataVariant = JsonVariant(json["data"]);
-                    Serial.print("[WebServerManager] Data for action: ");
-                    serializeJsonPretty(dataVariant, Serial);
-                } else {
-                    dataVariant = JsonVariant(json);
-                    Serial.println("[WebServerManager] No data provided for action");
+    const char *action = doc["action"];
+    if (!action)
+    {
+        sendError(client, "Missing 'action' field");
+        return;
+    }
 
-                }
-                
-                Serial.print("[WebServerManager] Dispatching action with data: ");
-                serializeJsonPretty(json, Serial);
-                Serial.println();
-                actionMap[i].handler(this, client, dataVariant);
-                return;
-            }
-        }
-        // Unknown action
-        Serial.printf("[WebServerManager] Unknown action: %s\n", action.c_str());
-        String errorMsg = "{\"type\":\"error\",\"message\":\"Unknown action: " + action + "\"}";
-        client->text(errorMsg);
+    ActionHandler handler = findAction(action);
+    if (!handler)
+    {
+        logMessagef(LogLevel::ERROR, "[WebServerManager] Unknown action: %s", action);
+        sendError(client, String("Unknown action: ") + action);
         return;
-    } else {
-        sendError(client, "Missing 'action' field");
+    }
+
+    // Handlers get "data" when present, otherwise the whole message
+    JsonVariant dataVariant = doc["data"];
+    if (dataVariant.isNull())
+        dataVariant = doc.as<JsonVariant>();
+    if (logLevelEnabled(LogLevel::DEBUG))
+    {
+        char dump[LOG_LINE_MAX];
+        serializeJson(dataVariant, dump, sizeof(dump));
+        logMessagef(LogLevel::DEBUG, "[WebServerManager] %s %s", action, dump);
+    }
+    handler(this, client, dataVariant);
+}
+
+// Handles controlUpdate action: queue the fields, the state task applies them once per tick
+void WebServerManager::handleControlUpdate(AsyncWebSocketClient *client, JsonVariant data)
+{
+    if (!data.is<JsonObject>())
+    {
+        sendError(client, "Missing or invalid data field");
         return;
     }
+
+    JsonObject obj = data.as<JsonObject>();
+    ControlUpdate update;
+
+    if (obj.containsKey("temp_setpoint"))
+    {
+        update.tempSetpoint = obj["temp_setpoint"].as<float>();
+        update.fields |= ControlUpdate::TEMP_SETPOINT;
+    }
+
+    if (obj.containsKey("rpm_setpoint"))
+    {
+        update.rpmSetpoint = obj["rpm_setpoint"].as<int>();
+        update.fields |= ControlUpdate::RPM_SETPOINT;
+    }
+
+    if (obj.containsKey("mode"))
+    {
+        if (!HeaterModeManager::parseMode(obj["mode"] | "", update.mode))
+        {
+            sendError(client, "Unknown mode");
+            return;
+        }
+        update.fields |= ControlUpdate::MODE;
+    }
+
+    if (obj.containsKey("duration"))
+    {
+        update.duration = obj["duration"].as<int>();
+        update.fields |= ControlUpdate::DURATION;
+    }
+
+    // No broadcast here: the state task broadcasts once after applying the batch
+    CommandQueue::getInstance().submit(update);
+    sendAck(client, "Update received");
 }
 
-// Initialize mode handlers
-void WebServerManager::initializeModeHandlers()
+// Add a new entry to the history ring (control task is the only producer)
+void WebServerManager::addHistoryEntry(float temperature)
 {
-    // Initialize mode handlers with C-style string constants
-    modeHandlers[Modes::OFF] = [this](const JsonObject &params)
-    { this->handleModeOff(params); };
-    modeHandlers[Modes::HOLD] = [this](const JsonObject &params)
-    { this->handleModeHold(params); };
-    modeHandlers[Modes::RAMP] = [this](const JsonObject &params)
-    { this->handleModeRamp(params); };
-    modeHandlers[Modes::TIMER] = [this](const JsonObject &params)
-    { this->handleModeTimer(params); };
+    HistoryEntry entry;
+    entry.timestamp = millis(); // Store absolute time reference (milliseconds since boot)
+    entry.temperature = temperature;
+    history.push(entry);
 }
 
-// Mode handler implementations
-void WebServerManager::handleModeOff(const JsonObject &params)
+// Handles getHistory action: snapshot the range, the chunks are sent from handle()
+void WebServerManager::handleGetHistory(AsyncWebSocketClient *client, JsonVariant data)
 {
-    if (modeManager)
+    if (data.is<JsonObject>() && (data.containsKey("window") || data.containsKey("from")))
     {
-        modeManager->setOff();
+        handleHistoryRange(client, data.as<JsonObject>());
+        return;
     }
-}
 
-void WebServerManager::handleModeHold(const JsonObject &params)
-{
-    if (modeManager)
+    HistoryStream stream;
+    stream.clientId = client->id();
+    stream.next = history.begin();
+    stream.end = history.end();
+
+    bool registered = false;
+    taskENTER_CRITICAL(&clientsMux);
+    // A repeated request from the same client restarts its stream
+    for (HistoryStream &h : historyStreams)
+    {
+        if (h.clientId == stream.clientId)
+        {
+            h = stream;
+            registered = true;
+            break;
+        }
+    }
+    for (HistoryStream &h : historyStreams)
     {
-        // Acquire mutex for thread-safe state access
-        float tempSetpoint = 0;
-        if (stateMutex && xSemaphoreTake(stateMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-            tempSetpoint = state.tempSetpoint;
-            xSemaphoreGive(stateMutex);
+        if (!registered && h.clientId == 0)
+        {
+            h = stream;
+            registered = true;
         }
-        modeManager->setHold(tempSetpoint);
+    }
+    taskEXIT_CRITICAL(&clientsMux);
+
+    if (!registered)
+    {
+        sendError(client, "History busy, try again");
     }
 }
 
-void WebServerManager::handleModeRamp(const JsonObject &params)
+void WebServerManager::handleHistoryRange(AsyncWebSocketClient *client, JsonObject data)
 {
-    if (!modeManager)
+    // Only called from the AsyncTCP task, so the result buffer can be static
+    static TelemetryRecord records[TLOG_MAX_QUERY_POINTS];
+    static char chunkBuf[HISTORY_CHUNK_ENTRIES * 80 + 128];
+
+    TelemetryLog &log = TelemetryLog::getInstance();
+    uint32_t now = log.now();
+    uint32_t to = data["to"] | now;
+    uint32_t from;
+    if (data.containsKey("window"))
+    {
+        uint32_t window = data["window"];
+        from = window < to ? to - window : 0;
+    }
+    else
+    {
+        from = data["from"] | 0;
+    }
+
+    if (from > to)
+    {
+        sendError(client, "Invalid history range: from is after to");
         return;
+    }
 
-    // Acquire mutex for thread-safe state access
-    float tempSetpoint = 0;
-    if (stateMutex && xSemaphoreTake(stateMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        tempSetpoint = state.tempSetpoint;
-        xSemaphoreGive(stateMutex);
+    TelemetryLog::Tier tier = TelemetryLog::TIER_COUNT;
+    size_t count = log.query(from, to, records, TLOG_MAX_QUERY_POINTS, tier);
+    if (tier == TelemetryLog::TIER_COUNT)
+    {
+        sendError(client, "History unavailable");
+        return;
     }
-    
-    float rampRate = params.containsKey("ramp_rate") ? params["ramp_rate"].as<float>() : 1.0f;
-    modeManager->setRamp(tempSetpoint, rampRate, 9999);
+
+    size_t sent = 0;
+    unsigned chunk = 0;
+    do
+    {
+        if (client->queueIsFull())
+        {
+            sendError(client, "History range truncated: client queue full");
+            return;
+        }
+
+        size_t n = min(count - sent, (size_t)HISTORY_CHUNK_ENTRIES);
+        size_t len = snprintf(chunkBuf, sizeof(chunkBuf),
+                              "{\"type\":\"historyRange\",\"tier\":\"%s\",\"period\":%lu,\"now\":%lu,\"chunk\":%u,\"data\":[",
+                              TelemetryLog::tierName(tier), (unsigned long)TelemetryLog::tierPeriod(tier),
+                              (unsigned long)now, chunk);
+        for (size_t i = 0; i < n && len < sizeof(chunkBuf); i++)
+        {
+            const TelemetryRecord &r = records[sent + i];
+            len += snprintf(chunkBuf + len, sizeof(chunkBuf) - len, "%s{\"t\":%lu,\"min\":%.2f,\"max\":%.2f,\"avg\":%.2f}",
+                            i ? "," : "", (unsigned long)r.time, r.minTemp, r.maxTemp, r.avgTemp);
+        }
+        sent += n;
+        if (len < sizeof(chunkBuf))
+            len += snprintf(chunkBuf + len, sizeof(chunkBuf) - len, "],\"last\":%s}", sent >= count ? "true" : "false");
+        if (len >= sizeof(chunkBuf))
+        {
+            sendError(client, "History range truncated: chunk too large");
+            return;
+        }
+        client->text(ws.makeBuffer((uint8_t *)chunkBuf, len));
+        chunk++;
+    } while (sent < count);
 }
 
-void WebServerManager::handleModeTimer(const JsonObject &params)
+size_t WebServerManager::formatHistoryChunk(HistoryStream &stream, char *out, size_t outSize)
 {
-    if (modeManager)
+    // Entries overwritten since the snapshot are skipped
+    uint32_t oldest = history.begin();
+    if (stream.next < oldest)
+        stream.next = oldest;
+
+    // Room for the closing suffix is kept free; entries that do not fit go into the next chunk
+    const size_t limit = outSize - sizeof("],\"last\":false}");
+    size_t len = snprintf(out, outSize, "{\"type\":\"history\",\"chunk\":%u,\"data\":[", (unsigned)stream.chunk);
+    bool first = true;
+    int count = 0;
+    HistoryEntry entry;
+    while (stream.next < stream.end && count < HISTORY_CHUNK_ENTRIES)
     {
-        // Acquire mutex for thread-safe state access
-        int duration = 0;
-        float tempSetpoint = 0;
-        if (stateMutex && xSemaphoreTake(stateMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-            duration = state.duration;
-            tempSetpoint = state.tempSetpoint;
-            xSemaphoreGive(stateMutex);
+        if (history.read(stream.next, entry) && !isnan(entry.temperature))
+        {
+            size_t n = snprintf(out + len, outSize - len, "%s{\"time\":%lu,\"temperature\":%.2f}",
+                                first ? "" : ",", (unsigned long)entry.timestamp, entry.temperature);
+            // An entry too long even for an empty chunk is dropped, so the stream still advances
+            if (len + n >= limit && !first)
+                break;
+            if (len + n < limit)
+            {
+                len += n;
+                first = false;
+            }
         }
-        modeManager->setTimer(duration, tempSetpoint);
+        stream.next++;
+        count++;
     }
+    len += snprintf(out + len, outSize - len, "],\"last\":%s}", stream.next >= stream.end ? "true" : "false");
+    stream.chunk++;
+    return len;
 }
 
-// Handles controlUpdate action (mostly state and mode updates)
-void WebServerManager::handleControlUpdate(AsyncWebSocketClient *client, JsonVariant data)
+void WebServerManager::pumpHistoryStreams()
 {
-    if (!data.is<JsonObject>())
+    // ~40 bytes per entry plus envelope; only used from the web task
+    static char chunkBuf[HISTORY_CHUNK_ENTRIES * 48 + 96];
+    constexpr int MAX_CHUNKS_PER_PUMP = 4;
+
+    for (size_t slot = 0; slot < historyStreams.size(); slot++)
     {
-        sendError(client, "Missing or invalid data field");
-        return;
+        for (int n = 0; n < MAX_CHUNKS_PER_PUMP; n++)
+        {
+            HistoryStream stream;
+            taskENTER_CRITICAL(&clientsMux);
+            stream = historyStreams[slot];
+            taskEXIT_CRITICAL(&clientsMux);
+            if (stream.clientId == 0)
+                break;
+
+            AsyncWebSocketClient *client = ws.client(stream.clientId);
+            if (!client || client->status() != WS_CONNECTED)
+            {
+                taskENTER_CRITICAL(&clientsMux);
+                if (historyStreams[slot].clientId == stream.clientId)
+                    historyStreams[slot] = HistoryStream();
+                taskEXIT_CRITICAL(&clientsMux);
+                break;
+            }
+            // Back off until AsyncTCP has drained this client's queue
+            if (client->queueIsFull())
+                break;
+
+            HistoryStream advanced = stream;
+            size_t len = formatHistoryChunk(advanced, chunkBuf, sizeof(chunkBuf));
+            client->text(ws.makeBuffer((uint8_t *)chunkBuf, len));
+            bool done = advanced.next >= advanced.end;
+
+            taskENTER_CRITICAL(&clientsMux);
+            // Only write back if the client did not restart its request meanwhile
+            if (historyStreams[slot].clientId == stream.clientId && historyStreams[slot].chunk == stream.chunk)
+                historyStreams[slot] = done ? HistoryStream() : advanced;
+            taskEXIT_CRITICAL(&clientsMux);
+
+            if (done)
+                break;
+        }
     }
+}
 
-    JsonObject obj = data.as<JsonObject>();
-    bool stateChanged = false;
+// Handles notepadList action: names come from the in-RAM index
+void WebServerManager::handleNotepadList(AsyncWebSocketClient *client, JsonVariant json)
+{
+    StaticJsonDocument<JSON_OBJECT_SIZE(2) + JSON_ARRAY_SIZE(NOTES_MAX)> doc;
+    doc["type"] = "notepadList";
 
-    // Acquire mutex for thread-safe state access
-    bool haveLock = false;
-    if (stateMutex && xSemaphoreTake(stateMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        haveLock = true;
-    }
+    JsonArray arr = doc.createNestedArray("experiments");
+    NotepadManager::getInstance().listNotes(arr);
 
-    float newTempSetpoint = state.tempSetpoint;
-    int newRpmSetpoint = state.rpmSetpoint;
-    String newMode = state.mode;
-    int newDuration = state.duration;
-    float currentTemp = state.temperature;
-    int currentRpm = state.rpm;
+    WsResponse::send(client, doc);
+}
 
-    // Handle temperature setpoint
-    if (obj.containsKey("temp_setpoint"))
+// Handles notepadLoad action: sends NOTE_CHUNK_BYTES from "offset"; the client asks for "next" until it reaches "total"
+void WebServerManager::handleNotepadLoad(AsyncWebSocketClient *client, JsonVariant data)
+{
+    if (!data.is<JsonObject>() || !data.containsKey("experiment"))
     {
-        newTempSetpoint = obj["temp_setpoint"].as<float>();
-        stateChanged = true;
+        sendError(client, "Missing experiment parameter");
+        return;
     }
 
-    // Handle RPM setpoint
-    if (obj.containsKey("rpm_setpoint"))
+    const char *experiment = data["experiment"];
+    size_t offset = data["offset"] | 0;
+
+    // AsyncTCP task only
+    static char chunk[NOTE_CHUNK_BYTES + 1];
+    size_t total = 0;
+    int len = NotepadManager::getInstance().loadNote(experiment, offset, chunk, NOTE_CHUNK_BYTES, total);
+    if (len < 0)
     {
-        newRpmSetpoint = obj["rpm_setpoint"].as<int>();
-        stateChanged = true;
+        sendError(client, "Note not found");
+        return;
     }
+    chunk[len] = '\0';
 
-    // Handle mode changes
-    if (obj.containsKey("mode"))
+    StaticJsonDocument<JSON_OBJECT_SIZE(6)> doc;
+    doc["type"] = "notepadData";
+    doc["experiment"] = experiment;
+    doc["offset"] = offset;
+    doc["next"] = offset + len;
+    doc["total"] = total;
+    doc["notes"] = (const char *)chunk;
+
+    WsResponse::send(client, doc);
+}
+
+// Handles notepadSave action: "offset" 0 replaces the note, the current size appends; "last" marks the final chunk
+void WebServerManager::handleNotepadSave(AsyncWebSocketClient *client, JsonVariant data)
+{
+    if (!data.is<JsonObject>() || !data.containsKey("experiment") || !data.containsKey("notes"))
     {
-        newMode = obj["mode"].as<String>();
-        stateChanged = true;
+        sendError(client, "Missing experiment or notes parameter");
+        return;
     }
 
-    // Handle duration changes
-    if (obj.containsKey("duration"))
+    const char *experiment = data["experiment"];
+    const char *notes = data["notes"] | "";
+    size_t offset = data["offset"] | 0;
+    NotepadManager &notepad = NotepadManager::getInstance();
+
+    if (!NotepadManager::isValidName(experiment))
     {
-        newDuration = obj["duration"].as<int>();
-        stateChanged = true;
+        sendError(client, "Invalid note name");
+        return;
     }
-
-    // Release mutex before calling StateManager (which will re-acquire it)
-    if (haveLock) {
-        xSemaphoreGive(stateMutex);
-        haveLock = false;
+    if (offset != 0 && notepad.noteSize(experiment) != (long)offset)
+    {
+        sendError(client, "Note changed on the device, reload it before saving");
+        return;
+    }
+    if (!notepad.saveNote(experiment, offset, notes, strlen(notes)))
+    {
+        sendError(client, "Failed to save note");
+        return;
     }
 
-    if (stateChanged)
+    if (data["last"] | true)
     {
-        StateManager::updateState(currentTemp, currentRpm, newMode, newTempSetpoint, newRpmSetpoint, newDuration, modeManager, stateMutex);
-        
-        // Re-acquire mutex to update startTime
-        if (stateMutex && xSemaphoreTake(stateMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-            state.startTime = millis();
-            xSemaphoreGive(stateMutex);
-        }
-        
-        notifyClients();
+        StaticJsonDocument<JSON_OBJECT_SIZE(3)> doc;
+        doc["type"] = "notepadSaved";
+        doc["experiment"] = experiment;
+        doc["size"] = notepad.noteSize(experiment);
+        WsResponse::send(client, doc);
     }
-    sendAck(client, "Update received");
 }
 
-// Add a new entry to the history circular buffer
-void WebServerManager::addHistoryEntry(float temperature)
+// Handles telemetryFormat action: switch a client between JSON and binary frames
+void WebServerManager::handleTelemetryFormat(AsyncWebSocketClient *client, JsonVariant data)
 {
-    // Acquire mutex for thread-safe history access
-    bool haveLock = false;
-    if (stateMutex && xSemaphoreTake(stateMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        haveLock = true;
+    if (!data.is<JsonObject>() || !data.containsKey("format"))
+    {
+        sendError(client, "Missing format parameter");
+        return;
     }
-    
-    history[historyIndex].temperature = temperature;
-    history[historyIndex].timestamp = millis(); // Store absolute time reference (milliseconds since boot)
-    historyIndex = (historyIndex + 1) % HISTORY_SIZE;
-    
-    // Release mutex
-    if (haveLock) {
-        xSemaphoreGive(stateMutex);
+
+    const char *format = data["format"] | "json";
+    bool binary = strcasecmp(format, "binary") == 0;
+
+    bool found = false;
+    taskENTER_CRITICAL(&clientsMux);
+    for (WsClientInfo &c : clients)
+    {
+        if (c.id == client->id())
+        {
+            c.binaryTelemetry = binary;
+            found = true;
+            break;
+        }
     }
+    taskEXIT_CRITICAL(&clientsMux);
+
+    if (!found)
+    {
+        sendError(client, "Too many clients for binary telemetry");
+        return;
+    }
+
+    sendAck(client, binary ? "Binary telemetry enabled" : "JSON telemetry enabled");
+    // Give the client a complete frame to start from
+    requestFullUpdate(client->id());
 }
 
-// Handles getHistory action
-void WebServerManager::handleGetHistory(AsyncWebSocketClient *client, JsonVariant)
+// Handles subscribe action: pick the dataUpdate fields and the maximum update rate
+void WebServerManager::handleSubscribe(AsyncWebSocketClient *client, JsonVariant data)
 {
-    // Acquire mutex for thread-safe history access
-    bool haveLock = false;
-    if (stateMutex && xSemaphoreTake(stateMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        haveLock = true;
+    uint16_t fields = Telemetry::FIELD_ALL;
+    if (data["fields"].is<JsonArray>())
+    {
+        fields = 0;
+        for (JsonVariant name : data["fields"].as<JsonArray>())
+        {
+            uint16_t bit = Telemetry::fieldByName(name | "");
+            if (!bit)
+            {
+                sendError(client, String("Unknown field: ") + (name | ""));
+                return;
+            }
+            fields |= bit;
+        }
     }
 
-    StaticJsonDocument<2048> histDoc;
-    JsonArray arr = histDoc.createNestedArray("data");
-    bool hasEntries = false;
-
-    // Return history entries in chronological order starting from oldest
-    int start = historyIndex; // oldest entry in circular buffer
-    for (int i = 0; i < HISTORY_SIZE; i++)
+    float maxRate = data["maxRate"] | 0.0f;
+    if (maxRate < 0.0f)
     {
-        int idx = (start + i) % HISTORY_SIZE;
-        if (history[idx].timestamp == 0)
-            continue;
+        sendError(client, "maxRate must not be negative");
+        return;
+    }
+    uint32_t intervalMs = maxRate > 0.0f ? min((uint32_t)(1000.0f / maxRate), WS_MAX_UPDATE_INTERVAL_MS) : 0;
 
-        JsonObject entry = arr.createNestedObject();
-        entry["time"] = history[idx].timestamp; // Send absolute timestamp (millis)
-        entry["temperature"] = history[idx].temperature;
-        hasEntries = true;
+    bool found = false;
+    taskENTER_CRITICAL(&clientsMux);
+    for (WsClientInfo &c : clients)
+    {
+        if (c.id == client->id())
+        {
+            c.fields = fields;
+            c.intervalMs = intervalMs;
+            c.resync++; // Start over from a complete update of the new field set
+            found = true;
+            break;
+        }
     }
+    taskEXIT_CRITICAL(&clientsMux);
 
-    // Release mutex before network operations
-    if (haveLock) {
-        xSemaphoreGive(stateMutex);
+    if (!found)
+    {
+        sendError(client, "Too many clients for subscriptions");
+        return;
     }
+    sendAck(client, "Subscribed");
+}
 
-    if (!hasEntries)
+// Handles pidAutotune action: hold at the setpoint and run the relay experiment there
+void WebServerManager::handlePidAutotune(AsyncWebSocketClient *client, JsonVariant data)
+{
+    if (!heater || !control)
+    {
+        sendError(client, "Heater not available");
+        return;
+    }
+    if (data.is<JsonObject>() && (data["cancel"] | false))
+    {
+        if (!control->cancelAutotune())
+        {
+            sendError(client, "Busy, try again");
+            return;
+        }
+        sendAck(client, "Autotune cancelled");
+        return;
+    }
+    if (!data.is<JsonObject>() || !data["setpoint"].is<float>())
     {
-        sendError(client, "No history data available");
+        sendError(client, "Missing setpoint parameter");
         return;
     }
 
-    histDoc["type"] = "history";
+    float setpoint = data["setpoint"];
+    if (setpoint <= 0.0f || setpoint >= MAX_TEMP_LIMIT - AUTOTUNE_HYSTERESIS)
+    {
+        sendError(client, "Setpoint out of range");
+        return;
+    }
 
-    String jsonStr;
-    if (serializeJson(histDoc, jsonStr) == 0)
+    if (!control->startAutotune(setpoint))
     {
-        sendError(client, "Failed to serialize history data");
+        sendError(client, "Busy, try again");
         return;
     }
 
-    client->text(jsonStr);
+    sendAck(client, "Autotune started");
 }
 
-// Placeholder handlers for Notepad API via WebSocket (if you want to extend)
-void WebServerManager::handleNotepadList(AsyncWebSocketClient *client, JsonVariant json)
+// Handles profileSave action: compile the JSON segments into a binary program and store it
+void WebServerManager::handleProfileSave(AsyncWebSocketClient *client, JsonVariant data)
 {
-    Serial.println("[WebServerManager] handleNotepadList called");
-
-    StaticJsonDocument<1024> doc;
-    doc["type"] = "notepadList";
-
-    JsonArray arr = doc.createNestedArray("experiments");
+    const char *name = data["name"];
+    JsonArray segments = data["segments"];
+    if (!Profile::isValidName(name) || strcasecmp(name, Modes::RECRYSTALLIZATION) == 0)
+    {
+        sendError(client, "Invalid profile name");
+        return;
+    }
+    if (segments.isNull() || segments.size() == 0 || segments.size() > PROFILE_MAX_SEGMENTS)
+    {
+        sendError(client, "Profile needs 1 to " + String(PROFILE_MAX_SEGMENTS) + " segments");
+        return;
+    }
 
-    // listNotes is void, so we don't check its return value
-    NotepadManager::getInstance().listNotes(arr);
+    // AsyncTCP task only
+    static Profile::Program program;
+    strlcpy(program.name, name, sizeof(program.name));
+    program.count = 0;
+    for (JsonVariant entry : segments)
+    {
+        JsonArray item = entry.as<JsonArray>();
+        const char *op = item[0] | "";
+        Profile::Segment &s = program.segments[program.count++];
+        s = Profile::Segment();
+        if (strcasecmp(op, "ramp") == 0)
+        {
+            s.op = Profile::RAMP_TO;
+            s.temperature = item[1] | NAN;
+            s.value = item[2] | NAN;
+        }
+        else if (strcasecmp(op, "soak") == 0)
+        {
+            s.op = Profile::SOAK;
+            s.value = item[1] | NAN;
+        }
+        else if (strcasecmp(op, "wait") == 0)
+        {
+            s.op = Profile::WAIT_TEMP;
+            s.temperature = item[1] | NAN;
+            s.value = item[2] | 0.5f;
+        }
+        else if (strcasecmp(op, "loop") == 0)
+        {
+            s.op = Profile::LOOP;
+            s.target = item[1] | 255;
+            s.count = item[2] | 1;
+        }
+    }
 
-    String out;
-    if (serializeJson(doc, out) == 0)
+    const char *problem = Profile::validate(program);
+    if (problem)
     {
-        sendError(client, "Failed to serialize note list");
+        sendError(client, problem);
         return;
     }
-
-    client->text(out);
+    if (!Profile::save(program))
+    {
+        sendError(client, "Failed to save profile");
+        return;
+    }
+    sendAck(client, String("Profile ") + name + " saved");
 }
 
-void WebServerManager::handleNotepadLoad(AsyncWebSocketClient *client, JsonVariant data)
+// Handles profileRun action: start a stored or built-in profile, or stop the running one
+void WebServerManager::handleProfileRun(AsyncWebSocketClient *client, JsonVariant data)
 {
-    if (!data.is<JsonObject>() || !data.containsKey("experiment"))
+    if (!control)
     {
-        sendError(client, "Missing experiment parameter");
+        sendError(client, "Heater not available");
         return;
     }
 
-    String experiment = data["experiment"].as<String>();
-    String notes;
-
-    // Assuming loadNote is void and populates notes by reference
-    NotepadManager::getInstance().loadNote(experiment, notes);
-
-    StaticJsonDocument<512> doc;
-    doc["type"] = "notepadData";
-    doc["experiment"] = experiment;
-    doc["notes"] = notes;
+    bool stop = data["stop"] | false;
+    static Profile::Program program; // AsyncTCP task only
+    if (!stop && !Profile::load(data["name"].as<const char *>(), program))
+    {
+        sendError(client, "Profile not found");
+        return;
+    }
 
-    String json;
-    if (serializeJson(doc, json) == 0)
+    // The state task picks up the new mode from the control snapshot
+    if (stop ? !control->setOff() : !control->setProfile(program))
     {
-        sendError(client, "Failed to serialize note data");
+        sendError(client, "Busy, try again");
         return;
     }
 
-    client->text(json);
+    sendAck(client, stop ? String("Profile stopped") : String("Profile ") + program.name + " started");
 }
 
-void WebServerManager::handleNotepadSave(AsyncWebSocketClient *client, JsonVariant data)
+// Handles setPidGains action: gains are applied by the control task and saved by the web task
+void WebServerManager::handleSetPidGains(AsyncWebSocketClient *client, JsonVariant data)
 {
-    String jsonStr;
-    serializeJson(data, jsonStr);
-    Serial.printf("[WebServerManager] handleNotepadSave called with data: %s\n", jsonStr.c_str());
-
-    if (!data.is<JsonObject>() || !data.containsKey("experiment") || !data.containsKey("notes"))
+    if (!heater)
     {
-        sendError(client, "Missing experiment or notes parameter");
+        sendError(client, "Heater not available");
+        return;
+    }
+    if (!data.is<JsonObject>() || !data["kp"].is<float>() || !data["ki"].is<float>() || !data["kd"].is<float>())
+    {
+        sendError(client, "Missing kp, ki or kd parameter");
         return;
     }
 
-    String experiment = data["experiment"].as<String>();
-    String notes = data["notes"].as<String>();
+    PidGains gains = {data["kp"], data["ki"], data["kd"]};
+    if (gains.kp < 0.0f || gains.ki < 0.0f || gains.kd < 0.0f)
+    {
+        sendError(client, "Gains must not be negative");
+        return;
+    }
+    heater->requestPidGains(gains);
+    sendAck(client, "PID gains updated");
+}
 
-    // Assuming saveNote is void, otherwise adjust accordingly
-    NotepadManager::getInstance().saveNote(experiment, notes);
-    sendAck(client, "Note saved successfully");
+// Handles getConfig action: setpoints, alert thresholds and PID configuration
+void WebServerManager::handleGetConfig(AsyncWebSocketClient *client, JsonVariant data)
+{
+    SystemState state = StateManager::snapshot();
+
+    JsonDocument &configDoc = responseDocument();
+    configDoc["tempSetpoint"] = state.tempSetpoint;
+    configDoc["rpmSetpoint"] = state.rpmSetpoint;
+    configDoc["alertTempThreshold"] = state.alertTempThreshold;
+    configDoc["alertRpmThreshold"] = state.alertRpmThreshold;
+    configDoc["alertTimerThreshold"] = state.alertTimerThreshold;
+    if (heater) {
+        static const char *const AUTOTUNE_STATES[] = {"idle", "running", "done", "failed"};
+        PidGains gains = heater->getPidGains();
+        JsonObject pid = configDoc.createNestedObject("pid");
+        pid["kp"] = gains.kp;
+        pid["ki"] = gains.ki;
+        pid["kd"] = gains.kd;
+        pid["autotune"] = AUTOTUNE_STATES[heater->getAutotuneState()];
+    }
+    WsResponse::send(client, configDoc);
 }
 
-// === Utility methods ===
+// Handles resetSystem action: flush the telemetry log and unsaved settings, then reboot
+void WebServerManager::handleResetSystem(AsyncWebSocketClient *client, JsonVariant data)
+{
+    logMessagef(LogLevel::INFO, "[WebServerManager] Resetting system...");
+    TelemetryLog::getInstance().flush();
+    PersistenceManager::getInstance().flush();
+    ESP.restart();
+}
 
-void WebServerManager::updateStateProperty(float &var, float val, const char *name)
+// Handles updateState action: replace temperature, RPM and mode in one step
+void WebServerManager::handleUpdateState(AsyncWebSocketClient *client, JsonVariant json)
 {
-    if (val != var)
-    {
-        logEvent(String(name) + " changed from " + String(var) + " to " + String(val));
-        var = val;
+    if (!json.is<JsonObject>()) {
+        sendError(client, "Missing 'data' field for state update");
+        return;
+    }
+    JsonObject data = json.as<JsonObject>();
+    if (!data.containsKey("temperature") || !data.containsKey("rpm") || !data.containsKey("mode")) {
+        sendError(client, "Incomplete state data");
+        return;
+    }
+
+    HeaterModeManager::Mode mode;
+    if (!HeaterModeManager::parseMode(data["mode"] | "", mode)) {
+        sendError(client, "Unknown mode");
+        return;
     }
+    // Temperature and RPM are measured by the state task; the mode is
+    // (re)started with the current setpoints at the next tick
+    ControlUpdate update;
+    update.fields = ControlUpdate::MODE | ControlUpdate::RESTART;
+    update.mode = mode;
+    CommandQueue::getInstance().submit(update);
 }
 
-void WebServerManager::updateStateProperty(int &var, int val, const char *name)
+void WebServerManager::handleGetMetrics(AsyncWebSocketClient *client, JsonVariant data)
 {
-    if (val != var)
-    {
-        logEvent(String(name) + " changed from " + String(var) + " to " + String(val));
-        var = val;
-    }
+    JsonDocument &doc = responseDocument();
+    buildMetrics(doc);
+    if (data.is<JsonObject>() && (data["reset"] | false))
+        resetMetrics();
+    WsResponse::send(client, doc);
 }
 
-void WebServerManager::updateMode(const String &newMode)
+// Handles getEvents action: the retained events, oldest first, rendered from their message IDs
+void WebServerManager::handleGetEvents(AsyncWebSocketClient *client, JsonVariant data)
 {
-    if (newMode != state.mode &&
-        (newMode == Modes::HOLD ||
-         newMode == Modes::RAMP ||
-         newMode == Modes::RECRYSTALLIZATION ||
-         newMode == Modes::TIMER ||
-         newMode == Modes::OFF))
+    // AsyncTCP task only; event texts need no JSON escaping (see EventLog.cpp)
+    static EventLog::Entry entries[MAX_EVENTS];
+    static char eventsBuf[MAX_EVENTS * EVENT_TEXT_MAX + 64];
+    EventLog &events = EventLog::getInstance();
+    size_t count = events.snapshot(entries);
+
+    size_t len = snprintf(eventsBuf, sizeof(eventsBuf), "{\"type\":\"events\",\"total\":%lu,\"now\":%lu,\"data\":[",
+                          (unsigned long)events.total(), (unsigned long)millis());
+    for (size_t i = 0; i < count && len < sizeof(eventsBuf); i++)
     {
-        logEvent("Mode changed from " + state.mode + " to " + newMode);
-        state.mode = newMode;
+        char text[EVENT_TEXT_MAX - 24];
+        EventLog::format(entries[i], text, sizeof(text));
+        len += snprintf(eventsBuf + len, sizeof(eventsBuf) - len, "%s{\"t\":%lu,\"id\":%u,\"text\":\"%s\"}",
+                        i ? "," : "", (unsigned long)entries[i].timeMs, (unsigned)entries[i].id, text);
     }
+    if (len < sizeof(eventsBuf))
+        len += snprintf(eventsBuf + len, sizeof(eventsBuf) - len, "]}");
+    if (len >= sizeof(eventsBuf))
+    {
+        sendError(client, "Event log too large");
+        return;
+    }
+    client->text(ws.makeBuffer((uint8_t *)eventsBuf, len));
 }
 
-void WebServerManager::logEvent(const String &desc)
+void WebServerManager::buildMetrics(JsonDocument &doc)
 {
-    if (eventsCount == MAX_EVENTS)
+    doc["type"] = "metrics";
+    doc["uptimeMs"] = millis();
+    doc["cpuMhz"] = getCpuFrequencyMhz();
+
+    JsonObject heap = doc.createNestedObject("heap");
+    uint32_t freeHeap = ESP.getFreeHeap();
+    uint32_t maxAlloc = ESP.getMaxAllocHeap();
+    heap["free"] = freeHeap;
+    heap["minFree"] = ESP.getMinFreeHeap();
+    heap["maxAlloc"] = maxAlloc;
+    // Percent of the free heap outside the largest block; high means large sends start failing
+    heap["fragmentation"] = freeHeap ? 100 - (uint32_t)((uint64_t)maxAlloc * 100 / freeHeap) : 0;
+    doc["wsAllocFailures"] = WsResponse::allocFailures();
+
+    std::array<WsClientInfo, MAX_WS_CLIENTS> snapshot;
+    taskENTER_CRITICAL(&clientsMux);
+    snapshot = clients;
+    taskEXIT_CRITICAL(&clientsMux);
+    JsonArray clientsOut = doc.createNestedArray("clients");
+    size_t queued = 0;
+    for (const WsClientInfo &c : snapshot)
     {
-        // Shift all events left by one (remove the oldest)
-        for (int i = 0; i < MAX_EVENTS - 1; i++)
+        if (c.id == 0)
+            continue;
+        JsonObject out = clientsOut.createNestedObject();
+        out["id"] = c.id;
+        out["binary"] = c.binaryTelemetry;
+        out["fields"] = c.fields;
+        out["intervalMs"] = c.intervalMs;
+        out["backoffMs"] = c.backoffMs;
+        out["skipped"] = c.skipped;
+        // Messages waiting in the library and free TCP send window (AsyncTCP task, like ws events)
+        AsyncWebSocketClient *client = ws.client(c.id);
+        if (client)
         {
-            events[i] = events[i + 1];
+            out["queueLen"] = client->queueLen();
+            out["tcpSpace"] = client->client()->space();
+            queued += client->queueLen();
         }
-        eventsCount--;
     }
+    doc["wsQueued"] = queued;
+
+    doc["logDropped"] = logDroppedCount();
+    PersistenceManager::Stats persisted = PersistenceManager::getInstance().stats();
+    JsonObject persist = doc.createNestedObject("persistence");
+    persist["writes"] = persisted.writes;
+    persist["failures"] = persisted.failures;
+    persist["coalesced"] = persisted.coalesced;
+    persist["unchanged"] = persisted.unchanged;
+    persist["sequence"] = persisted.sequence;
+    persist["lastWriteMs"] = persisted.lastWriteMs;
+    persist["dirty"] = persisted.dirty;
+    if (control)
+    {
+        doc["controlDropped"] = control->droppedCommands();
+        ControlSnapshot snapshot = control->snapshot();
+        JsonObject stir = doc.createNestedObject("stirrer");
+        stir["rpm"] = snapshot.rpm;
+        stir["targetRpm"] = snapshot.rpmTarget;
+        stir["duty"] = snapshot.stirrerDuty;
+        stir["stalled"] = snapshot.stirrerFault;
+        JsonObject sensor = doc.createNestedObject("sensor");
+        sensor["probeC"] = snapshot.probeTemperature;
+        sensor["dropped"] = snapshot.sensorDropped;
+    }
+
+    if (heater)
+    {
+        HeatingElement::RampTracking tracking = heater->getRampTracking();
+        JsonObject ramp = doc.createNestedObject("ramp");
+        ramp["trackingErrorC"] = tracking.error;
+        ramp["rmsC"] = tracking.rmsError;
+        ramp["maxC"] = tracking.maxError;
+        ramp["samples"] = tracking.samples;
+        JsonObject plant = ramp.createNestedObject("plant");
+        plant["valid"] = tracking.modelValid;
+        plant["gainC"] = tracking.gain;
+        plant["tauS"] = tracking.timeConstant;
+        plant["ambientC"] = tracking.ambient;
+    }
+
+    Metrics::getInstance().writeJson(doc.createNestedArray("sections"));
 
-    // Add the new event at the end
-    events[eventsCount].timestamp = millis();
-    events[eventsCount].description = desc;
-    eventsCount++;
+    JsonArray tasksOut = doc.createNestedArray("tasks");
+    if (taskManager)
+    {
+        TaskStats stats[16];
+        uint32_t count = taskManager->getTaskStats(stats, sizeof(stats) / sizeof(stats[0]));
+        for (uint32_t i = 0; i < count; i++)
+        {
+            JsonObject t = tasksOut.createNestedObject();
+            t["name"] = stats[i].name;
+            t["stackSize"] = stats[i].stackSize;
+            t["stackFree"] = stats[i].stackHighWaterMark;
+            t["static"] = stats[i].staticMemory;
+            if (!stats[i].isJob)
+                continue;
+            t["runs"] = stats[i].runs;
+            t["lastLatencyUs"] = stats[i].lastLatencyUs;
+            t["avgLatencyUs"] = stats[i].avgLatencyUs;
+            t["maxLatencyUs"] = stats[i].maxLatencyUs;
+            t["avgRunUs"] = stats[i].avgRunUs;
+            t["maxRunUs"] = stats[i].maxRunUs;
+        }
+    }
 }
 
-// Add this line near other static/global variables (after server/ws definitions)
+void WebServerManager::resetMetrics()
+{
+    Metrics::getInstance().reset();
+    if (taskManager)
+        taskManager->resetTaskStats();
+}
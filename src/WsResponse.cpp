@@ -0,0 +1,69 @@
+#include "utilities/WsResponse.h"
+#include "utilities/SerialRemote.h"
+
+namespace
+{
+    volatile uint32_t failures = 0;
+
+    void sendMessage(AsyncWebSocketClient *client, const char *type, const char *message)
+    {
+        StaticJsonDocument<JSON_OBJECT_SIZE(2)> doc;
+        doc["type"] = type;
+        doc["message"] = message; // Stored as a pointer; serialized before this returns
+        WsResponse::send(client, doc);
+    }
+}
+
+namespace WsResponse {
+    AsyncWebSocketMessageBuffer *serialize(AsyncWebSocket &ws, const JsonDocument &doc)
+    {
+        size_t len = measureJson(doc);
+        AsyncWebSocketMessageBuffer *buffer = ws.makeBuffer(len);
+        if (!buffer || !buffer->get())
+        {
+            failures++;
+            logMessagef(LogLevel::ERROR, "[WsResponse] No memory for a %u byte message", (unsigned)len);
+            return nullptr;
+        }
+        // Exactly len bytes fit, so no terminator is written past the message
+        serializeJson(doc, buffer->get(), len);
+        return buffer;
+    }
+
+    bool send(AsyncWebSocketClient *client, const JsonDocument &doc)
+    {
+        if (!client || client->status() != WS_CONNECTED)
+            return false;
+        AsyncWebSocketMessageBuffer *buffer = serialize(*client->server(), doc);
+        if (!buffer)
+            return false;
+        client->text(buffer);
+        return true;
+    }
+
+    bool broadcast(AsyncWebSocket &ws, const JsonDocument &doc)
+    {
+        AsyncWebSocketMessageBuffer *buffer = serialize(ws, doc);
+        if (!buffer)
+            return false;
+        ws.textAll(buffer);
+        return true;
+    }
+
+    void sendAck(AsyncWebSocketClient *client, const char *message)
+    {
+        logMessagef(LogLevel::DEBUG, "[WsResponse] ACK: %s", message);
+        sendMessage(client, "ack", message);
+    }
+
+    void sendError(AsyncWebSocketClient *client, const char *error)
+    {
+        logMessagef(LogLevel::DEBUG, "[WsResponse] ERROR: %s", error);
+        sendMessage(client, "error", error);
+    }
+
+    uint32_t allocFailures()
+    {
+        return failures;
+    }
+}
@@ -1,19 +1,42 @@
 #include <Arduino.h>
+#include <LittleFS.h>
 #include "managers/WebServerManager.h"
 #include "hardware/HeatingElement.h"
+#include "hardware/Stirrer.h"
 #include "managers/HeaterModeManager.h"
+#include "managers/ControlCore.h"
 #include "utilities/FileSystemExplorer.h"
+#include "managers/TelemetryLog.h"
+#include "managers/CommandQueue.h"
+#include "managers/NotepadManager.h"
+#include "managers/StateManager.h"
+#include "managers/FleetManager.h"
+#include "managers/PersistenceManager.h"
 #include "config/Config.h"
 #include <MAX31865Adapter.h>
+#include <ThermalSimulator.h>
 #include <ArduinoNetworkManager.h>
 #include <TaskManager.h>
 
 #include "utilities/SerialRemote.h"
+#include "utilities/Metrics.h"
+#include "utilities/TemperatureFilters.h"
+#include "utilities/Benchmarks.h"
+#include "utilities/EventLog.h"
 
 // System Objects
-MAX31865Adapter maxSensor(CS_PIN);
-HeatingElement heater(RELAY_PIN, MAX_TEMP_LIMIT, TEMP_FILTER_SIZE, &maxSensor);
+MAX31865Adapter maxSensor(CS_PIN, PROBE_CS_PIN);
+TemperatureFilters::ConfiguredPipeline tempFilter;
+#ifdef SMARTPLATE_SIMULATED_PLANT
+// The heater controls a simulated plate; the relay pin switches nothing real
+ThermalSimulator simulatedPlant(SIM_AMBIENT_C, SIM_GAIN_C, SIM_PLATE_TAU_S, SIM_ELEMENT_TAU_S, SIM_NOISE_C);
+HeatingElement heater(RELAY_PIN, MAX_TEMP_LIMIT, &simulatedPlant, &tempFilter);
+#else
+HeatingElement heater(RELAY_PIN, MAX_TEMP_LIMIT, &maxSensor, &tempFilter);
+#endif
+Stirrer stirrer(STIRRER_PWM_PIN, STIRRER_TACH_PIN);
 HeaterModeManager modeManager(heater);
+ControlCore controlCore(heater, modeManager, &stirrer);
 FileSystemExplorer explorer(WebServerManager::getServer());
 
 // Network and Task Management
@@ -21,15 +44,15 @@ ArduinoNetworkManager networkManager;
 TaskManager taskManager;
 
 // --- System State ---
-int rpm = RPM_MIN;
-SemaphoreHandle_t stateMutex;
+SystemState workingState;   ///< Written by the state task only, published through StateManager
+volatile bool networkUp = false;    ///< Set on the WiFi event task, consumed by webTask
+bool networkServicesStarted = false; ///< webTask only
 
 // --- Forward Declarations ---
 void setupWebServer();
-void updateSystemState();
-void updateRPM();
-const char* getModeString(HeaterModeManager::Mode mode);
-void handleRemoteSerial();
+void startNetworkServices();
+void onNetworkConnected();
+void updateSystemState(const ControlSnapshot &control);
 void handleComplete();
 void handleFault();
 void temperatureChanged(float newTemp);
@@ -38,111 +61,268 @@ void temperatureChanged(float newTemp);
  * @brief Callback handler for temperature changes
  * @param newTemp New temperature value in degrees Celsius
  * 
- * Logs the temperature change and adds entry to history
+ * Logs the temperature change and adds entry to history, at most once per
+ * HISTORY_INTERVAL_MS (the control task samples faster than the chart needs)
  */
 void temperatureChanged(float newTemp) {
-    // Use a simple char array instead of std::string
-    char buffer[64];
-    std::snprintf(buffer, sizeof(buffer), "[Temperature] Changed to %.2f°C", newTemp);
-    logMessage(LogLevel::INFO, buffer);
+    static uint32_t lastEntry = 0;
+    static bool first = true;
+    uint32_t now = millis();
+    if (!first && now - lastEntry < HISTORY_INTERVAL_MS)
+        return;
+    first = false;
+    lastEntry = now;
+
+    logMessagef(LogLevel::DEBUG, "[Temperature] Changed to %.2f°C", newTemp);
     WebServerManager::instance()->addHistoryEntry(newTemp);
 }
 
 // --- FreeRTOS Tasks ---
-TaskHandle_t heaterTaskHandle = NULL;
+TaskHandle_t sensorTaskHandle = NULL;
 TaskHandle_t webTaskHandle = NULL;
 TaskHandle_t stateTaskHandle = NULL;
+TaskHandle_t broadcastTaskHandle = NULL;
+TaskHandle_t telemetryTaskHandle = NULL;
+TaskHandle_t logTaskHandle = NULL;
+TaskHandle_t uploadTaskHandle = NULL;
+TaskHandle_t fleetTaskHandle = NULL;
+TaskHandle_t persistTaskHandle = NULL;
+
+// Task memory, placed at link time (sizes in Config.h)
+#ifndef SMARTPLATE_SIMULATED_PLANT
+TaskStack<SENSOR_TASK_STACK> sensorTaskStack;
+#endif
+TaskStack<WEB_TASK_STACK> webTaskStack;
+TaskStack<STATE_TASK_STACK> stateTaskStack;
+TaskStack<BROADCAST_TASK_STACK> broadcastTaskStack;
+TaskStack<TELEMETRY_TASK_STACK> telemetryTaskStack;
+TaskStack<LOG_TASK_STACK> logTaskStack;
+TaskStack<UPLOAD_TASK_STACK> uploadTaskStack;
+TaskStack<FLEET_TASK_STACK> fleetTaskStack;
+TaskStack<PERSIST_TASK_STACK> persistTaskStack;
 
 /**
- * @brief FreeRTOS task for heater control
- * @param pvParameters Task parameters (unused)
- * 
- * Updates heater state every 500ms
+ * @brief RTD acquisition job
+ * @param pvParameters Job parameters (unused)
+ *
+ * Woken by the MAX31865 DRDY interrupt (or every SENSOR_TIMEOUT_MS) to
+ * queue the latest conversion
  */
-void heaterTask(void *pvParameters) {
-    while (true) {
-        heater.update();
-        vTaskDelay(pdMS_TO_TICKS(500));
-    }
+void sensorTask(void *pvParameters) {
+    maxSensor.acquire();
 }
 
 /**
- * @brief FreeRTOS task for web server handling
- * @param pvParameters Task parameters (unused)
+ * @brief Web server housekeeping job
+ * @param pvParameters Job parameters (unused)
  * 
- * Handles web server events every 50ms
+ * Starts the network services once WiFi first connects, then cleans up
+ * clients, streams history, handles OTA and stores PID gains changed by the
+ * control task every WEB_PERIOD_MS
  */
 void webTask(void *pvParameters) {
-    while (true) {
-        WebServerManager::instance()->handle();
-        vTaskDelay(pdMS_TO_TICKS(50));
+    if (networkUp && !networkServicesStarted) {
+        networkServicesStarted = true;
+        startNetworkServices();
     }
+    WebServerManager::instance()->handle();
+    networkManager.handleOTA();
+    heater.savePendingGains();
 }
 
 /**
- * @brief FreeRTOS task for system state management
- * @param pvParameters Task parameters (unused)
+ * @brief System state management job
+ * @param pvParameters Job parameters (unused)
  * 
- * Updates system state, RPM, and mode manager periodically
+ * Runs on every control step (at least every STATE_TIMEOUT_MS). It is the
+ * only writer of the system state: it copies the control snapshot
+ * (temperature, measured RPM, mode) into the working state, applies queued
+ * control updates (forwarding them to the control core), then publishes the
+ * state, marks changed settings for the persistence task and wakes the
+ * broadcaster. Nothing here waits on another task.
  */
 void stateTask(void *pvParameters) {
     static unsigned long lastUpdate = 0;
-    while (true) {
-        // Use TaskManager for mutex operations
-        if (taskManager.takeMutex(stateMutex, 100)) {
-            if (millis() - lastUpdate > UPDATE_INTERVAL_MS) {
-                lastUpdate = millis();
-                updateRPM();
-                updateSystemState();
-                logMessagef(LogLevel::INFO, "[Status] Temp=%.2f°C, RPM=%d, Mode=%s", state.temperature, state.rpm, state.mode.c_str());
-            }
-            modeManager.update(heater.getCurrentTemperature());
-            taskManager.giveMutex(stateMutex);
-            
-            // Notify clients AFTER releasing mutex to avoid holding lock during I/O
-            WebServerManager::instance()->notifyClients();
-        }
-        vTaskDelay(pdMS_TO_TICKS(100));
+    METRICS_SCOPE("state.update");
+    ControlSnapshot control = controlCore.snapshot();
+    if (millis() - lastUpdate > UPDATE_INTERVAL_MS) {
+        lastUpdate = millis();
+        updateSystemState(control);
+        logMessagef(LogLevel::INFO, "[Status] Temp=%.2f°C, RPM=%d, Mode=%s", workingState.temperature, workingState.rpm, HeaterModeManager::modeName(workingState.mode));
     }
+    // The mode is the one the control core runs; the running time restarts with it
+    if (control.mode != workingState.mode) {
+        EventLog::getInstance().record(EventLog::MODE, workingState.mode, control.mode);
+        workingState.mode = control.mode;
+        workingState.startTime = millis();
+    }
+    static bool stirrerStalled = false;
+    if (control.stirrerFault && !stirrerStalled) {
+        EventLog::getInstance().record(EventLog::STIRRER_STALL, workingState.rpmSetpoint);
+    }
+    stirrerStalled = control.stirrerFault;
+    CommandQueue::getInstance().apply(workingState, &controlCore);
+    workingState.profileSegment = control.profileSegment;
+    workingState.profileElapsed = control.profileElapsed;
+    StateManager::publish(workingState);
+    PersistenceManager::getInstance().track(workingState);
+
+    // Broadcast from the network core; the control core never does socket I/O
+    TaskManager::notify(broadcastTaskHandle);
+}
+
+/**
+ * @brief WebSocket broadcast job
+ * @param pvParameters Job parameters (unused)
+ *
+ * Runs when the state task signals a state update; notifyClients() sends
+ * nothing if no field changed, the fleet datagram goes out at its own rate
+ */
+void broadcastTask(void *pvParameters) {
+    WebServerManager::instance()->notifyClients();
+    FleetManager::getInstance().publish(StateManager::snapshot());
+}
+
+/**
+ * @brief Fleet discovery job (collector only)
+ * @param pvParameters Job parameters (unused)
+ *
+ * Browses mDNS for plates every FLEET_DISCOVERY_MS; the query blocks, so it
+ * has a task of its own
+ */
+void fleetTask(void *pvParameters) {
+    FleetManager::getInstance().discover();
+}
+
+/**
+ * @brief Persistent telemetry log job
+ * @param pvParameters Job parameters (unused)
+ *
+ * Feeds one sample per TELEMETRY_PERIOD_MS into TelemetryLog, which batches flash writes
+ */
+void telemetryTask(void *pvParameters) {
+    TelemetryLog::getInstance().addSample(controlCore.snapshot().temperature);
+}
+
+/**
+ * @brief Settings persistence job
+ * @param pvParameters Job parameters (unused)
+ *
+ * Writes changed settings to NVS once their debounce expires; a task of its
+ * own so a flash write never delays web housekeeping
+ */
+void persistTask(void *pvParameters) {
+    PersistenceManager::getInstance().service();
 }
 
 /**
  * @brief Arduino setup function - initializes system components
  * 
- * Initializes serial, heater, WiFi, OTA, web server, and FreeRTOS tasks
+ * Boots in stages so the plate is under control before anything slow runs:
+ * 1. Heater (relay held off since construction), file system, stored
+ *    settings, control tasks
+ * 2. Storage managers, web routes and the network-side tasks
+ * 3. WiFi, which connects in the background; webTask starts OTA, the web
+ *    server, remote serial and the fleet role when it comes up
  */
 void setup() {
     Serial.begin(115200);
     Serial.println("[System] Starting SmartPlate ESP32...");
+
+#ifdef SMARTPLATE_BENCH
+    Benchmarks::run(controlCore);
+#endif
+#ifdef SMARTPLATE_SIMULATED_PLANT
+    simulatedPlant.attachHeater([]() { return heater.isRelayOn(); });
+#endif
     
-    // Initialize heater and callbacks
+    // Stage 1: control
     heater.setOnFaultCallback(handleFault);
     heater.setOnTemperatureChangedCallback(temperatureChanged);
     modeManager.setOnCompleteCallback(handleComplete);
     modeManager.setOnFaultCallback(handleFault);
     heater.begin();
-    
-    // Initialize network using NetworkManager
-    if (!networkManager.connectWiFi(WIFI_SSID, WIFI_PASSWORD)) {
-        Serial.println("[System] WiFi connection failed - continuing anyway");
+    stirrer.begin();
+
+    // The one mount for every file system user (gains, telemetry, notepad, explorer, web)
+    bool fsMounted = LittleFS.begin(true);
+    if (fsMounted) {
+        heater.loadPidGains();
+    } else {
+        Serial.println("[System] LittleFS mount failed - running without storage");
     }
-    if (!networkManager.setupOTA(OTA_HOSTNAME)) {
-        Serial.println("[System] OTA setup failed - continuing anyway");
+
+    // Settings from before the reset; the first state tick hands them to the control core
+    workingState.mode = HeaterModeManager::OFF;
+    if (PersistenceManager::getInstance().begin()) {
+        PersistenceManager::getInstance().restore(workingState);
+    }
+
+    // Publish the initial state before any task can read it
+    workingState.startTime = millis();
+    StateManager::publish(workingState);
+
+    // Create tasks using TaskManager; from here on logging is asynchronous.
+    // The state task notifies the broadcaster, which is harmless before it exists.
+    logTaskHandle = taskManager.createTask(logTaskStack.config("LogTask", tskIDLE_PRIORITY, NETWORK_CORE), logDrainTask, NULL);
+    stateTaskHandle = taskManager.createEventTask(stateTaskStack.config("StateTask", STATE_TASK_PRIORITY, CONTROL_CORE), stateTask, NULL, STATE_TIMEOUT_MS);
+#ifndef SMARTPLATE_SIMULATED_PLANT
+    sensorTaskHandle = taskManager.createEventTask(sensorTaskStack.config("SensorTask", SENSOR_TASK_PRIORITY, CONTROL_CORE), sensorTask, NULL, SENSOR_TIMEOUT_MS);
+    if (!maxSensor.beginContinuous(sensorTaskHandle, DRDY_PIN, SENSOR_FILTER_50HZ, PROBE_DRDY_PIN)) {
+        logMessage(LogLevel::ERROR, "[System] Continuous RTD mode unavailable - using one-shot reads");
+    }
+#endif
+    if (!controlCore.begin(taskManager, stateTaskHandle)) {
+        logMessage(LogLevel::ERROR, "[System] Control core start incomplete");
+    }
+    logMessagef(LogLevel::INFO, "[System] Control running %lu ms after reset", millis());
+
+    // Stage 2: storage and web
+    if (fsMounted) {
+        TelemetryLog::getInstance().begin();
     }
-    
-    // Initialize web server
     setupWebServer();
-    state.mode = Modes::OFF;
-    
-    // Create mutex using TaskManager
-    stateMutex = taskManager.createMutex();
-    
-    // Create tasks using TaskManager
-    heaterTaskHandle = taskManager.createTask("HeaterTask", heaterTask, NULL, 4096, 1, 1);
-    webTaskHandle = taskManager.createTask("WebTask", webTask, NULL, 4096, 1, 1);
-    stateTaskHandle = taskManager.createTask("StateTask", stateTask, NULL, 4096, 1, 1);
+    broadcastTaskHandle = taskManager.createEventTask(broadcastTaskStack.config("BroadcastTask", BROADCAST_TASK_PRIORITY, NETWORK_CORE), broadcastTask, NULL);
+    webTaskHandle = taskManager.createPeriodicTask(webTaskStack.config("WebTask", WEB_TASK_PRIORITY, NETWORK_CORE), webTask, NULL, WEB_PERIOD_MS);
+    telemetryTaskHandle = taskManager.createPeriodicTask(telemetryTaskStack.config("TelemetryTask", TELEMETRY_TASK_PRIORITY, NETWORK_CORE), telemetryTask, NULL, TELEMETRY_PERIOD_MS);
+    uploadTaskHandle = taskManager.createTask(uploadTaskStack.config("UploadTask", UPLOAD_TASK_PRIORITY, NETWORK_CORE), FileSystemExplorer::writerTask, &explorer);
+    persistTaskHandle = taskManager.createPeriodicTask(persistTaskStack.config("PersistTask", PERSIST_TASK_PRIORITY, NETWORK_CORE), persistTask, NULL, PERSIST_PERIOD_MS);
+
+    // Stage 3: network, completed by WiFi events
+    networkManager.setOnConnectedCallback(onNetworkConnected);
+    if (!networkManager.connectWiFi(WIFI_SSID, WIFI_PASSWORD)) {
+        logMessage(LogLevel::ERROR, "[System] WiFi start failed - running offline");
+    }
     
-    logMessagef(LogLevel::INFO, "[System] Setup complete!");
+    logMessagef(LogLevel::INFO, "[System] Setup complete in %lu ms", millis());
+}
+
+/**
+ * @brief Called on the WiFi event task whenever an address is obtained
+ */
+void onNetworkConnected() { networkUp = true; }
+
+/**
+ * @brief Start everything that needs the network (webTask, first connection only)
+ *
+ * OTA comes first: it starts the mDNS responder the fleet role announces on.
+ * The fleet task is created here since only a connected collector needs it.
+ */
+void startNetworkServices() {
+    if (!networkManager.setupOTA(FleetManager::hostname())) {
+        logMessage(LogLevel::ERROR, "[System] OTA setup failed - continuing anyway");
+    }
+    serialServer.begin(SERIAL_TCP_PORT);
+    serialServer.setNoDelay(true);
+    logMessagef(LogLevel::INFO, "[SerialServer] Started on port %d", SERIAL_TCP_PORT);
+    WebServerManager::instance()->begin();
+    logMessage(LogLevel::INFO, "[WebServer] Started");
+
+    FleetManager::getInstance().begin(static_cast<FleetManager::Role>(FLEET_ROLE));
+    if (FleetManager::getInstance().getRole() == FleetManager::COLLECTOR) {
+        fleetTaskHandle = taskManager.createPeriodicTask(fleetTaskStack.config("FleetTask", FLEET_TASK_PRIORITY, NETWORK_CORE), fleetTask, NULL, FLEET_DISCOVERY_MS);
+    }
+    logMessagef(LogLevel::INFO, "[System] Network services up %lu ms after reset", millis());
 }
 
 // --- Serial Handling ---
@@ -163,74 +343,48 @@ void setup() {
 /**
  * @brief Arduino main loop function
  * 
- * Handles OTA updates and remote serial communication
+ * All work runs in scheduled tasks (OTA in webTask, remote serial in the
+ * log task), so the Arduino loop task deletes itself instead of polling.
  */
 void loop() {
-    // Handle OTA via NetworkManager
-    networkManager.handleOTA();
-    handleRemoteSerial();
-    vTaskDelay(pdMS_TO_TICKS(10));
+    vTaskDelete(NULL);
 }
 
 /**
  * @brief Callback handler for operation completion
  */
-void handleComplete() { logMessage(LogLevel::INFO, "[HeaterModeManager] Operation complete"); }
+void handleComplete() {
+    logMessage(LogLevel::INFO, "[HeaterModeManager] Operation complete");
+    EventLog::getInstance().record(EventLog::MODE_COMPLETE);
+}
 
 /**
  * @brief Callback handler for fault detection
  */
-void handleFault() { logMessage(LogLevel::ERROR, "[HeaterModeManager] FAULT detected! Heater stopped"); }
+void handleFault() {
+    logMessage(LogLevel::ERROR, "[HeaterModeManager] FAULT detected! Heater stopped");
+    EventLog::getInstance().record(EventLog::HEATER_FAULT);
+}
 
 /**
- * @brief Initialize web server, file explorer, and remote serial
+ * @brief Attach the web server to the system and register the file routes
+ *
+ * The server itself starts with the network (startNetworkServices())
  */
 void setupWebServer() {
-    serialServer.begin(23);
-    serialServer.setNoDelay(true);
-    Serial.printf("[SerialServer] Started on port %d\n", SERIAL_TCP_PORT);
-    WebServerManager::instance()->setStateMutex(stateMutex);
-    WebServerManager::instance()->attachModeManager(&modeManager);
+    WebServerManager::instance()->attachControlCore(&controlCore);
+    WebServerManager::instance()->attachHeater(&heater);
+    WebServerManager::instance()->attachTaskManager(&taskManager);
     explorer.begin();
-    Serial.println("[FileSystem] Explorer initialized");
-    WebServerManager::instance()->begin(WIFI_SSID, WIFI_PASSWORD);
-    Serial.println("[WebServer] Started");
+    logMessage(LogLevel::INFO, "[FileSystem] Explorer initialized");
+    NotepadManager::getInstance().begin();
 }
 
 /**
- * @brief Update RPM value in a cycling pattern
+ * @brief Update the working state from the latest control snapshot
+ * @param control Snapshot published by the control core
  */
-void updateRPM() { rpm = (rpm >= RPM_MAX) ? RPM_MIN : rpm + RPM_INCREMENT; }
-
-/**
- * @brief Update system state with current values
- * @param temperature Current temperature in degrees Celsius
- * @param rpm Current RPM value
- * @param mode Current heater operating mode
- */
-void updateState(float temperature, int rpm, HeaterModeManager::Mode mode) {
-    state.temperature = temperature;
-    state.rpm = rpm;
-    state.mode = getModeString(mode);
+void updateSystemState(const ControlSnapshot &control) {
+    workingState.temperature = control.temperature;
+    workingState.rpm = (int)lroundf(control.rpm);
 }
-
-/**
- * @brief Update system state from current sensor readings
- */
-void updateSystemState() { updateState(heater.getCurrentTemperature(), rpm, modeManager.getCurrentMode()); }
-
-/**
- * @brief Convert Mode enum to string representation
- * @param mode HeaterModeManager Mode enum value
- * @return const char* String representation of the mode
- */
-const char* getModeString(HeaterModeManager::Mode mode) {
-    switch (mode) {
-        case HeaterModeManager::OFF: return Modes::OFF;
-        case HeaterModeManager::RAMP: return Modes::RAMP;
-        case HeaterModeManager::HOLD: return Modes::HOLD;
-        case HeaterModeManager::TIMER: return Modes::TIMER;
-        default: return Modes::OFF;
-    }
-}
-
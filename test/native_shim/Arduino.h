@@ -0,0 +1,87 @@
+#pragma once
+// Host stand-in for the Arduino core: only what the host-tested modules use
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <strings.h>
+#include "freertos/FreeRTOS.h"
+
+using std::isinf;
+using std::isnan;
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define IRAM_ATTR
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+
+namespace NativeShim {
+
+    /**
+     * @brief The clock behind millis(); tests set and advance it
+     */
+    inline uint32_t &clockMs()
+    {
+        static uint32_t now = 0;
+        return now;
+    }
+
+    constexpr uint8_t PIN_COUNT = 40;   ///< GPIOs of an ESP32
+
+    /**
+     * @brief GPIO stub: the level and mode last set on each pin; tests read the relay here
+     */
+    struct Pin
+    {
+        uint8_t mode = INPUT;
+        uint8_t level = LOW;
+        uint32_t writes = 0;    ///< digitalWrite() calls, including repeated levels
+    };
+
+    inline Pin &pin(uint8_t number)
+    {
+        static Pin pins[PIN_COUNT + 1];  // The last one absorbs out-of-range pins
+        return pins[number < PIN_COUNT ? number : PIN_COUNT];
+    }
+}
+
+/**
+ * @brief ESP object stand-in: the cycle counter counts host nanoseconds at a nominal 1000 MHz
+ */
+struct EspClass
+{
+    uint32_t getCycleCount() const
+    {
+        return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    uint32_t getCpuFreqMHz() const { return 1000; }
+};
+
+extern EspClass ESP;
+
+inline uint32_t millis() { return NativeShim::clockMs(); }
+
+inline void pinMode(uint8_t pin, uint8_t mode) { NativeShim::pin(pin).mode = mode; }
+inline int digitalRead(uint8_t pin) { return NativeShim::pin(pin).level; }
+inline void digitalWrite(uint8_t pin, uint8_t level)
+{
+    NativeShim::Pin &state = NativeShim::pin(pin);
+    state.level = level ? HIGH : LOW;
+    state.writes++;
+}
+
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+// glibc before 2.38 has no strlcpy
+size_t strlcpy(char *dst, const char *src, size_t size);
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+// Host stand-in for LittleFS: there is no filesystem, every open fails
+#include <Arduino.h>
+
+class File
+{
+public:
+    explicit operator bool() const { return false; }
+    size_t size() const { return 0; }
+    size_t read(uint8_t *, size_t) { return 0; }
+    int read() { return -1; }
+    size_t readBytes(char *, size_t) { return 0; }
+    size_t write(uint8_t) { return 0; }
+    size_t write(const uint8_t *, size_t) { return 0; }
+    void close() {}
+};
+
+class FS
+{
+public:
+    File open(const char *, const char * = "r") { return File(); }
+    bool exists(const char *) { return false; }
+    bool mkdir(const char *) { return false; }
+    bool remove(const char *) { return false; }
+};
+
+extern FS LittleFS;
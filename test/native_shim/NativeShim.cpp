@@ -0,0 +1,44 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <cstdarg>
+#include "utilities/SerialRemote.h"
+
+FS LittleFS;
+EspClass ESP;
+
+// Log output goes straight to stdout, where the test runner shows it on failure
+static const char *levelName(LogLevel level)
+{
+    return level == LogLevel::ERROR ? "ERROR" : (level == LogLevel::INFO ? "INFO" : "DEBUG");
+}
+
+void logWrite(LogLevel level, const char *message)
+{
+    printf("[%s] %s\n", levelName(level), message);
+}
+
+void logWritef(LogLevel level, const char *fmt, ...)
+{
+    char buffer[256];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buffer, sizeof(buffer), fmt, args);
+    va_end(args);
+    logWrite(level, buffer);
+}
+
+uint32_t logDroppedCount() { return 0; }
+
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+size_t strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t length = strlen(src);
+    if (size)
+    {
+        size_t copy = length < size - 1 ? length : size - 1;
+        memcpy(dst, src, copy);
+        dst[copy] = '\0';
+    }
+    return length;
+}
+#endif
@@ -0,0 +1,5 @@
+#pragma once
+// Host stand-in: SerialRemote.h only declares its telnet client
+class WiFiClient
+{
+};
@@ -0,0 +1,5 @@
+#pragma once
+// Host stand-in: SerialRemote.h only declares its telnet server
+class WiFiServer
+{
+};
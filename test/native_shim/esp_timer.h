@@ -0,0 +1,6 @@
+#pragma once
+// Host stand-in for esp_timer: the microsecond clock runs from the millis() clock,
+// so a test advancing NativeShim::clockMs() also advances the simulated plant
+#include <Arduino.h>
+
+inline int64_t esp_timer_get_time() { return (int64_t)NativeShim::clockMs() * 1000; }
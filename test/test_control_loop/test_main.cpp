@@ -0,0 +1,167 @@
+#include <unity.h>
+#include <ThermalSimulator.h>
+#include "hardware/HeatingElement.h"
+#include "managers/HeaterModeManager.h"
+#include "utilities/TemperatureFilters.h"
+#include "config/Config.h"
+
+namespace
+{
+    constexpr uint32_t ITERATIONS = 2000;
+    constexpr size_t TRACE_LENGTH = 600;    ///< One minute of control steps
+
+    float trace[TRACE_LENGTH];
+
+    // The simulated plate heats while the relay GPIO is high, like the real element
+    bool relayPinHigh() { return digitalRead(RELAY_PIN) == HIGH; }
+
+    /**
+     * @brief Run control steps the way the control task does: clock tick, heater, mode manager
+     */
+    void runSteps(HeatingElement &heater, HeaterModeManager &modes, uint32_t steps)
+    {
+        for (uint32_t i = 0; i < steps; i++)
+        {
+            NativeShim::clockMs() += HEATER_PERIOD_MS;
+            heater.update();
+            modes.update(heater.getCurrentTemperature());
+        }
+    }
+
+    /**
+     * @brief Time op(i) for i in [0, iterations), print ns per call and return the mean
+     *
+     * Same loop as the on-target Benchmarks, so the host numbers rank changes
+     * the same way (the absolute values are the host's, not the ESP32's).
+     */
+    template <typename Op>
+    uint32_t measure(const char *name, Op op)
+    {
+        uint64_t total = 0;
+        uint32_t best = UINT32_MAX;
+        for (uint32_t i = 0; i < ITERATIONS; i++)
+        {
+            uint32_t start = ESP.getCycleCount();
+            op(i);
+            uint32_t ns = ESP.getCycleCount() - start;
+            total += ns;
+            if (ns < best)
+                best = ns;
+        }
+        uint32_t mean = (uint32_t)(total / ITERATIONS);
+        printf("[Bench] %-26s %8u ns/op (min %u)\n", name, (unsigned)mean, (unsigned)best);
+        return mean;
+    }
+
+    void recordTrace()
+    {
+        // Reproducible heating trace: the plant under a 50% relay pattern
+        ThermalSimulator plant(SIM_AMBIENT_C, SIM_GAIN_C, SIM_PLATE_TAU_S, SIM_ELEMENT_TAU_S, SIM_NOISE_C);
+        for (size_t i = 0; i < TRACE_LENGTH; i++)
+        {
+            plant.step(HEATER_PERIOD_MS / 1000.0f, (i / 10) % 2 == 0);
+            trace[i] = plant.reading();
+        }
+    }
+}
+
+// Shared by the tests; setUp() puts the plate back at ambient and empties the filter
+static ThermalSimulator plant(SIM_AMBIENT_C, SIM_GAIN_C, SIM_PLATE_TAU_S, SIM_ELEMENT_TAU_S, SIM_NOISE_C);
+static TemperatureFilters::ConfiguredPipeline filter;
+
+void setUp()
+{
+    NativeShim::clockMs() = 0;
+    plant.reset(SIM_AMBIENT_C);
+    filter.reset();
+    plant.attachHeater(relayPinHigh);
+    plant.begin();
+}
+
+void tearDown() {}
+
+static void test_relay_pin_starts_low()
+{
+    digitalWrite(RELAY_PIN, HIGH);
+    HeatingElement heater(RELAY_PIN, MAX_TEMP_LIMIT, &plant);
+    TEST_ASSERT_EQUAL(OUTPUT, NativeShim::pin(RELAY_PIN).mode);
+    TEST_ASSERT_EQUAL(LOW, digitalRead(RELAY_PIN));
+}
+
+static void test_hold_settles_on_simulated_plate()
+{
+    HeatingElement heater(RELAY_PIN, MAX_TEMP_LIMIT, &plant, &filter);
+    HeaterModeManager modes(heater);
+    heater.begin();
+    modes.setHold(50.0f);
+
+    // 40 simulated minutes: heat-up plus settling
+    runSteps(heater, modes, 40 * 600);
+    TEST_ASSERT_EQUAL(HeaterModeManager::HOLD, modes.getCurrentMode());
+    TEST_ASSERT_FALSE(heater.hasFault());
+
+    // Settled: the mean over the last PID windows sits on the setpoint
+    float sum = 0.0f;
+    const uint32_t steps = 10 * 600;
+    for (uint32_t i = 0; i < steps; i++)
+    {
+        runSteps(heater, modes, 1);
+        sum += heater.getCurrentTemperature();
+        TEST_ASSERT_EQUAL(heater.isRelayOn() ? HIGH : LOW, digitalRead(RELAY_PIN));
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 50.0f, sum / steps);
+}
+
+static void test_over_temperature_drops_relay()
+{
+    HeatingElement heater(RELAY_PIN, MAX_TEMP_LIMIT, &plant);
+    HeaterModeManager modes(heater);
+    heater.begin();
+    modes.setHold(MAX_TEMP_LIMIT + 10.0f);
+
+    runSteps(heater, modes, 1);
+    TEST_ASSERT_EQUAL(HIGH, digitalRead(RELAY_PIN));
+
+    plant.reset(MAX_TEMP_LIMIT + 1.0f);
+    runSteps(heater, modes, 1);
+    TEST_ASSERT_TRUE(heater.hasFault());
+    TEST_ASSERT_FALSE(heater.isRunningState());
+    TEST_ASSERT_EQUAL(LOW, digitalRead(RELAY_PIN));
+}
+
+// A control step has HEATER_PERIOD_MS; either hot path taking 1% of it on a host is a regression
+static const uint32_t BUDGET_NS = HEATER_PERIOD_MS * 1000000UL / 100;
+
+static void test_bench_add_temperature_reading()
+{
+    static HeatingElement heater(RELAY_PIN, MAX_TEMP_LIMIT, &plant, &filter);
+    heater.setTargetTemperature(trace[TRACE_LENGTH / 2], 0.5f);
+    heater.start();
+    uint32_t mean = measure("heater.addTemperatureReading", [](uint32_t i)
+                            { heater.addTemperatureReading(trace[i % TRACE_LENGTH]); });
+    heater.stop();
+    TEST_ASSERT_LESS_THAN(BUDGET_NS, mean);
+}
+
+static void test_bench_mode_manager_update()
+{
+    static HeatingElement heater(RELAY_PIN, MAX_TEMP_LIMIT, &plant, &filter);
+    static HeaterModeManager modes(heater);
+    modes.setRamp(SIM_AMBIENT_C, SIM_AMBIENT_C + 40.0f, 600);
+    uint32_t mean = measure("modes.update (ramp)", [](uint32_t i)
+                            { modes.update(trace[i % TRACE_LENGTH]); });
+    modes.setOff();
+    TEST_ASSERT_LESS_THAN(BUDGET_NS, mean);
+}
+
+int main()
+{
+    recordTrace();
+    UNITY_BEGIN();
+    RUN_TEST(test_relay_pin_starts_low);
+    RUN_TEST(test_hold_settles_on_simulated_plate);
+    RUN_TEST(test_over_temperature_drops_relay);
+    RUN_TEST(test_bench_add_temperature_reading);
+    RUN_TEST(test_bench_mode_manager_update);
+    return UNITY_END();
+}
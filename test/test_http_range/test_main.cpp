@@ -0,0 +1,82 @@
+#include <unity.h>
+#include "utilities/HttpRange.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void test_closed_range()
+{
+    size_t start = 0, length = 0;
+    TEST_ASSERT_TRUE(HttpRange::parse("bytes=100-199", 1000, start, length));
+    TEST_ASSERT_EQUAL_size_t(100, start);
+    TEST_ASSERT_EQUAL_size_t(100, length);
+}
+
+static void test_open_range_runs_to_end()
+{
+    size_t start = 0, length = 0;
+    TEST_ASSERT_TRUE(HttpRange::parse("bytes=900-", 1000, start, length));
+    TEST_ASSERT_EQUAL_size_t(900, start);
+    TEST_ASSERT_EQUAL_size_t(100, length);
+}
+
+static void test_end_past_file_is_clamped()
+{
+    size_t start = 0, length = 0;
+    TEST_ASSERT_TRUE(HttpRange::parse("bytes=500-5000", 1000, start, length));
+    TEST_ASSERT_EQUAL_size_t(500, start);
+    TEST_ASSERT_EQUAL_size_t(500, length);
+}
+
+static void test_suffix_range()
+{
+    size_t start = 0, length = 0;
+    TEST_ASSERT_TRUE(HttpRange::parse("bytes=-200", 1000, start, length));
+    TEST_ASSERT_EQUAL_size_t(800, start);
+    TEST_ASSERT_EQUAL_size_t(200, length);
+
+    // A suffix longer than the file selects all of it
+    TEST_ASSERT_TRUE(HttpRange::parse("bytes=-5000", 1000, start, length));
+    TEST_ASSERT_EQUAL_size_t(0, start);
+    TEST_ASSERT_EQUAL_size_t(1000, length);
+}
+
+static void test_whitespace_is_allowed()
+{
+    size_t start = 0, length = 0;
+    TEST_ASSERT_TRUE(HttpRange::parse("bytes= 10 - 19", 1000, start, length));
+    TEST_ASSERT_EQUAL_size_t(10, start);
+    TEST_ASSERT_EQUAL_size_t(10, length);
+}
+
+static void test_unsatisfiable_ranges()
+{
+    size_t start = 0, length = 0;
+    TEST_ASSERT_FALSE(HttpRange::parse("bytes=1000-", 1000, start, length));
+    TEST_ASSERT_FALSE(HttpRange::parse("bytes=200-100", 1000, start, length));
+    TEST_ASSERT_FALSE(HttpRange::parse("bytes=-0", 1000, start, length));
+    TEST_ASSERT_FALSE(HttpRange::parse("bytes=0-", 0, start, length));
+}
+
+static void test_malformed_and_multi_range_headers()
+{
+    size_t start = 0, length = 0;
+    TEST_ASSERT_FALSE(HttpRange::parse(nullptr, 1000, start, length));
+    TEST_ASSERT_FALSE(HttpRange::parse("", 1000, start, length));
+    TEST_ASSERT_FALSE(HttpRange::parse("items=0-10", 1000, start, length));
+    TEST_ASSERT_FALSE(HttpRange::parse("bytes=100", 1000, start, length));
+    TEST_ASSERT_FALSE(HttpRange::parse("bytes=0-10,20-30", 1000, start, length));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_closed_range);
+    RUN_TEST(test_open_range_runs_to_end);
+    RUN_TEST(test_end_past_file_is_clamped);
+    RUN_TEST(test_suffix_range);
+    RUN_TEST(test_whitespace_is_allowed);
+    RUN_TEST(test_unsatisfiable_ranges);
+    RUN_TEST(test_malformed_and_multi_range_headers);
+    return UNITY_END();
+}
@@ -0,0 +1,105 @@
+#include <unity.h>
+#include <thread>
+#include "utilities/Mailbox.h"
+#include "utilities/HistoryRing.h"
+
+void setUp() {}
+void tearDown() {}
+
+struct Pair
+{
+    uint32_t a;
+    uint32_t b;     ///< Always ~a when published
+};
+
+static void test_mailbox_starts_empty()
+{
+    Mailbox<Pair> mailbox;
+    Pair out = {1, 1};
+    TEST_ASSERT_EQUAL(0, mailbox.version());
+    TEST_ASSERT_TRUE(mailbox.tryRead(out));
+    TEST_ASSERT_EQUAL(0, out.a);
+    TEST_ASSERT_EQUAL(0, out.b);
+}
+
+static void test_mailbox_returns_latest_value()
+{
+    Mailbox<Pair> mailbox;
+    mailbox.publish({1, ~1u});
+    mailbox.publish({2, ~2u});
+    TEST_ASSERT_EQUAL(2, mailbox.version());
+    Pair out = mailbox.read();
+    TEST_ASSERT_EQUAL(2, out.a);
+    TEST_ASSERT_EQUAL(~2u, out.b);
+}
+
+static void test_mailbox_never_returns_torn_value()
+{
+    Mailbox<Pair> mailbox;
+    mailbox.publish({0, ~0u});
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (uint32_t i = 1; i <= 1000000; i++)
+            mailbox.publish({i, ~i});
+        done.store(true);
+    });
+
+    uint32_t torn = 0;
+    while (!done.load())
+    {
+        Pair out;
+        if (mailbox.tryRead(out) && out.b != ~out.a)
+            torn++;
+    }
+    writer.join();
+    TEST_ASSERT_EQUAL(0, torn);
+    TEST_ASSERT_EQUAL(1000001, mailbox.version());
+}
+
+static void test_ring_reads_by_sequence()
+{
+    HistoryRing<uint32_t, 8> ring;
+    TEST_ASSERT_EQUAL(8, ring.capacity());
+    TEST_ASSERT_EQUAL(0, ring.begin());
+    TEST_ASSERT_EQUAL(0, ring.end());
+
+    uint32_t out = 0;
+    TEST_ASSERT_FALSE(ring.read(0, out));
+    for (uint32_t i = 0; i < 5; i++)
+        ring.push(100 + i);
+    TEST_ASSERT_EQUAL(0, ring.begin());
+    TEST_ASSERT_EQUAL(5, ring.end());
+    TEST_ASSERT_TRUE(ring.read(3, out));
+    TEST_ASSERT_EQUAL(103, out);
+    TEST_ASSERT_FALSE(ring.read(5, out));
+}
+
+static void test_ring_overwrites_oldest()
+{
+    HistoryRing<uint32_t, 8> ring;
+    for (uint32_t i = 0; i < 20; i++)
+        ring.push(100 + i);
+    TEST_ASSERT_EQUAL(12, ring.begin());
+    TEST_ASSERT_EQUAL(20, ring.end());
+
+    uint32_t out = 0;
+    TEST_ASSERT_TRUE(ring.read(12, out));
+    TEST_ASSERT_EQUAL(112, out);
+    TEST_ASSERT_TRUE(ring.read(19, out));
+    TEST_ASSERT_EQUAL(119, out);
+
+    // Sequence 4 shares a slot with 12 and must not read as valid
+    TEST_ASSERT_FALSE(ring.read(4, out));
+    TEST_ASSERT_FALSE(ring.read(20, out));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_mailbox_starts_empty);
+    RUN_TEST(test_mailbox_returns_latest_value);
+    RUN_TEST(test_mailbox_never_returns_torn_value);
+    RUN_TEST(test_ring_reads_by_sequence);
+    RUN_TEST(test_ring_overwrites_oldest);
+    return UNITY_END();
+}
@@ -0,0 +1,126 @@
+#include <unity.h>
+#include "utilities/Pid.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void test_proportional_output()
+{
+    PidController pid;
+    pid.setGains({0.1f, 0.0f, 0.0f});
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.5f, pid.compute(50.0f, 45.0f, 0.1f));
+}
+
+static void test_output_is_clamped_to_duty_range()
+{
+    PidController pid;
+    pid.setGains({1.0f, 0.0f, 0.0f});
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, pid.compute(50.0f, 20.0f, 0.1f));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pid.compute(20.0f, 50.0f, 0.1f));
+}
+
+static void test_integral_does_not_wind_up_while_saturated()
+{
+    PidController pid;
+    pid.setGains({0.0f, 0.1f, 0.0f});
+    for (int i = 0; i < 1000; i++)
+        pid.compute(50.0f, 40.0f, 1.0f);
+
+    // Clamped at full duty, so the first step past the setpoint already backs off
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.9f, pid.compute(50.0f, 51.0f, 1.0f));
+}
+
+static void test_setpoint_step_causes_no_derivative_kick()
+{
+    PidController pid;
+    pid.setGains({0.0f, 0.0f, 1.0f});
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pid.compute(40.0f, 40.0f, 1.0f));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pid.compute(80.0f, 40.0f, 1.0f));
+
+    // A falling measurement does act
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.5f, pid.compute(80.0f, 39.5f, 1.0f));
+}
+
+static void test_feed_forward_is_added_and_integral_only_corrects()
+{
+    PidController pid;
+    pid.setGains({0.0f, 0.0f, 0.0f});
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.3f, pid.compute(50.0f, 50.0f, 1.0f, 0.3f));
+}
+
+static void test_reset_forgets_history()
+{
+    PidController pid;
+    pid.setGains({0.0f, 0.1f, 0.0f});
+    pid.compute(50.0f, 45.0f, 1.0f);
+    pid.reset();
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, pid.compute(50.0f, 50.0f, 1.0f));
+}
+
+static void test_time_proportional_window()
+{
+    TimeProportionalOutput out(2000, 200);
+    TEST_ASSERT_TRUE(out.update(0.5f, 10000));
+    TEST_ASSERT_TRUE(out.update(0.9f, 10999));     // duty is sampled once per window
+    TEST_ASSERT_FALSE(out.update(0.9f, 11000));
+    TEST_ASSERT_FALSE(out.update(0.9f, 11999));
+    TEST_ASSERT_TRUE(out.update(0.9f, 12000));
+    TEST_ASSERT_TRUE(out.update(0.9f, 13799));
+    TEST_ASSERT_FALSE(out.update(0.9f, 13800));
+}
+
+static void test_time_proportional_drops_short_pulses()
+{
+    TimeProportionalOutput out(2000, 200);
+    TEST_ASSERT_FALSE(out.update(0.05f, 0));       // 100 ms on is too short
+    TEST_ASSERT_TRUE(out.update(0.95f, 2000));     // 100 ms off is too short: full window
+    TEST_ASSERT_TRUE(out.update(0.95f, 3999));
+}
+
+static void test_autotune_times_out()
+{
+    PidAutotuner tuner;
+    tuner.begin(50.0f, 0.3f, 4, 1000, 0);
+    TEST_ASSERT_EQUAL(PidAutotuner::RUNNING, tuner.getState());
+    TEST_ASSERT_TRUE(tuner.update(40.0f, 500));
+    TEST_ASSERT_FALSE(tuner.update(40.0f, 1001));
+    TEST_ASSERT_EQUAL(PidAutotuner::FAILED, tuner.getState());
+}
+
+static void test_autotune_derives_gains_from_limit_cycle()
+{
+    // Triangle wave of +/- 2 C around 50 C with a 60 s period, sampled at 1 Hz
+    PidAutotuner tuner;
+    tuner.begin(50.0f, 0.3f, 2, 3600000, 0);
+    uint32_t t = 0;
+    for (; t < 600000 && tuner.getState() == PidAutotuner::RUNNING; t += 1000)
+    {
+        uint32_t phase = t % 60000;
+        float temperature = phase < 30000 ? 48.0f + 4.0f * phase / 30000 : 52.0f - 4.0f * (phase - 30000) / 30000;
+        tuner.update(temperature, t);
+    }
+    TEST_ASSERT_EQUAL(PidAutotuner::DONE, tuner.getState());
+
+    // Ku = 4 * 0.5 / (pi * 2), Tu = 60 s, Tyreus-Luyben
+    const float ku = 2.0f / ((float)M_PI * 2.0f);
+    const float kp = ku / 2.2f;
+    TEST_ASSERT_FLOAT_WITHIN(kp * 0.05f, kp, tuner.getGains().kp);
+    TEST_ASSERT_FLOAT_WITHIN(kp / 132.0f * 0.05f, kp / 132.0f, tuner.getGains().ki);
+    TEST_ASSERT_FLOAT_WITHIN(kp * 60.0f / 6.3f * 0.05f, kp * 60.0f / 6.3f, tuner.getGains().kd);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_proportional_output);
+    RUN_TEST(test_output_is_clamped_to_duty_range);
+    RUN_TEST(test_integral_does_not_wind_up_while_saturated);
+    RUN_TEST(test_setpoint_step_causes_no_derivative_kick);
+    RUN_TEST(test_feed_forward_is_added_and_integral_only_corrects);
+    RUN_TEST(test_reset_forgets_history);
+    RUN_TEST(test_time_proportional_window);
+    RUN_TEST(test_time_proportional_drops_short_pulses);
+    RUN_TEST(test_autotune_times_out);
+    RUN_TEST(test_autotune_derives_gains_from_limit_cycle);
+    return UNITY_END();
+}
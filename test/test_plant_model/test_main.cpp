@@ -0,0 +1,105 @@
+#include <unity.h>
+#include "utilities/PlantModel.h"
+#include "config/Config.h"
+
+void setUp() {}
+void tearDown() {}
+
+/**
+ * @brief First-order plant driven by a relay, integrated in 100 ms steps
+ */
+struct SimulatedPlate
+{
+    float gain;
+    float tau;
+    float ambient;
+    float temperature;
+
+    void step(bool heating, float dt)
+    {
+        temperature += ((heating ? gain : 0.0f) - (temperature - ambient)) / tau * dt;
+    }
+};
+
+// Feeds the model from a plate run with a duty that changes every few minutes
+static void identify(PlantModel &model, SimulatedPlate &plate, uint32_t durationMs)
+{
+    static const float DUTIES[] = {1.0f, 0.2f, 0.7f, 0.0f, 0.5f, 0.9f, 0.3f};
+    for (uint32_t t = 0; t <= durationMs; t += 100)
+    {
+        float duty = DUTIES[(t / 120000) % (sizeof(DUTIES) / sizeof(DUTIES[0]))];
+        bool heating = (t % 2000) < duty * 2000;
+        model.update(plate.temperature, heating, t);
+        plate.step(heating, 0.1f);
+    }
+}
+
+static void test_defaults_until_enough_samples()
+{
+    PlantModel model;
+    TEST_ASSERT_FALSE(model.isValid());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, PLANT_DEFAULT_GAIN, model.getGain());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, PLANT_DEFAULT_TAU_S, model.getTimeConstant());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, PLANT_DEFAULT_AMBIENT, model.getAmbient());
+
+    SimulatedPlate plate = {200.0f, 300.0f, 25.0f, 25.0f};
+    identify(model, plate, (PLANT_MIN_SAMPLES - 1) * PLANT_SAMPLE_MS);
+    TEST_ASSERT_EQUAL(PLANT_MIN_SAMPLES - 1, model.getSamples());
+    TEST_ASSERT_FALSE(model.isValid());
+}
+
+static void test_identifies_first_order_plant()
+{
+    PlantModel model;
+    SimulatedPlate plate = {200.0f, 300.0f, 25.0f, 25.0f};
+    identify(model, plate, 3600000);
+
+    TEST_ASSERT_TRUE(model.isValid());
+    TEST_ASSERT_FLOAT_WITHIN(20.0f, 200.0f, model.getGain());
+    TEST_ASSERT_FLOAT_WITHIN(30.0f, 300.0f, model.getTimeConstant());
+    TEST_ASSERT_FLOAT_WITHIN(3.0f, 25.0f, model.getAmbient());
+}
+
+static void test_feed_forward_inverts_the_model()
+{
+    PlantModel model;
+    // Defaults: 150 C rise, 180 s, 22 C ambient
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, (97.0f - 22.0f) / 150.0f, model.feedForward(97.0f, 0.0f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, (97.0f - 22.0f + 180.0f * 0.1f) / 150.0f, model.feedForward(97.0f, 0.1f));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, model.feedForward(10.0f, 0.0f));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, model.feedForward(300.0f, 0.0f));
+}
+
+static void test_nan_restarts_the_interval()
+{
+    PlantModel model;
+    model.update(25.0f, true, 0);
+    model.update(NAN, true, 2500);
+    model.update(25.0f, true, 4000);
+    model.update(26.0f, true, 5000);
+    TEST_ASSERT_EQUAL(0, model.getSamples());
+    model.update(27.0f, true, 9000);
+    TEST_ASSERT_EQUAL(1, model.getSamples());
+}
+
+static void test_reset_forgets_estimate()
+{
+    PlantModel model;
+    SimulatedPlate plate = {200.0f, 300.0f, 25.0f, 25.0f};
+    identify(model, plate, 600000);
+    model.reset();
+    TEST_ASSERT_EQUAL(0, model.getSamples());
+    TEST_ASSERT_FALSE(model.isValid());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, PLANT_DEFAULT_GAIN, model.getGain());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_defaults_until_enough_samples);
+    RUN_TEST(test_identifies_first_order_plant);
+    RUN_TEST(test_feed_forward_inverts_the_model);
+    RUN_TEST(test_nan_restarts_the_interval);
+    RUN_TEST(test_reset_forgets_estimate);
+    return UNITY_END();
+}
@@ -0,0 +1,189 @@
+#include <unity.h>
+#include <string.h>
+#include "utilities/ProfileEngine.h"
+
+using namespace Profile;
+
+void setUp() {}
+void tearDown() {}
+
+static Program makeProgram(const Segment *segments, uint8_t count)
+{
+    Program program = {};
+    strcpy(program.name, "test");
+    program.count = count;
+    memcpy(program.segments, segments, count * sizeof(Segment));
+    return program;
+}
+
+static void test_ramp_interpolates_from_start_temperature()
+{
+    const Segment segments[] = {{RAMP_TO, 0, 0, 80.0f, 6.0f}};   // 30 -> 80 C at 6 C/min: 500 s
+    ProfileEngine engine;
+    engine.start(makeProgram(segments, 1), 30.0f, 1000);
+
+    TEST_ASSERT_TRUE(engine.update(30.0f, 1000));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 30.0f, engine.getSetpoint());
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.1f, engine.getSetpointRate());
+
+    TEST_ASSERT_TRUE(engine.update(50.0f, 251000));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 55.0f, engine.getSetpoint());
+    TEST_ASSERT_EQUAL(250, engine.getSegmentElapsed(251000));
+
+    TEST_ASSERT_FALSE(engine.update(80.0f, 501000));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 80.0f, engine.getSetpoint());
+    TEST_ASSERT_FALSE(engine.isRunning());
+    TEST_ASSERT_EQUAL(-1, engine.getSegment());
+}
+
+static void test_cooling_ramp_has_negative_rate()
+{
+    const Segment segments[] = {{RAMP_TO, 0, 0, 40.0f, 3.0f}};
+    ProfileEngine engine;
+    engine.start(makeProgram(segments, 1), 100.0f, 0);
+    TEST_ASSERT_TRUE(engine.update(100.0f, 600000));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 70.0f, engine.getSetpoint());
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, -0.05f, engine.getSetpointRate());
+}
+
+static void test_segments_end_on_schedule_despite_late_ticks()
+{
+    const Segment segments[] = {
+        {RAMP_TO, 0, 0, 40.0f, 60.0f},      // 20 -> 40 C: 20 s
+        {SOAK, 0, 0, 0.0f, 10.0f},
+        {RAMP_TO, 0, 0, 50.0f, 60.0f},      // 10 s
+    };
+    ProfileEngine engine;
+    engine.start(makeProgram(segments, 3), 20.0f, 0);
+
+    // One late tick passes the ramp and finds the soak 5 s in
+    TEST_ASSERT_TRUE(engine.update(40.0f, 25000));
+    TEST_ASSERT_EQUAL(1, engine.getSegment());
+    TEST_ASSERT_EQUAL(5, engine.getSegmentElapsed(25000));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 40.0f, engine.getSetpoint());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, engine.getSetpointRate());
+
+    // The second ramp starts at 30 s and its setpoint continues from the soak
+    TEST_ASSERT_TRUE(engine.update(40.0f, 35000));
+    TEST_ASSERT_EQUAL(2, engine.getSegment());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 45.0f, engine.getSetpoint());
+    TEST_ASSERT_FALSE(engine.update(50.0f, 40000));
+}
+
+static void test_wait_temp_holds_until_within_band()
+{
+    const Segment segments[] = {
+        {WAIT_TEMP, 0, 0, 60.0f, 1.0f},
+        {SOAK, 0, 0, 0.0f, 5.0f},
+    };
+    ProfileEngine engine;
+    engine.start(makeProgram(segments, 2), 25.0f, 0);
+
+    TEST_ASSERT_TRUE(engine.update(25.0f, 0));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 60.0f, engine.getSetpoint());
+    TEST_ASSERT_TRUE(engine.update(NAN, 300000));
+    TEST_ASSERT_TRUE(engine.update(58.5f, 400000));
+    TEST_ASSERT_EQUAL(0, engine.getSegment());
+
+    // The soak counts from the tick that saw the band, not from the start
+    TEST_ASSERT_TRUE(engine.update(59.5f, 500000));
+    TEST_ASSERT_EQUAL(1, engine.getSegment());
+    TEST_ASSERT_TRUE(engine.update(60.0f, 504999));
+    TEST_ASSERT_FALSE(engine.update(60.0f, 505000));
+}
+
+static void test_loop_repeats_count_times()
+{
+    const Segment segments[] = {
+        {SOAK, 0, 0, 0.0f, 10.0f},
+        {LOOP, 0, 2, 0.0f, 0.0f},
+    };
+    ProfileEngine engine;
+    engine.start(makeProgram(segments, 2), 25.0f, 0);
+
+    // The soak runs once plus two repetitions: 30 s
+    TEST_ASSERT_TRUE(engine.update(25.0f, 15000));
+    TEST_ASSERT_EQUAL(0, engine.getSegment());
+    TEST_ASSERT_EQUAL(5, engine.getSegmentElapsed(15000));
+    TEST_ASSERT_TRUE(engine.update(25.0f, 29999));
+    TEST_ASSERT_FALSE(engine.update(25.0f, 30000));
+}
+
+static void test_nested_loops_rearm()
+{
+    const Segment segments[] = {
+        {SOAK, 0, 0, 0.0f, 1.0f},
+        {LOOP, 0, 1, 0.0f, 0.0f},           // inner: 2 soaks
+        {LOOP, 0, 2, 0.0f, 0.0f},           // outer: 3 inner passes
+    };
+    ProfileEngine engine;
+    engine.start(makeProgram(segments, 3), 25.0f, 0);
+    TEST_ASSERT_TRUE(engine.update(25.0f, 5999));
+    TEST_ASSERT_FALSE(engine.update(25.0f, 6000));
+}
+
+static void test_loop_of_zero_length_segments_terminates()
+{
+    const Segment segments[] = {
+        {SOAK, 0, 0, 0.0f, 0.0f},
+        {LOOP, 0, 65535, 0.0f, 0.0f},
+    };
+    ProfileEngine engine;
+    engine.start(makeProgram(segments, 2), 25.0f, 0);
+    // Bounded per tick, so update() returns while the loop is still counting
+    TEST_ASSERT_TRUE(engine.update(25.0f, 0));
+}
+
+static void test_stop()
+{
+    ProfileEngine engine;
+    engine.start(recrystallization(), 25.0f, 0);
+    TEST_ASSERT_TRUE(engine.update(25.0f, 1000));
+    engine.stop();
+    TEST_ASSERT_FALSE(engine.update(25.0f, 2000));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, engine.getSetpointRate());
+}
+
+static void test_validate()
+{
+    TEST_ASSERT_NULL(validate(recrystallization()));
+
+    const Segment zeroRate[] = {{RAMP_TO, 0, 0, 50.0f, 0.0f}};
+    TEST_ASSERT_NOT_NULL(validate(makeProgram(zeroRate, 1)));
+    const Segment tooHot[] = {{WAIT_TEMP, 0, 0, MAX_TEMP_LIMIT + 1.0f, 1.0f}};
+    TEST_ASSERT_NOT_NULL(validate(makeProgram(tooHot, 1)));
+    const Segment nanTemp[] = {{RAMP_TO, 0, 0, NAN, 1.0f}};
+    TEST_ASSERT_NOT_NULL(validate(makeProgram(nanTemp, 1)));
+    const Segment forwardLoop[] = {{LOOP, 1, 1, 0.0f, 0.0f}, {SOAK, 0, 0, 0.0f, 1.0f}};
+    TEST_ASSERT_NOT_NULL(validate(makeProgram(forwardLoop, 2)));
+    const Segment unknownOp[] = {{9, 0, 0, 0.0f, 0.0f}};
+    TEST_ASSERT_NOT_NULL(validate(makeProgram(unknownOp, 1)));
+    TEST_ASSERT_NOT_NULL(validate(makeProgram(unknownOp, 0)));
+}
+
+static void test_is_valid_name()
+{
+    TEST_ASSERT_TRUE(isValidName("reflow_2-b"));
+    TEST_ASSERT_FALSE(isValidName(""));
+    TEST_ASSERT_FALSE(isValidName(nullptr));
+    TEST_ASSERT_FALSE(isValidName("../x"));
+    TEST_ASSERT_FALSE(isValidName("a b"));
+    TEST_ASSERT_TRUE(isValidName("abcdefghijklmnopqrstuvw"));     // 23 characters
+    TEST_ASSERT_FALSE(isValidName("abcdefghijklmnopqrstuvwx"));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_ramp_interpolates_from_start_temperature);
+    RUN_TEST(test_cooling_ramp_has_negative_rate);
+    RUN_TEST(test_segments_end_on_schedule_despite_late_ticks);
+    RUN_TEST(test_wait_temp_holds_until_within_band);
+    RUN_TEST(test_loop_repeats_count_times);
+    RUN_TEST(test_nested_loops_rearm);
+    RUN_TEST(test_loop_of_zero_length_segments_terminates);
+    RUN_TEST(test_stop);
+    RUN_TEST(test_validate);
+    RUN_TEST(test_is_valid_name);
+    return UNITY_END();
+}
@@ -0,0 +1,100 @@
+#include <unity.h>
+#include "utilities/TelemetryFrame.h"
+#include "managers/SystemState.h"
+
+using namespace Telemetry;
+
+void setUp() {}
+void tearDown() {}
+
+static void test_field_by_name()
+{
+    TEST_ASSERT_EQUAL_HEX16(FIELD_TEMPERATURE, fieldByName("temperature"));
+    TEST_ASSERT_EQUAL_HEX16(FIELD_ALERT_TIMER, fieldByName("alertTimerThreshold"));
+    TEST_ASSERT_EQUAL_HEX16(FIELD_PROFILE, fieldByName("profile"));
+    TEST_ASSERT_EQUAL_HEX16(0, fieldByName("Temperature"));
+    TEST_ASSERT_EQUAL_HEX16(0, fieldByName(""));
+}
+
+static void test_first_frame_carries_every_field()
+{
+    SystemState state;
+    state.temperature = 42.5f;
+    state.rpm = 300;
+    state.mode = HeaterModeManager::RAMP;
+
+    Encoder encoder;
+    TEST_ASSERT_TRUE(encoder.update(state, 12));
+    const Frame &frame = encoder.frame();
+    TEST_ASSERT_EQUAL_HEX8(FRAME_MAGIC, frame.magic);
+    TEST_ASSERT_EQUAL(FRAME_VERSION, frame.version);
+    TEST_ASSERT_EQUAL_HEX16(FIELD_ALL, frame.dirtyMask);
+    TEST_ASSERT_EQUAL(1, frame.sequence);
+    TEST_ASSERT_EQUAL_FLOAT(42.5f, frame.temperature);
+    TEST_ASSERT_EQUAL(300, frame.rpm);
+    TEST_ASSERT_EQUAL(HeaterModeManager::RAMP, frame.mode);
+    TEST_ASSERT_EQUAL(12, frame.runningTime);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, frame.profileSegment);
+}
+
+static void test_unchanged_state_sends_nothing()
+{
+    SystemState state;
+    Encoder encoder;
+    encoder.update(state, 0);
+    TEST_ASSERT_FALSE(encoder.update(state, 0));
+    TEST_ASSERT_EQUAL(1, encoder.frame().sequence);
+}
+
+static void test_dirty_mask_tracks_changed_fields()
+{
+    SystemState state;
+    Encoder encoder;
+    encoder.update(state, 0);
+
+    state.temperature = 30.0f;
+    state.rpmSetpoint = 500;
+    TEST_ASSERT_TRUE(encoder.update(state, 0));
+    TEST_ASSERT_EQUAL_HEX16(FIELD_TEMPERATURE | FIELD_RPM_SETPOINT, encoder.frame().dirtyMask);
+    TEST_ASSERT_EQUAL(2, encoder.frame().sequence);
+
+    state.profileSegment = 3;
+    TEST_ASSERT_TRUE(encoder.update(state, 1));
+    TEST_ASSERT_EQUAL_HEX16(FIELD_RUNNING_TIME | FIELD_PROFILE, encoder.frame().dirtyMask);
+    TEST_ASSERT_EQUAL(3, encoder.frame().profileSegment);
+}
+
+static void test_force_marks_every_field()
+{
+    SystemState state;
+    Encoder encoder;
+    encoder.update(state, 0);
+    TEST_ASSERT_TRUE(encoder.update(state, 0, true));
+    TEST_ASSERT_EQUAL_HEX16(FIELD_ALL, encoder.frame().dirtyMask);
+    TEST_ASSERT_EQUAL(2, encoder.frame().sequence);
+}
+
+static void test_frame_is_little_endian_packed()
+{
+    SystemState state;
+    state.rpm = 0x01020304;
+    Encoder encoder;
+    encoder.update(state, 0);
+
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&encoder.frame());
+    TEST_ASSERT_EQUAL_HEX8(FRAME_MAGIC, bytes[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x04, bytes[12]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, bytes[15]);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_field_by_name);
+    RUN_TEST(test_first_frame_carries_every_field);
+    RUN_TEST(test_unchanged_state_sends_nothing);
+    RUN_TEST(test_dirty_mask_tracks_changed_fields);
+    RUN_TEST(test_force_marks_every_field);
+    RUN_TEST(test_frame_is_little_endian_packed);
+    return UNITY_END();
+}
@@ -0,0 +1,110 @@
+#include <unity.h>
+#include "utilities/TemperatureFilters.h"
+
+using namespace TemperatureFilters;
+
+void setUp() {}
+void tearDown() {}
+
+static void test_median_rejects_single_spike()
+{
+    Median<5> median;
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, median.apply(20.0f));
+    median.apply(21.0f);
+    median.apply(22.0f);
+    TEST_ASSERT_EQUAL_FLOAT(22.0f, median.apply(500.0f));
+    TEST_ASSERT_EQUAL_FLOAT(22.0f, median.apply(23.0f));
+    TEST_ASSERT_EQUAL_FLOAT(23.0f, median.apply(24.0f));
+}
+
+static void test_median_window_slides_and_resets()
+{
+    Median<3> median;
+    median.apply(1.0f);
+    median.apply(9.0f);
+    median.apply(5.0f);
+    TEST_ASSERT_EQUAL_FLOAT(9.0f, median.apply(10.0f));     // {10, 9, 5}
+    median.reset();
+    TEST_ASSERT_EQUAL_FLOAT(42.0f, median.apply(42.0f));
+}
+
+static void test_ema_starts_at_first_sample()
+{
+    Ema ema(0.25f);
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, ema.apply(40.0f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 42.5f, ema.apply(50.0f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 44.375f, ema.apply(50.0f));
+    ema.reset();
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, ema.apply(10.0f));
+}
+
+static void test_biquad_has_no_startup_transient()
+{
+    BiquadLowPass biquad(0.5f, 10.0f, 0.7071f);
+    for (int i = 0; i < 50; i++)
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, 85.0f, biquad.apply(85.0f));
+}
+
+static void test_biquad_settles_on_step_and_attenuates_nyquist()
+{
+    BiquadLowPass biquad(0.5f, 10.0f, 0.7071f);
+    biquad.apply(20.0f);
+    float y = 0.0f;
+    for (int i = 0; i < 200; i++)
+        y = biquad.apply(30.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 30.0f, y);
+
+    // +/- 1 C alternating every sample is far above the cutoff
+    float peak = 0.0f;
+    for (int i = 0; i < 200; i++)
+    {
+        y = biquad.apply(30.0f + (i % 2 ? 1.0f : -1.0f));
+        if (i >= 100)
+            peak = fmaxf(peak, fabsf(y - 30.0f));
+    }
+    TEST_ASSERT_TRUE(peak < 0.05f);
+}
+
+static void test_kalman_converges_and_reduces_noise()
+{
+    Kalman kalman(0.001f, 1.0f);
+    TEST_ASSERT_EQUAL_FLOAT(50.0f, kalman.apply(50.0f));
+    float y = 0.0f;
+    for (int i = 0; i < 400; i++)
+        y = kalman.apply(60.0f + (i % 2 ? 0.5f : -0.5f));
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 60.0f, y);
+}
+
+static void test_stage_chain_applies_left_to_right()
+{
+    // The median removes the spike before the low-pass can smear it
+    Pipeline<Median<3>, ConfiguredKalman> pipeline;
+    ITemperatureFilter &filter = pipeline;
+    filter.apply(25.0f);
+    filter.apply(25.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 25.0f, filter.apply(900.0f));
+
+    filter.reset();
+    TEST_ASSERT_EQUAL_FLOAT(70.0f, filter.apply(70.0f));
+}
+
+static void test_configured_pipeline_passes_steady_temperature()
+{
+    ConfiguredPipeline pipeline;
+    for (int i = 0; i < 100; i++)
+        TEST_ASSERT_FLOAT_WITHIN(1e-2f, 37.5f, pipeline.apply(37.5f));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_median_rejects_single_spike);
+    RUN_TEST(test_median_window_slides_and_resets);
+    RUN_TEST(test_ema_starts_at_first_sample);
+    RUN_TEST(test_biquad_has_no_startup_transient);
+    RUN_TEST(test_biquad_settles_on_step_and_attenuates_nyquist);
+    RUN_TEST(test_kalman_converges_and_reduces_noise);
+    RUN_TEST(test_stage_chain_applies_left_to_right);
+    RUN_TEST(test_configured_pipeline_passes_steady_temperature);
+    return UNITY_END();
+}